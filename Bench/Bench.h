@@ -0,0 +1,35 @@
+/**
+* @file Bench.h
+*/
+#ifndef BENCH_H_INCLUDED
+#define BENCH_H_INCLUDED
+#include <chrono>
+
+/**
+* 経過時間計測クラス.
+*/
+class Stopwatch
+{
+public:
+  Stopwatch() : start(std::chrono::high_resolution_clock::now()) {}
+
+  void Reset() { start = std::chrono::high_resolution_clock::now(); }
+  double ElapsedNs() const {
+    return std::chrono::duration<double, std::nano>(std::chrono::high_resolution_clock::now() - start).count();
+  }
+
+private:
+  std::chrono::high_resolution_clock::time_point start;
+};
+
+void BenchSpriteVertex();
+void BenchTiledMapLoad();
+void BenchTileCollision();
+void BenchJsonParse();
+void BenchJsonBind();
+void BenchJsonWrite();
+void BenchPngDecode();
+void BenchTextureStartup();
+void BenchTextureAsync();
+
+#endif // BENCH_H_INCLUDED
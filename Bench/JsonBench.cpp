@@ -0,0 +1,635 @@
+/**
+* @file JsonBench.cpp
+*/
+#include "Bench.h"
+#include "JsonBind.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+#include <string>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
+
+namespace /* unnamed */ {
+
+size_t allocationCount = 0; ///< operator newの呼び出し回数.
+
+/**
+* Tiled Map Editorの出力に似たJSONデータを作成する.
+*
+* @param mapSize     タイルレイヤーの縦横のタイル数.
+* @param objectCount オブジェクトレイヤーのオブジェクト数.
+*
+* @return 作成したJSONデータ.
+*/
+std::string MakeMapJson(int mapSize, int objectCount)
+{
+  std::mt19937 rand(0);
+  std::string json;
+  json.reserve(mapSize * mapSize * 4 + objectCount * 160);
+  char buf[256];
+  snprintf(buf, sizeof(buf), "{\"height\":%d,\"width\":%d,\"tilewidth\":32,\"tileheight\":32,\"layers\":[\n", mapSize, mapSize);
+  json += buf;
+  snprintf(buf, sizeof(buf), " {\"type\":\"tilelayer\",\"name\":\"ground\",\"width\":%d,\"height\":%d,\"visible\":true,\"opacity\":1,\"data\":[", mapSize, mapSize);
+  json += buf;
+  for (int i = 0; i < mapSize * mapSize; ++i) {
+    snprintf(buf, sizeof(buf), i ? ",%u" : "%u", static_cast<unsigned>(rand() % 256));
+    json += buf;
+  }
+  json += "]},\n {\"type\":\"objectgroup\",\"name\":\"enemies\",\"visible\":true,\"opacity\":1,\"objects\":[\n";
+  for (int i = 0; i < objectCount; ++i) {
+    snprintf(buf, sizeof(buf),
+      "  {\"id\":%d,\"name\":\"enemy%d\",\"type\":\"zako\",\"x\":%.2f,\"y\":%.2f,\"width\":32,\"height\":32,"
+      "\"properties\":[{\"name\":\"hp\",\"type\":\"int\",\"value\":%d}]}%s\n",
+      i + 1, i, (rand() % 100000) * 0.25, (rand() % 100000) * 0.25, static_cast<int>(rand() % 10), i + 1 < objectCount ? "," : "");
+    json += buf;
+  }
+  json += " ]}],\n \"tilesets\":[{\"tilewidth\":32,\"tileheight\":32,\"columns\":16,\"firstgid\":1,\"image\":\"Objects.png\"}]}\n";
+  return json;
+}
+
+/**
+* JSONデータをTiled Map Editorの出力のように字下げする.
+*
+* @param json 空白を含まないJSONデータ.
+*
+* @return 字下げしたJSONデータ. 数値の配列は1行にまとめる.
+*/
+std::string Indent(const std::string& json)
+{
+  std::string out;
+  out.reserve(json.size() * 2);
+  std::vector<bool> isNumberArray;
+  bool inString = false;
+  auto newLine = [&out, &isNumberArray]() {
+    out += '\n';
+    out.append(isNumberArray.size() * 4, ' ');
+  };
+  for (size_t i = 0; i < json.size(); ++i) {
+    const char c = json[i];
+    if (inString) {
+      out += c;
+      if (c == '\\') {
+        out += json[++i];
+      } else if (c == '"') {
+        inString = false;
+      }
+      continue;
+    }
+    switch (c) {
+    case '"':
+      inString = true;
+      out += c;
+      break;
+    case '{':
+    case '[': {
+      const bool numbers = c == '[' && i + 1 < json.size() && (isdigit(static_cast<unsigned char>(json[i + 1])) || json[i + 1] == '-');
+      out += c;
+      isNumberArray.push_back(numbers);
+      if (!numbers) {
+        newLine();
+      }
+      break;
+    }
+    case '}':
+    case ']': {
+      const bool numbers = isNumberArray.back();
+      isNumberArray.pop_back();
+      if (!numbers) {
+        newLine();
+      }
+      out += c;
+      break;
+    }
+    case ',':
+      out += c;
+      if (isNumberArray.back()) {
+        out += ' ';
+      } else {
+        newLine();
+      }
+      break;
+    case ':':
+      out += ": ";
+      break;
+    case ' ':
+    case '\n':
+      break;
+    default:
+      out += c;
+      break;
+    }
+  }
+  return out;
+}
+
+/**
+* MakeMapJson()のオブジェクトレイヤーのオブジェクト.
+*/
+struct MapObject
+{
+  int id = 0;
+  std::string name;
+  std::string type;
+  float x = 0;
+  float y = 0;
+  float width = 0;
+  float height = 0;
+
+  JSON_FIELDS(MapObject,
+    JSON_REQUIRED(id, "id"),
+    JSON_REQUIRED(name, "name"),
+    JSON_REQUIRED(type, "type"),
+    JSON_REQUIRED(x, "x"),
+    JSON_REQUIRED(y, "y"),
+    JSON_REQUIRED(width, "width"),
+    JSON_REQUIRED(height, "height"));
+};
+
+/**
+* MakeMapJson()のレイヤー.
+*/
+struct MapLayer
+{
+  std::string type;
+  std::string name;
+  std::vector<uint32_t> data;
+  std::vector<MapObject> objects;
+
+  JSON_FIELDS(MapLayer,
+    JSON_REQUIRED(type, "type"),
+    JSON_REQUIRED(name, "name"),
+    JSON_OPTIONAL(data, "data"),
+    JSON_OPTIONAL(objects, "objects"));
+};
+
+/**
+* MakeMapJson()のマップ.
+*/
+struct MapFile
+{
+  int width = 0;
+  int height = 0;
+  std::vector<MapLayer> layers;
+
+  JSON_FIELDS(MapFile,
+    JSON_REQUIRED(width, "width"),
+    JSON_REQUIRED(height, "height"),
+    JSON_REQUIRED(layers, "layers"));
+};
+
+/**
+* Json::ValueからMapFileを作成する.
+*
+* Json::Bindを使わない場合の、Json::Objectを検索して値を取り出す処理.
+*/
+void LoadMapFile(const Json::Value& value, MapFile& map)
+{
+  const Json::Object& root = value.AsObject();
+  map.width = root.find("width")->second.AsNumber<int>();
+  map.height = root.find("height")->second.AsNumber<int>();
+  for (const auto& e : root.find("layers")->second.AsArray()) {
+    const Json::Object& layer = e.AsObject();
+    map.layers.emplace_back();
+    MapLayer& tmp = map.layers.back();
+    tmp.type = layer.find("type")->second.AsString();
+    tmp.name = layer.find("name")->second.AsString();
+    const auto data = layer.find("data");
+    if (data != layer.end()) {
+      tmp.data.reserve(data->second.AsArray().size());
+      for (const auto& tile : data->second.AsArray()) {
+        tmp.data.push_back(tile.AsNumber<uint32_t>());
+      }
+    }
+    const auto objects = layer.find("objects");
+    if (objects != layer.end()) {
+      for (const auto& o : objects->second.AsArray()) {
+        const Json::Object& object = o.AsObject();
+        tmp.objects.emplace_back();
+        MapObject& obj = tmp.objects.back();
+        obj.id = object.find("id")->second.AsNumber<int>();
+        obj.name = object.find("name")->second.AsString();
+        obj.type = object.find("type")->second.AsString();
+        obj.x = object.find("x")->second.AsNumber<float>();
+        obj.y = object.find("y")->second.AsNumber<float>();
+        obj.width = object.find("width")->second.AsNumber<float>();
+        obj.height = object.find("height")->second.AsNumber<float>();
+      }
+    }
+  }
+}
+
+/**
+* Json::NodeからMapFileを作成する.
+*/
+void LoadMapFile(const Json::Node& root, MapFile& map)
+{
+  map.width = root["width"].AsNumber<int>();
+  map.height = root["height"].AsNumber<int>();
+  const Json::Node& layers = root["layers"];
+  for (const Json::Node* e = layers.Begin(); e != layers.End(); ++e) {
+    const Json::Node& layer = *e;
+    map.layers.emplace_back();
+    MapLayer& tmp = map.layers.back();
+    tmp.type = layer["type"].AsString().ToString();
+    tmp.name = layer["name"].AsString().ToString();
+    const Json::Node& data = layer["data"];
+    tmp.data.reserve(data.Size());
+    for (const Json::Node* tile = data.Begin(); tile != data.End(); ++tile) {
+      tmp.data.push_back(tile->AsNumber<uint32_t>());
+    }
+    const Json::Node& objects = layer["objects"];
+    for (const Json::Node* o = objects.Begin(); o != objects.End(); ++o) {
+      tmp.objects.emplace_back();
+      MapObject& obj = tmp.objects.back();
+      obj.id = (*o)["id"].AsNumber<int>();
+      obj.name = (*o)["name"].AsString().ToString();
+      obj.type = (*o)["type"].AsString().ToString();
+      obj.x = (*o)["x"].AsNumber<float>();
+      obj.y = (*o)["y"].AsNumber<float>();
+      obj.width = (*o)["width"].AsNumber<float>();
+      obj.height = (*o)["height"].AsNumber<float>();
+    }
+  }
+}
+
+/**
+* 数値の数を数えるHandler.
+*/
+class CountHandler : public Json::Handler
+{
+public:
+  bool OnNumber(Json::Number) override { ++count; return true; }
+  bool OnInteger(int64_t) override { ++count; return true; }
+  size_t count = 0; ///< 数値の数.
+};
+
+} // unnamed namespace
+
+/**
+* メモリ確保の回数を数えるためのoperator new.
+*/
+void* operator new(size_t size)
+{
+  ++allocationCount;
+  if (void* p = malloc(size ? size : 1)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+/**
+* operator newに対応するoperator delete.
+*/
+void operator delete(void* p) noexcept
+{
+  free(p);
+}
+
+/**
+* サイズ付きのoperator delete. C++14ではサイズの分かるdeleteはこちらが呼ばれるため、同じく置き換える.
+*/
+void operator delete(void* p, std::size_t) noexcept
+{
+  free(p);
+}
+
+namespace /* unnamed */ {
+
+/**
+* JSONデータの解析速度とメモリ確保の回数を計測する.
+*
+* @param name 表示するデータの名前.
+* @param json 解析するJSONデータ.
+*/
+void BenchJson(const char* name, const std::string& json)
+{
+  const int repeatCount = 5;
+  const char* const begin = json.data();
+  const char* const end = begin + json.size();
+
+  // Json::Parseは非常に遅いので計測回数を減らす.
+  double valueTime = 1e30;
+  size_t valueAllocation = 0;
+  for (int i = 0; i < 2; ++i) {
+    const size_t count = allocationCount;
+    Stopwatch sw;
+    {
+      const Json::Result result = Json::Parse(begin, end);
+    }
+    valueTime = std::min(valueTime, sw.ElapsedNs());
+    valueAllocation = allocationCount - count;
+  }
+
+  double documentTime = 1e30;
+  double documentFirstTime = 0;
+  size_t documentAllocation = 0;
+  size_t documentFirstAllocation = 0;
+  Json::Document doc;
+  for (int i = 0; i < repeatCount; ++i) {
+    const size_t count = allocationCount;
+    Stopwatch sw;
+    doc.Parse(begin, end);
+    const double time = sw.ElapsedNs();
+    if (i == 0) {
+      documentFirstTime = time;
+      documentFirstAllocation = allocationCount - count;
+    } else {
+      documentTime = std::min(documentTime, time);
+      documentAllocation = allocationCount - count;
+    }
+  }
+
+  const size_t chunkSize = 64 * 1024;
+  double readerTime = 1e30;
+  size_t readerAllocation = 0;
+  for (int i = 0; i < repeatCount; ++i) {
+    CountHandler handler;
+    const size_t count = allocationCount;
+    Stopwatch sw;
+    Json::Reader reader(handler);
+    for (const char* p = begin; p != end; p += std::min<size_t>(chunkSize, end - p)) {
+      reader.Feed(p, std::min<size_t>(chunkSize, end - p));
+    }
+    if (!reader.Finish()) {
+      printf("  Reader  : %s", reader.Error().c_str());
+      return;
+    }
+    readerTime = std::min(readerTime, sw.ElapsedNs());
+    readerAllocation = allocationCount - count;
+  }
+
+  const double mb = json.size() / (1024.0 * 1024.0);
+  printf("  %s: %.2f MB (arena %.2f MB)\n", name, mb, doc.ArenaSize() / (1024.0 * 1024.0));
+  printf("    Value   : %9.3f ms %8.1f MB/s %8zu allocs\n", valueTime * 1e-6, mb / (valueTime * 1e-9), valueAllocation);
+  printf("    Document: %9.3f ms %8.1f MB/s %8zu allocs (first)\n", documentFirstTime * 1e-6, mb / (documentFirstTime * 1e-9), documentFirstAllocation);
+  printf("    Document: %9.3f ms %8.1f MB/s %8zu allocs (reuse)\n", documentTime * 1e-6, mb / (documentTime * 1e-9), documentAllocation);
+  printf("    Reader  : %9.3f ms %8.1f MB/s %8zu allocs\n", readerTime * 1e-6, mb / (readerTime * 1e-9), readerAllocation);
+}
+
+} // unnamed namespace
+
+/**
+* Json::Parse, Json::Document, Json::Readerの解析速度とメモリ確保の回数を比較する.
+*
+* 1024x1024タイルのタイルレイヤーと、20000個のオブジェクトを持つオブジェクトレイヤーからなる
+* JSONデータを解析する. 空白のないデータと、Tiled Map Editorのように字下げしたデータの2種類を使う.
+* Documentは2回目以降の解析でメモリブロックを再利用する.
+* Readerはファイルを読みながら解析する場合を想定して、64KBずつ分けて渡す.
+*/
+void BenchJsonParse()
+{
+  const std::string json = MakeMapJson(1024, 20000);
+  BenchJson("compact ", json);
+  BenchJson("indented", Indent(json));
+}
+
+/**
+* JSONデータから構造体を作成する速度とメモリ確保の回数を比較する.
+*
+* BenchJsonParse()と同じデータから、MapFile構造体を次の3つの方法で作成する.
+* - Json::Parseで作成したJson::Valueを、Json::Object::findで検索する.
+* - Json::Documentで作成したJson::Nodeを、キーで検索する.
+* - Json::Bindで、解析しながら直接書き込む.
+*/
+void BenchJsonBind()
+{
+  const std::string json = MakeMapJson(1024, 20000);
+  const char* const begin = json.data();
+  const char* const end = begin + json.size();
+  const int repeatCount = 5;
+
+  double valueTime = 1e30;
+  size_t valueAllocation = 0;
+  for (int i = 0; i < 2; ++i) {
+    MapFile map;
+    const size_t count = allocationCount;
+    Stopwatch sw;
+    const Json::Result result = Json::Parse(begin, end);
+    LoadMapFile(result.value, map);
+    valueTime = std::min(valueTime, sw.ElapsedNs());
+    valueAllocation = allocationCount - count;
+  }
+
+  double documentTime = 1e30;
+  size_t documentAllocation = 0;
+  Json::Document doc;
+  for (int i = 0; i < repeatCount; ++i) {
+    MapFile map;
+    const size_t count = allocationCount;
+    Stopwatch sw;
+    doc.Parse(begin, end);
+    LoadMapFile(doc.Root(), map);
+    documentTime = std::min(documentTime, sw.ElapsedNs());
+    documentAllocation = allocationCount - count;
+  }
+
+  double bindTime = 1e30;
+  size_t bindAllocation = 0;
+  for (int i = 0; i < repeatCount; ++i) {
+    MapFile map;
+    std::string error;
+    const size_t count = allocationCount;
+    Stopwatch sw;
+    if (!Json::Bind(begin, end, map, error)) {
+      printf("  Bind    : %s", error.c_str());
+      return;
+    }
+    bindTime = std::min(bindTime, sw.ElapsedNs());
+    bindAllocation = allocationCount - count;
+  }
+
+  const double mb = json.size() / (1024.0 * 1024.0);
+  printf("  %.2f MB\n", mb);
+  printf("    Value+find: %9.3f ms %8.1f MB/s %8zu allocs\n", valueTime * 1e-6, mb / (valueTime * 1e-9), valueAllocation);
+  printf("    Document  : %9.3f ms %8.1f MB/s %8zu allocs (reuse)\n", documentTime * 1e-6, mb / (documentTime * 1e-9), documentAllocation);
+  printf("    Bind      : %9.3f ms %8.1f MB/s %8zu allocs\n", bindTime * 1e-6, mb / (bindTime * 1e-9), bindAllocation);
+}
+
+namespace /* unnamed */ {
+
+/**
+* Json::Writerで書き出すデータ.
+*/
+struct WriteData
+{
+  std::vector<MapObject> objects; ///< オブジェクト.
+  std::vector<uint32_t> tiles; ///< タイルレイヤーのデータ.
+  std::vector<double> samples; ///< 計測値のような、任意の桁数の小数.
+};
+
+/**
+* WriteDataをsnprintfで書き出す.
+*
+* Json::Writerを使わない場合の処理. 小数は元の値に戻せるように"%.17g"で書き出す.
+*/
+void WriteWithSnprintf(const WriteData& data, std::string& json)
+{
+  char buf[256];
+  json += "{\"objects\":[";
+  for (size_t i = 0; i < data.objects.size(); ++i) {
+    const MapObject& o = data.objects[i];
+    snprintf(buf, sizeof(buf), "%s{\"id\":%d,\"name\":\"%s\",\"type\":\"%s\",\"x\":%.17g,\"y\":%.17g,\"width\":%.17g,\"height\":%.17g}",
+      i ? "," : "", o.id, o.name.c_str(), o.type.c_str(), o.x, o.y, o.width, o.height);
+    json += buf;
+  }
+  json += "],\"data\":[";
+  for (size_t i = 0; i < data.tiles.size(); ++i) {
+    snprintf(buf, sizeof(buf), i ? ",%u" : "%u", data.tiles[i]);
+    json += buf;
+  }
+  json += "],\"samples\":[";
+  for (size_t i = 0; i < data.samples.size(); ++i) {
+    snprintf(buf, sizeof(buf), i ? ",%.17g" : "%.17g", data.samples[i]);
+    json += buf;
+  }
+  json += "]}";
+}
+
+/**
+* WriteDataをJson::Writerで書き出す.
+*/
+void WriteWithWriter(const WriteData& data, Json::Writer& writer)
+{
+  writer.StartObject();
+  writer.Key("objects");
+  writer.StartArray();
+  for (const MapObject& o : data.objects) {
+    writer.StartObject();
+    writer.Key("id");
+    writer.Integer(o.id);
+    writer.Key("name");
+    writer.String(o.name);
+    writer.Key("type");
+    writer.String(o.type);
+    writer.Key("x");
+    writer.Number(o.x);
+    writer.Key("y");
+    writer.Number(o.y);
+    writer.Key("width");
+    writer.Number(o.width);
+    writer.Key("height");
+    writer.Number(o.height);
+    writer.EndObject();
+  }
+  writer.EndArray();
+  writer.Key("data");
+  writer.StartArray();
+  for (uint32_t e : data.tiles) {
+    writer.Integer(e);
+  }
+  writer.EndArray();
+  writer.Key("samples");
+  writer.StartArray();
+  for (double e : data.samples) {
+    writer.Number(e);
+  }
+  writer.EndArray();
+  writer.EndObject();
+  writer.Flush();
+}
+
+} // unnamed namespace
+
+/**
+* Json::Writerの書き出し速度とメモリ確保の回数を、snprintfを使う場合と比較する.
+*
+* 20000個のオブジェクト, 1024x1024個のタイル番号, 100000個の小数を書き出す.
+* Writerは同じ出力先の配列をclear()して再利用し、2回目以降のメモリ確保がないことを確かめる.
+* フレームごとの記録を想定して、小さなオブジェクトを繰り返し書き出す場合も計測する.
+*/
+void BenchJsonWrite()
+{
+  std::mt19937 rand(0);
+  WriteData data;
+  data.objects.resize(20000);
+  for (size_t i = 0; i < data.objects.size(); ++i) {
+    MapObject& o = data.objects[i];
+    o.id = static_cast<int>(i + 1);
+    o.name = "enemy" + std::to_string(i);
+    o.type = "zako";
+    o.x = (rand() % 100000) * 0.25f;
+    o.y = (rand() % 100000) * 0.25f;
+    o.width = 32;
+    o.height = 32;
+  }
+  data.tiles.resize(1024 * 1024);
+  for (auto& e : data.tiles) {
+    e = rand() % 256;
+  }
+  data.samples.resize(100000);
+  std::uniform_real_distribution<double> dist(0, 1000);
+  for (auto& e : data.samples) {
+    e = dist(rand);
+  }
+
+  const int repeatCount = 5;
+  double snprintfTime = 1e30;
+  size_t snprintfSize = 0;
+  for (int i = 0; i < repeatCount; ++i) {
+    std::string json;
+    Stopwatch sw;
+    WriteWithSnprintf(data, json);
+    snprintfTime = std::min(snprintfTime, sw.ElapsedNs());
+    snprintfSize = json.size();
+  }
+
+  for (int indent = 0; indent <= 2; indent += 2) {
+    std::vector<char> output;
+    Json::Writer writer(output, indent);
+    double time = 1e30;
+    size_t allocation = 0;
+    for (int i = 0; i < repeatCount; ++i) {
+      output.clear();
+      writer.Reset();
+      const size_t count = allocationCount;
+      Stopwatch sw;
+      WriteWithWriter(data, writer);
+      time = std::min(time, sw.ElapsedNs());
+      allocation = allocationCount - count;
+    }
+    const double mb = output.size() / (1024.0 * 1024.0);
+    if (indent == 0) {
+      const double snprintfMb = snprintfSize / (1024.0 * 1024.0);
+      printf("  snprintf: %9.3f ms %8.1f MB/s (%.2f MB)\n", snprintfTime * 1e-6, snprintfMb / (snprintfTime * 1e-9), snprintfMb);
+      printf("  Writer  : %9.3f ms %8.1f MB/s (%.2f MB) %zu allocs (reuse)\n", time * 1e-6, mb / (time * 1e-9), mb, allocation);
+    } else {
+      printf("  Writer  : %9.3f ms %8.1f MB/s (%.2f MB) %zu allocs (reuse, indent=%d)\n", time * 1e-6, mb / (time * 1e-9), mb, allocation, indent);
+    }
+  }
+
+  // フレームごとに小さなオブジェクトを書き出す.
+  const int frameCount = 100000;
+  std::vector<char> output;
+  output.reserve(1024);
+  Json::Writer writer(output);
+  double frameTime = 1e30;
+  size_t frameAllocation = 0;
+  for (int i = 0; i < repeatCount; ++i) {
+    const size_t count = allocationCount;
+    Stopwatch sw;
+    for (int frame = 0; frame < frameCount; ++frame) {
+      output.clear();
+      writer.Reset();
+      writer.StartObject();
+      writer.Key("frame");
+      writer.Integer(frame);
+      writer.Key("time");
+      writer.Number(frame * (1.0 / 60.0));
+      writer.Key("player");
+      writer.StartArray();
+      writer.Number(data.samples[frame]);
+      writer.Number(data.samples[frame + 1]);
+      writer.EndArray();
+      writer.Key("state");
+      writer.String("run");
+      writer.EndObject();
+      writer.Flush();
+    }
+    frameTime = std::min(frameTime, sw.ElapsedNs());
+    frameAllocation = allocationCount - count;
+  }
+  printf("  Writer  : %9.1f ns/frame %zu allocs (%d frames)\n", frameTime / frameCount, frameAllocation, frameCount);
+}
@@ -0,0 +1,46 @@
+/**
+* @file Bench/Main.cpp
+*
+* Lib/Easyの性能を計測するプログラム.
+*
+* Resフォルダを参照するため、ソリューションのフォルダを作業ディレクトリにして実行すること.
+* 引数を指定すると、名前にその文字列を含む計測だけを実行する.
+*/
+#include "Bench.h"
+#include <stdio.h>
+#include <string.h>
+
+namespace /* unnamed */ {
+
+/// 計測関数のリスト.
+const struct {
+  const char* name;
+  void(*func)();
+} benchList[] = {
+  { "SpriteVertex", BenchSpriteVertex },
+  { "TiledMapLoad", BenchTiledMapLoad },
+  { "TileCollision", BenchTileCollision },
+  { "JsonParse", BenchJsonParse },
+  { "JsonBind", BenchJsonBind },
+  { "JsonWrite", BenchJsonWrite },
+  { "PngDecode", BenchPngDecode },
+  { "TextureStartup", BenchTextureStartup },
+  { "TextureAsync", BenchTextureAsync },
+};
+
+} // unnamed namespace
+
+/**
+* プログラムのエントリーポイント.
+*/
+int main(int argc, char** argv)
+{
+  for (const auto& e : benchList) {
+    if (argc >= 2 && !strstr(e.name, argv[1])) {
+      continue;
+    }
+    printf("[%s]\n", e.name);
+    e.func();
+  }
+  return 0;
+}
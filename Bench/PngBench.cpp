@@ -0,0 +1,160 @@
+/**
+* @file PngBench.cpp
+*/
+#include "Bench.h"
+#include "Png.h"
+#include <algorithm>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <dirent.h>
+#endif
+
+namespace /* unnamed */ {
+
+/**
+* 読み込んだPNGファイル.
+*/
+struct PngFile
+{
+  std::string name;
+  std::vector<uint8_t> data;
+};
+
+/**
+* ディレクトリにあるPNGファイル名の一覧を取得する.
+*
+* @param dir 探すディレクトリ. 末尾は'/'で終わること.
+*
+* @return 見つかったファイル名(dirを含む)の配列.
+*/
+std::vector<std::string> FindPngFiles(const std::string& dir)
+{
+  std::vector<std::string> list;
+#ifdef _WIN32
+  _finddata_t data;
+  const intptr_t handle = _findfirst((dir + "*.png").c_str(), &data);
+  if (handle != -1) {
+    do {
+      list.push_back(dir + data.name);
+    } while (_findnext(handle, &data) == 0);
+    _findclose(handle);
+  }
+#else
+  if (DIR* d = opendir(dir.c_str())) {
+    while (const dirent* e = readdir(d)) {
+      const size_t len = strlen(e->d_name);
+      if (len > 4 && strcmp(e->d_name + len - 4, ".png") == 0) {
+        list.push_back(dir + e->d_name);
+      }
+    }
+    closedir(d);
+  }
+#endif
+  std::sort(list.begin(), list.end());
+  return list;
+}
+
+/**
+* ファイルの内容をすべて読み込む.
+*/
+bool ReadFile(const std::string& filename, std::vector<uint8_t>& data)
+{
+  FILE* fp = fopen(filename.c_str(), "rb");
+  if (!fp) {
+    return false;
+  }
+  uint8_t buf[4096];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), fp)) > 0) {
+    data.insert(data.end(), buf, buf + n);
+  }
+  fclose(fp);
+  return true;
+}
+
+} // unnamed namespace
+
+/**
+* PNG画像の展開速度を計測する.
+*
+* Resフォルダにあるすべての.pngファイルについて、1スレッドでの展開速度と、
+* 複数の画像を並列に展開した場合の速度を計測する.
+*/
+void BenchPngDecode()
+{
+  // リポジトリ直下とBenchフォルダのどちらから実行しても見つかるようにする.
+  std::vector<std::string> filenameList = FindPngFiles("Res/");
+  if (filenameList.empty()) {
+    filenameList = FindPngFiles("../Res/");
+  }
+  std::vector<PngFile> fileList;
+  for (const auto& e : filenameList) {
+    PngFile file;
+    file.name = e;
+    if (ReadFile(e, file.data)) {
+      fileList.push_back(std::move(file));
+    }
+  }
+  if (fileList.empty()) {
+    printf("  Resフォルダに.pngファイルが見つかりません.\n");
+    return;
+  }
+
+  const int repeatCount = 10;
+  double totalTime = 0;
+  size_t totalPixelBytes = 0;
+  size_t totalFileBytes = 0;
+  for (const auto& file : fileList) {
+    int width = 0;
+    int height = 0;
+    std::vector<uint8_t> pixels;
+    double time = 1e30;
+    for (int i = 0; i < repeatCount; ++i) {
+      Stopwatch sw;
+      if (!Png::Decode(file.data.data(), file.data.size(), width, height, pixels)) {
+        printf("  %s: 展開に失敗.\n", file.name.c_str());
+        return;
+      }
+      time = std::min(time, sw.ElapsedNs());
+    }
+    const double mb = pixels.size() / (1024.0 * 1024.0);
+    printf("  %-28s %4dx%-4d %8.3f ms %8.1f MB/s\n", file.name.c_str(), width, height, time * 1e-6, mb / (time * 1e-9));
+    totalTime += time;
+    totalPixelBytes += pixels.size();
+    totalFileBytes += file.data.size();
+  }
+  const double totalMb = totalPixelBytes / (1024.0 * 1024.0);
+  printf("  1 thread : %8.3f ms %8.1f MB/s (%.2f MB PNG -> %.2f MB RGBA)\n",
+    totalTime * 1e-6, totalMb / (totalTime * 1e-9), totalFileBytes / (1024.0 * 1024.0), totalMb);
+
+  // 全画像をrepeatCount回ずつ、ひとつの作業列として複数のスレッドで分担して展開する.
+  const size_t threadCount = std::max(1U, std::thread::hardware_concurrency());
+  const size_t jobCount = fileList.size() * repeatCount;
+  std::vector<std::future<void>> futureList;
+  futureList.reserve(threadCount);
+  Stopwatch sw;
+  for (size_t t = 0; t < threadCount; ++t) {
+    futureList.push_back(std::async(std::launch::async, [&fileList, t, threadCount, jobCount]() {
+      int width, height;
+      std::vector<uint8_t> pixels;
+      for (size_t i = t; i < jobCount; i += threadCount) {
+        const PngFile& file = fileList[i % fileList.size()];
+        Png::Decode(file.data.data(), file.data.size(), width, height, pixels);
+      }
+    }));
+  }
+  for (auto& e : futureList) {
+    e.get();
+  }
+  const double parallelTime = sw.ElapsedNs() / repeatCount;
+  printf("  %zu threads: %8.3f ms %8.1f MB/s (x%.2f)\n",
+    threadCount, parallelTime * 1e-6, totalMb / (parallelTime * 1e-9), totalTime / parallelTime);
+}
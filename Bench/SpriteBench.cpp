@@ -0,0 +1,86 @@
+/**
+* @file SpriteBench.cpp
+*/
+#include "Bench.h"
+#include "GLFWEW.h"
+#include "Sprite.h"
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <thread>
+#include <stdio.h>
+
+/**
+* SpriteRendererの頂点データ作成速度を計測する.
+*
+* 1スプライトあたりの時間を、AddVertices(const Sprite&)(スカラー版)、
+* AddVertices(first, last)(SIMD版)、およびそのマルチスレッド版で比較する.
+* マップ/アンマップの時間は含まない.
+*/
+void BenchSpriteVertex()
+{
+  GLFWEW::WindowRef window = GLFWEW::Window::Instance();
+  if (!window.Initialize(320, 240, "Bench")) {
+    return;
+  }
+
+  const int spriteCount = 100000;
+  const int repeatCount = 20;
+  const TexturePtr texList[] = {
+    Texture::Create(512, 512, GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, nullptr),
+    Texture::Create(256, 256, GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, nullptr),
+  };
+  std::mt19937 rand(0);
+  std::uniform_real_distribution<float> pos(-400, 400);
+  std::vector<Sprite> spriteList;
+  spriteList.reserve(spriteCount);
+  for (int i = 0; i < spriteCount; ++i) {
+    // 同じテクスチャが数十個ずつ続く、ゲーム中に近い並びにする.
+    spriteList.emplace_back(texList[(i / 64) % 2], Rect(0, 0, 32, 32));
+    Sprite& sprite = spriteList.back();
+    sprite.Position(glm::vec3(pos(rand), pos(rand), 0));
+    sprite.Rotation(pos(rand) * 0.01f);
+    sprite.Update(0);
+  }
+  std::vector<const Sprite*> pointerList;
+  pointerList.reserve(spriteCount);
+  for (const auto& e : spriteList) {
+    pointerList.push_back(&e);
+  }
+
+  SpriteRenderer renderer;
+  if (!renderer.Initialize(spriteCount)) {
+    return;
+  }
+  const size_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+  double scalarTime = 1e30;
+  double simdTime = 1e30;
+  double parallelTime = 1e30;
+  for (int i = 0; i < repeatCount; ++i) {
+    renderer.BeginUpdate();
+    Stopwatch sw;
+    for (const auto& e : spriteList) {
+      renderer.AddVertices(e);
+    }
+    scalarTime = std::min(scalarTime, sw.ElapsedNs());
+    renderer.EndUpdate();
+
+    renderer.BeginUpdate();
+    sw.Reset();
+    renderer.AddVertices(pointerList.data(), pointerList.data() + pointerList.size());
+    simdTime = std::min(simdTime, sw.ElapsedNs());
+    renderer.EndUpdate();
+
+    renderer.ThreadCount(threadCount);
+    renderer.BeginUpdate();
+    sw.Reset();
+    renderer.AddVertices(pointerList.data(), pointerList.data() + pointerList.size());
+    parallelTime = std::min(parallelTime, sw.ElapsedNs());
+    renderer.EndUpdate();
+    renderer.ThreadCount(1);
+  }
+  printf("  sprites: %d\n", spriteCount);
+  printf("  scalar : %7.2f ns/sprite\n", scalarTime / spriteCount);
+  printf("  simd   : %7.2f ns/sprite (x%.2f)\n", simdTime / spriteCount, scalarTime / simdTime);
+  printf("  simd x%zu: %7.2f ns/sprite (x%.2f)\n", threadCount, parallelTime / spriteCount, scalarTime / parallelTime);
+}
@@ -0,0 +1,227 @@
+/**
+* @file TextureBench.cpp
+*/
+#include "Bench.h"
+#include "Texture.h"
+#include "TextureAtlas.h"
+#include "RenderBackend.h"
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdio.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace /* unnamed */ {
+
+/// ゲームの起動時にテクスチャアトラスへまとめる画像.
+const char* const startupImageList[] = {
+  "UnknownPlanet.png",
+  "Objects.png",
+  "Title.png",
+};
+
+/**
+* ゲームの起動時と同じ手順でテクスチャを読み込む.
+*
+* @param resDir 画像のあるディレクトリ. 末尾は'/'で終わること.
+*
+* @retval true  読み込み成功.
+* @retval false 読み込み失敗.
+*
+* テクスチャアトラスの作成に加えて、アトラスに含めない場合を想定して同じ画像をLoadFromFileでも読み込む.
+* 読み込んだテクスチャは、次の計測に影響しないように最後にキャッシュから取り除く.
+*/
+bool LoadStartupTextures(const std::string& resDir)
+{
+  bool result = true;
+  {
+    TextureAtlasPtr atlas = TextureAtlas::Create(2048);
+    for (const char* e : startupImageList) {
+      atlas->Add((resDir + e).c_str());
+    }
+    result = atlas->Build(nullptr);
+    for (const char* e : startupImageList) {
+      if (!Texture::LoadFromFile((resDir + e).c_str())) {
+        result = false;
+      }
+    }
+  }
+  Texture::RemoveOrphan();
+  return result;
+}
+
+/**
+* 起動時の画像をLoadAsyncで読み込み、転送が終わるまで毎フレームProcessUploadsを呼び出す.
+*
+* @param resDir       画像のあるディレクトリ. 末尾は'/'で終わること.
+* @param requestTime  LoadAsyncの呼び出しにかかった時間を格納する変数.
+* @param maxFrameTime 1回のProcessUploadsにかかった時間の最大値を格納する変数.
+*
+* @retval true  読み込み成功.
+* @retval false 読み込み失敗.
+*
+* フレームの間隔を再現するため、ProcessUploadsの呼び出しごとに1ミリ秒待機する. 待機時間は計測に含めない.
+*/
+bool LoadStartupTexturesAsync(const std::string& resDir, double& requestTime, double& maxFrameTime)
+{
+  bool result = true;
+  {
+    std::vector<TexturePtr> list;
+    Stopwatch sw;
+    for (const char* e : startupImageList) {
+      list.push_back(Texture::LoadAsync((resDir + e).c_str()));
+    }
+    requestTime = sw.ElapsedNs();
+    maxFrameTime = 0;
+    for (;;) {
+      sw.Reset();
+      Texture::ProcessUploads();
+      maxFrameTime = std::max(maxFrameTime, sw.ElapsedNs());
+      const auto isLoading = [](const TexturePtr& p) { return p && p->IsLoading(); };
+      if (std::none_of(list.begin(), list.end(), isLoading)) {
+        break;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    for (const TexturePtr& e : list) {
+      if (!e || e->IsFailed()) {
+        result = false;
+      }
+    }
+  }
+  Texture::RemoveOrphan();
+  return result;
+}
+
+} // unnamed namespace
+
+/**
+* 起動時のテクスチャ読み込み時間を、ディスクキャッシュの有無で比較する.
+*
+* ディスクキャッシュなし、キャッシュファイルを作成する初回起動(コールド)、
+* キャッシュファイルから読み込む2回目以降の起動(ウォーム)の3通りを計測する.
+* コールドでは、アトラスの作成時に書き込んだキャッシュファイルをLoadFromFileが使うため、
+* キャッシュなしより速くなる.
+* GPUへの転送量はどの場合も同じなので、NullBackendを使ってCPU側の時間だけを計測する.
+*/
+void BenchTextureStartup()
+{
+  // リポジトリ直下とBenchフォルダのどちらから実行しても見つかるようにする.
+  std::string resDir = "Res/";
+  struct stat st;
+  if (stat((resDir + startupImageList[0]).c_str(), &st)) {
+    resDir = "../Res/";
+  }
+
+  RenderBackend::Set(RenderBackend::NullBackend::Create());
+  if (!Texture::Initialize()) {
+    RenderBackend::Set(nullptr);
+    return;
+  }
+  const char cacheDir[] = "TextureCacheBench";
+
+  const int repeatCount = 10;
+  double noCacheTime = 1e30;
+  double coldTime = 1e30;
+  double warmTime = 1e30;
+  bool result = Texture::SetDiskCache(nullptr);
+  for (int i = 0; result && i < repeatCount; ++i) {
+    Stopwatch sw;
+    result = LoadStartupTextures(resDir);
+    noCacheTime = std::min(noCacheTime, sw.ElapsedNs());
+  }
+  result = result && Texture::SetDiskCache(cacheDir);
+  for (int i = 0; result && i < repeatCount; ++i) {
+    Texture::ClearDiskCache();
+    Stopwatch sw;
+    result = LoadStartupTextures(resDir);
+    coldTime = std::min(coldTime, sw.ElapsedNs());
+  }
+  for (int i = 0; result && i < repeatCount; ++i) {
+    Stopwatch sw;
+    result = LoadStartupTextures(resDir);
+    warmTime = std::min(warmTime, sw.ElapsedNs());
+  }
+
+  if (result) {
+    printf("  キャッシュなし    : %8.3f ms\n", noCacheTime * 1e-6);
+    printf("  コールド(作成)    : %8.3f ms\n", coldTime * 1e-6);
+    printf("  ウォーム(読み込み): %8.3f ms (x%.2f)\n", warmTime * 1e-6, noCacheTime / warmTime);
+  } else {
+    printf("  %sの画像を読み込めません.\n", resDir.c_str());
+  }
+
+  Texture::ClearDiskCache();
+  Texture::SetDiskCache(nullptr);
+#ifdef _WIN32
+  _rmdir(cacheDir);
+#else
+  rmdir(cacheDir);
+#endif
+  Texture::Finalize();
+  RenderBackend::Set(nullptr);
+}
+
+/**
+* 起動時のテクスチャ読み込みで、メインスレッドが止まる時間を同期読み込みと非同期読み込みで比較する.
+*
+* 同期読み込みはLoadFromFileの合計時間、非同期読み込みはLoadAsyncの呼び出し時間と、
+* 1フレームのProcessUploadsにかかった最大の時間を計測する.
+* ディスクキャッシュは使わず、毎回PNGを展開する.
+*/
+void BenchTextureAsync()
+{
+  std::string resDir = "Res/";
+  struct stat st;
+  if (stat((resDir + startupImageList[0]).c_str(), &st)) {
+    resDir = "../Res/";
+  }
+
+  RenderBackend::Set(RenderBackend::NullBackend::Create());
+  if (!Texture::Initialize()) {
+    RenderBackend::Set(nullptr);
+    return;
+  }
+  bool result = Texture::SetDiskCache(nullptr);
+
+  const int repeatCount = 10;
+  double syncTime = 1e30;
+  double requestTime = 1e30;
+  double frameTime = 1e30;
+  for (int i = 0; result && i < repeatCount; ++i) {
+    Stopwatch sw;
+    for (const char* e : startupImageList) {
+      if (!Texture::LoadFromFile((resDir + e).c_str())) {
+        result = false;
+      }
+    }
+    syncTime = std::min(syncTime, sw.ElapsedNs());
+    Texture::RemoveOrphan();
+  }
+  for (int i = 0; result && i < repeatCount; ++i) {
+    double request;
+    double frame;
+    result = LoadStartupTexturesAsync(resDir, request, frame);
+    requestTime = std::min(requestTime, request);
+    frameTime = std::min(frameTime, frame);
+  }
+
+  if (result) {
+    printf("  同期読み込み          : %8.3f ms\n", syncTime * 1e-6);
+    printf("  LoadAsync             : %8.3f ms\n", requestTime * 1e-6);
+    printf("  ProcessUploads(最大)  : %8.3f ms\n", frameTime * 1e-6);
+  } else {
+    printf("  %sの画像を読み込めません.\n", resDir.c_str());
+  }
+
+  Texture::Finalize();
+  RenderBackend::Set(nullptr);
+}
@@ -0,0 +1,177 @@
+/**
+* @file TiledMapBench.cpp
+*/
+#include "Bench.h"
+#include "GLFWEW.h"
+#include "TiledMap.h"
+#include "TileCollision.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+#include <stdio.h>
+
+namespace /* unnamed */ {
+
+/**
+* データをBase64で符号化してファイルに書き込む.
+*
+* @param fp   書き込み先のファイル.
+* @param data 符号化するデータ.
+* @param size dataのバイト数.
+*/
+void WriteBase64(FILE* fp, const uint8_t* data, size_t size)
+{
+  static const char chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  for (size_t i = 0; i < size; i += 3) {
+    const uint32_t n = (data[i] << 16) | (i + 1 < size ? data[i + 1] << 8 : 0) | (i + 2 < size ? data[i + 2] : 0);
+    fputc(chars[(n >> 18) & 63], fp);
+    fputc(chars[(n >> 12) & 63], fp);
+    fputc(i + 1 < size ? chars[(n >> 6) & 63] : '=', fp);
+    fputc(i + 2 < size ? chars[n & 63] : '=', fp);
+  }
+}
+
+} // unnamed namespace
+
+/**
+* TiledMapの読み込み速度を計測する.
+*
+* 1024x1024タイルのJSONファイルを作成し、整数の配列形式、Base64形式、それを変換したバイナリファイルの
+* 読み込み時間を比較する. 描画データは作成しない.
+*/
+void BenchTiledMapLoad()
+{
+  GLFWEW::WindowRef window = GLFWEW::Window::Instance();
+  if (!window.Initialize(320, 240, "Bench")) {
+    return;
+  }
+
+  const int mapSize = 1024;
+  const int repeatCount = 5;
+  const char jsonFilename[] = "BenchMap.json";
+  const char base64Filename[] = "BenchMapBase64.json";
+  const char binaryFilename[] = "BenchMap.tmap";
+
+  FILE* fp = fopen(jsonFilename, "w");
+  if (!fp) {
+    return;
+  }
+  fprintf(fp, "{\"layers\":[{\"type\":\"tilelayer\",\"width\":%d,\"height\":%d,\"visible\":true,\"opacity\":1,\"data\":[", mapSize, mapSize);
+  std::mt19937 rand(0);
+  std::vector<uint32_t> mapData(mapSize * mapSize);
+  for (auto& e : mapData) {
+    e = rand() % 256;
+  }
+  for (size_t i = 0; i < mapData.size(); ++i) {
+    fprintf(fp, i ? ",%u" : "%u", mapData[i]);
+  }
+  fprintf(fp, "]}],\"tilesets\":[{\"tilewidth\":32,\"tileheight\":32,\"columns\":16,\"firstgid\":1,\"image\":\"Objects.png\"}]}");
+  fclose(fp);
+
+  fp = fopen(base64Filename, "w");
+  if (!fp) {
+    return;
+  }
+  fprintf(fp, "{\"layers\":[{\"type\":\"tilelayer\",\"width\":%d,\"height\":%d,\"visible\":true,\"opacity\":1,\"encoding\":\"base64\",\"data\":\"", mapSize, mapSize);
+  WriteBase64(fp, reinterpret_cast<const uint8_t*>(mapData.data()), mapData.size() * sizeof(uint32_t));
+  fprintf(fp, "\"}],\"tilesets\":[{\"tilewidth\":32,\"tileheight\":32,\"columns\":16,\"firstgid\":1,\"image\":\"Objects.png\"}]}");
+  fclose(fp);
+
+  Stopwatch sw;
+  if (!TiledMap::Convert(jsonFilename, binaryFilename)) {
+    return;
+  }
+  const double convertTime = sw.ElapsedNs();
+
+  double jsonTime = 1e30;
+  double base64Time = 1e30;
+  double binaryTime = 1e30;
+  for (int i = 0; i < repeatCount; ++i) {
+    TiledMap json;
+    sw.Reset();
+    json.Load(jsonFilename);
+    jsonTime = std::min(jsonTime, sw.ElapsedNs());
+
+    TiledMap base64;
+    sw.Reset();
+    base64.Load(base64Filename);
+    base64Time = std::min(base64Time, sw.ElapsedNs());
+
+    TiledMap binary;
+    sw.Reset();
+    binary.Load(binaryFilename);
+    binaryTime = std::min(binaryTime, sw.ElapsedNs());
+  }
+  remove(jsonFilename);
+  remove(base64Filename);
+  remove(binaryFilename);
+
+  printf("  tiles  : %dx%d\n", mapSize, mapSize);
+  printf("  convert: %9.3f ms\n", convertTime * 1e-6);
+  printf("  json   : %9.3f ms\n", jsonTime * 1e-6);
+  printf("  base64 : %9.3f ms (x%.0f)\n", base64Time * 1e-6, jsonTime / base64Time);
+  printf("  binary : %9.3f ms (x%.0f)\n", binaryTime * 1e-6, jsonTime / binaryTime);
+}
+
+/**
+* TileCollisionの判定速度を計測する.
+*
+* 1024x1024タイルのうち2%に衝突判定があるマップで、矩形の重なり判定、移動する矩形の衝突判定、
+* 線分の交差判定の1回あたりの時間を計測する. 矩形は縦横8タイル(256ピクセル)の大きさ.
+*/
+void BenchTileCollision()
+{
+  const int mapSize = 1024;
+  const int queryCount = 100000;
+  const glm::vec2 tileSize(32, 32);
+  std::mt19937 rand(0);
+  std::vector<uint32_t> mapData(mapSize * mapSize);
+  for (auto& e : mapData) {
+    e = rand() % 50 == 0 ? 1 : 0;
+  }
+  TiledMap::Layer layer;
+  layer.size = glm::ivec2(mapSize);
+  layer.mapData = mapData.data();
+  TileCollision collision;
+  Stopwatch sw;
+  collision.Build(layer, tileSize, [](uint32_t tile) { return tile != 0; });
+  const double buildTime = sw.ElapsedNs();
+
+  const float range = mapSize * tileSize.x * 0.5f;
+  std::uniform_real_distribution<float> pos(-range, range);
+  std::uniform_real_distribution<float> move(-512, 512);
+  std::vector<Rect> boxList;
+  std::vector<glm::vec2> moveList;
+  boxList.reserve(queryCount);
+  moveList.reserve(queryCount);
+  for (int i = 0; i < queryCount; ++i) {
+    boxList.emplace_back(pos(rand), pos(rand), 256.0f, 256.0f);
+    moveList.emplace_back(move(rand), move(rand));
+  }
+
+  int hitCount = 0;
+  sw.Reset();
+  for (const auto& e : boxList) {
+    hitCount += collision.Overlap(e);
+  }
+  const double overlapTime = sw.ElapsedNs();
+
+  TileCollision::Hit hit;
+  sw.Reset();
+  for (int i = 0; i < queryCount; ++i) {
+    hitCount += collision.Sweep(Rect(boxList[i].origin, glm::vec2(24, 24)), moveList[i], hit);
+  }
+  const double sweepTime = sw.ElapsedNs();
+
+  sw.Reset();
+  for (int i = 0; i < queryCount; ++i) {
+    hitCount += collision.Raycast(boxList[i].origin, boxList[i].origin + moveList[i], hit);
+  }
+  const double raycastTime = sw.ElapsedNs();
+
+  printf("  tiles  : %dx%d (hits %d)\n", mapSize, mapSize, hitCount);
+  printf("  build  : %9.3f ms\n", buildTime * 1e-6);
+  printf("  overlap: %7.2f ns/query\n", overlapTime / queryCount);
+  printf("  sweep  : %7.2f ns/query\n", sweepTime / queryCount);
+  printf("  raycast: %7.2f ns/query\n", raycastTime / queryCount);
+}
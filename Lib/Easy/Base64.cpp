@@ -0,0 +1,182 @@
+/**
+* @file Base64.cpp
+*/
+#include "Base64.h"
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define EASY_BASE64_USE_SSE2
+#endif
+
+namespace Base64 {
+
+namespace /* unnamed */ {
+
+/**
+* 文字を6ビットの値に変換する表を作成する.
+*
+* @param table 変換表を格納する配列. Base64の文字でなければ-1を格納する.
+*/
+void MakeDecodeTable(int8_t(&table)[256])
+{
+  static const char chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  for (auto& e : table) {
+    e = -1;
+  }
+  for (int i = 0; i < 64; ++i) {
+    table[static_cast<uint8_t>(chars[i])] = static_cast<int8_t>(i);
+  }
+}
+
+/**
+* 文字を6ビットの値に変換する.
+*
+* @param c 変換する文字.
+*
+* @return cに対応する値. Base64の文字でなければ-1.
+*/
+int Lookup(char c)
+{
+  static int8_t table[256];
+  static const bool initialized = (MakeDecodeTable(table), true);
+  (void)initialized;
+  return table[static_cast<uint8_t>(c)];
+}
+
+#ifdef EASY_BASE64_USE_SSE2
+/**
+* 16文字を12バイトに変換する.
+*
+* @param src 変換する16文字.
+* @param dst 変換したデータの格納先.
+*
+* @retval true  変換成功.
+* @retval false Base64の文字以外が含まれている. dstは変更されない.
+*/
+bool Decode16(const char* src, uint8_t* dst)
+{
+  const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+
+  // 文字の範囲ごとに、6ビットの値にするための加算値を選ぶ.
+  const __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('Z' + 1)));
+  const __m128i lower = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('z' + 1)));
+  const __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1)));
+  const __m128i plus = _mm_cmpeq_epi8(v, _mm_set1_epi8('+'));
+  const __m128i slash = _mm_cmpeq_epi8(v, _mm_set1_epi8('/'));
+  const __m128i valid = _mm_or_si128(_mm_or_si128(_mm_or_si128(upper, lower), _mm_or_si128(digit, plus)), slash);
+  if (_mm_movemask_epi8(valid) != 0xffff) {
+    return false;
+  }
+  __m128i offset = _mm_and_si128(upper, _mm_set1_epi8(-'A'));
+  offset = _mm_or_si128(offset, _mm_and_si128(lower, _mm_set1_epi8(26 - 'a')));
+  offset = _mm_or_si128(offset, _mm_and_si128(digit, _mm_set1_epi8(52 - '0')));
+  offset = _mm_or_si128(offset, _mm_and_si128(plus, _mm_set1_epi8(62 - '+')));
+  offset = _mm_or_si128(offset, _mm_and_si128(slash, _mm_set1_epi8(63 - '/')));
+  const __m128i sextets = _mm_add_epi8(v, offset);
+
+  // 4文字(a, b, c, d)を、32ビットごとに(a << 18) | (b << 12) | (c << 6) | dにまとめる.
+  const __m128i even = _mm_and_si128(sextets, _mm_set1_epi16(0x00ff));
+  const __m128i odd = _mm_srli_epi16(sextets, 8);
+  const __m128i pairs = _mm_or_si128(_mm_slli_epi16(even, 6), odd);
+  const __m128i quads = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+
+  uint32_t tmp[4];
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(tmp), quads);
+  for (int i = 0; i < 4; ++i) {
+    dst[0] = static_cast<uint8_t>(tmp[i] >> 16);
+    dst[1] = static_cast<uint8_t>(tmp[i] >> 8);
+    dst[2] = static_cast<uint8_t>(tmp[i]);
+    dst += 3;
+  }
+  return true;
+}
+#endif // EASY_BASE64_USE_SSE2
+
+} // unnamed namespace
+
+/**
+* デコード後のバイト数を計算する.
+*
+* @param src     Base64の文字列.
+* @param srcSize srcの文字数.
+*
+* @return デコード後のバイト数. srcが正しいBase64の文字列でない場合、実際のバイト数より大きくなることがある.
+*/
+size_t DecodedSize(const char* src, size_t srcSize)
+{
+  for (int i = 0; i < 2 && srcSize > 0 && src[srcSize - 1] == '='; ++i) {
+    --srcSize;
+  }
+  return srcSize / 4 * 3 + (srcSize % 4 * 3) / 4;
+}
+
+/**
+* Base64の文字列をデコードする.
+*
+* @param src     Base64の文字列.
+* @param srcSize srcの文字数.
+* @param dst     デコードしたデータの格納先.
+* @param dstSize dstのバイト数.
+* @param written デコードしたバイト数を格納する変数.
+*
+* @retval true  デコード成功.
+* @retval false srcが正しいBase64の文字列でないか、dstの大きさが足りない.
+*/
+bool Decode(const char* src, size_t srcSize, uint8_t* dst, size_t dstSize, size_t& written)
+{
+  written = 0;
+  if (srcSize % 4 == 0) {
+    for (int i = 0; i < 2 && srcSize > 0 && src[srcSize - 1] == '='; ++i) {
+      --srcSize;
+    }
+  }
+  const size_t remainder = srcSize % 4;
+  if (remainder == 1) {
+    return false;
+  }
+  const size_t size = DecodedSize(src, srcSize);
+  if (size > dstSize) {
+    return false;
+  }
+
+  const char* const end = src + (srcSize - remainder);
+#ifdef EASY_BASE64_USE_SSE2
+  while (end - src >= 16 && Decode16(src, dst)) {
+    src += 16;
+    dst += 12;
+  }
+#endif // EASY_BASE64_USE_SSE2
+  for (; src != end; src += 4) {
+    const int a = Lookup(src[0]);
+    const int b = Lookup(src[1]);
+    const int c = Lookup(src[2]);
+    const int d = Lookup(src[3]);
+    if ((a | b | c | d) < 0) {
+      return false;
+    }
+    const uint32_t n = (a << 18) | (b << 12) | (c << 6) | d;
+    dst[0] = static_cast<uint8_t>(n >> 16);
+    dst[1] = static_cast<uint8_t>(n >> 8);
+    dst[2] = static_cast<uint8_t>(n);
+    dst += 3;
+  }
+
+  // 末尾の2文字または3文字を変換.
+  if (remainder) {
+    const int a = Lookup(src[0]);
+    const int b = Lookup(src[1]);
+    const int c = remainder == 3 ? Lookup(src[2]) : 0;
+    if ((a | b | c) < 0) {
+      return false;
+    }
+    const uint32_t n = (a << 18) | (b << 12) | (c << 6);
+    dst[0] = static_cast<uint8_t>(n >> 16);
+    if (remainder == 3) {
+      dst[1] = static_cast<uint8_t>(n >> 8);
+    }
+  }
+  written = size;
+  return true;
+}
+
+} // namespace Base64
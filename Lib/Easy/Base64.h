@@ -0,0 +1,22 @@
+/**
+* @file Base64.h
+*/
+#ifndef BASE64_H_INCLUDED
+#define BASE64_H_INCLUDED
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+* Base64(RFC 4648)のデコード機能を格納する名前空間.
+*
+* SSE2が使える環境では16文字ずつ変換する.
+* 末尾の'='は省略されていてもよい. 空白や改行を含むデータはエラーになる.
+*/
+namespace Base64 {
+
+size_t DecodedSize(const char* src, size_t srcSize);
+bool Decode(const char* src, size_t srcSize, uint8_t* dst, size_t dstSize, size_t& written);
+
+} // namespace Base64
+
+#endif // BASE64_H_INCLUDED
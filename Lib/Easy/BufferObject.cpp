@@ -2,91 +2,88 @@
 * @file BufferObject.cpp
 */
 #include "BufferObject.h"
+#include "GLState.h"
+#include "RenderBackend.h"
 
 /**
-* obt@IuWFNg쐬.
+* バッファオブジェクトを作成する.
 *
-* @param target obt@IuWFNg̎.
-* @param size   _f[^̃TCY.
-* @param data   _f[^ւ̃|C^.
-* @param usage  obt@IuWFNg̃ANZX^Cv.
+* @param target バッファオブジェクトの種類.
+* @param size   頂点データのサイズ.
+* @param data   頂点データへのポインタ.
+* @param usage  バッファオブジェクトのアクセスタイプ.
 */
 void BufferObject::Init(GLenum target, GLsizeiptr size, const GLvoid* data, GLenum usage)
 {
   Destroy();
-  glGenBuffers(1, &id);
-  glBindBuffer(target, id);
-  glBufferData(target, size, data, usage);
-  glBindBuffer(target, 0);
+  if (target == GL_ELEMENT_ARRAY_BUFFER) {
+    GLState::BindVertexArray(0); // 割り当て中のVAOのIBOを書き換えないようにする.
+  }
+  id = RenderBackend::Get().CreateBuffer(target, size, data, usage);
 }
 
 /**
-* Buffer Objectj.
+* Buffer Objectを破棄する.
 */
 void BufferObject::Destroy()
 {
   if (id) {
-    glDeleteBuffers(1, &id);
+    RenderBackend::Get().DeleteBuffer(id);
     id = 0;
   }
 }
 
 /**
-* VAO쐬.
+* VAOを作成する.
 *
-* @param vbo  _obt@IuWFNgID.
-* @param ibo  CfbNXobt@IuWFNgID.
+* @param vbo  頂点バッファオブジェクトのID.
+* @param ibo  インデックスバッファオブジェクトのID.
 */
 void VertexArrayObject::Init(GLuint vbo, GLuint ibo)
 {
   Destroy();
-  glGenVertexArrays(1, &id);
-  glBindVertexArray(id);
-  glBindBuffer(GL_ARRAY_BUFFER, vbo);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
-  glBindVertexArray(0);
+  id = RenderBackend::Get().CreateVertexArray(vbo, ibo);
+  this->vbo = vbo;
 }
 
 /**
-* VAOj.
+* VAOを破棄する.
 */
 void VertexArrayObject::Destroy()
 {
   if (id) {
-    glDeleteVertexArrays(1, &id);
+    GLState::DeleteVertexArray(id);
     id = 0;
   }
 }
 
 /**
-* _Agr[gݒ肷.
+* 頂点アトリビュートを設定する.
 *
-* @param index      _Agr[g̃CfbNX.
-* @param size       _Agr[g̗vf.
-* @param type       _Agr[ǧ^.
-* @param normalized GL_TRUE=vf𐳋K. GL_FALSE=KȂ.
-* @param stride     ̒_f[^܂ł̃oCg.
-* @param offset     _f[^擪̃oCgItZbg.
+* @param index      頂点アトリビュートのインデックス.
+* @param size       頂点アトリビュートの要素数.
+* @param type       頂点アトリビュートの型.
+* @param normalized GL_TRUE=要素を正規化する. GL_FALSE=正規化しない.
+* @param stride     次の頂点データまでのバイト数.
+* @param offset     頂点データ先頭からのバイトオフセット.
 */
 void VertexArrayObject::VertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, size_t offset)
 {
-  glEnableVertexAttribArray(index);
-  glVertexAttribPointer(index, size, type, normalized, stride,
-    reinterpret_cast<GLvoid*>(offset));
+  RenderBackend::Get().VertexAttribPointer(id, vbo, { index, size, type, normalized, false, stride, offset });
 }
 
 /**
-* VAOΏۂɂ.
+* VAOを処理対象にする.
 */
 void VertexArrayObject::Bind() const
 {
-  glBindVertexArray(id);
+  GLState::BindVertexArray(id);
 }
 
 /**
-* VAOΏۂO.
+* VAOを処理対象から外す.
 */
 void VertexArrayObject::Unbind() const
 {
-  glBindVertexArray(0);
+  GLState::BindVertexArray(0);
 }
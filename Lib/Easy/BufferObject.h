@@ -43,6 +43,7 @@ public:
   void Unbind() const;
 private:
   GLuint id = 0;
+  GLuint vbo = 0; ///< 頂点アトリビュートの参照先VBO.
 };
 
 #endif // BUFFEROBJECT_H_INCLUDED
\ No newline at end of file
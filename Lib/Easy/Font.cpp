@@ -2,17 +2,19 @@
 * @file Font.cpp
 */
 #include "Font.h"
+#include "GLState.h"
+#include "RenderBackend.h"
 #include <memory>
 #include <iostream>
 #include <stdio.h>
 
 /**
-* tHg`@\i[閼O.
+* フォント描画機能を格納する名前空間.
 */
 namespace Font {
 
 /**
-* tHgp_f[^^.
+* フォント用頂点データ型.
 */
 struct Vertex
 {
@@ -24,18 +26,18 @@ struct Vertex
 };
 
 /**
-* tHg`IuWFNg.
+* フォント描画オブジェクトを初期化する.
 *
-* @param maxChar ő`敶.
-* @param screen  `XN[̑傫.
+* @param maxChar 最大描画文字数.
+* @param screen  描画先スクリーンの大きさ.
 *
-* @retval true  .
-* @retval false s.
+* @retval true  初期化成功.
+* @retval false 初期化失敗.
 */
 bool Renderer::Initialize(size_t maxChar, const glm::vec2& screen)
 {
   if (maxChar > (USHRT_MAX + 1) / 4) {
-    std::cerr << "WARNING: " << maxChar << "͐ݒ\ȍő啶zĂ܂"<< std::endl;
+    std::cerr << "WARNING: " << maxChar << "は設定可能な最大文字数を越えています"<< std::endl;
     maxChar = (USHRT_MAX + 1) / 4;
   }
   vboCapacity = static_cast<GLsizei>(4 * maxChar);
@@ -71,12 +73,12 @@ bool Renderer::Initialize(size_t maxChar, const glm::vec2& screen)
 }
 
 /**
-* tHgt@Cǂݍ.
+* フォントファイルを読み込む.
 *
-* @param filename tHgt@C.
+* @param filename フォントファイル名.
 *
-* @retval true  ǂݍݐ.
-* @retval false ǂݍݎs.
+* @retval true  読み込み成功.
+* @retval false 読み込み失敗.
 */
 bool Renderer::LoadFromFile(const char* filename)
 {
@@ -95,7 +97,7 @@ bool Renderer::LoadFromFile(const char* filename)
   glm::vec2 scale;
   ret = fscanf(fp.get(), " common lineHeight=%*d base=%*d scaleW=%f scaleH=%f pages=%*d packed=%*d%*[^\r\n]", &scale.x, &scale.y);
   if (ret < 2) {
-    std::cerr << "ERROR: '" << filename << "'̓ǂݍ݂Ɏs(line=" << line << ")" << std::endl;
+    std::cerr << "ERROR: '" << filename << "'の読み込みに失敗(line=" << line << ")" << std::endl;
     return false;
   }
   const glm::vec2 reciprocalScale = glm::vec2(1.0f / scale);
@@ -115,20 +117,20 @@ bool Renderer::LoadFromFile(const char* filename)
     } else {
       texFilename.resize(lastSlashIndex + 1);
     }
-    texFilename.append(tex + 1); // ŏ́u"v𔲂Ēǉ.
-    texFilename.pop_back(); // Ṓu"v.
+    texFilename.append(tex + 1); // 最初の「"」を抜いて追加.
+    texFilename.pop_back(); // 最後の「"」を消す.
     texNameList.push_back(texFilename);
     ++line;
   }
   if (texNameList.empty()) {
-    std::cerr << "ERROR: '" << filename << "'̓ǂݍ݂Ɏs(line=" << line << ")" << std::endl;
+    std::cerr << "ERROR: '" << filename << "'の読み込みに失敗(line=" << line << ")" << std::endl;
     return false;
   }
 
   int charCount;
   ret = fscanf(fp.get(), " chars count=%d", &charCount);
   if (ret < 1) {
-    std::cerr << "ERROR: '" << filename << "'̓ǂݍ݂Ɏs(line=" << line << ")" << std::endl;
+    std::cerr << "ERROR: '" << filename << "'の読み込みに失敗(line=" << line << ")" << std::endl;
     return false;
   }
   ++line;
@@ -140,7 +142,7 @@ bool Renderer::LoadFromFile(const char* filename)
     glm::vec2 uv;
     ret = fscanf(fp.get(), " char id=%d x=%f y=%f width=%f height=%f xoffset=%f yoffset=%f xadvance=%f page=%d chnl=%*d", &font.id, &uv.x, &uv.y, &font.size.x, &font.size.y, &font.offset.x, &font.offset.y, &font.xadvance, &font.page);
     if (ret < 9) {
-      std::cerr << "ERROR: '" << filename << "'̓ǂݍ݂Ɏs(line=" << line << ")" << std::endl;
+      std::cerr << "ERROR: '" << filename << "'の読み込みに失敗(line=" << line << ")" << std::endl;
       return false;
     }
     font.offset.y *= -1;
@@ -168,13 +170,13 @@ bool Renderer::LoadFromFile(const char* filename)
 }
 
 /**
-* ǉ.
+* 文字列を追加する.
 *
-* @param position \JnW.
-* @param str      ǉ镶.
+* @param position 表示開始座標.
+* @param str      追加する文字列.
 *
-* @retval true  ǉ.
-* @retval false ǉs.
+* @retval true  追加成功.
+* @retval false 追加失敗.
 */
 bool Renderer::AddString(const glm::vec2& position, const char* str)
 {
@@ -188,13 +190,13 @@ bool Renderer::AddString(const glm::vec2& position, const char* str)
 }
 
 /**
-* ǉ.
+* 文字列を追加する.
 *
-* @param position \JnW.
-* @param str      ǉ镶.
+* @param position 表示開始座標.
+* @param str      追加する文字列.
 *
-* @retval true  ǉ.
-* @retval false ǉs.
+* @retval true  追加成功.
+* @retval false 追加失敗.
 */
 bool Renderer::AddString(const glm::vec2& position, const wchar_t* str)
 {
@@ -206,7 +208,11 @@ bool Renderer::AddString(const glm::vec2& position, const wchar_t* str)
   Vertex* p = pVBO + vboSize;
   glm::vec2 pos = position * reciprocalScreenSize;
   for (const wchar_t* itr = str; *itr; ++itr) {
+    ++stats[FrameStats::Counter_Submitted];
     if (vboSize + 4 > vboCapacity) {
+      const size_t remaining = wcslen(itr);
+      stats[FrameStats::Counter_Submitted] += remaining - 1;
+      stats[FrameStats::Counter_Rejected] += remaining;
       break;
     }
     const FontInfo& font = fontList[*itr];
@@ -242,6 +248,7 @@ bool Renderer::AddString(const glm::vec2& position, const wchar_t* str)
 
       p += 4;
       vboSize += 4;
+      stats[FrameStats::Counter_Vertices] += 4;
     }
     float advance;
     if (propotional) {
@@ -258,9 +265,9 @@ bool Renderer::AddString(const glm::vec2& position, const wchar_t* str)
 }
 
 /**
-* Fݒ肷.
+* 文字色を設定する.
 *
-* @param c F.
+* @param c 文字色.
 */
 void Renderer::Color(const glm::vec4& c)
 {
@@ -268,9 +275,9 @@ void Renderer::Color(const glm::vec4& c)
 }
 
 /**
-* F擾.
+* 文字色取得する.
 *
-* @return F.
+* @return 文字色.
 */
 glm::vec4 Renderer::Color() const
 {
@@ -278,9 +285,9 @@ glm::vec4 Renderer::Color() const
 }
 
 /**
-* TuFݒ肷.
+* サブ文字色を設定する.
 *
-* @param c F.
+* @param c 文字色.
 */
 void Renderer::SubColor(const glm::vec4& c)
 {
@@ -288,9 +295,9 @@ void Renderer::SubColor(const glm::vec4& c)
 }
 
 /**
-* TuF擾.
+* サブ文字色取得する.
 *
-* @return F.
+* @return 文字色.
 */
 glm::vec4 Renderer::SubColor() const
 {
@@ -298,53 +305,60 @@ glm::vec4 Renderer::SubColor() const
 }
 
 /**
-* VBOVXeɃ}bsO.
+* VBOをシステムメモリにマッピングする.
+*
+* 前回のBeginUpdate()から集計した処理量を1フレームぶんの結果として履歴に追加する.
 */
 void Renderer::BeginUpdate()
 {
   if (pVBO) {
     return;
   }
-  glBindBuffer(GL_ARRAY_BUFFER, vbo.Id());
-  pVBO = static_cast<Vertex*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, sizeof(Vertex) * vboCapacity, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+  if (hasStats) {
+    statsHistory.Push(stats);
+  }
+  stats = {};
+  hasStats = true;
+  RenderBackend::Backend& backend = RenderBackend::Get();
+  pVBO = static_cast<Vertex*>(backend.MapBufferRange(GL_ARRAY_BUFFER, vbo.Id(), 0, sizeof(Vertex) * vboCapacity, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+  stats[FrameStats::Counter_BytesMapped] += sizeof(Vertex) * vboCapacity;
   if (!pVBO) {
-    const GLenum err = glGetError();
-    std::cerr << "ERROR: MapBuffers(0x" << std::hex << err << ")" << std::endl;
+    const GLenum err = backend.GetError();
+    std::cerr << "ERROR: MapBuffer失敗(0x" << std::hex << err << ")" << std::endl;
   }
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
   vboSize = 0;
 }
 
 /**
-* VBÕ}bsO.
+* VBOのマッピングを解除する.
 */
 void Renderer::EndUpdate()
 {
   if (!pVBO || vboSize == 0) {
     return;
   }
-  glBindBuffer(GL_ARRAY_BUFFER, vbo.Id());
-  glUnmapBuffer(GL_ARRAY_BUFFER);
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  RenderBackend::Get().UnmapBuffer(GL_ARRAY_BUFFER, vbo.Id());
   pVBO = nullptr;
+  stats[FrameStats::Counter_Batches] = 1;
 }
 
 /**
-* tHg`悷.
+* フォントを描画する.
 */
 void Renderer::Draw() const
 {
   if (vboSize > 0) {
     vao.Bind();
-    glDisable(GL_DEPTH_TEST);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    GLState::Disable(GL_DEPTH_TEST);
+    GLState::Enable(GL_BLEND);
+    GLState::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     progFont->UseProgram();
     for (size_t i = 0; i < texList.size(); ++i) {
       progFont->BindTexture(GL_TEXTURE0 + i, GL_TEXTURE_2D, texList[i]->Id());
     }
-    glDrawElements(GL_TRIANGLES, (vboSize / 4) * 6, GL_UNSIGNED_SHORT, 0);
-    vao.Unbind();
+    RenderBackend::Get().DrawElements(GL_TRIANGLES, (vboSize / 4) * 6, GL_UNSIGNED_SHORT, 0);
+    stats[FrameStats::Counter_TextureSwitches] += texList.size();
+    ++stats[FrameStats::Counter_DrawCalls];
   }
 }
 
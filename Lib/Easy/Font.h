@@ -7,6 +7,7 @@
 #include "BufferObject.h"
 #include "Shader.h"
 #include "Texture.h"
+#include "FrameStats.h"
 #include <glm/glm.hpp>
 #include <vector>
 #include <string>
@@ -25,7 +26,7 @@ struct FontInfo {
 };
 
 /**
-* rbg}bvtHg`NX.
+* ビットマップフォント描画クラス.
 */
 class Renderer
 {
@@ -57,6 +58,9 @@ public:
   void EndUpdate();
   void Draw() const;
 
+  const FrameStats::Counters& Stats() const { return stats; }
+  const FrameStats::History& StatsHistory() const { return statsHistory; }
+
 private:
   BufferObject vbo;
   BufferObject ibo;
@@ -77,6 +81,10 @@ private:
 
   GLsizei vboSize = 0;
   Vertex* pVBO = nullptr;
+
+  mutable FrameStats::Counters stats = {}; ///< 現在のフレームの集計結果.
+  FrameStats::History statsHistory; ///< 完了したフレームの集計結果.
+  bool hasStats = false; ///< true=statsに集計中のフレームがある.
 };
 
 } // namespace Font
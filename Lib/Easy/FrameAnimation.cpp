@@ -9,15 +9,15 @@
 namespace FrameAnimation {
 
 /**
-* ^CC쐬.
+* タイムラインを作成する.
 *
-* @param first ^CC\L[t[z̐擪.
-* @param last  ^CC\L[t[z̏I[.
+* @param first タイムラインを構成するキーフレーム配列の先頭.
+* @param last  タイムラインを構成するキーフレーム配列の終端.
 *
-* @return ^CCIuWFNg.
+* @return タイムラインオブジェクト.
 *
-* L[t[z[first, last)^CC쐬.
-* ^CC̃L[t[͔̏zƓɂȂ.
+* キーフレーム配列[first, last)からタイムラインを作成する.
+* タイムライン中のキーフレームの順序は配列と同じになる.
 */
 TimelinePtr Timeline::Create(const KeyFrame* first, const KeyFrame* last)
 {
@@ -27,11 +27,11 @@ TimelinePtr Timeline::Create(const KeyFrame* first, const KeyFrame* last)
 }
 
 /**
-* Aj[VIuWFNg쐬.
+* アニメーション制御オブジェクトを作成する.
 *
-* @param tl ^CC.
+* @param tl タイムライン.
 *
-* @return Aj[VIuWFNg.
+* @return アニメーション制御オブジェクト.
 */
 AnimatePtr Animate::Create(const TimelinePtr& tl)
 {
@@ -39,9 +39,9 @@ AnimatePtr Animate::Create(const TimelinePtr& tl)
 }
 
 /**
-* RXgN^.
+* コンストラクタ.
 *
-* @param tl ^CC.
+* @param tl タイムライン.
 */
 Animate::Animate(const TimelinePtr& tl)
   : timeline(tl)
@@ -49,10 +49,10 @@ Animate::Animate(const TimelinePtr& tl)
 }
 
 /**
-* Aj[VXV.
+* アニメーションを更新する.
 *
-* @param targe Aj[V̓KpΏۂƂȂXvCg.
-* @param delta O̍XV̌oߎ(b).
+* @param targe アニメーションの適用対象となるスプライト.
+* @param delta 前回の更新からの経過時間(秒).
 */
 void Animate::Update(Sprite& target, glm::f32 delta)
 {
@@ -78,10 +78,10 @@ void Animate::Update(Sprite& target, glm::f32 delta)
 }
 
 /**
-* Aj[VIׂ.
+* アニメーションが終了したか調べる.
 *
-* @retval true  Aj[V͏Iς.
-* @retval false Aj[V([vĐLȏꍇ͏ɂ).
+* @retval true  アニメーションは終了済み.
+* @retval false アニメーション中(ループ再生が有効な場合は常にこちら).
 */
 bool Animate::IsFinished() const
 {
@@ -11,49 +11,49 @@ class Sprite;
 
 namespace FrameAnimation {
 
-// s錾.
+// 先行宣言.
 struct Timeline;
 class Animate;
 using TimelinePtr = std::shared_ptr<Timeline>;
 using AnimatePtr = std::shared_ptr<Animate>;
 
 /**
-* uԂɃXvCgƂĕ\eNX`͈̔.
+* ある瞬間にスプライトとして表示するテクスチャ内の範囲.
 */
 struct KeyFrame
 {
-  glm::f32 time; ///< KpJn.
-  glm::vec2 origin; ///< _.
-  glm::vec2 size; ///< 傫.
+  glm::f32 time; ///< 適用開始時間.
+  glm::vec2 origin; ///< 原点.
+  glm::vec2 size; ///< 大きさ.
 };
 
 /**
-* L[t[Ԃɉĕׂf[^^.
+* キーフレームを時間に沿って並べたデータ型.
 */
 struct Timeline
 {
   static TimelinePtr Create(const KeyFrame* first, const KeyFrame* last);
   template<size_t N> static TimelinePtr Create(const KeyFrame(&array)[N]);
 
-  std::vector<KeyFrame> data; ///< ɐ񂳂ĂL[t[̔z.
+  std::vector<KeyFrame> data; ///< 時刻順に整列されているキーフレームの配列.
 };
 
 
 /**
-* ^CC쐬.
+* タイムラインを作成する.
 *
-* @param array ^CC\L[t[z.
+* @param array タイムラインを構成するキーフレーム配列.
 *
-* @return ^CCIuWFNg.
+* @return タイムラインオブジェクト.
 *
-* L[t[z񂩂^CC쐬.
-* ^CC̃L[t[͔̏zƓɂȂ.
+* キーフレーム配列からタイムラインを作成する.
+* タイムライン中のキーフレームの順序は配列と同じになる.
 */
 template<size_t N>
 inline TimelinePtr Timeline::Create(const KeyFrame (&array)[N]) { return Create(array, array + N); }
 
 /**
-* XvCg̃Aj[V𐧌䂷NX.
+* スプライトのアニメーションを制御するクラス.
 */
 class Animate
 {
@@ -81,12 +81,12 @@ public:
   void Update(Sprite&, glm::f32);
 
 private:
-  TimelinePtr timeline; ///< ɐ񂳂ĂL[t[̔z.
-  glm::f32 speed = 1.0f; ///< ^CC̐isx.
-  glm::f32 elapsedTime = 0.0f; ///< oߎ.
-  glm::u32 keyFrameIndex = 0; ///< ݓKpΏۂƂȂĂ^CC̃L[t[wCfbNX.
-  bool isPause = false; ///< Ԍo߂ꎞ~邩ǂ.
-  bool isLoop = true; ///< [vĐsǂ.
+  TimelinePtr timeline; ///< 時刻順に整列されているキーフレームの配列.
+  glm::f32 speed = 1.0f; ///< タイムラインの進行速度.
+  glm::f32 elapsedTime = 0.0f; ///< 経過時間.
+  glm::u32 keyFrameIndex = 0; ///< 現在適用対象となっているタイムライン内のキーフレームを指すインデックス.
+  bool isPause = false; ///< 時間経過を一時停止するかどうか.
+  bool isLoop = true; ///< ループ再生を行うかどうか.
 };
 
 } // namespace FrameAnimation
@@ -0,0 +1,100 @@
+/**
+* @file FrameStats.cpp
+*/
+#include "FrameStats.h"
+#include <algorithm>
+
+namespace FrameStats {
+
+const size_t History::frameCount;
+
+/**
+* 項目の名前を取得する.
+*
+* @param c 項目.
+*
+* @return cの短い名前. 画面表示用.
+*/
+const char* CounterName(Counter c)
+{
+  static const char* const nameList[Counter_Count] = {
+    "sub", "rej", "vtx", "bat", "dc", "tex", "map",
+  };
+  return c < Counter_Count ? nameList[c] : "";
+}
+
+/**
+* 1フレームぶんの集計結果を追加する.
+*
+* @param counters 追加する集計結果.
+*
+* 保持しているフレーム数がframeCountに達している場合、最も古い結果を取り除く.
+*/
+void History::Push(const Counters& counters)
+{
+  Counters& slot = frames[next];
+  for (int i = 0; i < Counter_Count; ++i) {
+    if (size >= frameCount) {
+      sum[i] -= slot.value[i];
+    }
+    sum[i] += counters.value[i];
+  }
+  slot = counters;
+  next = (next + 1) % frameCount;
+  size = std::min(size + 1, frameCount);
+}
+
+/**
+* 履歴を消去する.
+*/
+void History::Clear()
+{
+  *this = History();
+}
+
+/**
+* 最後に追加した集計結果を取得する.
+*
+* @return 最後に追加した集計結果. 履歴が空の場合は全て0.
+*/
+const Counters& History::Last() const
+{
+  static const Counters empty = {};
+  if (size == 0) {
+    return empty;
+  }
+  return frames[(next + frameCount - 1) % frameCount];
+}
+
+/**
+* 直近のフレームの平均を取得する.
+*
+* @param c 項目.
+*
+* @return 保持しているフレームにおけるcの平均値. 履歴が空の場合は0.
+*/
+double History::Average(Counter c) const
+{
+  if (size == 0) {
+    return 0;
+  }
+  return static_cast<double>(sum[c]) / static_cast<double>(size);
+}
+
+/**
+* 直近のフレームの最大値を取得する.
+*
+* @param c 項目.
+*
+* @return 保持しているフレームにおけるcの最大値. 履歴が空の場合は0.
+*/
+uint64_t History::Max(Counter c) const
+{
+  uint64_t n = 0;
+  for (size_t i = 0; i < size; ++i) {
+    n = std::max(n, frames[i].value[c]);
+  }
+  return n;
+}
+
+} // namespace FrameStats
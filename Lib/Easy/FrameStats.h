@@ -0,0 +1,68 @@
+/**
+* @file FrameStats.h
+*/
+#ifndef FRAMESTATS_H_INCLUDED
+#define FRAMESTATS_H_INCLUDED
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+* 描画クラスがフレームごとに行った処理の量を集計する機能を格納する名前空間.
+*
+* SpriteRenderer, Font::Rendererは、BeginUpdate()からの処理量をCountersに記録し、
+* 次のBeginUpdate()で1フレームぶんの結果としてHistoryに追加する.
+* Historyは直近frameCountフレームの平均と最大値を返すため、耐久試験で
+* バッチ数や追加できなかったスプライト数が閾値を超えていないかを監視できる.
+*/
+namespace FrameStats {
+
+/// 集計する項目.
+enum Counter {
+  Counter_Submitted, ///< 追加を要求されたスプライト(文字)の数.
+  Counter_Rejected, ///< 容量不足で追加できなかったスプライト(文字)の数.
+  Counter_Vertices, ///< 頂点バッファに書き込んだ頂点数.
+  Counter_Batches, ///< 作成した描画データの数.
+  Counter_DrawCalls, ///< 描画コマンドの発行回数.
+  Counter_TextureSwitches, ///< 描画中にテクスチャを切り替えた回数.
+  Counter_BytesMapped, ///< システムメモリにマップした頂点バッファのバイト数.
+  Counter_Count, ///< 項目の数.
+};
+
+const char* CounterName(Counter);
+
+/**
+* 1フレームぶんの集計結果.
+*/
+struct Counters
+{
+  uint64_t value[Counter_Count]; ///< 項目ごとの値.
+
+  uint64_t& operator[](Counter c) { return value[c]; }
+  uint64_t operator[](Counter c) const { return value[c]; }
+};
+
+/**
+* 直近の集計結果の履歴.
+*/
+class History
+{
+public:
+  static const size_t frameCount = 60; ///< 保持するフレーム数.
+
+  void Push(const Counters&);
+  void Clear();
+  size_t Size() const { return size; }
+  const Counters& Last() const;
+  double Average(Counter) const;
+  uint64_t Max(Counter) const;
+
+private:
+  Counters frames[frameCount] = {}; ///< 集計結果のリングバッファ.
+  uint64_t sum[Counter_Count] = {}; ///< 保持しているフレームの合計.
+  size_t next = 0; ///< 次に書き込むフレームの位置.
+  size_t size = 0; ///< 保持しているフレーム数.
+};
+
+} // namespace FrameStats
+
+#endif // FRAMESTATS_H_INCLUDED
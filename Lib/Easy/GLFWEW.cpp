@@ -4,14 +4,14 @@
 #include "GLFWEW.h"
 #include <iostream>
 
-/// GLFWGLEWbv邽߂̖O.
+/// GLFWとGLEWをラップするための名前空間.
 namespace GLFWEW {
 
 /**
-* GLFW̃G[񍐂.
+* GLFWからのエラー報告を処理する.
 *
-* @param error G[ԍ.
-* @param desc  G[̓e.
+* @param error エラー番号.
+* @param desc  エラーの内容.
 */
 void ErrorCallback(int error, const char* desc)
 {
@@ -19,7 +19,7 @@ void ErrorCallback(int error, const char* desc)
 }
 
 /**
-* GLFW̃L[񍐂.
+* GLFWからのキー操作報告を処理する.
 */
 void Window::KeyCallback(GLFWwindow* pWindow, int key, int scancode, int action, int mods)
 {
@@ -37,9 +37,9 @@ void Window::KeyCallback(GLFWwindow* pWindow, int key, int scancode, int action,
 }
 
 /**
-* VOgCX^X擾.
+* シングルトンインスタンスを取得する.
 *
-* @return Window̃VOgCX^X.
+* @return Windowのシングルトンインスタンス.
 */
 WindowRef Window::Instance()
 {
@@ -48,7 +48,7 @@ WindowRef Window::Instance()
 }
 
 /**
-* fXgN^.
+* デストラクタ.
 */
 Window::~Window()
 {
@@ -58,25 +58,25 @@ Window::~Window()
 }
 
 /**
-* GLFW/GLEW̏.
+* GLFW/GLEWの初期化.
 *
-* @param w EBhE̕`͈͂̕(sNZ).
-* @param h EBhE̕`͈͂̍(sNZ).
-* @param title EBhE^Cg(UTF-80I[).
+* @param w ウィンドウの描画範囲の幅(ピクセル).
+* @param h ウィンドウの描画範囲の高さ(ピクセル).
+* @param title ウィンドウタイトル(UTF-8の0終端文字列).
 *
-* @retval true .
-* @retval false s.
+* @retval true 初期化成功.
+* @retval false 初期化失敗.
 */
 bool Window::Initialize(int w, int h, const char* title)
 {
   if (isInitialized) {
-    std::cerr << "ERROR: GLFWEW͊ɏĂ܂." << std::endl;
+    std::cerr << "ERROR: GLFWEWは既に初期化されています." << std::endl;
     return false;
   }
   if (!isGLFWInitialized) {
     glfwSetErrorCallback(ErrorCallback);
     if (glfwInit() != GL_TRUE) {
-      std::cerr << "ERROR: GLEW̏Ɏs܂." << std::endl;
+      std::cerr << "ERROR: GLEWの初期化に失敗しました." << std::endl;
       return false;
     }
     isGLFWInitialized = true;
@@ -85,14 +85,14 @@ bool Window::Initialize(int w, int h, const char* title)
   if (!window) {
     window = glfwCreateWindow(w, h, title, nullptr, nullptr);
     if (!window) {
-      std::cerr << "ERROR: GLEW̏Ɏs܂." << std::endl;
+      std::cerr << "ERROR: GLEWの初期化に失敗しました." << std::endl;
       return false;
     }
     glfwMakeContextCurrent(window);
   }
 
   if (glewInit() != GLEW_OK) {
-    std::cerr << "ERROR: GLEW̏Ɏs܂." << std::endl;
+    std::cerr << "ERROR: GLEWの初期化に失敗しました." << std::endl;
     return false;
   }
 
@@ -119,10 +119,10 @@ bool Window::Initialize(int w, int h, const char* title)
 }
 
 /**
-* EBhEׂׂ.
+* ウィンドウを閉じるべきか調べる.
 *
-* @retval true .
-* @retval false Ȃ. 
+* @retval true 閉じる.
+* @retval false 閉じない. 
 */
 bool Window::ShouldClose() const
 {
@@ -130,7 +130,7 @@ bool Window::ShouldClose() const
 }
 
 /**
-* tgobt@ƃobNobt@؂ւ.
+* フロントバッファとバックバッファを切り替える.
 */
 void Window::SwapBuffers() const
 {
@@ -139,9 +139,9 @@ void Window::SwapBuffers() const
 }
 
 /**
-* Q[pbh̏Ԃ擾.
+* ゲームパッドの状態を取得する.
 *
-* @return Q[pbh̏.
+* @return ゲームパッドの状態.
 */
 const GamePad& Window::GetGamePad() const
 {
@@ -149,7 +149,7 @@ const GamePad& Window::GetGamePad() const
 }
 
 /**
-* GLFWEW̏ԂXV.
+* GLFWEWの状態を更新する.
 */
 void Window::Update()
 {
@@ -157,13 +157,13 @@ void Window::Update()
 
   glfwGetWindowSize(window, &width, &height);
 
-  // oߎԌv.
+  // 経過時間計測.
   if (prevTime <= 0) {
     prevTime = glfwGetTime();
   } else {
     const double curTime = glfwGetTime();
     deltaTime = static_cast<float>(curTime - prevTime);
-    static const float irregularThreshold = 0.5f; ///< fobOȂǂłȂ΂肦Ȃƍloߎ.
+    static const float irregularThreshold = 0.5f; ///< デバッグ中などでなければありえないと考えられる経過時間.
     if (deltaTime > irregularThreshold) {
       deltaTime = 1.0f / 60.0f;
     }
@@ -172,7 +172,7 @@ void Window::Update()
 }
 
 /**
-* oߎԂ̌vZbg.
+* 経過時間の計測をリセットする.
 */
 void Window::ResetDeltaTime()
 {
@@ -181,48 +181,48 @@ void Window::ResetDeltaTime()
 }
 
 /**
-* WCXeBbÑAiO͑uID.
+* ジョイスティックのアナログ入力装置ID.
 +
-* @note XBOX360Rg[[.
+* @note XBOX360コントローラー基準.
 */
 enum GLFWAXESID {
-  GLFWAXESID_LeftX, ///< XeBbNX.
-  GLFWAXESID_LeftY, ///< XeBbNY.
-  GLFWAXESID_BackX, ///< AiOgK[.
-  GLFWAXESID_RightY, ///< EXeBbNY.
-  GLFWAXESID_RightX, ///< EXeBbNX.
+  GLFWAXESID_LeftX, ///< 左スティックのX軸.
+  GLFWAXESID_LeftY, ///< 左スティックのY軸.
+  GLFWAXESID_BackX, ///< アナログトリガー.
+  GLFWAXESID_RightY, ///< 右スティックのY軸.
+  GLFWAXESID_RightX, ///< 右スティックのX軸.
 };
 
 /**
-* WCXeBbÑfW^͑uID.
+* ジョイスティックのデジタル入力装置ID.
 +
-* @note XBOX360Rg[[.
+* @note XBOX360コントローラー基準.
 */
 enum GLFWBUTTONID {
-  GLFWBUTTONID_A, ///< A{^.
-  GLFWBUTTONID_B, ///< B{^.
-  GLFWBUTTONID_X, ///< X{^.
-  GLFWBUTTONID_Y, ///< Y{^.
-  GLFWBUTTONID_L, ///< L{^.
-  GLFWBUTTONID_R, ///< R{^.
-  GLFWBUTTONID_Back, ///< Back{^.
-  GLFWBUTTONID_Start, ///< Start{^.
-  GLFWBUTTONID_LThumb, ///< XeBbN{^.
-  GLFWBUTTONID_RThumb, ///< EXeBbN{^.
-  GLFWBUTTONID_Up, ///< L[.
-  GLFWBUTTONID_Right, ///< EL[.
-  GLFWBUTTONID_Down, ///< L[.
-  GLFWBUTTONID_Left, ///< L[.
+  GLFWBUTTONID_A, ///< Aボタン.
+  GLFWBUTTONID_B, ///< Bボタン.
+  GLFWBUTTONID_X, ///< Xボタン.
+  GLFWBUTTONID_Y, ///< Yボタン.
+  GLFWBUTTONID_L, ///< Lボタン.
+  GLFWBUTTONID_R, ///< Rボタン.
+  GLFWBUTTONID_Back, ///< Backボタン.
+  GLFWBUTTONID_Start, ///< Startボタン.
+  GLFWBUTTONID_LThumb, ///< 左スティックボタン.
+  GLFWBUTTONID_RThumb, ///< 右スティックボタン.
+  GLFWBUTTONID_Up, ///< 上キー.
+  GLFWBUTTONID_Right, ///< 右キー.
+  GLFWBUTTONID_Down, ///< 下キー.
+  GLFWBUTTONID_Left, ///< 左キー.
 };
 
 /**
-* Q[pbh̏ԂXV.
+* ゲームパッドの状態を更新する.
 */
 void Window::UpdateGamePad()
 {
-  const uint32_t prevButtons = gamepad.buttons; //Ot[̃{^Ԃۑ.
+  const uint32_t prevButtons = gamepad.buttons; //前フレームのボタン状態を保存.
 
-  // WCXeBbN͂擾A擾vfĂ΂g.
+  // ジョイスティック入力を取得し、取得した要素数が足りていればそれを使う.
   int axesCount, buttonCount;
   const float* axes = glfwGetJoystickAxes(GLFW_JOYSTICK_1, &axesCount);
   const uint8_t* buttons = glfwGetJoystickButtons(GLFW_JOYSTICK_1, &buttonCount);
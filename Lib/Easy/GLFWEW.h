@@ -9,12 +9,12 @@
 
 namespace GLFWEW {
 
-// s錾.
+// 先行宣言.
 class Window;
 using WindowRef = Window&;
 
 /**
-* GLFWGLEW̃bp[NX.
+* GLFWとGLEWのラッパークラス.
 */
 class Window
 {
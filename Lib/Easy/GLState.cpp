@@ -0,0 +1,360 @@
+/**
+* @file GLState.cpp
+*/
+#include "GLState.h"
+#include "RenderBackend.h"
+
+namespace GLState {
+
+namespace /* unnamed */ {
+
+const GLuint unknownId = ~0u; ///< 状態が不明であることを示す値.
+const GLenum unknownEnum = ~0u; ///< 状態が不明であることを示す値.
+const size_t maxUnitCount = 16; ///< 記録するテクスチャ・イメージ・ユニットの数.
+
+/// 記録するテクスチャの種類.
+enum TextureTarget {
+  TextureTarget_2D,
+  TextureTarget_CubeMap,
+  TextureTarget_Count,
+};
+
+/// 記録する有効/無効状態の種類.
+enum Capability {
+  Capability_Blend,
+  Capability_DepthTest,
+  Capability_Count,
+};
+
+/**
+* 記録しているOpenGLの状態.
+*/
+struct State
+{
+  GLuint program;
+  GLuint vao;
+  GLenum activeUnit;
+  GLuint texture[maxUnitCount][TextureTarget_Count];
+  int capability[Capability_Count]; ///< -1=不明 0=無効 1=有効.
+  GLenum blendSrc;
+  GLenum blendDst;
+};
+
+State state; ///< 記録している状態. 最初に使われたときにReset()で初期化される.
+Stats stats = {}; ///< 統計情報.
+bool isInitialized = false; ///< stateを初期化したかどうか.
+
+/**
+* 全ての状態を不明にする.
+*/
+void Reset()
+{
+  state.program = unknownId;
+  state.vao = unknownId;
+  state.activeUnit = unknownEnum;
+  for (auto& unit : state.texture) {
+    for (auto& e : unit) {
+      e = unknownId;
+    }
+  }
+  for (auto& e : state.capability) {
+    e = -1;
+  }
+  state.blendSrc = unknownEnum;
+  state.blendDst = unknownEnum;
+  isInitialized = true;
+}
+
+/**
+* 必要なら状態を初期化する.
+*/
+void Initialize()
+{
+  if (!isInitialized) {
+    Reset();
+  }
+}
+
+/**
+* テクスチャの種類を記録用の番号に変換する.
+*
+* @param target テクスチャの種類.
+*
+* @return targetに対応する番号. 記録しない種類の場合はTextureTarget_Count.
+*/
+int ToTextureTarget(GLenum target)
+{
+  switch (target) {
+  case GL_TEXTURE_2D: return TextureTarget_2D;
+  case GL_TEXTURE_CUBE_MAP: return TextureTarget_CubeMap;
+  default: return TextureTarget_Count;
+  }
+}
+
+/**
+* 有効/無効状態の種類を記録用の番号に変換する.
+*
+* @param cap 有効/無効状態の種類.
+*
+* @return capに対応する番号. 記録しない種類の場合はCapability_Count.
+*/
+int ToCapability(GLenum cap)
+{
+  switch (cap) {
+  case GL_BLEND: return Capability_Blend;
+  case GL_DEPTH_TEST: return Capability_DepthTest;
+  default: return Capability_Count;
+  }
+}
+
+/**
+* 有効/無効状態を設定する.
+*
+* @param cap    設定する状態の種類.
+* @param enable true=有効にする. false=無効にする.
+*/
+void SetCapability(GLenum cap, bool enable)
+{
+  Initialize();
+  const int index = ToCapability(cap);
+  if (index < Capability_Count) {
+    if (state.capability[index] == static_cast<int>(enable)) {
+      ++stats.skipped[StatType_Capability];
+      return;
+    }
+    state.capability[index] = enable;
+  }
+  ++stats.issued[StatType_Capability];
+  if (enable) {
+    RenderBackend::Get().Enable(cap);
+  } else {
+    RenderBackend::Get().Disable(cap);
+  }
+}
+
+} // unnamed namespace
+
+/**
+* 実際にOpenGLを呼び出した回数の合計を取得する.
+*
+* @return 全ての種類の呼び出し回数の合計.
+*/
+uint32_t Stats::TotalIssued() const
+{
+  uint32_t n = 0;
+  for (auto e : issued) {
+    n += e;
+  }
+  return n;
+}
+
+/**
+* 呼び出しを省略した回数の合計を取得する.
+*
+* @return 全ての種類の省略回数の合計.
+*/
+uint32_t Stats::TotalSkipped() const
+{
+  uint32_t n = 0;
+  for (auto e : skipped) {
+    n += e;
+  }
+  return n;
+}
+
+/**
+* 描画用プログラムを設定する.
+*
+* @param program 設定するプログラムオブジェクト.
+*/
+void UseProgram(GLuint program)
+{
+  Initialize();
+  if (state.program == program) {
+    ++stats.skipped[StatType_Program];
+    return;
+  }
+  ++stats.issued[StatType_Program];
+  state.program = program;
+  RenderBackend::Get().UseProgram(program);
+}
+
+/**
+* VAOを割り当てる.
+*
+* @param vao 割り当てるVAO.
+*
+* GL_ELEMENT_ARRAY_BUFFERの割り当てはVAOに記録されるため、VAOと関係なくIBOを操作する場合は
+* 事前にBindVertexArray(0)を呼ぶこと.
+*/
+void BindVertexArray(GLuint vao)
+{
+  Initialize();
+  if (state.vao == vao) {
+    ++stats.skipped[StatType_VertexArray];
+    return;
+  }
+  ++stats.issued[StatType_VertexArray];
+  state.vao = vao;
+  RenderBackend::Get().BindVertexArray(vao);
+}
+
+/**
+* テクスチャをテクスチャ・イメージ・ユニットに割り当てる.
+*
+* @param unit    割り当て先のテクスチャ・イメージ・ユニット番号(GL_TEXTURE0～).
+* @param target  割り当てるテクスチャの種類(GL_TEXTURE_2D, GL_TEXTURE_CUBE_MAP, etc).
+* @param texture 割り当てるテクスチャオブジェクト.
+*
+* 記録するのはGL_TEXTURE_2DとGL_TEXTURE_CUBE_MAPのみ. それ以外の種類は常にOpenGLを呼び出す.
+*/
+void BindTexture(GLenum unit, GLenum target, GLuint texture)
+{
+  Initialize();
+  const size_t unitIndex = unit - GL_TEXTURE0;
+  const int targetIndex = ToTextureTarget(target);
+  const bool isTracked = unitIndex < maxUnitCount && targetIndex < TextureTarget_Count;
+  if (isTracked && state.texture[unitIndex][targetIndex] == texture) {
+    ++stats.skipped[StatType_Texture];
+    return;
+  }
+
+  if (state.activeUnit == unit) {
+    ++stats.skipped[StatType_ActiveTexture];
+  } else {
+    ++stats.issued[StatType_ActiveTexture];
+    state.activeUnit = unit;
+    RenderBackend::Get().ActiveTexture(unit);
+  }
+  ++stats.issued[StatType_Texture];
+  if (isTracked) {
+    state.texture[unitIndex][targetIndex] = texture;
+  }
+  RenderBackend::Get().BindTexture(target, texture);
+}
+
+/**
+* 描画機能を有効にする.
+*
+* @param cap 有効にする機能(GL_BLEND, GL_DEPTH_TEST, etc).
+*
+* 記録するのはGL_BLENDとGL_DEPTH_TESTのみ. それ以外の機能は常にOpenGLを呼び出す.
+*/
+void Enable(GLenum cap)
+{
+  SetCapability(cap, true);
+}
+
+/**
+* 描画機能を無効にする.
+*
+* @param cap 無効にする機能(GL_BLEND, GL_DEPTH_TEST, etc).
+*
+* 記録するのはGL_BLENDとGL_DEPTH_TESTのみ. それ以外の機能は常にOpenGLを呼び出す.
+*/
+void Disable(GLenum cap)
+{
+  SetCapability(cap, false);
+}
+
+/**
+* ブレンド関数を設定する.
+*
+* @param sfactor 描画する色に掛ける係数.
+* @param dfactor 描画先の色に掛ける係数.
+*/
+void BlendFunc(GLenum sfactor, GLenum dfactor)
+{
+  Initialize();
+  if (state.blendSrc == sfactor && state.blendDst == dfactor) {
+    ++stats.skipped[StatType_BlendFunc];
+    return;
+  }
+  ++stats.issued[StatType_BlendFunc];
+  state.blendSrc = sfactor;
+  state.blendDst = dfactor;
+  RenderBackend::Get().BlendFunc(sfactor, dfactor);
+}
+
+/**
+* プログラムオブジェクトを削除する.
+*
+* @param program 削除するプログラムオブジェクト.
+*
+* 削除したIDが再利用されたときに誤って呼び出しを省略しないように、記録を不明状態に戻す.
+*/
+void DeleteProgram(GLuint program)
+{
+  Initialize();
+  if (state.program == program) {
+    state.program = unknownId;
+  }
+  RenderBackend::Get().DeleteProgram(program);
+}
+
+/**
+* VAOを削除する.
+*
+* @param vao 削除するVAO.
+*
+* 割り当て中のVAOを削除するとOpenGLは0を割り当てるので、記録もそれに合わせる.
+*/
+void DeleteVertexArray(GLuint vao)
+{
+  Initialize();
+  if (state.vao == vao) {
+    state.vao = 0;
+  }
+  RenderBackend::Get().DeleteVertexArray(vao);
+}
+
+/**
+* テクスチャを削除する.
+*
+* @param texture 削除するテクスチャ.
+*
+* 割り当て中のテクスチャを削除するとOpenGLは0を割り当てるので、記録もそれに合わせる.
+*/
+void DeleteTexture(GLuint texture)
+{
+  Initialize();
+  for (auto& unit : state.texture) {
+    for (auto& e : unit) {
+      if (e == texture) {
+        e = 0;
+      }
+    }
+  }
+  RenderBackend::Get().DeleteTexture(texture);
+}
+
+/**
+* 記録している状態を全て破棄する.
+*
+* OpenGLの関数を直接呼び出して状態を変更した場合や、コンテキストを作り直した場合に呼び出すこと.
+* 次の呼び出しでは必ずOpenGLが呼び出される.
+*/
+void Invalidate()
+{
+  Reset();
+}
+
+/**
+* 統計情報を取得する.
+*
+* @return 前回ResetStats()を呼び出してからの統計情報.
+*/
+const Stats& GetStats()
+{
+  return stats;
+}
+
+/**
+* 統計情報をリセットする.
+*/
+void ResetStats()
+{
+  stats = {};
+}
+
+} // namespace GLState
@@ -0,0 +1,59 @@
+/**
+* @file GLState.h
+*/
+#ifndef GLSTATE_H_INCLUDED
+#define GLSTATE_H_INCLUDED
+#include <GL/glew.h>
+#include <stdint.h>
+
+/**
+* OpenGLの描画状態を記録し、状態を変更しないAPI呼び出しを省略する機能を格納する名前空間.
+*
+* プログラム、VAO、テクスチャ・イメージ・ユニットごとのテクスチャ、GL_BLEND/GL_DEPTH_TESTの
+* 有効/無効、ブレンド関数を記録する.
+* 記録した状態を正しく保つため、これらの状態はこの名前空間の関数を通して変更すること.
+* 直接OpenGLの関数で状態を変更した場合はInvalidate()を呼ぶこと.
+*/
+namespace GLState {
+
+/// 統計情報の種類.
+enum StatType {
+  StatType_Program, ///< glUseProgram.
+  StatType_VertexArray, ///< glBindVertexArray.
+  StatType_ActiveTexture, ///< glActiveTexture.
+  StatType_Texture, ///< glBindTexture.
+  StatType_Capability, ///< glEnable/glDisable.
+  StatType_BlendFunc, ///< glBlendFunc.
+  StatType_Count, ///< 統計情報の種類数.
+};
+
+/**
+* API呼び出しの統計情報.
+*/
+struct Stats
+{
+  uint32_t issued[StatType_Count]; ///< 実際にOpenGLを呼び出した回数.
+  uint32_t skipped[StatType_Count]; ///< 状態が変わらないため呼び出しを省略した回数.
+
+  uint32_t TotalIssued() const;
+  uint32_t TotalSkipped() const;
+};
+
+void UseProgram(GLuint program);
+void BindVertexArray(GLuint vao);
+void BindTexture(GLenum unit, GLenum target, GLuint texture);
+void Enable(GLenum cap);
+void Disable(GLenum cap);
+void BlendFunc(GLenum sfactor, GLenum dfactor);
+
+void DeleteProgram(GLuint program);
+void DeleteVertexArray(GLuint vao);
+void DeleteTexture(GLuint texture);
+
+void Invalidate();
+const Stats& GetStats();
+void ResetStats();
+
+} // namespace GLState
+
+#endif // GLSTATE_H_INCLUDED
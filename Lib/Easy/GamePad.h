@@ -6,7 +6,7 @@
 #include <stdint.h>
 
 /**
-* Q[pbh.
+* ゲームパッド情報.
 */
 struct GamePad
 {
@@ -24,8 +24,8 @@ struct GamePad
     R = 0x0400,
     ESC = 0x8000,
   };
-  uint32_t buttons; ///< Ă邠tO.
-  uint32_t buttonDown; ///< ꂽuԂtO.
+  uint32_t buttons; ///< 押されているあいだフラグが立つ.
+  uint32_t buttonDown; ///< 押された瞬間だけフラグが立つ.
 };
 
 #endif // GAMEPAD_H_INCLUDED
@@ -0,0 +1,689 @@
+/**
+* @file Inflate.cpp
+*/
+#include "Inflate.h"
+#include <string.h>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define EASY_INFLATE_USE_SSE2
+#endif
+
+namespace Inflate {
+
+namespace /* unnamed */ {
+
+const int maxCodeLength = 15; ///< ハフマン符号の最大ビット数.
+const int fastBits = 10; ///< 表引きで一度に復号するビット数.
+
+/// 長さ符号(257～285)の基本値.
+const uint16_t lengthBase[29] = {
+  3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+  35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+/// 長さ符号(257～285)の追加ビット数.
+const uint8_t lengthExtra[29] = {
+  0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+  3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+/// 距離符号(0～29)の基本値.
+const uint16_t distBase[30] = {
+  1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+  257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+/// 距離符号(0～29)の追加ビット数.
+const uint8_t distExtra[30] = {
+  0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+  7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+/**
+* ハフマン符号の復号表.
+*
+* fastBits以下の長さの符号はfastから直接引き、それより長い符号はcountとsymbolから1ビットずつ調べる.
+*/
+struct Huffman
+{
+  uint16_t fast[1 << fastBits]; ///< (記号 << 4) | 符号の長さ. 0ならfastBitsより長い符号.
+  uint16_t count[maxCodeLength + 1]; ///< 長さごとの符号の数.
+  uint16_t symbol[288]; ///< 符号の順に並べた記号.
+
+  bool Build(const uint8_t* lengths, int n);
+};
+
+/**
+* 符号の長さの列から復号表を作成する.
+*
+* @param lengths 記号ごとの符号の長さ. 0は使われない記号.
+* @param n       記号の数.
+*
+* @retval true  作成成功.
+* @retval false 符号の数が長さに対して多すぎる.
+*/
+bool Huffman::Build(const uint8_t* lengths, int n)
+{
+  memset(count, 0, sizeof(count));
+  for (int i = 0; i < n; ++i) {
+    ++count[lengths[i]];
+  }
+  count[0] = 0;
+  int left = 1;
+  for (int len = 1; len <= maxCodeLength; ++len) {
+    left = (left << 1) - count[len];
+    if (left < 0) {
+      return false;
+    }
+  }
+
+  uint16_t offsets[maxCodeLength + 1];
+  offsets[1] = 0;
+  for (int len = 1; len < maxCodeLength; ++len) {
+    offsets[len + 1] = offsets[len] + count[len];
+  }
+  for (int i = 0; i < n; ++i) {
+    if (lengths[i]) {
+      symbol[offsets[lengths[i]]++] = static_cast<uint16_t>(i);
+    }
+  }
+
+  // 符号はビットの並びが逆順に格納されているので、反転した位置に登録する.
+  memset(fast, 0, sizeof(fast));
+  int code = 0;
+  int index = 0;
+  for (int len = 1; len <= fastBits; ++len) {
+    for (int i = 0; i < count[len]; ++i, ++code, ++index) {
+      int reversed = 0;
+      for (int bit = 0; bit < len; ++bit) {
+        reversed |= ((code >> bit) & 1) << (len - 1 - bit);
+      }
+      const uint16_t entry = static_cast<uint16_t>((symbol[index] << 4) | len);
+      for (int j = reversed; j < (1 << fastBits); j += 1 << len) {
+        fast[j] = entry;
+      }
+    }
+    code <<= 1;
+  }
+  return true;
+}
+
+/**
+* 固定ハフマン符号の復号表を取得する.
+*
+* @param lit  リテラル・長さ符号の復号表を格納する変数.
+* @param dist 距離符号の復号表を格納する変数.
+*/
+void GetFixedHuffman(const Huffman*& lit, const Huffman*& dist)
+{
+  struct Table
+  {
+    Table() {
+      uint8_t lengths[288];
+      memset(lengths, 8, 144);
+      memset(lengths + 144, 9, 112);
+      memset(lengths + 256, 7, 24);
+      memset(lengths + 280, 8, 8);
+      lit.Build(lengths, 288);
+      memset(lengths, 5, 30);
+      dist.Build(lengths, 30);
+    }
+    Huffman lit;
+    Huffman dist;
+  };
+  static const Table table;
+  lit = &table.lit;
+  dist = &table.dist;
+}
+
+/**
+* Deflate形式の復号器.
+*
+* 入力はリトルエンディアンで8バイトずつビットバッファに読み込む.
+*/
+class Decoder
+{
+public:
+  Decoder(const uint8_t* src, const uint8_t* srcEnd, uint8_t* dst, uint8_t* dstEnd) :
+    p(src), end(srcEnd), outBegin(dst), out(dst), outEnd(dstEnd) {}
+
+  bool Run();
+  const uint8_t* InputPosition();
+  size_t OutputSize() const { return out - outBegin; }
+
+private:
+  void Refill();
+  void Consume(int n) { bitBuf >>= n; bitCount -= n; }
+  uint32_t Bits(int n) {
+    const uint32_t v = static_cast<uint32_t>(bitBuf & ((1ull << n) - 1));
+    Consume(n);
+    return v;
+  }
+  bool Need(int n) {
+    if (bitCount < n) {
+      Refill();
+    }
+    return bitCount >= n;
+  }
+  int Decode(const Huffman& h);
+  int DecodeSlow(const Huffman& h);
+  void CopyMatch(size_t distance, size_t length);
+
+  bool Stored();
+  bool Dynamic(Huffman& lit, Huffman& dist);
+  bool Codes(const Huffman& lit, const Huffman& dist);
+
+  const uint8_t* p; ///< 次に読み込む入力の位置.
+  const uint8_t* end; ///< 入力の終端.
+  uint64_t bitBuf = 0; ///< ビットバッファ. 下位ビットから順に使う.
+  int bitCount = 0; ///< ビットバッファの有効なビット数. 負数なら入力が足りなかった.
+  uint8_t* outBegin; ///< 出力の先頭.
+  uint8_t* out; ///< 次に書き込む出力の位置.
+  uint8_t* outEnd; ///< 出力の終端.
+};
+
+/**
+* ビットバッファに入力を読み込む.
+*
+* 入力が残っていれば、bitCountは56以上になる.
+*/
+void Decoder::Refill()
+{
+  if (end - p >= 8) {
+    // 読み込んだ8バイトのうち、bitCountに収まる分だけ入力を進める.
+    uint64_t v;
+    memcpy(&v, p, 8);
+    bitBuf |= v << bitCount;
+    p += (63 - bitCount) >> 3;
+    bitCount |= 56;
+    return;
+  }
+  while (bitCount <= 56 && p != end) {
+    bitBuf |= static_cast<uint64_t>(*p++) << bitCount;
+    bitCount += 8;
+  }
+}
+
+/**
+* ハフマン符号を1つ復号する.
+*
+* @param h 復号表.
+*
+* @return 復号した記号. 符号が不正なら-1.
+*/
+int Decoder::Decode(const Huffman& h)
+{
+  const uint16_t entry = h.fast[bitBuf & ((1 << fastBits) - 1)];
+  if (entry) {
+    Consume(entry & 15);
+    return entry >> 4;
+  }
+  return DecodeSlow(h);
+}
+
+/**
+* fastBitsより長いハフマン符号を1つ復号する.
+*
+* @param h 復号表.
+*
+* @return 復号した記号. 符号が不正なら-1.
+*/
+int Decoder::DecodeSlow(const Huffman& h)
+{
+  int code = 0;
+  int first = 0;
+  int index = 0;
+  for (int len = 1; len <= maxCodeLength; ++len) {
+    code |= static_cast<int>(bitBuf >> (len - 1)) & 1;
+    const int count = h.count[len];
+    if (code - first < count) {
+      Consume(len);
+      return h.symbol[index + code - first];
+    }
+    index += count;
+    first = (first + count) << 1;
+    code <<= 1;
+  }
+  return -1;
+}
+
+/**
+* 出力済みのデータを複製する.
+*
+* @param distance 複製元までの距離.
+* @param length   複製するバイト数.
+*
+* 複製元と複製先が重なっている場合は、同じ並びが繰り返される.
+*/
+void Decoder::CopyMatch(size_t distance, size_t length)
+{
+  const uint8_t* from = out - distance;
+  uint8_t* const last = out + length;
+  if (static_cast<size_t>(outEnd - out) < length + 16) {
+    while (out != last) {
+      *out++ = *from++;
+    }
+    return;
+  }
+  if (distance == 1) {
+    memset(out, *from, length);
+    out = last;
+    return;
+  }
+  // 16バイト単位で複製できるように、距離が短い場合は繰り返しの周期を16バイト以上に広げる.
+  if (distance < 16) {
+    const size_t period = distance * ((16 + distance - 1) / distance);
+    const size_t n = period < length ? period : length;
+    for (size_t i = 0; i < n; ++i) {
+      out[i] = from[i];
+    }
+    from = out;
+    out += n;
+  }
+  while (out < last) {
+#ifdef EASY_INFLATE_USE_SSE2
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_loadu_si128(reinterpret_cast<const __m128i*>(from)));
+#else
+    memcpy(out, from, 8);
+    memcpy(out + 8, from + 8, 8);
+#endif
+    out += 16;
+    from += 16;
+  }
+  out = last;
+}
+
+/**
+* 圧縮データ全体を展開する.
+*
+* @retval true  展開成功.
+* @retval false データが不正か、出力先の大きさが足りない.
+*/
+bool Decoder::Run()
+{
+  Huffman lit;
+  Huffman dist;
+  for (;;) {
+    if (!Need(3)) {
+      return false;
+    }
+    const uint32_t isFinal = Bits(1);
+    const uint32_t type = Bits(2);
+    bool result = false;
+    if (type == 0) {
+      result = Stored();
+    } else if (type == 1) {
+      const Huffman* fixedLit;
+      const Huffman* fixedDist;
+      GetFixedHuffman(fixedLit, fixedDist);
+      result = Codes(*fixedLit, *fixedDist);
+    } else if (type == 2) {
+      result = Dynamic(lit, dist) && Codes(lit, dist);
+    }
+    if (!result) {
+      return false;
+    }
+    if (isFinal) {
+      return true;
+    }
+  }
+}
+
+/**
+* 圧縮データの直後の位置を取得する.
+*
+* @return 圧縮データの直後の位置. Run()の後で呼び出すこと.
+*/
+const uint8_t* Decoder::InputPosition()
+{
+  Consume(bitCount & 7);
+  return p - (bitCount >> 3);
+}
+
+/**
+* 非圧縮ブロックを展開する.
+*
+* @retval true  展開成功.
+* @retval false データが不正か、出力先の大きさが足りない.
+*/
+bool Decoder::Stored()
+{
+  // バイト境界に揃え、ビットバッファに読み込んだ分を入力に戻す.
+  p = InputPosition();
+  bitBuf = 0;
+  bitCount = 0;
+  if (end - p < 4) {
+    return false;
+  }
+  const size_t length = p[0] | (p[1] << 8);
+  const size_t nlength = p[2] | (p[3] << 8);
+  p += 4;
+  if (length != (~nlength & 0xffff)) {
+    return false;
+  }
+  if (static_cast<size_t>(end - p) < length || static_cast<size_t>(outEnd - out) < length) {
+    return false;
+  }
+  memcpy(out, p, length);
+  p += length;
+  out += length;
+  return true;
+}
+
+/**
+* 動的ハフマン符号の復号表を読み込む.
+*
+* @param lit  リテラル・長さ符号の復号表を格納する変数.
+* @param dist 距離符号の復号表を格納する変数.
+*
+* @retval true  読み込み成功.
+* @retval false データが不正.
+*/
+bool Decoder::Dynamic(Huffman& lit, Huffman& dist)
+{
+  static const uint8_t order[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+  if (!Need(14)) {
+    return false;
+  }
+  const int litCount = Bits(5) + 257;
+  const int distCount = Bits(5) + 1;
+  const int lengthCount = Bits(4) + 4;
+  if (litCount > 286 || distCount > 30) {
+    return false;
+  }
+
+  uint8_t lengths[286 + 30] = {};
+  for (int i = 0; i < lengthCount; ++i) {
+    if (!Need(3)) {
+      return false;
+    }
+    lengths[order[i]] = static_cast<uint8_t>(Bits(3));
+  }
+  Huffman lengthCode;
+  if (!lengthCode.Build(lengths, 19)) {
+    return false;
+  }
+
+  memset(lengths, 0, sizeof(lengths));
+  const int total = litCount + distCount;
+  for (int i = 0; i < total;) {
+    Refill();
+    const int symbol = Decode(lengthCode);
+    if (symbol < 0) {
+      return false;
+    }
+    if (symbol < 16) {
+      lengths[i++] = static_cast<uint8_t>(symbol);
+    } else {
+      uint8_t value = 0;
+      int repeat;
+      if (symbol == 16) {
+        if (i == 0) {
+          return false;
+        }
+        value = lengths[i - 1];
+        repeat = 3 + Bits(2);
+      } else if (symbol == 17) {
+        repeat = 3 + Bits(3);
+      } else {
+        repeat = 11 + Bits(7);
+      }
+      if (i + repeat > total) {
+        return false;
+      }
+      memset(lengths + i, value, repeat);
+      i += repeat;
+    }
+    if (bitCount < 0) {
+      return false;
+    }
+  }
+  if (lengths[256] == 0) {
+    return false;
+  }
+  return lit.Build(lengths, litCount) && dist.Build(lengths + litCount, distCount);
+}
+
+/**
+* ハフマン符号化されたブロックを展開する.
+*
+* @param lit  リテラル・長さ符号の復号表.
+* @param dist 距離符号の復号表.
+*
+* @retval true  展開成功.
+* @retval false データが不正か、出力先の大きさが足りない.
+*/
+bool Decoder::Codes(const Huffman& lit, const Huffman& dist)
+{
+  for (;;) {
+    // 1回の読み込みで、最長の符号の組(15+5+15+13ビット)を復号できる.
+    Refill();
+    int symbol = Decode(lit);
+    if (symbol < 256) {
+      if (symbol < 0 || out == outEnd) {
+        return false;
+      }
+      *out++ = static_cast<uint8_t>(symbol);
+    } else if (symbol == 256) {
+      return bitCount >= 0;
+    } else {
+      symbol -= 257;
+      if (symbol >= 29) {
+        return false;
+      }
+      const size_t length = lengthBase[symbol] + Bits(lengthExtra[symbol]);
+      const int distSymbol = Decode(dist);
+      if (distSymbol < 0 || distSymbol >= 30) {
+        return false;
+      }
+      const size_t distance = distBase[distSymbol] + Bits(distExtra[distSymbol]);
+      if (bitCount < 0 || distance > static_cast<size_t>(out - outBegin) || length > static_cast<size_t>(outEnd - out)) {
+        return false;
+      }
+      CopyMatch(distance, length);
+    }
+    if (bitCount < 0) {
+      return false;
+    }
+  }
+}
+
+/**
+* Adler-32チェックサムを計算する.
+*
+* @param data データの先頭.
+* @param size データのバイト数.
+*
+* @return チェックサム.
+*/
+uint32_t Adler32(const uint8_t* data, size_t size)
+{
+  uint32_t a = 1;
+  uint32_t b = 0;
+#ifdef EASY_INFLATE_USE_SSE2
+  // 16バイトのブロックごとに、バイトの合計と(16-位置)で重み付けした合計を求める.
+  // ブロックを処理するとbは16*(処理前のa)+重み付きの合計だけ増えるので、処理前のaの合計も求めておく.
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i weightLow = _mm_setr_epi16(16, 15, 14, 13, 12, 11, 10, 9);
+  const __m128i weightHigh = _mm_setr_epi16(8, 7, 6, 5, 4, 3, 2, 1);
+  while (size >= 16) {
+    const size_t n = (size < 5552 ? size : 5552) & ~static_cast<size_t>(15);
+    __m128i sum = zero; // バイトの合計.
+    __m128i prefix = zero; // 各ブロックを処理する前のsumの合計.
+    __m128i weighted = zero; // 重み付きの合計.
+    for (size_t i = 0; i < n; i += 16) {
+      const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+      prefix = _mm_add_epi32(prefix, sum);
+      sum = _mm_add_epi32(sum, _mm_sad_epu8(v, zero));
+      weighted = _mm_add_epi32(weighted, _mm_add_epi32(
+        _mm_madd_epi16(_mm_unpacklo_epi8(v, zero), weightLow),
+        _mm_madd_epi16(_mm_unpackhi_epi8(v, zero), weightHigh)));
+    }
+    uint32_t s[4], p[4], w[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(s), sum);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p), prefix);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(w), weighted);
+    const uint64_t bytes = static_cast<uint64_t>(s[0]) + s[2];
+    const uint64_t prefixBytes = static_cast<uint64_t>(p[0]) + p[2];
+    const uint64_t weightedBytes = static_cast<uint64_t>(w[0]) + w[1] + w[2] + w[3];
+    b = static_cast<uint32_t>((b + static_cast<uint64_t>(a) * n + prefixBytes * 16 + weightedBytes) % 65521);
+    a = static_cast<uint32_t>((a + bytes) % 65521);
+    data += n;
+    size -= n;
+  }
+#endif
+  while (size) {
+    // 5552バイトまでは32ビットであふれない.
+    const size_t n = size < 5552 ? size : 5552;
+    for (size_t i = 0; i < n; ++i) {
+      a += data[i];
+      b += a;
+    }
+    a %= 65521;
+    b %= 65521;
+    data += n;
+    size -= n;
+  }
+  return (b << 16) | a;
+}
+
+/**
+* CRC-32チェックサムを計算する.
+*
+* @param data データの先頭.
+* @param size データのバイト数.
+*
+* @return チェックサム.
+*/
+uint32_t Crc32(const uint8_t* data, size_t size)
+{
+  struct Table
+  {
+    Table() {
+      for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t c = i;
+        for (int j = 0; j < 8; ++j) {
+          c = (c & 1) ? 0xedb88320 ^ (c >> 1) : c >> 1;
+        }
+        crc[i] = c;
+      }
+    }
+    uint32_t crc[256];
+  };
+  static const Table table;
+  uint32_t c = 0xffffffff;
+  for (size_t i = 0; i < size; ++i) {
+    c = table.crc[(c ^ data[i]) & 0xff] ^ (c >> 8);
+  }
+  return c ^ 0xffffffff;
+}
+
+/**
+* gzipヘッダを読み飛ばす.
+*
+* @param p   gzipヘッダの先頭.
+* @param end 入力の終端.
+*
+* @return 圧縮データの先頭. ヘッダが不正ならnullptr.
+*/
+const uint8_t* SkipGzipHeader(const uint8_t* p, const uint8_t* end)
+{
+  if (end - p < 10 || p[0] != 0x1f || p[1] != 0x8b || p[2] != 8) {
+    return nullptr;
+  }
+  const uint8_t flags = p[3];
+  p += 10;
+  if (flags & 4) { // FEXTRA.
+    if (end - p < 2) {
+      return nullptr;
+    }
+    const size_t size = p[0] | (p[1] << 8);
+    if (static_cast<size_t>(end - p - 2) < size) {
+      return nullptr;
+    }
+    p += 2 + size;
+  }
+  for (int bit = 8; bit <= 16; bit <<= 1) { // FNAME, FCOMMENT.
+    if (flags & bit) {
+      p = static_cast<const uint8_t*>(memchr(p, 0, end - p));
+      if (!p) {
+        return nullptr;
+      }
+      ++p;
+    }
+  }
+  if (flags & 2) { // FHCRC.
+    if (end - p < 2) {
+      return nullptr;
+    }
+    p += 2;
+  }
+  return p;
+}
+
+} // unnamed namespace
+
+/**
+* 圧縮データを展開する.
+*
+* @param format  圧縮データの形式.
+* @param src     圧縮データ.
+* @param srcSize srcのバイト数.
+* @param dst     展開したデータの格納先.
+* @param dstSize dstのバイト数.
+* @param written 展開したバイト数を格納する変数.
+*
+* @retval true  展開成功.
+* @retval false データが不正か、チェックサムが一致しないか、dstの大きさが足りない.
+*/
+bool Decompress(Format format, const void* src, size_t srcSize, void* dst, size_t dstSize, size_t& written)
+{
+  written = 0;
+  const uint8_t* p = static_cast<const uint8_t*>(src);
+  const uint8_t* const end = p + srcSize;
+  if (format == Format_Zlib) {
+    if (srcSize < 2) {
+      return false;
+    }
+    const int cmf = p[0];
+    const int flg = p[1];
+    if ((cmf & 15) != 8 || (cmf >> 4) > 7 || (cmf * 256 + flg) % 31 || (flg & 0x20)) {
+      return false;
+    }
+    p += 2;
+  } else if (format == Format_Gzip) {
+    p = SkipGzipHeader(p, end);
+    if (!p) {
+      return false;
+    }
+  }
+
+  uint8_t* const out = static_cast<uint8_t*>(dst);
+  Decoder decoder(p, end, out, out + dstSize);
+  if (!decoder.Run()) {
+    return false;
+  }
+  p = decoder.InputPosition();
+  const size_t size = decoder.OutputSize();
+
+  if (format == Format_Zlib) {
+    if (end - p < 4) {
+      return false;
+    }
+    const uint32_t adler = (static_cast<uint32_t>(p[0]) << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+    if (adler != Adler32(out, size)) {
+      return false;
+    }
+  } else if (format == Format_Gzip) {
+    if (end - p < 8) {
+      return false;
+    }
+    const uint32_t crc = p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+    const uint32_t isize = p[4] | (p[5] << 8) | (p[6] << 16) | (static_cast<uint32_t>(p[7]) << 24);
+    if (isize != static_cast<uint32_t>(size) || crc != Crc32(out, size)) {
+      return false;
+    }
+  }
+  written = size;
+  return true;
+}
+
+} // namespace Inflate
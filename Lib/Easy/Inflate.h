@@ -0,0 +1,28 @@
+/**
+* @file Inflate.h
+*/
+#ifndef INFLATE_H_INCLUDED
+#define INFLATE_H_INCLUDED
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+* Deflate(RFC 1951)形式の圧縮データを展開する機能を格納する名前空間.
+*
+* 展開後の大きさが分かっているデータを、一度の呼び出しで出力先に直接展開する.
+* zlib形式とgzip形式ではチェックサムも検証する.
+*/
+namespace Inflate {
+
+/// 圧縮データの形式.
+enum Format {
+  Format_Deflate, ///< ヘッダのないDeflate形式(RFC 1951).
+  Format_Zlib, ///< zlib形式(RFC 1950).
+  Format_Gzip, ///< gzip形式(RFC 1952).
+};
+
+bool Decompress(Format format, const void* src, size_t srcSize, void* dst, size_t dstSize, size_t& written);
+
+} // namespace Inflate
+
+#endif // INFLATE_H_INCLUDED
@@ -1,63 +1,252 @@
 /**
 * @file Json.cpp
 *
-* JSONf[^͂p[T.
+* JSONデータを解析するパーサ.
 */
 #include "Json.h"
+#include <algorithm>
+#include <cmath>
 #include <string.h>
 #include <stdlib.h>
 
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define EASY_JSON_USE_SSE2
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
 /**
-* JSONp[T.
+* JSONパーサ.
 */
 namespace Json {
 
+const size_t Writer::bufferSize;
+
+namespace /* unnamed */ {
+
+/**
+* 空白文字か調べる.
+*
+* @param c 調べる文字.
+*
+* @retval true  ' ', '\n', '\t', '\r'のいずれか.
+* @retval false それ以外の文字.
+*/
+inline bool IsSpace(char c)
+{
+	return c == ' ' || c == '\n' || c == '\t' || c == '\r';
+}
+
+#ifdef EASY_JSON_USE_SSE2
+/**
+* 最下位の1のビットの位置を取得する.
+*
+* @param n 0以外の値.
+*
+* @return 最下位の1のビットの位置.
+*/
+inline int CountTrailingZeros(uint32_t n)
+{
+#ifdef _MSC_VER
+	unsigned long i;
+	_BitScanForward(&i, n);
+	return static_cast<int>(i);
+#else
+	return __builtin_ctz(n);
+#endif
+}
+
+/**
+* 16バイトの中で、指定した文字と一致する位置を求める.
+*
+* @param v 調べる16バイト.
+* @param c 探す文字.
+*
+* @return 一致した位置のバイトの全ビットを1にした値.
+*/
+inline __m128i Equal16(__m128i v, char c)
+{
+	return _mm_cmpeq_epi8(v, _mm_set1_epi8(c));
+}
+#endif // EASY_JSON_USE_SSE2
+
+/**
+* 2文字以上続く空白文字を読み飛ばす.
+*
+* @param p   読み込み位置.
+* @param end データの終端.
+*
+* @return 空白でない最初の文字の位置. 見つからなければend.
+*
+* 字下げのような長い空白は、SSE2が使える環境では16文字ずつ調べる.
+*/
+const char* SkipWhitespaceRun(const char* p, const char* end)
+{
+#ifdef EASY_JSON_USE_SSE2
+	for (; end - p >= 16; p += 16) {
+		const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+		const __m128i space = _mm_or_si128(
+			_mm_or_si128(Equal16(v, ' '), Equal16(v, '\n')), _mm_or_si128(Equal16(v, '\t'), Equal16(v, '\r')));
+		const uint32_t other = ~static_cast<uint32_t>(_mm_movemask_epi8(space)) & 0xffff;
+		if (other) {
+			return p + CountTrailingZeros(other);
+		}
+	}
+#endif // EASY_JSON_USE_SSE2
+	while (p != end && IsSpace(*p)) {
+		++p;
+	}
+	return p;
+}
+
+/**
+* 空白文字を読み飛ばす.
+*
+* @param p   読み込み位置.
+* @param end データの終端.
+*
+* @return 空白でない最初の文字の位置. 見つからなければend.
+*
+* 空白がないか1文字だけの場合が多いので、最初の2文字はインライン展開できる形で1文字ずつ調べる.
+*/
+inline const char* SkipWhitespace(const char* p, const char* end)
+{
+	if (p == end || !IsSpace(*p)) {
+		return p;
+	}
+	++p;
+	if (p == end || !IsSpace(*p)) {
+		return p;
+	}
+	return SkipWhitespaceRun(p + 1, end);
+}
+
+/**
+* 文字列の終端を探す.
+*
+* @param p         探索開始位置.
+* @param end       探索範囲の終端.
+* @param escaped   直前の文字が'\\'ならtrue. 探索後の状態を格納する.
+* @param hasEscape エスケープシーケンスを見つけたらtrueを格納する.
+*
+* @return 終端の'"'の位置. 見つからなければnullptr.
+*
+* SSE2が使える環境では、16文字ずつ'"'と'\\'を探す.
+*/
+const char* FindStringEnd(const char* p, const char* end, bool& escaped, bool& hasEscape)
+{
+	for (;;) {
+		if (escaped) {
+			if (p == end) {
+				return nullptr;
+			}
+			escaped = false;
+			++p;
+		}
+#ifdef EASY_JSON_USE_SSE2
+		for (; end - p >= 16; p += 16) {
+			const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+			const uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_or_si128(Equal16(v, '"'), Equal16(v, '\\'))));
+			if (mask) {
+				p += CountTrailingZeros(mask);
+				break;
+			}
+		}
+#endif // EASY_JSON_USE_SSE2
+		while (p != end && *p != '"' && *p != '\\') {
+			++p;
+		}
+		if (p == end) {
+			return nullptr;
+		} else if (*p == '"') {
+			return p;
+		}
+		hasEscape = true;
+		escaped = true;
+		++p;
+	}
+}
+
+/**
+* 文字列の中で、エスケープが必要な文字を探す.
+*
+* @param p   探索開始位置.
+* @param end 探索範囲の終端.
+*
+* @return '"', '\\', 制御文字(0x00～0x1f)のいずれかの位置. 見つからなければend.
+*
+* SSE2が使える環境では16文字ずつ調べる.
+*/
+const char* FindEscapeChar(const char* p, const char* end)
+{
+#ifdef EASY_JSON_USE_SSE2
+	const __m128i controlMax = _mm_set1_epi8(0x1f);
+	for (; end - p >= 16; p += 16) {
+		const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+		const __m128i control = _mm_cmpeq_epi8(_mm_max_epu8(v, controlMax), controlMax);
+		const uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(
+			_mm_or_si128(_mm_or_si128(Equal16(v, '"'), Equal16(v, '\\')), control)));
+		if (mask) {
+			return p + CountTrailingZeros(mask);
+		}
+	}
+#endif // EASY_JSON_USE_SSE2
+	while (p != end && static_cast<unsigned char>(*p) >= 0x20 && *p != '"' && *p != '\\') {
+		++p;
+	}
+	return p;
+}
+
+} // unnamed namespace
+
 /**
-* ftHgRXgN^.
+* デフォルトコンストラクタ.
 *
-* nulllƂď.
+* null値として初期化.
 */
 Value::Value() : type(Type::Null) {}
 
 /**
-* IuWFNg^ƂăRXgNg.
+* オブジェクト型としてコンストラクトする.
 *
-* @param o IuWFNg.
+* @param o オブジェクト.
 */
 Value::Value(const Object& o) : type(Type::Object) { new(&object) Object(o); }
 
 /**
-* z^ƂăRXgNg.
+* 配列型としてコンストラクトする.
 *
-* @param a z.
+* @param a 配列.
 */
 Value::Value(const Array& a) : type(Type::Array) { new(&array) Array(a); }
 
 /**
-* ^ƂăRXgNg.
+* 文字列型としてコンストラクトする.
 *
-* @param s .
+* @param s 文字列.
 */
 Value::Value(const std::string& s) : type(Type::String) { new(&string) String(s); }
 
 /**
-* l^ƂăRXgNg.
+* 数値型としてコンストラクトする.
 *
-* @param d l.
+* @param d 数値.
 */
 Value::Value(double d) : type(Type::Number) { new(&number) Number(d); }
 
 /**
-* ^UlƂăRXgNg.
+* 真偽値としてコンストラクトする.
 *
-* @param b ^Ul.
+* @param b 真偽値.
 */
 Value::Value(bool b) : type(Type::Boolean) { new(&boolean) Boolean(b); }
 
 /**
-* Rs[RXgN^.
+* コピーコンストラクタ.
 *
-* @param v Rs[IuWFNg.
+* @param v コピー元オブジェクト.
 */
 Value::Value(const Value& v) {
 	type = v.type;
@@ -72,7 +261,7 @@ Value::Value(const Value& v) {
 }
 
 /**
-* fXgN^.
+* デストラクタ.
 */
 Value::~Value() {
 	switch (type) {
@@ -86,9 +275,9 @@ Value::~Value() {
 }
 
 /**
-* f[^^擾.
+* データ型を取得する.
 *
-* @return f[^̎.
+* @return データの種類.
 */
 Type Value::GetType() const
 {
@@ -96,9 +285,9 @@ Type Value::GetType() const
 }
 
 /**
-* ƂăANZX.
+* 文字列としてアクセス.
 *
-* @return f[^.
+* @return 文字列データ.
 */
 const String& Value::AsString() const
 {
@@ -107,9 +296,9 @@ const String& Value::AsString() const
 }
 
 /**
-* lƂăANZX.
+* 数値としてアクセス.
 *
-* @return lf[^.
+* @return 数値データ.
 */
 Number Value::AsNumber() const
 {
@@ -117,9 +306,9 @@ Number Value::AsNumber() const
 }
 
 /**
-* ^UlƂăANZX.
+* 真偽値としてアクセス.
 *
-* @return ^Ulf[^.
+* @return 真偽値データ.
 */
 Boolean Value::AsBoolean() const
 {
@@ -127,9 +316,9 @@ Boolean Value::AsBoolean() const
 }
 
 /**
-* IuWFNgƂăANZX.
+* オブジェクトとしてアクセス.
 *
-* @return IuWFNgf[^.
+* @return オブジェクトデータ.
 */
 const Object& Value::AsObject() const
 {
@@ -138,9 +327,9 @@ const Object& Value::AsObject() const
 }
 
 /**
-* zƂăANZX.
+* 配列としてアクセス.
 *
-* @return zf[^.
+* @return 配列データ.
 */
 const Array& Value::AsArray() const
 {
@@ -149,7 +338,7 @@ const Array& Value::AsArray() const
 }
 
 /**
-* JSONf[^͊.
+* JSONデータ解析器.
 */
 class Parser
 {
@@ -170,74 +359,67 @@ private:
 	Value ParseArray();
 
 private:
-	const char* data; ///< ͒̈ʒuւ̃|C^.
-	const char* end; ///< JSONf[^̏I[|C^.
-	int line; ///< ͒̍s.
-	std::string error; ///< G[̏.
+	const char* begin; ///< JSONデータの先頭を示すポインタ.
+	const char* data; ///< 解析中の位置へのポインタ.
+	const char* end; ///< JSONデータの終端を示すポインタ.
+	std::string error; ///< 発生したエラーの情報.
 };
 
 /**
-* JSONf[^͂.
+* JSONデータを解析する.
 *
-* @param d JSONf[^̉͊Jnʒu|C^.
-* @param e JSONf[^̏I[|C^.
+* @param d JSONデータの解析開始位置を示すポインタ.
+* @param e JSONデータの終端を示すポインタ.
 *
-* @return Result^̉͌ʃIuWFNg.
+* @return Result型の解析結果オブジェクト.
 */
 Result Parser::Parse(const char* d, const char* e)
 {
+	begin = d;
 	data = d;
 	end = e;
-	line = 0;
 	error.clear();
 
 	Value value = ParseValue();
 	SkipSpace();
 	if (data != end) {
-		AddError(std::string("(Parse) ͕s\ȕ܂: '") + *data + "'");
+		AddError(std::string("(Parse) 解析不能な文字があります: '") + *data + "'");
 	}
 	return { value, error };
 }
 
 /**
-* G[ǉ.
+* エラー情報を追加.
 *
-* @param err G[̓e.
+* @param err エラーの内容を示す文字列.
 *
-* err̐擪ɍsԍt^AG[obt@ɒǉ.
+* errの先頭に行番号を付与し、エラーバッファに追加する.
+* 行番号は解析中には数えず、エラーが起きたときに先頭からの改行を数えて求める.
 */
 void Parser::AddError(const std::string& err)
 {
+	const long line = static_cast<long>(std::count(begin, data, '\n'));
 	error += std::to_string(line) + ": " + err + "\n";
 }
 
 /**
-* 󔒕XLbv.
+* 空白文字をスキップする.
 */
 void Parser::SkipSpace()
 {
-	for (; data != end; ++data) {
-		const char c = *data;
-		if (c == ' ' || c == '\t' || c == '\r') {
-			/* EMPTY */
-		} else if (c == '\n') {
-			++line;
-		} else {
-			break;
-		}
-	}
+	data = SkipWhitespace(data, end);
 }
 
 /**
-* l͂.
+* 値を解析する.
 *
-* @return li[Value^IuWFNg.
+* @return 値を格納したValue型オブジェクト.
 */
 Value Parser::ParseValue()
 {
 	SkipSpace();
 	if (data == end) {
-		AddError("(ParseValue) ͒Ƀf[^I[ɓB܂");
+		AddError("(ParseValue) 解析中にデータ終端に到達しました");
 		return Value();
 	} else if (*data == '{') {
 		return ParseObject();
@@ -258,7 +440,7 @@ Value Parser::ParseValue()
 		char* endPtr;
 		const double d = strtod(data, &endPtr);
 		if (data == endPtr) {
-			AddError(std::string("(ParseValue) ͕s\ȕ܂: '") + *data + "'");
+			AddError(std::string("(ParseValue) 解析不能な文字があります: '") + *data + "'");
 			return Value();
 		}
 		data = endPtr;
@@ -267,40 +449,36 @@ Value Parser::ParseValue()
 }
 
 /**
-* ͂.
+* 文字列を解析する.
 *
-* @return i[Value^IuWFNg.
+* @return 文字列を格納したValue型オブジェクト.
 */
 Value Parser::ParseString()
 {
-	++data; // skip first double quotation.
-
-	std::string s;
-	for (;;) {
-		if (data == end) {
-			AddError("(ParseString) ̏I['\"'܂");
-			return Value();
-		} else if (*data == '"') {
-			++data; // skip last double quotation.
-			break;
-		}
-		s.push_back(static_cast<char>(*data));
-		++data;
+	const char* const first = data + 1; // skip first double quotation.
+	bool escaped = false;
+	bool hasEscape = false;
+	const char* const last = FindStringEnd(first, end, escaped, hasEscape);
+	if (!last) {
+		data = end;
+		AddError("(ParseString) 文字列の終端に'\"'がありません");
+		return Value();
 	}
-	return Value(s);
+	data = last + 1; // skip last double quotation.
+	return Value(std::string(first, last));
 }
 
 /**
-* JSONIuWFNg͂.
+* JSONオブジェクトを解析する.
 *
-* @return JSONIuWFNgi[Value^IuWFNg.
+* @return JSONオブジェクトを格納したValue型オブジェクト.
 */
 Value Parser::ParseObject()
 {
 	++data; // skip first brace.
 	SkipSpace();
 	if (data == end) {
-		AddError("(ParseObject) IuWFNg̏I['}'܂");
+		AddError("(ParseObject) オブジェクトの終端に'}'がありません");
 		return Value();
 	} else if (*data == '}') {
 		++data;
@@ -309,18 +487,18 @@ Value Parser::ParseObject()
 
 	Object obj;
 	for (;;) {
-		if (*data != '"') {
-			AddError(std::string("(ParseObject) łȂL[܂: '") + *data + "'");
+		if (data == end || *data != '"') {
+			AddError(std::string("(ParseObject) 文字列でないキーがあります: '") + (data != end ? *data : ' ') + "'");
 			return Value();
 		}
 		const Value key = ParseString();
 
 		SkipSpace();
 		if (data == end) {
-			AddError("(ParseObject) ':'Kvł");
+			AddError("(ParseObject) ':'が必要です");
 			return Value();
 		} else if (*data != ':') {
-			AddError(std::string("(ParseObject) ':'Kvł: '") + *data + "'");
+			AddError(std::string("(ParseObject) ':'が必要です: '") + *data + "'");
 			return Value();
 		}
 		++data; // skip colon.
@@ -331,13 +509,13 @@ Value Parser::ParseObject()
 
 		SkipSpace();
 		if (data == end) {
-			AddError("(ParseObject) IuWFNg̏I['}'܂");
+			AddError("(ParseObject) オブジェクトの終端に'}'がありません");
 			return Value();
 		} else if (*data == '}') {
 			++data; // skip last brace.
 			break;
 		} else if (*data != ',') {
-			AddError(std::string("(ParseObject) ','Kvł: '") + *data + "'");
+			AddError(std::string("(ParseObject) ','が必要です: '") + *data + "'");
 			return Value();
 		}
 		++data; // skip comma.
@@ -347,16 +525,16 @@ Value Parser::ParseObject()
 }
 
 /**
-* JSONz͂.
+* JSON配列を解析する.
 *
-* @return JSONzi[Value^IuWFNg.
+* @return JSON配列を格納したValue型オブジェクト.
 */
 Value Parser::ParseArray()
 {
 	++data; // skip first bracket.
 	SkipSpace();
 	if (data == end) {
-		AddError("(ParseArray) z̏I[']'܂");
+		AddError("(ParseArray) 配列の終端に']'がありません");
 		return Value();
 	} else if (*data == ']') {
 		++data;
@@ -369,13 +547,13 @@ Value Parser::ParseArray()
 		arr.push_back(value);
 		SkipSpace();
 		if (data == end) {
-			AddError("(ParseArray) z̏I[']'܂");
+			AddError("(ParseArray) 配列の終端に']'がありません");
 			return Value();
 		} else if (*data == ']') {
 			++data; // skip last bracket.
 			break;
 		} else if (*data != ',') {
-			AddError(std::string("(ParseArray) ','Kvł: '") + *data + "'");
+			AddError(std::string("(ParseArray) ','が必要です: '") + *data + "'");
 			return Value();
 		}
 		++data; // skip comma.
@@ -385,12 +563,12 @@ Value Parser::ParseArray()
 }
 
 /**
-* JSONf[^͂.
+* JSONデータを解析する.
 *
-* @param data JSONf[^̉͊Jnʒu|C^.
-* @param end  JSONf[^̏I[|C^.
+* @param data JSONデータの解析開始位置を示すポインタ.
+* @param end  JSONデータの終端を示すポインタ.
 *
-* @return Result^̉͌ʃIuWFNg.
+* @return Result型の解析結果オブジェクト.
 */
 Result Parse(const char* data, const char* end)
 {
@@ -398,4 +576,2031 @@ Result Parse(const char* data, const char* end)
 	return parser.Parse(data, end);
 }
 
+namespace /* unnamed */ {
+
+/**
+* 空の値を取得する.
+*
+* @return 空の値.
+*/
+const Node& NullNode()
+{
+	static const Node node;
+	return node;
+}
+
+/**
+* 数値を解析する.
+*
+* @param p     数値の先頭.
+* @param end   JSONデータの終端.
+* @param value 数値を格納する変数.
+*
+* @return 数値の直後の位置. 数値でなければnullptr.
+*
+* 15桁以下の整数はstrtodを使わずに変換する. 15桁以下ならdoubleで正確に表現できる.
+*/
+const char* ParseNumber(const char* p, const char* end, double& value)
+{
+	const char* const begin = p;
+	const bool negative = p != end && *p == '-';
+	if (negative) {
+		++p;
+	}
+	uint64_t n = 0;
+	const char* const digitBegin = p;
+	for (; p != end && *p >= '0' && *p <= '9'; ++p) {
+		n = n * 10 + (*p - '0');
+	}
+	if (p == digitBegin) {
+		return nullptr;
+	}
+	if ((p == end || (*p != '.' && *p != 'e' && *p != 'E')) && p - digitBegin <= 15) {
+		const double d = static_cast<double>(n);
+		value = negative ? -d : d;
+		return p;
+	}
+
+	// 小数と指数はstrtodで変換する. JSONデータは'\0'で終わっているとは限らないので、コピーしてから変換する.
+	for (; p != end; ++p) {
+		const char c = *p;
+		if (!((c >= '0' && c <= '9') || c == '.' || c == 'e' || c == 'E' || c == '+' || c == '-')) {
+			break;
+		}
+	}
+	const std::string tmp(begin, p);
+	char* endPtr;
+	value = strtod(tmp.c_str(), &endPtr);
+	if (endPtr != tmp.c_str() + tmp.size()) {
+		return nullptr;
+	}
+	return p;
+}
+
+/**
+* 16進数4桁を解析する.
+*
+* @param p 16進数の先頭. 4文字以上あること.
+*
+* @return 解析した値. 16進数でなければ-1.
+*/
+int ParseHex4(const char* p)
+{
+	int n = 0;
+	for (int i = 0; i < 4; ++i) {
+		const char c = p[i];
+		n <<= 4;
+		if (c >= '0' && c <= '9') {
+			n |= c - '0';
+		} else if (c >= 'a' && c <= 'f') {
+			n |= c - 'a' + 10;
+		} else if (c >= 'A' && c <= 'F') {
+			n |= c - 'A' + 10;
+		} else {
+			return -1;
+		}
+	}
+	return n;
+}
+
+/**
+* エスケープシーケンスを含む文字列を変換する.
+*
+* @param p   文字列の先頭('"'の次).
+* @param end 文字列の終端('"'の位置).
+* @param out 変換した文字列の格納先. end - pバイト以上あること.
+*
+* @return 変換した文字列の終端. エスケープシーケンスが不正ならnullptr.
+*
+* \uXXXXはUTF-8に変換する. 変換後の文字列が変換前より長くなることはない.
+*/
+char* Unescape(const char* p, const char* end, char* out)
+{
+	while (p != end) {
+		if (*p != '\\') {
+			*out++ = *p++;
+			continue;
+		}
+		if (++p == end) {
+			return nullptr;
+		}
+		const char c = *p++;
+		switch (c) {
+		case '"': *out++ = '"'; break;
+		case '\\': *out++ = '\\'; break;
+		case '/': *out++ = '/'; break;
+		case 'b': *out++ = '\b'; break;
+		case 'f': *out++ = '\f'; break;
+		case 'n': *out++ = '\n'; break;
+		case 'r': *out++ = '\r'; break;
+		case 't': *out++ = '\t'; break;
+		case 'u': {
+			if (end - p < 4) {
+				return nullptr;
+			}
+			int code = ParseHex4(p);
+			if (code < 0) {
+				return nullptr;
+			}
+			p += 4;
+			// サロゲートペアを結合する.
+			if (code >= 0xd800 && code < 0xdc00 && end - p >= 6 && p[0] == '\\' && p[1] == 'u') {
+				const int low = ParseHex4(p + 2);
+				if (low >= 0xdc00 && low < 0xe000) {
+					code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+					p += 6;
+				}
+			}
+			if (code < 0x80) {
+				*out++ = static_cast<char>(code);
+			} else if (code < 0x800) {
+				*out++ = static_cast<char>(0xc0 | (code >> 6));
+				*out++ = static_cast<char>(0x80 | (code & 0x3f));
+			} else if (code < 0x10000) {
+				*out++ = static_cast<char>(0xe0 | (code >> 12));
+				*out++ = static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+				*out++ = static_cast<char>(0x80 | (code & 0x3f));
+			} else {
+				*out++ = static_cast<char>(0xf0 | (code >> 18));
+				*out++ = static_cast<char>(0x80 | ((code >> 12) & 0x3f));
+				*out++ = static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+				*out++ = static_cast<char>(0x80 | (code & 0x3f));
+			}
+			break;
+		}
+		default:
+			return nullptr;
+		}
+	}
+	return out;
+}
+
+} // unnamed namespace
+
+/**
+* 文字列と比較する.
+*
+* @param s 比較する文字列.
+*
+* @retval true  一致する.
+* @retval false 一致しない.
+*/
+bool StringRef::operator==(const char* s) const
+{
+	return strncmp(data, s, size) == 0 && s[size] == '\0';
+}
+
+/**
+* 文字列としてアクセス.
+*
+* @return 文字列データ.
+*/
+StringRef Node::AsString() const
+{
+	if (type == Type::String) {
+		return { string, size };
+	}
+	return { "", 0 };
+}
+
+/**
+* 要素数を取得する.
+*
+* @return 配列の要素数、オブジェクトのメンバ数、または文字列のバイト数. それ以外の型は0.
+*/
+size_t Node::Size() const
+{
+	return type == Type::Array || type == Type::Object || type == Type::String ? size : 0;
+}
+
+/**
+* 配列の要素を取得する.
+*
+* @param i 要素の番号.
+*
+* @return i番目の要素. 配列でないか範囲外の場合は空の値.
+*/
+const Node& Node::operator[](size_t i) const
+{
+	return type == Type::Array && i < size ? elements[i] : NullNode();
+}
+
+/**
+* オブジェクトのメンバを検索する.
+*
+* @param key 検索するキー.
+*
+* @return keyに対応する値へのポインタ. 見つからなければnullptr.
+*
+* メンバは線形に検索する. メンバ数の少ないオブジェクトでは、ハッシュ表より高速.
+*/
+const Node* Node::Find(const char* key) const
+{
+	if (type != Type::Object) {
+		return nullptr;
+	}
+	for (const Member* i = members; i != members + size; ++i) {
+		if (i->key == key) {
+			return &i->value;
+		}
+	}
+	return nullptr;
+}
+
+/**
+* オブジェクトのメンバを取得する.
+*
+* @param key 取得するメンバのキー.
+*
+* @return keyに対応する値. 見つからなければ空の値.
+*/
+const Node& Node::operator[](const char* key) const
+{
+	const Node* p = Find(key);
+	return p ? *p : NullNode();
+}
+
+/**
+* オブジェクトの最初のメンバを取得する.
+*
+* @return 最初のメンバへのポインタ. オブジェクトでなければnullptr.
+*/
+const Member* Node::MemberBegin() const
+{
+	return type == Type::Object ? members : nullptr;
+}
+
+/**
+* オブジェクトの最後のメンバの次を取得する.
+*
+* @return 最後のメンバの次へのポインタ. オブジェクトでなければnullptr.
+*/
+const Member* Node::MemberEnd() const
+{
+	return type == Type::Object ? members + size : nullptr;
+}
+
+/**
+* 配列の最初の要素を取得する.
+*
+* @return 最初の要素へのポインタ. 配列でなければnullptr.
+*/
+const Node* Node::Begin() const
+{
+	return type == Type::Array ? elements : nullptr;
+}
+
+/**
+* 配列の最後の要素の次を取得する.
+*
+* @return 最後の要素の次へのポインタ. 配列でなければnullptr.
+*/
+const Node* Node::End() const
+{
+	return type == Type::Array ? elements + size : nullptr;
+}
+
+/**
+* JSONデータを解析してDocumentのNodeを作成するクラス.
+*/
+class DocumentParser
+{
+public:
+	DocumentParser(Document& d, const char* b, const char* e) : doc(d), begin(b), data(b), end(e) {}
+	~DocumentParser() = default;
+	DocumentParser(const DocumentParser&) = delete;
+	DocumentParser& operator=(const DocumentParser&) = delete;
+
+	bool Parse(Node& node);
+
+private:
+	bool AddError(const std::string& err);
+	void SkipSpace();
+	bool ParseValue(Node& node);
+	bool ParseString(const char*& str, uint32_t& size);
+	bool ParseObject(Node& node);
+	bool ParseArray(Node& node);
+
+	Document& doc; ///< Nodeを割り当てるDocument.
+	const char* begin; ///< JSONデータの先頭.
+	const char* data; ///< 解析中の位置へのポインタ.
+	const char* end; ///< JSONデータの終端を示すポインタ.
+};
+
+/**
+* JSONデータを解析する.
+*
+* @param node ルートの値を格納する変数.
+*
+* @retval true  解析成功.
+* @retval false 解析失敗.
+*/
+bool DocumentParser::Parse(Node& node)
+{
+	if (!ParseValue(node)) {
+		return false;
+	}
+	SkipSpace();
+	if (data != end) {
+		return AddError(std::string("(Parse) 解析不能な文字があります: '") + *data + "'");
+	}
+	return true;
+}
+
+/**
+* エラー情報を追加.
+*
+* @param err エラーの内容を示す文字列.
+*
+* @return 常にfalse.
+*
+* errの先頭に行番号を付与し、エラーバッファに追加する.
+* 行番号はエラーが起きたときにだけ数える.
+*/
+bool DocumentParser::AddError(const std::string& err)
+{
+	const long line = static_cast<long>(std::count(begin, data, '\n'));
+	doc.error += std::to_string(line) + ": " + err + "\n";
+	return false;
+}
+
+/**
+* 空白文字をスキップする.
+*/
+void DocumentParser::SkipSpace()
+{
+	data = SkipWhitespace(data, end);
+}
+
+/**
+* 値を解析する.
+*
+* @param node 値を格納する変数.
+*
+* @retval true  解析成功.
+* @retval false 解析失敗.
+*/
+bool DocumentParser::ParseValue(Node& node)
+{
+	SkipSpace();
+	if (data == end) {
+		return AddError("(ParseValue) 解析中にデータ終端に到達しました");
+	}
+	switch (*data) {
+	case '{':
+		return ParseObject(node);
+	case '[':
+		return ParseArray(node);
+	case '"':
+		node.type = Type::String;
+		return ParseString(node.string, node.size);
+	case 't':
+		if (end - data >= 4 && strncmp(data, "true", 4) == 0) {
+			data += 4;
+			node.type = Type::Boolean;
+			node.boolean = true;
+			return true;
+		}
+		break;
+	case 'f':
+		if (end - data >= 5 && strncmp(data, "false", 5) == 0) {
+			data += 5;
+			node.type = Type::Boolean;
+			node.boolean = false;
+			return true;
+		}
+		break;
+	case 'n':
+		if (end - data >= 4 && strncmp(data, "null", 4) == 0) {
+			data += 4;
+			node.type = Type::Null;
+			return true;
+		}
+		break;
+	default: {
+		const char* p = ParseNumber(data, end, node.number);
+		if (p) {
+			data = p;
+			node.type = Type::Number;
+			return true;
+		}
+		break;
+	}
+	}
+	return AddError(std::string("(ParseValue) 解析不能な文字があります: '") + *data + "'");
+}
+
+/**
+* 文字列を解析する.
+*
+* @param str  文字列の先頭を格納する変数.
+* @param size 文字列のバイト数を格納する変数.
+*
+* @retval true  解析成功.
+* @retval false 解析失敗.
+*
+* エスケープシーケンスを含まない文字列はJSONデータを直接参照する.
+* 含む場合は変換した文字列をアリーナに割り当てる.
+*/
+bool DocumentParser::ParseString(const char*& str, uint32_t& size)
+{
+	const char* const first = data + 1; // skip first double quotation.
+	bool escaped = false;
+	bool hasEscape = false;
+	const char* const last = FindStringEnd(first, end, escaped, hasEscape);
+	if (!last) {
+		data = end;
+		return AddError("(ParseString) 文字列の終端に'\"'がありません");
+	}
+	data = last + 1; // skip last double quotation.
+
+	if (!hasEscape) {
+		str = first;
+		size = static_cast<uint32_t>(last - first);
+		return true;
+	}
+	char* const buffer = static_cast<char*>(doc.Allocate(last - first));
+	char* const bufferEnd = Unescape(first, last, buffer);
+	if (!bufferEnd) {
+		return AddError("(ParseString) 不正なエスケープシーケンスがあります");
+	}
+	str = buffer;
+	size = static_cast<uint32_t>(bufferEnd - buffer);
+	return true;
+}
+
+/**
+* JSONオブジェクトを解析する.
+*
+* @param node オブジェクトを格納する変数.
+*
+* @retval true  解析成功.
+* @retval false 解析失敗.
+*
+* メンバは解析中はDocument::memberStackに積み、終端に達したときにアリーナへまとめて移す.
+*/
+bool DocumentParser::ParseObject(Node& node)
+{
+	++data; // skip first brace.
+	SkipSpace();
+	if (data == end) {
+		return AddError("(ParseObject) オブジェクトの終端に'}'がありません");
+	}
+	node.type = Type::Object;
+	node.size = 0;
+	node.members = nullptr;
+	if (*data == '}') {
+		++data;
+		return true;
+	}
+
+	std::vector<Member>& stack = doc.memberStack;
+	const size_t base = stack.size();
+	for (;;) {
+		if (data == end || *data != '"') {
+			return AddError(std::string("(ParseObject) 文字列でないキーがあります: '") + (data != end ? *data : ' ') + "'");
+		}
+		Member member;
+		uint32_t keySize;
+		if (!ParseString(member.key.data, keySize)) {
+			return false;
+		}
+		member.key.size = keySize;
+
+		SkipSpace();
+		if (data == end) {
+			return AddError("(ParseObject) ':'が必要です");
+		} else if (*data != ':') {
+			return AddError(std::string("(ParseObject) ':'が必要です: '") + *data + "'");
+		}
+		++data; // skip colon.
+
+		if (!ParseValue(member.value)) {
+			return false;
+		}
+		if (stack.size() == stack.capacity()) {
+			++doc.allocationCount;
+		}
+		stack.push_back(member);
+
+		SkipSpace();
+		if (data == end) {
+			return AddError("(ParseObject) オブジェクトの終端に'}'がありません");
+		} else if (*data == '}') {
+			++data; // skip last brace.
+			break;
+		} else if (*data != ',') {
+			return AddError(std::string("(ParseObject) ','が必要です: '") + *data + "'");
+		}
+		++data; // skip comma.
+		SkipSpace();
+	}
+
+	const size_t count = stack.size() - base;
+	Member* const members = static_cast<Member*>(doc.Allocate(sizeof(Member) * count));
+	std::copy(stack.begin() + base, stack.end(), members);
+	stack.resize(base);
+	node.size = static_cast<uint32_t>(count);
+	node.members = members;
+	return true;
+}
+
+/**
+* JSON配列を解析する.
+*
+* @param node 配列を格納する変数.
+*
+* @retval true  解析成功.
+* @retval false 解析失敗.
+*
+* 要素は解析中はDocument::elementStackに積み、終端に達したときにアリーナへまとめて移す.
+*/
+bool DocumentParser::ParseArray(Node& node)
+{
+	++data; // skip first bracket.
+	SkipSpace();
+	if (data == end) {
+		return AddError("(ParseArray) 配列の終端に']'がありません");
+	}
+	node.type = Type::Array;
+	node.size = 0;
+	node.elements = nullptr;
+	if (*data == ']') {
+		++data;
+		return true;
+	}
+
+	std::vector<Node>& stack = doc.elementStack;
+	const size_t base = stack.size();
+	for (;;) {
+		Node value;
+		if (!ParseValue(value)) {
+			return false;
+		}
+		if (stack.size() == stack.capacity()) {
+			++doc.allocationCount;
+		}
+		stack.push_back(value);
+
+		SkipSpace();
+		if (data == end) {
+			return AddError("(ParseArray) 配列の終端に']'がありません");
+		} else if (*data == ']') {
+			++data; // skip last bracket.
+			break;
+		} else if (*data != ',') {
+			return AddError(std::string("(ParseArray) ','が必要です: '") + *data + "'");
+		}
+		++data; // skip comma.
+	}
+
+	const size_t count = stack.size() - base;
+	Node* const elements = static_cast<Node*>(doc.Allocate(sizeof(Node) * count));
+	std::copy(stack.begin() + base, stack.end(), elements);
+	stack.resize(base);
+	node.size = static_cast<uint32_t>(count);
+	node.elements = elements;
+	return true;
+}
+
+/**
+* JSONデータを解析する.
+*
+* @param data JSONデータの解析開始位置を示すポインタ.
+* @param end  JSONデータの終端を示すポインタ.
+*
+* @retval true  解析成功.
+* @retval false 解析失敗. エラー情報はError()で取得できる.
+*
+* 以前に解析したNodeは全て無効になる.
+*/
+bool Document::Parse(const char* data, const char* end)
+{
+	Clear();
+	if (blocks.empty()) {
+		// 最初のブロックはJSONデータと同じ大きさにする. 足りなければ倍の大きさのブロックを追加する.
+		Allocate(std::max<size_t>(end - data, 4096));
+		used = 0;
+	}
+	DocumentParser parser(*this, data, end);
+	if (!parser.Parse(root)) {
+		root = Node();
+		return false;
+	}
+	return true;
+}
+
+/**
+* 解析したNodeを全て破棄する.
+*
+* 確保したメモリブロックは次のParse()で再利用するため解放しない.
+*/
+void Document::Clear()
+{
+	currentBlock = 0;
+	used = 0;
+	elementStack.clear();
+	memberStack.clear();
+	allocationCount = 0;
+	root = Node();
+	error.clear();
+}
+
+/**
+* アリーナのメモリを割り当てる.
+*
+* @param size 割り当てるバイト数.
+*
+* @return 割り当てたメモリの先頭アドレス. 8バイト境界に揃えられている.
+*/
+void* Document::Allocate(size_t size)
+{
+	size = (size + 7) & ~static_cast<size_t>(7);
+	for (; currentBlock < blocks.size(); ++currentBlock, used = 0) {
+		Block& block = blocks[currentBlock];
+		if (block.size - used >= size) {
+			void* p = block.buffer.get() + used;
+			used += size;
+			return p;
+		}
+	}
+	const size_t blockSize = std::max(blocks.empty() ? 0 : blocks.back().size * 2, size);
+	blocks.push_back({ std::unique_ptr<char[]>(new char[blockSize]), blockSize });
+	++allocationCount;
+	currentBlock = blocks.size() - 1;
+	used = size;
+	return blocks.back().buffer.get();
+}
+
+/**
+* アリーナの大きさを取得する.
+*
+* @return 確保したメモリブロックの合計バイト数.
+*/
+size_t Document::ArenaSize() const
+{
+	size_t size = 0;
+	for (const auto& e : blocks) {
+		size += e.size;
+	}
+	return size;
+}
+
+namespace /* unnamed */ {
+
+/**
+* 数値を構成する文字か調べる.
+*/
+bool IsNumberChar(char c);
+
+/**
+* 整数を解析する.
+*
+* @param p     整数の先頭.
+* @param end   データの終端.
+* @param value 整数を格納する変数.
+*
+* @return 整数の直後の位置. 18桁以下の整数でないか、データの終端で区切られている場合はnullptr.
+*/
+const char* ParseInteger(const char* p, const char* end, int64_t& value)
+{
+	const bool negative = *p == '-';
+	const char* const digitBegin = negative ? p + 1 : p;
+	const char* q = digitBegin;
+	int64_t n = 0;
+	for (; q != end && *q >= '0' && *q <= '9' && q - digitBegin < 18; ++q) {
+		n = n * 10 + (*q - '0');
+	}
+	if (q == digitBegin || q == end || IsNumberChar(*q)) {
+		return nullptr;
+	}
+	value = negative ? -n : n;
+	return q;
+}
+
+/**
+* 数値を構成する文字か調べる.
+*/
+bool IsNumberChar(char c)
+{
+	return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+}
+
+/**
+* true, false, nullを構成する文字か調べる.
+*/
+bool IsLiteralChar(char c)
+{
+	return c >= 'a' && c <= 'z';
+}
+
+} // unnamed namespace
+
+/**
+* JSONデータの一部を解析する.
+*
+* @param data JSONデータの一部. 前回のFeed()に渡したデータの続き.
+* @param size dataのバイト数.
+*
+* @retval true  解析成功. 続きのデータがあれば再びFeed()に渡し、なければFinish()を呼ぶこと.
+* @retval false 解析失敗. エラー情報はError()で取得できる.
+*
+* dataはFeed()から戻った後に破棄してよい.
+*/
+bool Reader::Feed(const char* data, size_t size)
+{
+	if (!error.empty()) {
+		return false;
+	}
+	chunk = data;
+	const char* p = data;
+	const char* const end = data + size;
+	if (partial != Partial_None) {
+		p = ContinueToken(p, end);
+		if (!p) {
+			return false;
+		}
+	}
+	while (p != end) {
+		const char c = *p;
+		if (IsSpace(c)) {
+			p = SkipSpace(p, end);
+			continue;
+		}
+		tokenBegin = Offset(p);
+		tokenEnd = tokenBegin + 1;
+		switch (state) {
+		case State_ValueOrEnd:
+			if (c == ']') {
+				stack.pop_back();
+				if (!handler.OnEndArray()) {
+					return AddError("(Reader) 解析が中断されました");
+				}
+				EndValue();
+				++p;
+				break;
+			}
+			// FALLTHROUGH
+		case State_Value:
+			if (c == '{') {
+				stack.push_back('{');
+				state = State_KeyOrEnd;
+				if (!handler.OnStartObject()) {
+					return AddError("(Reader) 解析が中断されました");
+				}
+				++p;
+			} else if (c == '[') {
+				stack.push_back('[');
+				state = State_ValueOrEnd;
+				if (!handler.OnStartArray()) {
+					return AddError("(Reader) 解析が中断されました");
+				}
+				++p;
+			} else {
+				p = ReadToken(p, end);
+				if (!p) {
+					return false;
+				}
+			}
+			break;
+		case State_KeyOrEnd:
+			if (c == '}') {
+				stack.pop_back();
+				if (!handler.OnEndObject()) {
+					return AddError("(Reader) 解析が中断されました");
+				}
+				EndValue();
+				++p;
+				break;
+			}
+			// FALLTHROUGH
+		case State_Key:
+			if (c != '"') {
+				return AddError(std::string("(Reader) 文字列でないキーがあります: '") + c + "'");
+			}
+			p = ReadToken(p, end);
+			if (!p) {
+				return false;
+			}
+			break;
+		case State_Colon:
+			if (c != ':') {
+				return AddError(std::string("(Reader) ':'が必要です: '") + c + "'");
+			}
+			state = State_Value;
+			++p;
+			break;
+		case State_CommaOrEnd:
+			if (c == ',') {
+				state = stack.back() == '{' ? State_Key : State_Value;
+			} else if (c == '}' && stack.back() == '{') {
+				stack.pop_back();
+				if (!handler.OnEndObject()) {
+					return AddError("(Reader) 解析が中断されました");
+				}
+				EndValue();
+			} else if (c == ']' && stack.back() == '[') {
+				stack.pop_back();
+				if (!handler.OnEndArray()) {
+					return AddError("(Reader) 解析が中断されました");
+				}
+				EndValue();
+			} else {
+				return AddError(std::string("(Reader) ','が必要です: '") + c + "'");
+			}
+			++p;
+			break;
+		case State_Done:
+			return AddError(std::string("(Reader) 解析不能な文字があります: '") + c + "'");
+		}
+	}
+	offset += size;
+	return true;
+}
+
+/**
+* JSONデータの解析を完了する.
+*
+* @retval true  解析成功.
+* @retval false 解析失敗. エラー情報はError()で取得できる.
+*
+* データの終端で区切られていた数値などは、ここで通知される.
+*/
+bool Reader::Finish()
+{
+	if (!error.empty()) {
+		return false;
+	}
+	chunk = nullptr;
+	tokenEnd = offset;
+	switch (partial) {
+	case Partial_String:
+		return AddError("(Reader) 文字列の終端に'\"'がありません");
+	case Partial_Number:
+		partial = Partial_None;
+		if (!EmitNumber(pending.data(), pending.data() + pending.size())) {
+			return false;
+		}
+		break;
+	case Partial_Literal:
+		partial = Partial_None;
+		if (!EmitLiteral(pending.data(), pending.data() + pending.size())) {
+			return false;
+		}
+		break;
+	case Partial_None:
+		break;
+	}
+	if (state != State_Done) {
+		return AddError("(Reader) 解析中にデータ終端に到達しました");
+	}
+	return true;
+}
+
+/**
+* 解析状態を初期化する.
+*
+* 新しいJSONデータを解析する前に呼び出す.
+*/
+void Reader::Reset()
+{
+	state = State_Value;
+	stack.clear();
+	partial = Partial_None;
+	escaped = false;
+	hasEscape = false;
+	pending.clear();
+	chunk = nullptr;
+	offset = 0;
+	tokenBegin = 0;
+	tokenEnd = 0;
+	line = 0;
+	error.clear();
+}
+
+/**
+* エラー情報を追加.
+*
+* @param err エラーの内容を示す文字列.
+*
+* @return 常にfalse.
+*/
+bool Reader::AddError(const std::string& err)
+{
+	error += std::to_string(line) + ": " + err + "\n";
+	return false;
+}
+
+/**
+* 文字列、数値、true, false, nullを解析する.
+*
+* @param p   要素の先頭.
+* @param end データの終端.
+*
+* @return 要素の直後の位置. 要素がデータの終端で区切られている場合はend.
+*         解析に失敗した場合はnullptr.
+*/
+const char* Reader::ReadToken(const char* p, const char* end)
+{
+	const char c = *p;
+	if (c == '"') {
+		escaped = false;
+		hasEscape = false;
+		const char* const first = p + 1;
+		const char* const last = FindStringEnd(first, end, escaped, hasEscape);
+		if (!last) {
+			partial = Partial_String;
+			pending.assign(first, end);
+			return end;
+		}
+		tokenEnd = Offset(last + 1);
+		return EmitString(first, last, hasEscape) ? last + 1 : nullptr;
+	}
+	if ((c >= '0' && c <= '9') || c == '-') {
+		int64_t n;
+		const char* const q = ParseInteger(p, end, n);
+		if (q) {
+			return ReadIntegers(q, end, n);
+		}
+	}
+	if (IsNumberChar(c) || IsLiteralChar(c)) {
+		const Partial type = IsLiteralChar(c) ? Partial_Literal : Partial_Number;
+		const char* q = p + 1;
+		if (type == Partial_Number) {
+			while (q != end && IsNumberChar(*q)) {
+				++q;
+			}
+		} else {
+			while (q != end && IsLiteralChar(*q)) {
+				++q;
+			}
+		}
+		if (q == end) {
+			partial = type;
+			pending.assign(p, end);
+			return end;
+		}
+		tokenEnd = Offset(q);
+		const bool result = type == Partial_Number ? EmitNumber(p, q) : EmitLiteral(p, q);
+		return result ? q : nullptr;
+	}
+	AddError(std::string("(Reader) 解析不能な文字があります: '") + c + "'");
+	return nullptr;
+}
+
+/**
+* 整数を通知し、同じ配列に続く整数もまとめて通知する.
+*
+* @param p   整数の直後の位置.
+* @param end データの終端.
+* @param n   通知する整数.
+*
+* @return 最後に通知した整数の後の位置. 解析に失敗した場合はnullptr.
+*
+* マップデータのような整数の配列を、Feed()の状態遷移を通らずに処理する.
+*/
+const char* Reader::ReadIntegers(const char* p, const char* end, int64_t n)
+{
+	for (;;) {
+		tokenEnd = Offset(p);
+		if (!handler.OnInteger(n)) {
+			AddError("(Reader) 解析が中断されました");
+			return nullptr;
+		}
+		EndValue();
+		if (stack.empty() || stack.back() != '[') {
+			return p;
+		}
+		const char* q = SkipSpace(p, end);
+		if (q == end || *q != ',') {
+			return q;
+		}
+		state = State_Value;
+		q = SkipSpace(q + 1, end);
+		if (q == end) {
+			return q;
+		}
+		p = ParseInteger(q, end, n);
+		if (!p) {
+			return q;
+		}
+		tokenBegin = Offset(q);
+	}
+}
+
+/**
+* 空白を読み飛ばす.
+*
+* @param p   読み込み位置.
+* @param end データの終端.
+*
+* @return 空白でない最初の文字の位置.
+*
+* Feed()から戻るとデータは破棄され、後から行番号を数えることができないので、読み飛ばした改行をその場で数える.
+*/
+const char* Reader::SkipSpace(const char* p, const char* end)
+{
+	const char* const q = SkipWhitespace(p, end);
+	line += std::count(p, q, '\n');
+	return q;
+}
+
+/**
+* 前回のFeed()で区切られた要素の続きを解析する.
+*
+* @param p   データの先頭.
+* @param end データの終端.
+*
+* @return 要素の直後の位置. 要素がまだ続いている場合はend.
+*         解析に失敗した場合はnullptr.
+*/
+const char* Reader::ContinueToken(const char* p, const char* end)
+{
+	const char* q;
+	if (partial == Partial_String) {
+		q = FindStringEnd(p, end, escaped, hasEscape);
+		if (!q) {
+			pending.append(p, end);
+			return end;
+		}
+		pending.append(p, q);
+		tokenEnd = Offset(q + 1);
+		partial = Partial_None;
+		return EmitString(pending.data(), pending.data() + pending.size(), hasEscape) ? q + 1 : nullptr;
+	}
+	const bool isNumber = partial == Partial_Number;
+	for (q = p; q != end && (isNumber ? IsNumberChar(*q) : IsLiteralChar(*q)); ++q) {
+	}
+	pending.append(p, q);
+	if (q == end) {
+		return end;
+	}
+	tokenEnd = Offset(q);
+	partial = Partial_None;
+	const char* const first = pending.data();
+	const char* const last = first + pending.size();
+	const bool result = isNumber ? EmitNumber(first, last) : EmitLiteral(first, last);
+	return result ? q : nullptr;
+}
+
+/**
+* 文字列またはキーを通知する.
+*
+* @param p         文字列の先頭('"'の次).
+* @param end       文字列の終端('"'の位置).
+* @param hasEscape 文字列がエスケープシーケンスを含むならtrue.
+*
+* @retval true  通知成功.
+* @retval false 解析失敗.
+*/
+bool Reader::EmitString(const char* p, const char* end, bool hasEscape)
+{
+	StringRef str = { p, static_cast<size_t>(end - p) };
+	if (hasEscape) {
+		unescaped.resize(end - p);
+		char* const buffer = &unescaped[0];
+		char* const bufferEnd = Unescape(p, end, buffer);
+		if (!bufferEnd) {
+			return AddError("(Reader) 不正なエスケープシーケンスがあります");
+		}
+		str = { buffer, static_cast<size_t>(bufferEnd - buffer) };
+	}
+	if (state == State_KeyOrEnd || state == State_Key) {
+		state = State_Colon;
+		if (!handler.OnKey(str)) {
+			return AddError("(Reader) 解析が中断されました");
+		}
+		return true;
+	}
+	if (!handler.OnString(str)) {
+		return AddError("(Reader) 解析が中断されました");
+	}
+	EndValue();
+	return true;
+}
+
+/**
+* 数値を通知する.
+*
+* @param p   数値の先頭.
+* @param end 数値の終端.
+*
+* @retval true  通知成功.
+* @retval false 解析失敗.
+*
+* 18桁以下の整数はOnInteger()で通知する. 18桁以下ならint64_tで桁あふれしない.
+*/
+bool Reader::EmitNumber(const char* p, const char* end)
+{
+	const bool negative = *p == '-';
+	const char* q = negative ? p + 1 : p;
+	if (end - q > 0 && end - q <= 18) {
+		int64_t n = 0;
+		for (; q != end && *q >= '0' && *q <= '9'; ++q) {
+			n = n * 10 + (*q - '0');
+		}
+		if (q == end) {
+			if (!handler.OnInteger(negative ? -n : n)) {
+				return AddError("(Reader) 解析が中断されました");
+			}
+			EndValue();
+			return true;
+		}
+	}
+	double value;
+	if (ParseNumber(p, end, value) != end) {
+		return AddError("(Reader) 数値として解析できません: '" + std::string(p, end) + "'");
+	}
+	if (!handler.OnNumber(value)) {
+		return AddError("(Reader) 解析が中断されました");
+	}
+	EndValue();
+	return true;
+}
+
+/**
+* true, false, nullを通知する.
+*
+* @param p   要素の先頭.
+* @param end 要素の終端.
+*
+* @retval true  通知成功.
+* @retval false 解析失敗.
+*/
+bool Reader::EmitLiteral(const char* p, const char* end)
+{
+	const std::string::size_type size = end - p;
+	bool result;
+	if (size == 4 && strncmp(p, "true", 4) == 0) {
+		result = handler.OnBoolean(true);
+	} else if (size == 5 && strncmp(p, "false", 5) == 0) {
+		result = handler.OnBoolean(false);
+	} else if (size == 4 && strncmp(p, "null", 4) == 0) {
+		result = handler.OnNull();
+	} else {
+		return AddError("(Reader) 解析不能な値があります: '" + std::string(p, end) + "'");
+	}
+	if (!result) {
+		return AddError("(Reader) 解析が中断されました");
+	}
+	EndValue();
+	return true;
+}
+
+/**
+* 値の解析を終え、次に読み込む要素を決める.
+*/
+void Reader::EndValue()
+{
+	state = stack.empty() ? State_Done : State_CommaOrEnd;
+}
+
+
+namespace /* unnamed */ {
+
+/// 00から99までの2桁の数字.
+const char digitPairs[] =
+	"00010203040506070809" "10111213141516171819" "20212223242526272829" "30313233343536373839" "40414243444546474849"
+	"50515253545556575859" "60616263646566676869" "70717273747576777879" "80818283848586878889" "90919293949596979899";
+
+/// 10の0乗から19乗.
+const uint64_t pow10Table[] = {
+	1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL,
+	10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL, 100000000000000ULL,
+	1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL, 1000000000000000000ULL,
+	10000000000000000000ULL,
+};
+
+/**
+* 符号なし整数を10進数の文字列に変換する.
+*
+* @param p 書き込み先. 20バイト以上の空きがあること.
+* @param n 変換する整数.
+*
+* @return 書き込んだ文字列の終端.
+*
+* 2桁ずつ表を引いて変換する. 64ビットの除算は32ビットに収まらない上位の桁だけに使う.
+*/
+char* WriteUnsigned(char* p, uint64_t n)
+{
+	char tmp[20];
+	char* q = tmp + sizeof(tmp);
+	while (n > 0xffffffffULL) {
+		uint32_t low = static_cast<uint32_t>(n % 100000000);
+		n /= 100000000;
+		for (int i = 0; i < 4; ++i) {
+			q -= 2;
+			memcpy(q, digitPairs + (low % 100) * 2, 2);
+			low /= 100;
+		}
+	}
+	uint32_t m = static_cast<uint32_t>(n);
+	while (m >= 100) {
+		q -= 2;
+		memcpy(q, digitPairs + (m % 100) * 2, 2);
+		m /= 100;
+	}
+	if (m >= 10) {
+		q -= 2;
+		memcpy(q, digitPairs + m * 2, 2);
+	} else {
+		*--q = static_cast<char>('0' + m);
+	}
+	const size_t size = tmp + sizeof(tmp) - q;
+	memcpy(p, q, size);
+	return p + size;
+}
+
+/**
+* 最上位の1のビットより上にある0のビットの数を取得する.
+*
+* @param n 0以外の値.
+*
+* @return 0のビットの数.
+*/
+inline int CountLeadingZeros64(uint64_t n)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+	unsigned long i;
+	_BitScanReverse64(&i, n);
+	return 63 - static_cast<int>(i);
+#elif defined(_MSC_VER)
+	unsigned long i;
+	if (n >> 32) {
+		_BitScanReverse(&i, static_cast<unsigned long>(n >> 32));
+		return 31 - static_cast<int>(i);
+	}
+	_BitScanReverse(&i, static_cast<unsigned long>(n));
+	return 63 - static_cast<int>(i);
+#else
+	return __builtin_clzll(n);
+#endif
+}
+
+/**
+* 64ビットの仮数と2進の指数で表した浮動小数点数(Grisu3で使う).
+*/
+struct DiyFp
+{
+	DiyFp(uint64_t fp, int exp) : f(fp), e(exp) {}
+
+	/// 最上位ビットが1になるように仮数をシフトする.
+	DiyFp Normalize() const {
+		const int shift = CountLeadingZeros64(f);
+		return DiyFp(f << shift, e - shift);
+	}
+
+	uint64_t f; ///< 仮数.
+	int e; ///< 2進の指数.
+};
+
+/**
+* 2つのDiyFpの積を求める.
+*
+* @return 128ビットの積の上位64ビットを丸めた値.
+*/
+DiyFp Multiply(const DiyFp& a, const DiyFp& b)
+{
+	const uint64_t mask = 0xffffffffULL;
+	const uint64_t a1 = a.f >> 32;
+	const uint64_t a0 = a.f & mask;
+	const uint64_t b1 = b.f >> 32;
+	const uint64_t b0 = b.f & mask;
+	const uint64_t p11 = a1 * b1;
+	const uint64_t p10 = a1 * b0;
+	const uint64_t p01 = a0 * b1;
+	const uint64_t p00 = a0 * b0;
+	const uint64_t mid = (p00 >> 32) + (p10 & mask) + (p01 & mask) + (1ULL << 31);
+	return DiyFp(p11 + (p10 >> 32) + (p01 >> 32) + (mid >> 32), a.e + b.e + 64);
+}
+
+/**
+* Grisu3で使う、10のべき乗の近似値を取得する.
+*
+* @param e 掛けられる数の2進の指数.
+* @param k 10のべき乗の指数の符号を反転した値を格納する変数.
+*
+* @return 積の2進の指数が-60～-32になるような10のべき乗.
+*
+* 表は10^-348から10^340までの8乗ごとの値を、64ビットの仮数に丸めたもの.
+*/
+DiyFp GetCachedPower(int e, int& k)
+{
+	static const uint64_t significands[] = {
+		0xfa8fd5a0081c0288ULL, 0xbaaee17fa23ebf76ULL, 0x8b16fb203055ac76ULL, 0xcf42894a5dce35eaULL,
+		0x9a6bb0aa55653b2dULL, 0xe61acf033d1a45dfULL, 0xab70fe17c79ac6caULL, 0xff77b1fcbebcdc4fULL,
+		0xbe5691ef416bd60cULL, 0x8dd01fad907ffc3cULL, 0xd3515c2831559a83ULL, 0x9d71ac8fada6c9b5ULL,
+		0xea9c227723ee8bcbULL, 0xaecc49914078536dULL, 0x823c12795db6ce57ULL, 0xc21094364dfb5637ULL,
+		0x9096ea6f3848984fULL, 0xd77485cb25823ac7ULL, 0xa086cfcd97bf97f4ULL, 0xef340a98172aace5ULL,
+		0xb23867fb2a35b28eULL, 0x84c8d4dfd2c63f3bULL, 0xc5dd44271ad3cdbaULL, 0x936b9fcebb25c996ULL,
+		0xdbac6c247d62a584ULL, 0xa3ab66580d5fdaf6ULL, 0xf3e2f893dec3f126ULL, 0xb5b5ada8aaff80b8ULL,
+		0x87625f056c7c4a8bULL, 0xc9bcff6034c13053ULL, 0x964e858c91ba2655ULL, 0xdff9772470297ebdULL,
+		0xa6dfbd9fb8e5b88fULL, 0xf8a95fcf88747d94ULL, 0xb94470938fa89bcfULL, 0x8a08f0f8bf0f156bULL,
+		0xcdb02555653131b6ULL, 0x993fe2c6d07b7facULL, 0xe45c10c42a2b3b06ULL, 0xaa242499697392d3ULL,
+		0xfd87b5f28300ca0eULL, 0xbce5086492111aebULL, 0x8cbccc096f5088ccULL, 0xd1b71758e219652cULL,
+		0x9c40000000000000ULL, 0xe8d4a51000000000ULL, 0xad78ebc5ac620000ULL, 0x813f3978f8940984ULL,
+		0xc097ce7bc90715b3ULL, 0x8f7e32ce7bea5c70ULL, 0xd5d238a4abe98068ULL, 0x9f4f2726179a2245ULL,
+		0xed63a231d4c4fb27ULL, 0xb0de65388cc8ada8ULL, 0x83c7088e1aab65dbULL, 0xc45d1df942711d9aULL,
+		0x924d692ca61be758ULL, 0xda01ee641a708deaULL, 0xa26da3999aef774aULL, 0xf209787bb47d6b85ULL,
+		0xb454e4a179dd1877ULL, 0x865b86925b9bc5c2ULL, 0xc83553c5c8965d3dULL, 0x952ab45cfa97a0b3ULL,
+		0xde469fbd99a05fe3ULL, 0xa59bc234db398c25ULL, 0xf6c69a72a3989f5cULL, 0xb7dcbf5354e9beceULL,
+		0x88fcf317f22241e2ULL, 0xcc20ce9bd35c78a5ULL, 0x98165af37b2153dfULL, 0xe2a0b5dc971f303aULL,
+		0xa8d9d1535ce3b396ULL, 0xfb9b7cd9a4a7443cULL, 0xbb764c4ca7a44410ULL, 0x8bab8eefb6409c1aULL,
+		0xd01fef10a657842cULL, 0x9b10a4e5e9913129ULL, 0xe7109bfba19c0c9dULL, 0xac2820d9623bf429ULL,
+		0x80444b5e7aa7cf85ULL, 0xbf21e44003acdd2dULL, 0x8e679c2f5e44ff8fULL, 0xd433179d9c8cb841ULL,
+		0x9e19db92b4e31ba9ULL, 0xeb96bf6ebadf77d9ULL, 0xaf87023b9bf0ee6bULL,
+	};
+	static const int16_t exponents[] = {
+		-1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980, -954, -927,
+		-901, -874, -847, -821, -794, -768, -741, -715, -688, -661, -635, -608,
+		-582, -555, -529, -502, -475, -449, -422, -396, -369, -343, -316, -289,
+		-263, -236, -210, -183, -157, -130, -103, -77, -50, -24, 3, 30,
+		56, 83, 109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+		375, 402, 428, 455, 481, 508, 534, 561, 588, 614, 641, 667,
+		694, 720, 747, 774, 800, 827, 853, 880, 907, 933, 960, 986,
+		1013, 1039, 1066,
+	};
+	const double dk = (-61 - e) * 0.30102999566398114 + 347;
+	int ik = static_cast<int>(dk);
+	if (dk - ik > 0.0) {
+		++ik;
+	}
+	const int index = (ik >> 3) + 1;
+	k = -(-348 + index * 8);
+	return DiyFp(significands[index], exponents[index]);
+}
+
+/**
+* 生成した最後の桁を、元の値に近づくように調整する.
+*
+* @param buffer   生成した桁.
+* @param length   生成した桁数.
+* @param distance 上限から元の値までの距離.
+* @param unsafe   元の値に戻せる範囲の幅(誤差を含む).
+* @param rest     上限から生成した値までの距離.
+* @param tenKappa 最後の桁の1に相当する値.
+* @param unit     誤差の大きさ.
+*
+* @retval true  最短で最も近い桁であることが保証できた.
+* @retval false 誤差のため保証できない.
+*/
+bool RoundWeed(char* buffer, int length, uint64_t distance, uint64_t unsafe, uint64_t rest, uint64_t tenKappa, uint64_t unit)
+{
+	const uint64_t smallDistance = distance - unit;
+	const uint64_t bigDistance = distance + unit;
+	while (rest < smallDistance && unsafe - rest >= tenKappa &&
+		(rest + tenKappa < smallDistance || smallDistance - rest >= rest + tenKappa - smallDistance)) {
+		--buffer[length - 1];
+		rest += tenKappa;
+	}
+	if (rest < bigDistance && unsafe - rest >= tenKappa &&
+		(rest + tenKappa < bigDistance || bigDistance - rest > rest + tenKappa - bigDistance)) {
+		return false;
+	}
+	return 2 * unit <= rest && rest <= unsafe - 4 * unit;
+}
+
+/**
+* 元の値に戻せる範囲で、最も短い10進数の桁を生成する.
+*
+* @param low    元の値に戻せる範囲の下限.
+* @param w      元の値.
+* @param high   元の値に戻せる範囲の上限.
+* @param buffer 桁の書き込み先.
+* @param length 生成した桁数を格納する変数.
+* @param kappa  生成した桁の最後の桁の位置を格納する変数.
+*
+* @retval true  生成成功.
+* @retval false 誤差のため最短の桁を決められない.
+*/
+bool DigitGen(const DiyFp& low, const DiyFp& w, const DiyFp& high, char* buffer, int& length, int& kappa)
+{
+	uint64_t unit = 1;
+	const DiyFp tooLow(low.f - unit, low.e);
+	const DiyFp tooHigh(high.f + unit, high.e);
+	uint64_t unsafe = tooHigh.f - tooLow.f;
+	const DiyFp one(1ULL << -w.e, w.e);
+	uint32_t integrals = static_cast<uint32_t>(tooHigh.f >> -one.e);
+	uint64_t fractionals = tooHigh.f & (one.f - 1);
+	kappa = 0;
+	while (kappa < 10 && integrals >= pow10Table[kappa]) {
+		++kappa;
+	}
+	length = 0;
+	while (kappa > 0) {
+		const uint32_t divisor = static_cast<uint32_t>(pow10Table[kappa - 1]);
+		buffer[length++] = static_cast<char>('0' + integrals / divisor);
+		integrals %= divisor;
+		--kappa;
+		const uint64_t rest = (static_cast<uint64_t>(integrals) << -one.e) + fractionals;
+		if (rest < unsafe) {
+			return RoundWeed(buffer, length, tooHigh.f - w.f, unsafe, rest, static_cast<uint64_t>(divisor) << -one.e, unit);
+		}
+	}
+	for (;;) {
+		fractionals *= 10;
+		unit *= 10;
+		unsafe *= 10;
+		buffer[length++] = static_cast<char>('0' + (fractionals >> -one.e));
+		fractionals &= one.f - 1;
+		--kappa;
+		if (fractionals < unsafe) {
+			return RoundWeed(buffer, length, (tooHigh.f - w.f) * unit, unsafe, fractionals, one.f, unit);
+		}
+	}
+}
+
+/**
+* 正の有限な浮動小数点数を、Grisu3で最短の10進数の桁と指数に変換する.
+*
+* @param value  変換する値.
+* @param buffer 桁の書き込み先. 18バイト以上の空きがあること.
+* @param length 書き込んだ桁数を格納する変数.
+* @param k      10進の指数を格納する変数. 値は buffer × 10^k になる.
+*
+* @retval true  変換成功. 結果は元の値に戻せる最短の桁で、その中で最も元の値に近い.
+* @retval false 64ビットの精度では最短の桁を決められない(約0.5%の値).
+*/
+bool Grisu3(double value, char* buffer, int& length, int& k)
+{
+	uint64_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	const uint64_t hiddenBit = 0x0010000000000000ULL;
+	const int biasedExponent = static_cast<int>((bits >> 52) & 0x7ff);
+	const uint64_t significand = bits & (hiddenBit - 1);
+	const DiyFp v = biasedExponent ? DiyFp(significand | hiddenBit, biasedExponent - 1075) : DiyFp(significand, -1074);
+
+	// 隣の値との中間を境界とする. 2のべき乗の場合、下の値との間隔は半分になる.
+	const DiyFp plus = DiyFp((v.f << 1) + 1, v.e - 1).Normalize();
+	DiyFp minus = (v.f == hiddenBit && biasedExponent > 1) ? DiyFp((v.f << 2) - 1, v.e - 2) : DiyFp((v.f << 1) - 1, v.e - 1);
+	minus.f <<= minus.e - plus.e;
+	minus.e = plus.e;
+
+	int cachedK;
+	const DiyFp cachedPower = GetCachedPower(plus.e, cachedK);
+	int kappa;
+	if (!DigitGen(Multiply(minus, cachedPower), Multiply(v.Normalize(), cachedPower), Multiply(plus, cachedPower),
+		buffer, length, kappa)) {
+		return false;
+	}
+	k = cachedK + kappa;
+	return true;
+}
+
+/**
+* snprintfとstrtodを使って、最短の10進数の桁と指数を求める.
+*
+* @param value  変換する値.
+* @param buffer 桁の書き込み先. 18バイト以上の空きがあること.
+* @param k      10進の指数を格納する変数. 値は buffer × 10^k になる.
+*
+* @return 書き込んだ桁数.
+*
+* Grisu3で変換できない値のために使う. 遅いが常に最短の桁を求められる.
+*/
+int ShortestDigitsSlow(double value, char* buffer, int& k)
+{
+	char tmp[32];
+	for (int precision = 1;; ++precision) {
+		snprintf(tmp, sizeof(tmp), "%.*e", precision - 1, value);
+		if (strtod(tmp, nullptr) == value || precision >= 17) {
+			break;
+		}
+	}
+	int length = 0;
+	const char* p = tmp;
+	for (; *p != 'e'; ++p) {
+		if (*p >= '0' && *p <= '9') {
+			buffer[length++] = *p;
+		}
+	}
+	while (length > 1 && buffer[length - 1] == '0') {
+		--length;
+	}
+	k = atoi(p + 1) - (length - 1);
+	return length;
+}
+
+/**
+* 10進の指数を書き込む.
+*
+* @param p 書き込み先.
+* @param k 指数.
+*
+* @return 書き込んだ文字列の終端.
+*/
+char* WriteExponent(char* p, int k)
+{
+	if (k < 0) {
+		*p++ = '-';
+		k = -k;
+	}
+	if (k >= 100) {
+		*p++ = static_cast<char>('0' + k / 100);
+		k %= 100;
+		memcpy(p, digitPairs + k * 2, 2);
+		return p + 2;
+	} else if (k >= 10) {
+		memcpy(p, digitPairs + k * 2, 2);
+		return p + 2;
+	}
+	*p++ = static_cast<char>('0' + k);
+	return p;
+}
+
+/**
+* 10進数の桁と指数を、JSONの数値の形式に整える.
+*
+* @param buffer 桁の先頭. 桁を含めて26バイト以上の領域があること.
+* @param length 桁数.
+* @param k      10進の指数.
+*
+* @return 書き込んだ文字列の終端.
+*
+* 整数部が21桁以下なら指数を使わず、小数の場合は'.'を入れる.
+* 整数の値には".0"を付けて、整数型の値と区別できるようにする.
+*/
+char* Prettify(char* buffer, int length, int k)
+{
+	const int kk = length + k; // 10^(kk - 1) <= 値 < 10^kk.
+	if (k >= 0 && kk <= 21) {
+		// 1234e7 -> 12340000000.0
+		memset(buffer + length, '0', k);
+		buffer[kk] = '.';
+		buffer[kk + 1] = '0';
+		return buffer + kk + 2;
+	} else if (kk > 0 && kk <= 21) {
+		// 1234e-2 -> 12.34
+		memmove(buffer + kk + 1, buffer + kk, length - kk);
+		buffer[kk] = '.';
+		return buffer + length + 1;
+	} else if (kk > -6 && kk <= 0) {
+		// 1234e-6 -> 0.001234
+		const int offset = 2 - kk;
+		memmove(buffer + offset, buffer, length);
+		buffer[0] = '0';
+		buffer[1] = '.';
+		memset(buffer + 2, '0', -kk);
+		return buffer + length + offset;
+	} else if (length == 1) {
+		// 1e30
+		buffer[1] = 'e';
+		return WriteExponent(buffer + 2, kk - 1);
+	}
+	// 1234e30 -> 1.234e33
+	memmove(buffer + 2, buffer + 1, length - 1);
+	buffer[1] = '.';
+	buffer[length + 1] = 'e';
+	return WriteExponent(buffer + length + 2, kk - 1);
+}
+
+/**
+* 有限な浮動小数点数を、元の値に戻せる最短の10進数の文字列に変換する.
+*
+* @param p 書き込み先. 32バイト以上の空きがあること.
+* @param n 変換する値.
+*
+* @return 書き込んだ文字列の終端.
+*/
+char* WriteDouble(char* p, double n)
+{
+	if (n == 0) {
+		if (std::signbit(n)) {
+			*p++ = '-';
+		}
+		memcpy(p, "0.0", 3);
+		return p + 3;
+	}
+	if (n < 0) {
+		*p++ = '-';
+		n = -n;
+	}
+	// 2^53未満の整数値は、整数の変換を使う.
+	if (n < 9007199254740992.0 && n == static_cast<double>(static_cast<int64_t>(n))) {
+		p = WriteUnsigned(p, static_cast<uint64_t>(n));
+		memcpy(p, ".0", 2);
+		return p + 2;
+	}
+	int length;
+	int k;
+	if (!Grisu3(n, p, length, k)) {
+		length = ShortestDigitsSlow(n, p, k);
+	}
+	return Prettify(p, length, k);
+}
+
+} // unnamed namespace
+
+/**
+* 配列に書き込むWriterを作成する.
+*
+* @param out 出力先の配列. データは末尾に追加される.
+* @param n   字下げの空白数. 0なら改行と字下げをせずに書き込む.
+*/
+Writer::Writer(std::vector<char>& out, int n) : output(&out), indent(n)
+{
+}
+
+/**
+* ファイルに書き込むWriterを作成する.
+*
+* @param f 出力先のファイル. Writerより後に閉じること.
+* @param n 字下げの空白数. 0なら改行と字下げをせずに書き込む.
+*/
+Writer::Writer(FILE* f, int n) : fp(f), indent(n)
+{
+}
+
+/**
+* デストラクタ.
+*
+* 出力先に書き込んでいないデータがあれば書き込む.
+*/
+Writer::~Writer()
+{
+	Drain();
+}
+
+/**
+* オブジェクトの書き込みを開始する.
+*
+* @retval true  書き込み成功.
+* @retval false 値を書き込めない位置で呼び出された.
+*/
+bool Writer::StartObject()
+{
+	return StartContainer(true);
+}
+
+/**
+* オブジェクトの書き込みを終了する.
+*
+* @retval true  書き込み成功.
+* @retval false オブジェクトを書き込んでいないか、キーに対応する値がない.
+*/
+bool Writer::EndObject()
+{
+	return EndContainer(true);
+}
+
+/**
+* 配列の書き込みを開始する.
+*
+* @retval true  書き込み成功.
+* @retval false 値を書き込めない位置で呼び出された.
+*/
+bool Writer::StartArray()
+{
+	return StartContainer(false);
+}
+
+/**
+* 配列の書き込みを終了する.
+*
+* @retval true  書き込み成功.
+* @retval false 配列を書き込んでいない.
+*/
+bool Writer::EndArray()
+{
+	return EndContainer(false);
+}
+
+/**
+* オブジェクトのキーを書き込む.
+*
+* @param s    キーの文字列. UTF-8であること.
+* @param size sのバイト数.
+*
+* @retval true  書き込み成功.
+* @retval false オブジェクトの外か、前のキーに対応する値がない.
+*/
+bool Writer::Key(const char* s, size_t size)
+{
+	if (stack.empty() || !stack.back().isObject || afterKey) {
+		return false;
+	}
+	Level& level = stack.back();
+	if (level.hasValue) {
+		Put(',');
+	}
+	level.hasValue = true;
+	NewLine();
+	WriteString(s, size);
+	Put(':');
+	if (indent > 0) {
+		Put(' ');
+	}
+	afterKey = true;
+	return true;
+}
+
+/**
+* 文字列を書き込む.
+*
+* @param s    書き込む文字列. UTF-8であること.
+* @param size sのバイト数.
+*
+* @retval true  書き込み成功.
+* @retval false 値を書き込めない位置で呼び出された.
+*/
+bool Writer::String(const char* s, size_t size)
+{
+	if (!BeginValue()) {
+		return false;
+	}
+	WriteString(s, size);
+	EndValue();
+	return true;
+}
+
+/**
+* 数値を書き込む.
+*
+* @param n 書き込む数値.
+*
+* @retval true  書き込み成功.
+* @retval false 値を書き込めない位置で呼び出された.
+*
+* 元の値に戻せる最短の桁数で書き込む. 整数の値は"1.0"のように書き込む.
+* JSONは無限大とNaNを表せないので、nullを書き込む.
+*/
+bool Writer::Number(Json::Number n)
+{
+	if (!std::isfinite(n)) {
+		return Null();
+	}
+	if (!BeginValue()) {
+		return false;
+	}
+	char* const p = Reserve(32);
+	used += WriteDouble(p, n) - p;
+	EndValue();
+	return true;
+}
+
+/**
+* 整数を書き込む.
+*
+* @param n 書き込む整数.
+*
+* @retval true  書き込み成功.
+* @retval false 値を書き込めない位置で呼び出された.
+*/
+bool Writer::Integer(int64_t n)
+{
+	if (!BeginValue()) {
+		return false;
+	}
+	char* p = Reserve(24);
+	const char* const begin = p;
+	uint64_t u = static_cast<uint64_t>(n);
+	if (n < 0) {
+		*p++ = '-';
+		u = 0 - u;
+	}
+	used += WriteUnsigned(p, u) - begin;
+	EndValue();
+	return true;
+}
+
+/**
+* 真偽値を書き込む.
+*
+* @param b 書き込む真偽値.
+*
+* @retval true  書き込み成功.
+* @retval false 値を書き込めない位置で呼び出された.
+*/
+bool Writer::Boolean(Json::Boolean b)
+{
+	if (!BeginValue()) {
+		return false;
+	}
+	const size_t size = b ? 4 : 5;
+	memcpy(Reserve(size), b ? "true" : "false", size);
+	used += size;
+	EndValue();
+	return true;
+}
+
+/**
+* nullを書き込む.
+*
+* @retval true  書き込み成功.
+* @retval false 値を書き込めない位置で呼び出された.
+*/
+bool Writer::Null()
+{
+	if (!BeginValue()) {
+		return false;
+	}
+	memcpy(Reserve(4), "null", 4);
+	used += 4;
+	EndValue();
+	return true;
+}
+
+/**
+* 内部のバッファに溜めたデータを出力先に書き込む.
+*
+* @retval true  書き込み成功.
+* @retval false ファイルへの書き込みに失敗した.
+*
+* FILEに書き込む場合、fflushは呼び出さない.
+*/
+bool Writer::Flush()
+{
+	return Drain();
+}
+
+/**
+* 新しいJSONデータの書き込みを開始する.
+*
+* 書き込み中のオブジェクトと配列を破棄する. 出力先に書き込んでいないデータは破棄しない.
+* 確保済みのメモリは再利用する.
+*/
+void Writer::Reset()
+{
+	stack.clear();
+	afterKey = false;
+	isComplete = false;
+}
+
+/**
+* 値を書き込む前の区切り文字と字下げを書き込む.
+*
+* @retval true  値を書き込める.
+* @retval false 値を書き込めない位置で呼び出された.
+*/
+bool Writer::BeginValue()
+{
+	if (stack.empty()) {
+		return !isComplete;
+	}
+	Level& level = stack.back();
+	if (level.isObject) {
+		if (!afterKey) {
+			return false;
+		}
+		afterKey = false;
+		return true;
+	}
+	if (level.hasValue) {
+		Put(',');
+	}
+	level.hasValue = true;
+	NewLine();
+	return true;
+}
+
+/**
+* 値の書き込みを完了する.
+*/
+void Writer::EndValue()
+{
+	if (stack.empty()) {
+		isComplete = true;
+	}
+}
+
+/**
+* オブジェクトまたは配列の書き込みを開始する.
+*
+* @param isObject true=オブジェクト. false=配列.
+*
+* @retval true  書き込み成功.
+* @retval false 値を書き込めない位置で呼び出された.
+*/
+bool Writer::StartContainer(bool isObject)
+{
+	if (!BeginValue()) {
+		return false;
+	}
+	Put(isObject ? '{' : '[');
+	stack.push_back({ isObject, false });
+	return true;
+}
+
+/**
+* オブジェクトまたは配列の書き込みを終了する.
+*
+* @param isObject true=オブジェクト. false=配列.
+*
+* @retval true  書き込み成功.
+* @retval false 対応するオブジェクトまたは配列を書き込んでいない.
+*/
+bool Writer::EndContainer(bool isObject)
+{
+	if (stack.empty() || stack.back().isObject != isObject || afterKey) {
+		return false;
+	}
+	const bool hasValue = stack.back().hasValue;
+	stack.pop_back();
+	if (hasValue) {
+		NewLine();
+	}
+	Put(isObject ? '}' : ']');
+	EndValue();
+	return true;
+}
+
+/**
+* 改行と字下げを書き込む.
+*
+* 字下げの空白数が0なら何もしない.
+*/
+void Writer::NewLine()
+{
+	if (indent <= 0) {
+		return;
+	}
+	Put('\n');
+	for (size_t n = indent * stack.size(); n;) {
+		const size_t size = n < bufferSize ? n : bufferSize;
+		memset(Reserve(size), ' ', size);
+		used += size;
+		n -= size;
+	}
+}
+
+/**
+* 文字列を'"'で囲み、必要な文字をエスケープして書き込む.
+*
+* @param s    書き込む文字列.
+* @param size sのバイト数.
+*/
+void Writer::WriteString(const char* s, size_t size)
+{
+	static const char hex[] = "0123456789abcdef";
+	Put('"');
+	const char* const end = s + size;
+	for (;;) {
+		const char* const p = FindEscapeChar(s, end);
+		while (s != p) {
+			const size_t n = std::min<size_t>(p - s, size_t(bufferSize));
+			memcpy(Reserve(n), s, n);
+			used += n;
+			s += n;
+		}
+		if (s == end) {
+			break;
+		}
+		char* const q = Reserve(6);
+		q[0] = '\\';
+		switch (*s) {
+		case '"': q[1] = '"'; used += 2; break;
+		case '\\': q[1] = '\\'; used += 2; break;
+		case '\n': q[1] = 'n'; used += 2; break;
+		case '\r': q[1] = 'r'; used += 2; break;
+		case '\t': q[1] = 't'; used += 2; break;
+		case '\b': q[1] = 'b'; used += 2; break;
+		case '\f': q[1] = 'f'; used += 2; break;
+		default:
+			q[1] = 'u';
+			q[2] = '0';
+			q[3] = '0';
+			q[4] = hex[(*s >> 4) & 0xf];
+			q[5] = hex[*s & 0xf];
+			used += 6;
+			break;
+		}
+		++s;
+	}
+	Put('"');
+}
+
+/**
+* 内部のバッファに空きを確保する.
+*
+* @param size 確保するバイト数. bufferSize以下であること.
+*
+* @return 確保した領域の先頭. 書き込んだらusedを増やすこと.
+*/
+char* Writer::Reserve(size_t size)
+{
+	if (bufferSize - used < size) {
+		Drain();
+	}
+	return buffer + used;
+}
+
+/**
+* 内部のバッファのデータを出力先に書き込み、バッファを空にする.
+*
+* @retval true  書き込み成功.
+* @retval false ファイルへの書き込みに失敗したことがある.
+*/
+bool Writer::Drain()
+{
+	if (used) {
+		if (output) {
+			output->insert(output->end(), buffer, buffer + used);
+		} else if (fp && fwrite(buffer, 1, used, fp) != used) {
+			hasError = true;
+		}
+		used = 0;
+	}
+	return !hasError;
+}
+
 } // namespace Json
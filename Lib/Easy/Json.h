@@ -7,6 +7,11 @@
 #include <vector>
 #include <unordered_map>
 #include <type_traits>
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
 
 namespace Json {
 
@@ -18,23 +23,23 @@ typedef std::unordered_map<String, Value> Object;
 typedef std::vector<Value> Array;
 
 /**
-* ValueۂɕێĂ^ʂ邽߂̗񋓌^.
+* Valueが実際に保持している型を識別するための列挙型.
 */
 enum class Type
 {
-	Object, ///< IuWFNg^.
-	Array, ///< z^.
-	String, ///< ^.
-	Number, ///< l^.
-	Boolean, ///< ^Ul.
-	Null, ///< nulll.
+	Object, ///< オブジェクト型.
+	Array, ///< 配列型.
+	String, ///< 文字列型.
+	Number, ///< 数値型.
+	Boolean, ///< 真偽値.
+	Null, ///< null値.
 };
 
 /**
-* JSON̒li[ėp^.
+* JSONの値を格納する汎用型.
 *
-* typeɑΉoϐɃANZX邱ƂŎۂ̒l.
-* typeƈقȂ郁oϐɃANZXꍇ͖̓`.
+* typeに対応したメンバ変数にアクセスすることで実際の値が得られる.
+* typeと異なるメンバ変数にアクセスした場合の動作は未定義.
 */
 class Value
 {
@@ -50,9 +55,9 @@ public:
 	~Value();
 
 	/**
-	* Rs[Zq.
+	* コピー代入演算子.
 	*
-	* @param v Rs[IuWFNg.
+	* @param v コピー元オブジェクト.
 	*/
 	template<typename T>
 	Value& operator=(const T& v) {
@@ -68,7 +73,7 @@ public:
 	const Object& AsObject() const;
 	const Array& AsArray() const;
 
-	/// Zp^TƂăANZX.
+	/// 算術型Tとしてアクセス.
 	template<typename T>
 	T AsNumber() const {
 		static_assert(std::is_arithmetic<T>::value, "T should be the arithmetic type.");
@@ -87,20 +92,347 @@ private:
 };
 
 /**
-* p[X.
+* パース結果.
 *
-* errorȂp[X.
-* łȂΉ炩̃G[Ă.
-* errorɂ͔G[̏񂪍sPʂŊi[Ă̂ŁAOutputDebugStringAŏo͂ł.
+* errorが空ならパース成功.
+* 空でなければ何らかのエラーが発生している.
+* errorには発生したエラーの情報が行単位で格納されているので、OutputDebugStringA等で出力できる.
 */
 struct Result
 {
-	Value value; ///< JSONIuWFNg.
-	std::string error; ///< G[.
+	Value value; ///< JSONオブジェクト.
+	std::string error; ///< エラー情報.
 };
 
 Result Parse(const char* data, const char* end);
 
+/**
+* 文字列の範囲を参照する型.
+*
+* 文字列は終端に'\0'を持たないため、C文字列として扱わないこと.
+*/
+struct StringRef
+{
+	const char* data; ///< 文字列の先頭.
+	size_t size; ///< 文字列のバイト数.
+
+	bool operator==(const char* s) const;
+	bool operator!=(const char* s) const { return !(*this == s); }
+	String ToString() const { return String(data, size); }
+};
+
+struct Member;
+
+/**
+* Documentが作成するJSONの値.
+*
+* Valueと異なり、全てのNodeはDocumentのアリーナに割り当てられ、Documentが破棄されるまで有効.
+* オブジェクトのメンバと配列の要素は、アリーナ上に連続して並んでいる.
+* 型が異なる値としてアクセスした場合は、空の値(0, false, 空文字列, 要素数0)を返す.
+*/
+class Node
+{
+	friend class DocumentParser;
+public:
+	Node() : type(Type::Null), size(0), number(0) {}
+
+	Type GetType() const { return type; }
+	StringRef AsString() const;
+	Number AsNumber() const { return type == Type::Number ? number : 0; }
+	Boolean AsBoolean() const { return type == Type::Boolean ? boolean : false; }
+
+	/// 算術型Tとしてアクセス.
+	template<typename T>
+	T AsNumber() const {
+		static_assert(std::is_arithmetic<T>::value, "T should be the arithmetic type.");
+		return static_cast<T>(AsNumber());
+	}
+
+	size_t Size() const;
+	const Node& operator[](size_t i) const;
+	const Node& operator[](int i) const { return (*this)[static_cast<size_t>(i)]; }
+	const Node* Find(const char* key) const;
+	const Node& operator[](const char* key) const;
+	const Member* MemberBegin() const;
+	const Member* MemberEnd() const;
+	const Node* Begin() const;
+	const Node* End() const;
+
+private:
+	Type type;
+	uint32_t size; ///< 文字列のバイト数、メンバ数、要素数.
+	union {
+		const char* string;
+		Number number;
+		Boolean boolean;
+		const Member* members;
+		const Node* elements;
+	};
+};
+
+/**
+* オブジェクトのメンバ.
+*/
+struct Member
+{
+	StringRef key; ///< キー.
+	Node value; ///< 値.
+};
+
+/**
+* JSONデータを解析し、アリーナに割り当てたNodeの木を保持するクラス.
+*
+* Parse()はNodeを大きなメモリブロックから順に割り当てるため、値ごとのメモリ確保が発生しない.
+* エスケープを含まない文字列は解析したJSONデータを直接参照するので、
+* JSONデータはDocumentを使い終わるまで破棄しないこと.
+* 同じDocumentで繰り返しParse()すると、確保済みのメモリブロックを再利用する.
+*
+* - 使い方.
+*   Json::Document doc;
+*   if (doc.Parse(data, data + size)) {
+*     const int width = doc.Root()["width"].AsNumber<int>();
+*   }
+*/
+class Document
+{
+public:
+	Document() = default;
+	~Document() = default;
+	Document(const Document&) = delete;
+	Document& operator=(const Document&) = delete;
+
+	bool Parse(const char* data, const char* end);
+	void Clear();
+	const Node& Root() const { return root; }
+	const std::string& Error() const { return error; }
+	size_t AllocationCount() const { return allocationCount; }
+	size_t ArenaSize() const;
+
+private:
+	friend class DocumentParser;
+	void* Allocate(size_t size);
+
+	/// アリーナのメモリブロック.
+	struct Block
+	{
+		std::unique_ptr<char[]> buffer; ///< メモリブロック.
+		size_t size; ///< メモリブロックのバイト数.
+	};
+	std::vector<Block> blocks; ///< 確保したメモリブロック.
+	size_t currentBlock = 0; ///< 割り当て中のメモリブロックの番号.
+	size_t used = 0; ///< 割り当て中のメモリブロックの使用済みバイト数.
+	std::vector<Node> elementStack; ///< 解析中の配列の要素.
+	std::vector<Member> memberStack; ///< 解析中のオブジェクトのメンバ.
+	size_t allocationCount = 0; ///< メモリの確保回数.
+	Node root; ///< ルートの値.
+	std::string error; ///< エラー情報.
+};
+
+/**
+* Readerが解析したJSONの要素を受け取るクラス.
+*
+* Readerは値を作らずに、解析した順に対応する関数を呼び出す.
+* 各関数がfalseを返すと解析を中断する.
+* 文字列とキーは呼び出しの間だけ有効なので、必要ならコピーすること.
+*/
+class Handler
+{
+public:
+	virtual ~Handler() = default;
+	virtual bool OnStartObject() { return true; }
+	virtual bool OnEndObject() { return true; }
+	virtual bool OnStartArray() { return true; }
+	virtual bool OnEndArray() { return true; }
+	virtual bool OnKey(const StringRef&) { return true; }
+	virtual bool OnString(const StringRef&) { return true; }
+	virtual bool OnNumber(Number) { return true; }
+
+	/**
+	* 整数を受け取る.
+	*
+	* 小数点と指数を持たない18桁以下の数値は、strtodを使わずに変換してこの関数に渡される.
+	* 既定ではOnNumberを呼び出す.
+	*/
+	virtual bool OnInteger(int64_t n) { return OnNumber(static_cast<Number>(n)); }
+	virtual bool OnBoolean(Boolean) { return true; }
+	virtual bool OnNull() { return true; }
+};
+
+/**
+* JSONデータを解析し、値を作らずにHandlerへ通知するクラス.
+*
+* データは任意の位置で区切って、複数回に分けてFeed()に渡せる.
+* 区切りにまたがった文字列や数値は内部でつなげてから通知する.
+* ファイルを読み込みながら解析したり、DOMを作らずに必要な値だけを取り出す場合に使う.
+*
+* - 使い方.
+*   Json::Reader reader(handler);
+*   while (size_t n = fread(buf, 1, sizeof(buf), fp)) {
+*     if (!reader.Feed(buf, n)) { ... }
+*   }
+*   if (!reader.Finish()) { ... }
+*/
+class Reader
+{
+public:
+	explicit Reader(Handler& h) : handler(h) {}
+	~Reader() = default;
+	Reader(const Reader&) = delete;
+	Reader& operator=(const Reader&) = delete;
+
+	bool Feed(const char* data, size_t size);
+	bool Finish();
+	void Reset();
+	const std::string& Error() const { return error; }
+
+	/// 通知中の要素の先頭位置(Feed()に渡したデータの先頭からのバイト数).
+	size_t TokenBegin() const { return tokenBegin; }
+
+	/// 通知中の要素の終端位置(Feed()に渡したデータの先頭からのバイト数).
+	size_t TokenEnd() const { return tokenEnd; }
+
+private:
+	/// 次に読み込む要素.
+	enum State {
+		State_Value, ///< 値.
+		State_ValueOrEnd, ///< 値または']'.
+		State_KeyOrEnd, ///< キーまたは'}'.
+		State_Key, ///< キー.
+		State_Colon, ///< ':'.
+		State_CommaOrEnd, ///< ','または'}', ']'.
+		State_Done, ///< 解析完了. 以後は空白のみ.
+	};
+
+	/// Feed()の区切りにまたがっている要素.
+	enum Partial {
+		Partial_None, ///< なし.
+		Partial_String, ///< 文字列.
+		Partial_Number, ///< 数値.
+		Partial_Literal, ///< true, false, null.
+	};
+
+	bool AddError(const std::string& err);
+	const char* ReadToken(const char* p, const char* end);
+	const char* ReadIntegers(const char* p, const char* end, int64_t n);
+	const char* SkipSpace(const char* p, const char* end);
+	const char* ContinueToken(const char* p, const char* end);
+	bool EmitString(const char* p, const char* end, bool hasEscape);
+	bool EmitNumber(const char* p, const char* end);
+	bool EmitLiteral(const char* p, const char* end);
+	void EndValue();
+	size_t Offset(const char* p) const { return offset + (p - chunk); }
+
+	Handler& handler; ///< 解析結果を通知する先.
+	State state = State_Value; ///< 次に読み込む要素.
+	std::vector<char> stack; ///< 解析中のオブジェクト('{')と配列('[').
+	Partial partial = Partial_None; ///< 区切りにまたがっている要素.
+	bool escaped = false; ///< 区切りの直前が'\\'だった.
+	bool hasEscape = false; ///< 解析中の文字列がエスケープシーケンスを含む.
+	std::string pending; ///< 区切りにまたがっている要素の文字列.
+	std::string unescaped; ///< エスケープシーケンスを変換した文字列.
+	const char* chunk = nullptr; ///< Feed()に渡されたデータの先頭.
+	size_t offset = 0; ///< chunkの先頭の位置.
+	size_t tokenBegin = 0; ///< 通知中の要素の先頭位置.
+	size_t tokenEnd = 0; ///< 通知中の要素の終端位置.
+	size_t line = 0; ///< 解析位置までの改行の数.
+	std::string error; ///< エラー情報.
+};
+
+/**
+* JSONデータを書き出すクラス.
+*
+* Valueを作らずに、呼び出した順に要素を出力先へ書き込む.
+* 出力先は呼び出し側のstd::vector<char>(末尾に追加する)か、FILEのどちらか.
+* 書き込みは内部のバッファに溜めてからまとめて行うので、書き込んだデータを使う前にFlush()を呼ぶこと.
+* 数値はsnprintfを使わずに変換し、小数は元の値に戻せる最短の桁数で書き込む.
+* バッファとオブジェクト, 配列のスタックは再利用されるので、Reset()して使い続ければメモリ確保は発生しない
+* (std::vector<char>の出力先は、呼び出し側でclear()して再利用すること).
+*
+* Handlerを継承しているので、Readerに渡してJSONデータを整形し直すこともできる.
+*
+* - 使い方.
+*   std::vector<char> buf;
+*   Json::Writer writer(buf, 2);
+*   writer.StartObject();
+*   writer.Key("frame");
+*   writer.Integer(frameCount);
+*   writer.Key("time");
+*   writer.Number(deltaTime);
+*   writer.EndObject();
+*   writer.Flush();
+*/
+class Writer : public Handler
+{
+public:
+	explicit Writer(std::vector<char>& output, int indent = 0);
+	explicit Writer(FILE* fp, int indent = 0);
+	~Writer();
+	Writer(const Writer&) = delete;
+	Writer& operator=(const Writer&) = delete;
+
+	bool StartObject();
+	bool EndObject();
+	bool StartArray();
+	bool EndArray();
+	bool Key(const char* s, size_t size);
+	bool Key(const char* s) { return Key(s, strlen(s)); }
+	bool Key(const StringRef& s) { return Key(s.data, s.size); }
+	bool String(const char* s, size_t size);
+	bool String(const char* s) { return String(s, strlen(s)); }
+	bool String(const StringRef& s) { return String(s.data, s.size); }
+	bool String(const std::string& s) { return String(s.data(), s.size()); }
+	bool Number(Json::Number n);
+	bool Integer(int64_t n);
+	bool Boolean(Json::Boolean b);
+	bool Null();
+	bool Flush();
+	void Reset();
+
+	/// ルートの値を書き終えたらtrue.
+	bool IsComplete() const { return isComplete; }
+
+	bool OnStartObject() override { return StartObject(); }
+	bool OnEndObject() override { return EndObject(); }
+	bool OnStartArray() override { return StartArray(); }
+	bool OnEndArray() override { return EndArray(); }
+	bool OnKey(const StringRef& s) override { return Key(s); }
+	bool OnString(const StringRef& s) override { return String(s); }
+	bool OnNumber(Json::Number n) override { return Number(n); }
+	bool OnInteger(int64_t n) override { return Integer(n); }
+	bool OnBoolean(Json::Boolean b) override { return Boolean(b); }
+	bool OnNull() override { return Null(); }
+
+private:
+	/// 書き込み中のオブジェクトまたは配列.
+	struct Level
+	{
+		bool isObject; ///< true=オブジェクト. false=配列.
+		bool hasValue; ///< メンバまたは要素を1つ以上書き込んだ.
+	};
+
+	bool BeginValue();
+	void EndValue();
+	bool StartContainer(bool isObject);
+	bool EndContainer(bool isObject);
+	void NewLine();
+	void WriteString(const char* s, size_t size);
+	char* Reserve(size_t size);
+	void Put(char c) { *Reserve(1) = c; ++used; }
+	bool Drain();
+
+	static const size_t bufferSize = 4096; ///< 内部バッファのバイト数.
+
+	std::vector<char>* output = nullptr; ///< 出力先の配列.
+	FILE* fp = nullptr; ///< 出力先のファイル.
+	int indent; ///< 字下げの空白数. 0なら改行と字下げをしない.
+	std::vector<Level> stack; ///< 書き込み中のオブジェクトと配列.
+	bool afterKey = false; ///< キーを書き込み、値を待っている.
+	bool isComplete = false; ///< ルートの値を書き終えた.
+	bool hasError = false; ///< ファイルへの書き込みに失敗した.
+	size_t used = 0; ///< bufferの使用済みバイト数.
+	char buffer[bufferSize]; ///< 出力先に書き込む前のデータ.
+};
+
 } // namespace Json
 
 #endif // EASY_JSON_H_
@@ -0,0 +1,390 @@
+/**
+* @file JsonBind.cpp
+*
+* JSONの値をC++の構造体へ直接書き込むBinder.
+*/
+#include "JsonBind.h"
+#include <string.h>
+#include <stdio.h>
+
+namespace Json {
+
+/**
+* コンストラクタ.
+*
+* @param binding targetの型.
+* @param target  書き込み先.
+* @param name    targetの名前(エラー表示用).
+*/
+Binder::Binder(const TypeBinding& binding, void* target, const char* name) :
+	rootBinding(binding), root(target), rootName(name)
+{
+}
+
+/**
+* 次に受け取る値の書き込み先を得る.
+*
+* @param binding 書き込み先の型を格納する変数.
+*
+* @return 書き込み先. 値を読み飛ばす場合はnullptr.
+*
+* 配列の場合は、ここで要素を追加する.
+*/
+void* Binder::NextValue(const TypeBinding*& binding)
+{
+	if (depth == 0) {
+		binding = &rootBinding;
+		return root;
+	}
+	Frame& f = frames[depth - 1];
+	if (f.kind == Kind_Array) {
+		++f.count;
+		binding = f.element;
+		return f.binding->addElement(f.target);
+	}
+	binding = nextBinding;
+	return nextTarget;
+}
+
+/**
+* 値の受け取りを完了する.
+*
+* @return 常にtrue.
+*/
+bool Binder::EndValue()
+{
+	if (depth == 0) {
+		isDone = true;
+	}
+	return true;
+}
+
+/**
+* オブジェクトまたは配列の書き込みを開始する.
+*
+* @param binding 書き込み先の型.
+* @param target  書き込み先.
+* @param kind    書き込み方法.
+*/
+void Binder::Push(const TypeBinding& binding, void* target, Kind kind)
+{
+	if (depth == frames.size()) {
+		frames.emplace_back();
+	}
+	Frame& f = frames[depth++];
+	f.binding = &binding;
+	f.element = binding.element ? &binding.element() : nullptr;
+	f.target = target;
+	f.kind = kind;
+	f.found = 0;
+	f.field = binding.fieldCount;
+	f.count = 0;
+	f.key.clear();
+}
+
+/**
+* オブジェクトの開始を処理する.
+*/
+bool Binder::OnStartObject()
+{
+	if (skipDepth) {
+		++skipDepth;
+		return true;
+	}
+	const TypeBinding* binding;
+	void* const target = NextValue(binding);
+	if (!target) {
+		skipDepth = 1;
+		return true;
+	}
+	if (binding->fields) {
+		Push(*binding, target, Kind_Struct);
+	} else if (binding->addMember) {
+		Push(*binding, target, Kind_Map);
+	} else {
+		return TypeError(*binding, "オブジェクト");
+	}
+	return true;
+}
+
+/**
+* オブジェクトの終了を処理する.
+*
+* 構造体の必須のメンバが全て揃っているかを調べる.
+*/
+bool Binder::OnEndObject()
+{
+	if (skipDepth) {
+		--skipDepth;
+		return true;
+	}
+	const Frame& f = frames[depth - 1];
+	if (f.kind == Kind_Struct) {
+		for (size_t i = 0; i < f.binding->fieldCount; ++i) {
+			const Field& field = f.binding->fields[i];
+			if (field.isRequired && !(f.found & (1ULL << i))) {
+				return AddError(Path(depth - 1) + ": " + f.binding->name + "の必須のメンバ\"" + field.name + "\"がありません");
+			}
+		}
+	}
+	--depth;
+	return EndValue();
+}
+
+/**
+* 配列の開始を処理する.
+*/
+bool Binder::OnStartArray()
+{
+	if (skipDepth) {
+		++skipDepth;
+		return true;
+	}
+	const TypeBinding* binding;
+	void* const target = NextValue(binding);
+	if (!target) {
+		skipDepth = 1;
+		return true;
+	}
+	if (!binding->addElement) {
+		return TypeError(*binding, "配列");
+	}
+	Push(*binding, target, Kind_Array);
+	return true;
+}
+
+/**
+* 配列の終了を処理する.
+*/
+bool Binder::OnEndArray()
+{
+	if (skipDepth) {
+		--skipDepth;
+		return true;
+	}
+	--depth;
+	return EndValue();
+}
+
+/**
+* キーを処理する.
+*
+* 構造体の場合、JSONのメンバは定義順に並んでいることが多いので、直前のメンバの次から探す.
+* 対応するメンバがなければ、次の値は読み飛ばす.
+*/
+bool Binder::OnKey(const StringRef& key)
+{
+	if (skipDepth) {
+		return true;
+	}
+	Frame& f = frames[depth - 1];
+	if (f.kind == Kind_Map) {
+		f.key.assign(key.data, key.size);
+		nextBinding = f.element;
+		nextTarget = f.binding->addMember(f.target, key);
+		return true;
+	}
+	const size_t count = f.binding->fieldCount;
+	size_t i = f.field + 1 < count ? f.field + 1 : 0;
+	for (size_t n = 0; n < count; ++n) {
+		const Field& field = f.binding->fields[i];
+		if (field.nameSize == key.size && memcmp(field.name, key.data, key.size) == 0) {
+			f.field = i;
+			f.found |= 1ULL << i;
+			nextBinding = &field.binding();
+			nextTarget = field.member(f.target);
+			return true;
+		}
+		if (++i == count) {
+			i = 0;
+		}
+	}
+	f.field = count;
+	nextTarget = nullptr;
+	return true;
+}
+
+/**
+* 文字列を処理する.
+*/
+bool Binder::OnString(const StringRef& s)
+{
+	if (skipDepth) {
+		return true;
+	}
+	const TypeBinding* binding;
+	if (void* const target = NextValue(binding)) {
+		if (!binding->onString) {
+			return TypeError(*binding, "文字列");
+		}
+		if (!binding->onString(target, s)) {
+			return AddError(Path(depth) + ": \"" + s.ToString() + "\"は" + binding->name + "として不正な値です");
+		}
+	}
+	return EndValue();
+}
+
+/**
+* 数値を処理する.
+*/
+bool Binder::OnNumber(Number n)
+{
+	if (skipDepth) {
+		return true;
+	}
+	const TypeBinding* binding;
+	if (void* const target = NextValue(binding)) {
+		if (!binding->onNumber) {
+			return TypeError(*binding, "数値");
+		}
+		if (!binding->onNumber(target, n)) {
+			char buf[32];
+			snprintf(buf, sizeof(buf), "%g", n);
+			return AddError(Path(depth) + ": " + buf + "は" + binding->name + "として不正な値です");
+		}
+	}
+	return EndValue();
+}
+
+/**
+* 整数を処理する.
+*
+* onIntegerがなければonNumberで書き込む.
+*/
+bool Binder::OnInteger(int64_t n)
+{
+	if (skipDepth) {
+		return true;
+	}
+	const TypeBinding* binding;
+	if (void* const target = NextValue(binding)) {
+		if (!binding->onInteger && !binding->onNumber) {
+			return TypeError(*binding, "数値");
+		}
+		if (!(binding->onInteger ? binding->onInteger(target, n) : binding->onNumber(target, static_cast<Number>(n)))) {
+			return AddError(Path(depth) + ": " + std::to_string(n) + "は" + binding->name + "として不正な値です");
+		}
+	}
+	return EndValue();
+}
+
+/**
+* 真偽値を処理する.
+*/
+bool Binder::OnBoolean(Boolean b)
+{
+	if (skipDepth) {
+		return true;
+	}
+	const TypeBinding* binding;
+	if (void* const target = NextValue(binding)) {
+		if (!binding->onBoolean || !binding->onBoolean(target, b)) {
+			return TypeError(*binding, "真偽値");
+		}
+	}
+	return EndValue();
+}
+
+/**
+* nullを処理する.
+*/
+bool Binder::OnNull()
+{
+	if (skipDepth) {
+		return true;
+	}
+	const TypeBinding* binding;
+	if (void* const target = NextValue(binding)) {
+		if (!binding->onNull || !binding->onNull(target)) {
+			return TypeError(*binding, "null");
+		}
+	}
+	return EndValue();
+}
+
+/**
+* 書き込み中の値の位置を示す文字列を作成する.
+*
+* @param frameCount 位置の作成に使うframesの要素数.
+*
+* @return "tilesets[0].image"のような、ルートの名前から続く文字列.
+*/
+std::string Binder::Path(size_t frameCount) const
+{
+	std::string path = rootName;
+	for (size_t i = 0; i < frameCount; ++i) {
+		const Frame& f = frames[i];
+		switch (f.kind) {
+		case Kind_Struct:
+			if (f.field < f.binding->fieldCount) {
+				path += '.';
+				path += f.binding->fields[f.field].name;
+			}
+			break;
+		case Kind_Map:
+			path += '.';
+			path += f.key;
+			break;
+		case Kind_Array:
+			path += '[' + std::to_string(f.count - 1) + ']';
+			break;
+		}
+	}
+	if (path.empty()) {
+		return "(root)";
+	} else if (path[0] == '.') {
+		path.erase(0, 1);
+	}
+	return path;
+}
+
+/**
+* エラー情報を追加.
+*
+* @param err エラーの内容を示す文字列.
+*
+* @return 常にfalse.
+*/
+bool Binder::AddError(const std::string& err)
+{
+	error += "(Bind) " + err + "\n";
+	return false;
+}
+
+/**
+* 型が違うというエラー情報を追加.
+*
+* @param binding   書き込み先の型.
+* @param valueType 受け取った値の種類.
+*
+* @return 常にfalse.
+*/
+bool Binder::TypeError(const TypeBinding& binding, const char* valueType)
+{
+	return AddError(Path(depth) + ": " + binding.name + "が必要ですが、" + valueType + "があります");
+}
+
+/**
+* JSONデータを解析し、TypeBindingに従って直接書き込む.
+*
+* @param data    JSONデータの先頭.
+* @param end     JSONデータの終端.
+* @param binding targetの型.
+* @param target  書き込み先.
+* @param error   エラー情報を格納する変数.
+*
+* @retval true  書き込み成功.
+* @retval false 書き込み失敗. errorにエラー情報が格納される.
+*/
+bool Bind(const char* data, const char* end, const TypeBinding& binding, void* target, std::string& error)
+{
+	Binder binder(binding, target);
+	Reader reader(binder);
+	if (!reader.Feed(data, end - data) || !reader.Finish()) {
+		error = binder.Error() + reader.Error();
+		return false;
+	}
+	return true;
+}
+
+} // namespace Json
@@ -0,0 +1,374 @@
+/**
+* @file JsonBind.h
+*
+* JSONの値をDOMを作らずにC++の構造体へ直接書き込む機能.
+*/
+#ifndef EASY_JSONBIND_H_
+#define EASY_JSONBIND_H_
+#include "Json.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <limits>
+#include <type_traits>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace Json {
+
+struct Field;
+
+/**
+* JSONの値をC++の型に書き込む方法.
+*
+* 受け取れない種類の値に対応する関数ポインタはnullptrにする.
+* nullptrの種類の値を受け取ると、Binderは型が違うというエラーにする.
+* 通常はBinding<T>::Get()が作成するので、直接作成するのは複数の形式を受け付ける型を定義する場合だけ.
+*/
+struct TypeBinding
+{
+	const char* name; ///< 型の名前(エラー表示用).
+	bool (*onString)(void* target, const StringRef& s); ///< 文字列を書き込む. 書き込めない値ならfalseを返す.
+	bool (*onNumber)(void* target, Number n); ///< 数値を書き込む. 書き込めない値ならfalseを返す.
+	bool (*onInteger)(void* target, int64_t n); ///< 整数を書き込む. nullptrならonNumberを使う.
+	bool (*onBoolean)(void* target, Boolean b); ///< 真偽値を書き込む.
+	bool (*onNull)(void* target); ///< nullを書き込む.
+	const Field* fields; ///< オブジェクトを構造体として受け取る場合のメンバの一覧.
+	size_t fieldCount; ///< fieldsの要素数. 64以下.
+	void* (*addMember)(void* target, const StringRef& key); ///< オブジェクトを連想配列として受け取る場合に、メンバを追加する.
+	void* (*addElement)(void* target); ///< 配列の要素を追加する.
+	const TypeBinding& (*element)(); ///< addMember, addElementが返す値の型.
+};
+
+/**
+* 構造体のメンバとJSONのキーの対応.
+*
+* JSON_REQUIRED, JSON_OPTIONALマクロで作成する.
+*/
+struct Field
+{
+	const char* name; ///< JSONのキー.
+	size_t nameSize; ///< nameのバイト数.
+	void* (*member)(void* object); ///< 構造体のアドレスから、メンバのアドレスを得る.
+	const TypeBinding& (*binding)(); ///< メンバの型.
+	bool isRequired; ///< true=必須. false=省略可能.
+};
+
+/**
+* 構造体のメンバの一覧.
+*
+* JSON_FIELDSマクロが定義するJsonFields()の戻り値.
+*/
+struct FieldList
+{
+	const char* name; ///< 構造体の名前(エラー表示用).
+	const Field* fields; ///< メンバの一覧.
+	size_t count; ///< fieldsの要素数.
+};
+
+/**
+* 構造体のアドレスから、メンバのアドレスを得る.
+*
+* @tparam T 構造体の型.
+* @tparam M メンバの型.
+* @tparam P メンバへのポインタ.
+*/
+template<typename T, typename M, M T::*P>
+void* MemberOf(void* object)
+{
+	return &(static_cast<T*>(object)->*P);
+}
+
+/**
+* 型TにJSONの値を書き込む方法を提供するクラス.
+*
+* 既定ではJSON_FIELDSマクロでメンバの一覧を定義した構造体として扱う.
+* 算術型, bool, std::string, std::vector, std::map<std::string, T>は特殊化で対応する.
+* 他の型に対応させる場合は、Get()でTypeBindingを返す特殊化を定義すること.
+*/
+template<typename T, typename Enable = void>
+struct Binding
+{
+	static const TypeBinding& Get()
+	{
+		static const FieldList list = T::JsonFields();
+		static const TypeBinding binding = {
+			list.name, nullptr, nullptr, nullptr, nullptr, nullptr, list.fields, list.count, nullptr, nullptr, nullptr
+		};
+		return binding;
+	}
+};
+
+/**
+* 算術型に数値を書き込む.
+*
+* 整数型の場合、小数部を持つ数値と範囲外の数値は書き込めない.
+*/
+template<typename T>
+struct Binding<T, typename std::enable_if<std::is_arithmetic<T>::value>::type>
+{
+	static bool OnNumber(void* target, Number n)
+	{
+		if (std::is_integral<T>::value) {
+			if (!(n >= -9.2e18 && n <= 9.2e18) || n != static_cast<Number>(static_cast<int64_t>(n))) {
+				return false;
+			}
+			return OnInteger(target, static_cast<int64_t>(n));
+		}
+		*static_cast<T*>(target) = static_cast<T>(n);
+		return true;
+	}
+	static bool OnInteger(void* target, int64_t n)
+	{
+		if (std::is_integral<T>::value) {
+			if (std::is_unsigned<T>::value ? (n < 0 || static_cast<uint64_t>(n) > static_cast<uint64_t>(std::numeric_limits<T>::max())) :
+				(n < static_cast<int64_t>(std::numeric_limits<T>::min()) || n > static_cast<int64_t>(std::numeric_limits<T>::max()))) {
+				return false;
+			}
+		}
+		*static_cast<T*>(target) = static_cast<T>(n);
+		return true;
+	}
+	static const TypeBinding& Get()
+	{
+		static const TypeBinding binding = {
+			std::is_integral<T>::value ? "整数" : "数値",
+			nullptr, &OnNumber, &OnInteger, nullptr, nullptr, nullptr, 0, nullptr, nullptr, nullptr
+		};
+		return binding;
+	}
+};
+
+/**
+* boolに真偽値を書き込む.
+*/
+template<>
+struct Binding<bool>
+{
+	static bool OnBoolean(void* target, Boolean b)
+	{
+		*static_cast<bool*>(target) = b;
+		return true;
+	}
+	static const TypeBinding& Get()
+	{
+		static const TypeBinding binding = {
+			"真偽値", nullptr, nullptr, nullptr, &OnBoolean, nullptr, nullptr, 0, nullptr, nullptr, nullptr
+		};
+		return binding;
+	}
+};
+
+/**
+* std::stringに文字列を書き込む.
+*/
+template<>
+struct Binding<std::string>
+{
+	static bool OnString(void* target, const StringRef& s)
+	{
+		static_cast<std::string*>(target)->assign(s.data, s.size);
+		return true;
+	}
+	static const TypeBinding& Get()
+	{
+		static const TypeBinding binding = {
+			"文字列", &OnString, nullptr, nullptr, nullptr, nullptr, nullptr, 0, nullptr, nullptr, nullptr
+		};
+		return binding;
+	}
+};
+
+/**
+* std::vectorに配列の要素を追加する.
+*/
+template<typename T>
+struct Binding<std::vector<T>>
+{
+	static void* AddElement(void* target)
+	{
+		std::vector<T>& v = *static_cast<std::vector<T>*>(target);
+		v.emplace_back();
+		return &v.back();
+	}
+	static const TypeBinding& Get()
+	{
+		static const TypeBinding binding = {
+			"配列", nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, 0, nullptr, &AddElement, &Binding<T>::Get
+		};
+		return binding;
+	}
+};
+
+/**
+* std::mapにオブジェクトのメンバを追加する.
+*
+* キーが重複している場合は後のメンバで上書きする.
+*/
+template<typename T>
+struct Binding<std::map<std::string, T>>
+{
+	static void* AddMember(void* target, const StringRef& key)
+	{
+		return &(*static_cast<std::map<std::string, T>*>(target))[key.ToString()];
+	}
+	static const TypeBinding& Get()
+	{
+		static const TypeBinding binding = {
+			"オブジェクト", nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, 0, &AddMember, nullptr, &Binding<T>::Get
+		};
+		return binding;
+	}
+};
+
+/**
+* Readerの通知を、TypeBindingに従ってC++の変数に直接書き込むクラス.
+*
+* 構造体のメンバはJSON_FIELDSで定義したキーと照合して書き込み、定義していないキーの値は読み飛ばす.
+* 必須のメンバがないオブジェクトや、型が違う値を受け取るとエラー情報を記録して解析を中断する.
+* 別のHandlerから通知を転送して、JSONデータの一部だけを書き込むこともできる.
+*
+* - 使い方.
+*   struct Size {
+*     int width = 0;
+*     int height = 0;
+*     JSON_FIELDS(Size,
+*       JSON_REQUIRED(width, "width"),
+*       JSON_OPTIONAL(height, "height"));
+*   };
+*   Size size;
+*   std::string error;
+*   if (!Json::Bind(data, end, size, error)) { ... }
+*/
+class Binder : public Handler
+{
+public:
+	Binder(const TypeBinding& binding, void* target, const char* name = "");
+	~Binder() = default;
+	Binder(const Binder&) = delete;
+	Binder& operator=(const Binder&) = delete;
+
+	/**
+	* 変数を書き込み先とするBinderを作成する.
+	*
+	* @param target 書き込み先の変数.
+	* @param name   targetの名前(エラー表示用).
+	*/
+	template<typename T>
+	explicit Binder(T& target, const char* name = "") : Binder(Binding<T>::Get(), &target, name) {}
+
+	bool OnStartObject() override;
+	bool OnEndObject() override;
+	bool OnStartArray() override;
+	bool OnEndArray() override;
+	bool OnKey(const StringRef&) override;
+	bool OnString(const StringRef&) override;
+	bool OnNumber(Number) override;
+	bool OnInteger(int64_t) override;
+	bool OnBoolean(Boolean) override;
+	bool OnNull() override;
+
+	/// 書き込み先の値を最後まで受け取ったらtrue.
+	bool IsDone() const { return isDone; }
+	const std::string& Error() const { return error; }
+
+private:
+	/// オブジェクトまたは配列の書き込み方法.
+	enum Kind {
+		Kind_Struct, ///< オブジェクトのメンバを構造体のメンバに書き込む.
+		Kind_Map, ///< オブジェクトのメンバを連想配列に追加する.
+		Kind_Array, ///< 配列の要素を追加する.
+	};
+
+	/// 書き込み中のオブジェクトまたは配列.
+	struct Frame
+	{
+		const TypeBinding* binding; ///< 書き込み先の型.
+		const TypeBinding* element; ///< 連想配列または配列の要素の型.
+		void* target; ///< 書き込み先.
+		Kind kind; ///< 書き込み方法.
+		uint64_t found; ///< 受け取った構造体のメンバを示すビット.
+		size_t field; ///< 直前のキーに対応する構造体のメンバの番号. 対応するメンバがなければfieldCount.
+		size_t count; ///< 追加した要素数.
+		std::string key; ///< 直前のキー(エラー表示用).
+	};
+
+	void* NextValue(const TypeBinding*& binding);
+	bool EndValue();
+	void Push(const TypeBinding& binding, void* target, Kind kind);
+	std::string Path(size_t frameCount) const;
+	bool AddError(const std::string& err);
+	bool TypeError(const TypeBinding& binding, const char* valueType);
+
+	const TypeBinding& rootBinding; ///< ルートの型.
+	void* root; ///< ルートの書き込み先.
+	const char* rootName; ///< ルートの名前(エラー表示用).
+	std::vector<Frame> frames; ///< 書き込み中のオブジェクトと配列.
+	size_t depth = 0; ///< framesのうち使用中の要素数.
+	const TypeBinding* nextBinding = nullptr; ///< 直前のキーに対応する値の型.
+	void* nextTarget = nullptr; ///< 直前のキーに対応する値の書き込み先. nullptrなら値を読み飛ばす.
+	int skipDepth = 0; ///< 読み飛ばしている値の深さ. 0なら読み飛ばしていない.
+	bool isDone = false; ///< ルートの値を受け取った.
+	std::string error; ///< エラー情報.
+};
+
+bool Bind(const char* data, const char* end, const TypeBinding& binding, void* target, std::string& error);
+
+/**
+* JSONデータを解析し、変数に直接書き込む.
+*
+* @param data   JSONデータの先頭.
+* @param end    JSONデータの終端.
+* @param target 書き込み先の変数.
+* @param error  エラー情報を格納する変数.
+*
+* @retval true  書き込み成功.
+* @retval false 書き込み失敗. errorにエラー情報が格納される.
+*/
+template<typename T>
+bool Bind(const char* data, const char* end, T& target, std::string& error)
+{
+	return Bind(data, end, Binding<T>::Get(), &target, error);
+}
+
+} // namespace Json
+
+/**
+* 構造体のメンバとJSONのキーの対応を定義する.
+*
+* 構造体の定義の中で使い、JSON_REQUIRED, JSON_OPTIONALで作成したFieldを並べる.
+* 対応表は定数として作成されるため、実行時の初期化は発生しない.
+*
+* @param type 構造体の型.
+*/
+#define JSON_FIELDS(type, ...) \
+	static Json::FieldList JsonFields() { \
+		typedef type JsonSelf; \
+		static constexpr Json::Field fields[] = { __VA_ARGS__ }; \
+		static_assert(sizeof(fields) / sizeof(fields[0]) <= 64, #type "のメンバが多すぎます"); \
+		return { #type, fields, sizeof(fields) / sizeof(fields[0]) }; \
+	}
+
+/**
+* JSON_FIELDSの中で、必須のメンバを定義する.
+*
+* @param member 構造体のメンバ.
+* @param key    JSONのキー(文字列リテラル).
+*/
+#define JSON_REQUIRED(member, key) \
+	{ key, sizeof(key) - 1, &Json::MemberOf<JsonSelf, decltype(JsonSelf::member), &JsonSelf::member>, \
+		&Json::Binding<decltype(JsonSelf::member)>::Get, true }
+
+/**
+* JSON_FIELDSの中で、省略可能なメンバを定義する.
+*
+* キーがなければメンバの値は変更されない.
+*
+* @param member 構造体のメンバ.
+* @param key    JSONのキー(文字列リテラル).
+*/
+#define JSON_OPTIONAL(member, key) \
+	{ key, sizeof(key) - 1, &Json::MemberOf<JsonSelf, decltype(JsonSelf::member), &JsonSelf::member>, \
+		&Json::Binding<decltype(JsonSelf::member)>::Get, false }
+
+#endif // EASY_JSONBIND_H_
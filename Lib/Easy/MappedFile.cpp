@@ -0,0 +1,97 @@
+/**
+* @file MappedFile.cpp
+*/
+#include "MappedFile.h"
+#include <iostream>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/**
+* ファイルをメモリ空間に割り当てる.
+*
+* @param filename ファイル名.
+*
+* @return 割り当てに成功した場合はMappedFileへのポインタを返す.
+*         失敗した場合はnullptrを返す.
+*
+* 大きさが0のファイルは割り当てられないため、Data()がnullptrでSize()が0のMappedFileを返す.
+*/
+MappedFilePtr MappedFile::Open(const char* filename)
+{
+  struct Impl : MappedFile { Impl() {} ~Impl() {} };
+  MappedFilePtr p = std::make_shared<Impl>();
+
+#ifdef _WIN32
+  const HANDLE hFile = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (hFile == INVALID_HANDLE_VALUE) {
+    return {};
+  }
+  LARGE_INTEGER fileSize;
+  if (!GetFileSizeEx(hFile, &fileSize)) {
+    CloseHandle(hFile);
+    return {};
+  }
+  if (fileSize.QuadPart == 0) {
+    CloseHandle(hFile);
+    return p;
+  }
+  // ビューが存在する間はマッピングオブジェクトも維持されるので、ハンドルはすぐに閉じてよい.
+  const HANDLE hMapping = CreateFileMappingA(hFile, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+  CloseHandle(hFile);
+  if (!hMapping) {
+    std::cerr << "ERROR: " << filename << "をメモリに割り当てられません(" << GetLastError() << ")." << std::endl;
+    return {};
+  }
+  void* view = MapViewOfFile(hMapping, FILE_MAP_COPY, 0, 0, 0);
+  CloseHandle(hMapping);
+  if (!view) {
+    std::cerr << "ERROR: " << filename << "をメモリに割り当てられません(" << GetLastError() << ")." << std::endl;
+    return {};
+  }
+  p->data = static_cast<uint8_t*>(view);
+  p->size = static_cast<size_t>(fileSize.QuadPart);
+#else
+  const int fd = open(filename, O_RDONLY);
+  if (fd < 0) {
+    return {};
+  }
+  struct stat st;
+  if (fstat(fd, &st)) {
+    close(fd);
+    return {};
+  }
+  if (st.st_size == 0) {
+    close(fd);
+    return p;
+  }
+  void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (view == MAP_FAILED) {
+    std::cerr << "ERROR: " << filename << "をメモリに割り当てられません." << std::endl;
+    return {};
+  }
+  p->data = static_cast<uint8_t*>(view);
+  p->size = static_cast<size_t>(st.st_size);
+#endif
+  return p;
+}
+
+/**
+* デストラクタ.
+*/
+MappedFile::~MappedFile()
+{
+  if (data) {
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+#else
+    munmap(data, size);
+#endif
+  }
+}
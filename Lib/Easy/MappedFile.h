@@ -0,0 +1,40 @@
+/**
+* @file MappedFile.h
+*/
+#ifndef MAPPEDFILE_H_INCLUDED
+#define MAPPEDFILE_H_INCLUDED
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+
+class MappedFile;
+typedef std::shared_ptr<MappedFile> MappedFilePtr; ///< メモリマップトファイルポインタ型.
+
+/**
+* ファイルをメモリ空間に割り当てるクラス.
+*
+* ファイルの内容は参照したページだけがOSによって読み込まれるため、
+* freadでバッファにコピーするより高速に、少ないメモリで大きなファイルを扱える.
+* 割り当てはコピーオンライトで行われる. Data()への書き込みはこのプロセス内にだけ反映され、
+* ファイルは変更されない.
+*/
+class MappedFile
+{
+public:
+  static MappedFilePtr Open(const char* filename);
+
+  const uint8_t* Data() const { return data; }
+  uint8_t* Data() { return data; }
+  size_t Size() const { return size; }
+
+private:
+  MappedFile() = default;
+  ~MappedFile();
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  uint8_t* data = nullptr; ///< 割り当てたメモリの先頭アドレス.
+  size_t size = 0; ///< ファイルのバイト数.
+};
+
+#endif // MAPPEDFILE_H_INCLUDED
@@ -6,7 +6,7 @@
 #include <algorithm>
 
 /**
-* fXgN^.
+* デストラクタ.
 */
 Node::~Node()
 {
@@ -21,9 +21,9 @@ Node::~Node()
 }
 
 /**
-* qm[hǉ.
+* 子ノードを追加する.
 *
-* @param node ǉqm[hւ̃|C^.
+* @param node 追加する子ノードへのポインタ.
 */
 void Node::AddChild(Node* node)
 {
@@ -33,9 +33,9 @@ void Node::AddChild(Node* node)
 }
 
 /**
-* qm[hO.
+* 子ノードを外す.
 *
-* @param node Oqm[hւ̃|C^.
+* @param node 外す子ノードへのポインタ.
 */
 void Node::RemoveChild(Node* node)
 {
@@ -48,9 +48,9 @@ void Node::RemoveChild(Node* node)
 }
 
 /**
-* m[h̏ԂċAIɍXV.
+* ノードの状態を再帰的に更新する.
 *
-* @param dt O̍XV̌oߎ.
+* @param dt 前回の更新からの経過時間.
 */
 void Node::UpdateRecursive(float dt)
 {
@@ -76,11 +76,11 @@ void Node::UpdateTransform()
 }
 
 /**
-* m[h̏ԂXV.
+* ノードの状態を更新する.
 *
-* @param dt O̍XV̌oߎ.
+* @param dt 前回の更新からの経過時間.
 *
-* m[h̍XV@ύXꍇ͂̊֐I[o[Ch܂B
+* ノードの更新方法を変更したい場合はこの関数をオーバーライドします。
 */
 void Node::Update(float dt)
 {
@@ -93,7 +93,7 @@ void Node::Update(float dt)
 }
 
 /**
-* Wϊs.
+* 座標変換を行う.
 */
 void Node::DoTransform()
 {
@@ -114,10 +114,10 @@ void Node::DoTransform()
 }
 
 /**
-* gEB[jOIuWFNgݒ肷.
+* トウィーニングオブジェクトを設定する.
 *
-* @param p gEB[jOIuWFNgւ̃|C^.
-*          gEB[jOɂnullptrw肷.
+* @param p トウィーニングオブジェクトへのポインタ.
+*          トウィーニングを解除するにはnullptrを指定する.
 */
 void Node::Tweener(const TweenAnimation::AnimatePtr& p)
 {
@@ -128,13 +128,13 @@ void Node::Tweener(const TweenAnimation::AnimatePtr& p)
 }
 
 /**
-* m[h`悷.
+* ノードを描画する.
 *
-* @param `s_[.
+* @param 描画を行うレンダラー.
 *
-* m[h̕`@ύXꍇ͂̊֐I[o[Ch܂B
+* ノードの描画方法を変更したい場合はこの関数をオーバーライドします。
 */
 void Node::Draw(SpriteRenderer& renderer) const
 {
-  // Ȃ.
+  // 何もしない.
 }
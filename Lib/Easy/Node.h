@@ -8,21 +8,21 @@
 #include <deque>
 #include <string>
 
-// s錾.
+// 先行宣言.
 class SpriteRenderer;
 
 /**
-* m[hNX.
+* ノードクラス.
 *
-* m[h́uV[\؍\(V[Ot)v\z邽߂̕ił.
-* V[Ot\zɂ́A܂{ɂem[h([gm[h)쐬A
-* addChildɂĎqm[hǉĂ܂.
+* ノードは「シーンを構成する木構造(シーングラフ)」を構築するための部品です.
+* シーングラフを構築するには、まず根本にあたる親ノード(ルートノード)を作成し、
+* addChildによって子ノードを追加していきます.
 * 
-* m[h̓V[Ot\邾ŁAɂ͉܂.
-* m[hɓʂȓꍇNodeNXhāAUpdate֐
-* Draw֐A邢̗͂I[o[ChĂ.
+* ノードはシーングラフを構成するだけで、他には何もしません.
+* ノードに特別な動きをさせたい場合はNodeクラスを派生させて、Update関数か
+* Draw関数、あるいはその両方をオーバーライドしてください.
 *
-* ʂɉ\ꍇNodeNXł͂ȂSpriteNXgpĂ.
+* 画面に何かを表示したい場合はNodeクラスではなくSpriteクラスを使用してください.
 *
 * @sa Sprite
 */
@@ -78,20 +78,20 @@ private:
   virtual void Draw(SpriteRenderer&) const;
   void DoTransform();
 
-  std::string name; ///< m[h.
-  glm::vec3 position; ///< m[h̍W.
-  glm::vec2 scale = glm::vec2(1, 1); ///< m[h̊gk.
+  std::string name; ///< ノード名.
+  glm::vec3 position; ///< ノードの座標.
+  glm::vec2 scale = glm::vec2(1, 1); ///< ノードの拡大縮小率.
   float rotation = 0; 
   float shear = 0;
 
   bool isDirtyTransformation = false;
-  glm::mat4x4 transform; ///< m[h̍Wϊs.
+  glm::mat4x4 transform; ///< ノードの座標変換行列.
   glm::vec3 worldPosition;
 
-  Node* parent = nullptr; ///< em[h.
-  std::deque<Node*> children; ///< qm[h̃Xg.
+  Node* parent = nullptr; ///< 親ノード.
+  std::deque<Node*> children; ///< 子ノードのリスト.
 
-  TweenAnimation::AnimatePtr tweener; ///< gEB[jO.
+  TweenAnimation::AnimatePtr tweener; ///< トウィーニング制御.
 };
 
 #endif // NODE_H_INCLUDED
\ No newline at end of file
@@ -0,0 +1,595 @@
+/**
+* @file Png.cpp
+*/
+#include "Png.h"
+#include "Inflate.h"
+#include <string.h>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define EASY_PNG_USE_SSE2
+#endif
+
+namespace Png {
+
+namespace /* unnamed */ {
+
+/// PNGファイルの先頭に置かれるシグネチャ.
+const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+
+/// 展開を受け付ける画像の最大ピクセル数.
+const uint64_t maxPixelCount = 1 << 28;
+
+/// 色の種類.
+enum ColorType {
+  ColorType_Gray = 0,
+  ColorType_RGB = 2,
+  ColorType_Palette = 3,
+  ColorType_GrayAlpha = 4,
+  ColorType_RGBA = 6,
+};
+
+/// 行ごとのフィルタの種類.
+enum FilterType {
+  FilterType_None,
+  FilterType_Sub,
+  FilterType_Up,
+  FilterType_Average,
+  FilterType_Paeth,
+};
+
+/// Adam7インターレースの各パスの開始位置と間隔.
+const uint32_t adam7XStart[7] = { 0, 4, 0, 2, 0, 1, 0 };
+const uint32_t adam7YStart[7] = { 0, 0, 4, 0, 2, 0, 1 };
+const uint32_t adam7XStep[7] = { 8, 8, 4, 4, 2, 2, 1 };
+const uint32_t adam7YStep[7] = { 8, 8, 8, 4, 4, 2, 2 };
+
+/**
+* ビッグエンディアンの32ビット整数を読み込む.
+*/
+uint32_t ReadU32(const uint8_t* p)
+{
+  return (static_cast<uint32_t>(p[0]) << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+/**
+* 展開に必要な画像の情報.
+*/
+struct Header
+{
+  uint32_t width = 0;
+  uint32_t height = 0;
+  int bitDepth = 0;
+  int colorType = 0;
+  int interlace = 0;
+  int channels = 0; ///< 1ピクセルあたりのサンプル数.
+  int bitsPerPixel = 0;
+  int filterBpp = 0; ///< フィルタが参照する左のピクセルまでのバイト数.
+
+  bool hasColorKey = false; ///< グレースケールとRGBで透明色が指定されているか.
+  uint16_t colorKey[3] = {}; ///< 透明色.
+
+  /// パレットとグレースケール(8ビット以下)の値をRGBAに変換する表.
+  uint8_t lut[256 * 4];
+};
+
+/**
+* IHDRチャンクを読み込む.
+*
+* @param p      IHDRチャンクのデータ.
+* @param length pのバイト数.
+* @param header 読み込んだ情報を格納する変数.
+*
+* @retval true  読み込み成功.
+* @retval false 対応していない形式か、値が不正.
+*/
+bool ReadHeader(const uint8_t* p, uint32_t length, Header& header)
+{
+  if (length != 13) {
+    return false;
+  }
+  header.width = ReadU32(p);
+  header.height = ReadU32(p + 4);
+  header.bitDepth = p[8];
+  header.colorType = p[9];
+  header.interlace = p[12];
+  if (header.width == 0 || header.height == 0 || header.width > 0x7fffffff || header.height > 0x7fffffff) {
+    return false;
+  }
+  if (static_cast<uint64_t>(header.width) * header.height > maxPixelCount) {
+    return false;
+  }
+  if (p[10] != 0 || p[11] != 0 || header.interlace > 1) {
+    return false;
+  }
+  const int depth = header.bitDepth;
+  switch (header.colorType) {
+  case ColorType_Gray:
+    header.channels = 1;
+    if (depth != 1 && depth != 2 && depth != 4 && depth != 8 && depth != 16) {
+      return false;
+    }
+    break;
+  case ColorType_Palette:
+    header.channels = 1;
+    if (depth != 1 && depth != 2 && depth != 4 && depth != 8) {
+      return false;
+    }
+    break;
+  case ColorType_RGB: header.channels = 3; break;
+  case ColorType_GrayAlpha: header.channels = 2; break;
+  case ColorType_RGBA: header.channels = 4; break;
+  default:
+    return false;
+  }
+  if (header.channels > 1 && depth != 8 && depth != 16) {
+    return false;
+  }
+  header.bitsPerPixel = header.channels * depth;
+  header.filterBpp = header.bitsPerPixel < 8 ? 1 : header.bitsPerPixel / 8;
+
+  // グレースケールの変換表を作る. パレットの場合はPLTEチャンクで上書きされる.
+  if (depth <= 8) {
+    const int maxValue = (1 << depth) - 1;
+    for (int i = 0; i <= maxValue; ++i) {
+      const uint8_t gray = header.colorType == ColorType_Gray ? static_cast<uint8_t>(i * 255 / maxValue) : 0;
+      uint8_t* e = header.lut + i * 4;
+      e[0] = e[1] = e[2] = gray;
+      e[3] = 255;
+    }
+  }
+  return true;
+}
+
+/**
+* 1行分のピクセルの大きさ(フィルタの種類を除く)を求める.
+*/
+size_t GetStride(const Header& header, uint32_t width)
+{
+  return (static_cast<size_t>(width) * header.bitsPerPixel + 7) / 8;
+}
+
+/**
+* Paeth予測子.
+*/
+inline int PaethPredictor(int a, int b, int c)
+{
+  const int p = a + b - c;
+  const int pa = p > a ? p - a : a - p;
+  const int pb = p > b ? p - b : b - p;
+  const int pc = p > c ? p - c : c - p;
+  if (pa <= pb && pa <= pc) {
+    return a;
+  } else if (pb <= pc) {
+    return b;
+  }
+  return c;
+}
+
+/**
+* フィルタを1行分だけ元に戻す(任意のピクセルの大きさ).
+*/
+void UnfilterScalar(int filterType, uint8_t* row, const uint8_t* prev, size_t stride, size_t bpp)
+{
+  switch (filterType) {
+  case FilterType_Sub:
+    for (size_t i = bpp; i < stride; ++i) {
+      row[i] = static_cast<uint8_t>(row[i] + row[i - bpp]);
+    }
+    break;
+  case FilterType_Up:
+    for (size_t i = 0; i < stride; ++i) {
+      row[i] = static_cast<uint8_t>(row[i] + prev[i]);
+    }
+    break;
+  case FilterType_Average:
+    for (size_t i = 0; i < bpp; ++i) {
+      row[i] = static_cast<uint8_t>(row[i] + (prev[i] >> 1));
+    }
+    for (size_t i = bpp; i < stride; ++i) {
+      row[i] = static_cast<uint8_t>(row[i] + ((row[i - bpp] + prev[i]) >> 1));
+    }
+    break;
+  case FilterType_Paeth:
+    for (size_t i = 0; i < bpp; ++i) {
+      row[i] = static_cast<uint8_t>(row[i] + prev[i]);
+    }
+    for (size_t i = bpp; i < stride; ++i) {
+      row[i] = static_cast<uint8_t>(row[i] + PaethPredictor(row[i - bpp], prev[i], prev[i - bpp]));
+    }
+    break;
+  }
+}
+
+#ifdef EASY_PNG_USE_SSE2
+/**
+* 1ピクセル(3または4バイト)をSSEレジスタの下位に読み込む.
+*/
+template<int Bpp>
+inline __m128i LoadPixel(const uint8_t* p)
+{
+  int32_t v = 0;
+  memcpy(&v, p, Bpp);
+  return _mm_cvtsi32_si128(v);
+}
+
+/**
+* SSEレジスタの下位から1ピクセル(3または4バイト)を書き込む.
+*/
+template<int Bpp>
+inline void StorePixel(uint8_t* p, __m128i v)
+{
+  const int32_t x = _mm_cvtsi128_si32(v);
+  memcpy(p, &x, Bpp);
+}
+
+/**
+* SSE2でフィルタを1行分だけ元に戻す(8ビットのRGBとRGBA).
+*
+* Sub、Average、Paethは左のピクセルに依存するので、ピクセルの全チャンネルを同時に処理する.
+*/
+template<int Bpp>
+void UnfilterSSE2(int filterType, uint8_t* row, const uint8_t* prev, size_t stride)
+{
+  const __m128i zero = _mm_setzero_si128();
+  switch (filterType) {
+  case FilterType_Sub: {
+    __m128i a = zero;
+    for (size_t i = 0; i < stride; i += Bpp) {
+      a = _mm_add_epi8(a, LoadPixel<Bpp>(row + i));
+      StorePixel<Bpp>(row + i, a);
+    }
+    break;
+  }
+  case FilterType_Up: {
+    size_t i = 0;
+    for (; i + 16 <= stride; i += 16) {
+      const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+      const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev + i));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(row + i), _mm_add_epi8(x, b));
+    }
+    for (; i < stride; ++i) {
+      row[i] = static_cast<uint8_t>(row[i] + prev[i]);
+    }
+    break;
+  }
+  case FilterType_Average: {
+    // _mm_avg_epu8は切り上げるので、両者の和が奇数の場合は1を引いて切り捨てにする.
+    const __m128i one = _mm_set1_epi8(1);
+    __m128i a = zero;
+    for (size_t i = 0; i < stride; i += Bpp) {
+      const __m128i b = LoadPixel<Bpp>(prev + i);
+      const __m128i avg = _mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), one));
+      a = _mm_add_epi8(LoadPixel<Bpp>(row + i), avg);
+      StorePixel<Bpp>(row + i, a);
+    }
+    break;
+  }
+  case FilterType_Paeth: {
+    // 16ビットに広げて、3つの距離の最小値と一致するものを優先順位(a, b, c)の順に選ぶ.
+    const __m128i lowByte = _mm_set1_epi16(0xff);
+    __m128i a = zero;
+    __m128i c = zero;
+    for (size_t i = 0; i < stride; i += Bpp) {
+      const __m128i b = _mm_unpacklo_epi8(LoadPixel<Bpp>(prev + i), zero);
+      const __m128i x = _mm_unpacklo_epi8(LoadPixel<Bpp>(row + i), zero);
+      __m128i pa = _mm_sub_epi16(b, c);
+      __m128i pb = _mm_sub_epi16(a, c);
+      __m128i pc = _mm_add_epi16(pa, pb);
+      pa = _mm_max_epi16(pa, _mm_sub_epi16(zero, pa));
+      pb = _mm_max_epi16(pb, _mm_sub_epi16(zero, pb));
+      pc = _mm_max_epi16(pc, _mm_sub_epi16(zero, pc));
+      const __m128i smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+      const __m128i useA = _mm_cmpeq_epi16(smallest, pa);
+      const __m128i useB = _mm_cmpeq_epi16(smallest, pb);
+      const __m128i bc = _mm_or_si128(_mm_and_si128(useB, b), _mm_andnot_si128(useB, c));
+      const __m128i predictor = _mm_or_si128(_mm_and_si128(useA, a), _mm_andnot_si128(useA, bc));
+      const __m128i d = _mm_packus_epi16(_mm_and_si128(_mm_add_epi16(x, predictor), lowByte), zero);
+      StorePixel<Bpp>(row + i, d);
+      a = _mm_unpacklo_epi8(d, zero);
+      c = b;
+    }
+    break;
+  }
+  }
+}
+#endif // EASY_PNG_USE_SSE2
+
+/**
+* フィルタを1行分だけ元に戻す.
+*
+* @param filterType フィルタの種類.
+* @param row        フィルタを戻す行.
+* @param prev       ひとつ上の行(フィルタを戻したもの).
+* @param stride     1行のバイト数.
+* @param bpp        フィルタが参照する左のピクセルまでのバイト数.
+*
+* @retval true  成功.
+* @retval false フィルタの種類が不正.
+*/
+bool Unfilter(int filterType, uint8_t* row, const uint8_t* prev, size_t stride, int bpp)
+{
+  if (filterType > FilterType_Paeth) {
+    return false;
+  }
+  if (filterType == FilterType_None) {
+    return true;
+  }
+#ifdef EASY_PNG_USE_SSE2
+  if (bpp == 4) {
+    UnfilterSSE2<4>(filterType, row, prev, stride);
+    return true;
+  } else if (bpp == 3) {
+    UnfilterSSE2<3>(filterType, row, prev, stride);
+    return true;
+  }
+#endif
+  UnfilterScalar(filterType, row, prev, stride, bpp);
+  return true;
+}
+
+/**
+* フィルタを戻した1行分のピクセルをRGBA8に変換して出力する.
+*
+* @param header 画像の情報.
+* @param src    フィルタを戻した行.
+* @param count  行のピクセル数.
+* @param dst    出力先.
+* @param step   出力するピクセルの間隔(バイト数).
+*/
+void ExpandRow(const Header& header, const uint8_t* src, uint32_t count, uint8_t* dst, size_t step)
+{
+  const int depth = header.bitDepth;
+  if (depth < 8) {
+    const int mask = (1 << depth) - 1;
+    const int perByte = 8 / depth;
+    for (uint32_t i = 0; i < count; ++i, dst += step) {
+      const int shift = 8 - depth * (static_cast<int>(i % perByte) + 1);
+      memcpy(dst, header.lut + ((src[i / perByte] >> shift) & mask) * 4, 4);
+    }
+    return;
+  }
+  if (depth == 8) {
+    switch (header.colorType) {
+    case ColorType_Gray:
+    case ColorType_Palette:
+      for (uint32_t i = 0; i < count; ++i, dst += step) {
+        memcpy(dst, header.lut + src[i] * 4, 4);
+      }
+      break;
+    case ColorType_RGB:
+      if (header.hasColorKey) {
+        const uint16_t* key = header.colorKey;
+        for (uint32_t i = 0; i < count; ++i, src += 3, dst += step) {
+          dst[0] = src[0];
+          dst[1] = src[1];
+          dst[2] = src[2];
+          dst[3] = (src[0] == key[0] && src[1] == key[1] && src[2] == key[2]) ? 0 : 255;
+        }
+      } else {
+        for (uint32_t i = 0; i < count; ++i, src += 3, dst += step) {
+          dst[0] = src[0];
+          dst[1] = src[1];
+          dst[2] = src[2];
+          dst[3] = 255;
+        }
+      }
+      break;
+    case ColorType_GrayAlpha:
+      for (uint32_t i = 0; i < count; ++i, src += 2, dst += step) {
+        dst[0] = dst[1] = dst[2] = src[0];
+        dst[3] = src[1];
+      }
+      break;
+    case ColorType_RGBA:
+      if (step == 4) {
+        memcpy(dst, src, static_cast<size_t>(count) * 4);
+      } else {
+        for (uint32_t i = 0; i < count; ++i, src += 4, dst += step) {
+          memcpy(dst, src, 4);
+        }
+      }
+      break;
+    }
+    return;
+  }
+
+  // 16ビットの場合は上位バイトを使う. 透明色は16ビットのまま比較する.
+  const int channels = header.channels;
+  const uint16_t* key = header.colorKey;
+  for (uint32_t i = 0; i < count; ++i, src += channels * 2, dst += step) {
+    switch (header.colorType) {
+    case ColorType_Gray:
+      dst[0] = dst[1] = dst[2] = src[0];
+      dst[3] = (header.hasColorKey && ((src[0] << 8) | src[1]) == key[0]) ? 0 : 255;
+      break;
+    case ColorType_RGB:
+      dst[0] = src[0];
+      dst[1] = src[2];
+      dst[2] = src[4];
+      dst[3] = (header.hasColorKey && ((src[0] << 8) | src[1]) == key[0] &&
+        ((src[2] << 8) | src[3]) == key[1] && ((src[4] << 8) | src[5]) == key[2]) ? 0 : 255;
+      break;
+    case ColorType_GrayAlpha:
+      dst[0] = dst[1] = dst[2] = src[0];
+      dst[3] = src[2];
+      break;
+    case ColorType_RGBA:
+      dst[0] = src[0];
+      dst[1] = src[2];
+      dst[2] = src[4];
+      dst[3] = src[6];
+      break;
+    }
+  }
+}
+
+} // unnamed namespace
+
+/**
+* データがPNG形式かどうか調べる.
+*
+* @param data 調べるデータ.
+* @param size dataのバイト数.
+*
+* @retval true  PNGのシグネチャで始まっている.
+* @retval false PNG形式ではない.
+*/
+bool IsPng(const void* data, size_t size)
+{
+  return size >= sizeof(signature) && memcmp(data, signature, sizeof(signature)) == 0;
+}
+
+/**
+* PNG画像をRGBA8形式に展開する.
+*
+* @param data   PNGファイルの内容.
+* @param size   dataのバイト数.
+* @param width  画像の幅を格納する変数.
+* @param height 画像の高さを格納する変数.
+* @param pixels 展開したピクセルを格納する配列. 下の行から順に並ぶ.
+*
+* @retval true  展開成功.
+* @retval false 対応していない形式か、データが壊れている.
+*
+* フィルタを戻した行は、すぐにRGBA8へ変換して上下反転した位置へ書き込む.
+* そのため、上下反転やチャンネル変換のために画像全体をもう一度走査することはない.
+*/
+bool Decode(const void* data, size_t size, int& width, int& height, std::vector<uint8_t>& pixels)
+{
+  if (!IsPng(data, size)) {
+    return false;
+  }
+  const uint8_t* p = static_cast<const uint8_t*>(data) + sizeof(signature);
+  const uint8_t* const end = static_cast<const uint8_t*>(data) + size;
+
+  Header header;
+  bool hasHeader = false;
+  int paletteSize = 0;
+  std::vector<uint8_t> idatBuffer;
+  const uint8_t* idat = nullptr;
+  size_t idatSize = 0;
+  for (;;) {
+    if (end - p < 12) {
+      return false;
+    }
+    const uint32_t length = ReadU32(p);
+    if (length > static_cast<size_t>(end - p) - 12) {
+      return false;
+    }
+    const uint8_t* const type = p + 4;
+    const uint8_t* const body = p + 8;
+    p = body + length + 4;
+    if (!hasHeader) {
+      if (memcmp(type, "IHDR", 4) != 0 || !ReadHeader(body, length, header)) {
+        return false;
+      }
+      hasHeader = true;
+    } else if (memcmp(type, "PLTE", 4) == 0) {
+      if (length % 3 || length > 256 * 3) {
+        return false;
+      }
+      if (header.colorType == ColorType_Palette) {
+        paletteSize = static_cast<int>(length / 3);
+        for (int i = 0; i < paletteSize; ++i) {
+          memcpy(header.lut + i * 4, body + i * 3, 3);
+        }
+      }
+    } else if (memcmp(type, "tRNS", 4) == 0) {
+      if (header.colorType == ColorType_Palette) {
+        if (static_cast<int>(length) > paletteSize) {
+          return false;
+        }
+        for (uint32_t i = 0; i < length; ++i) {
+          header.lut[i * 4 + 3] = body[i];
+        }
+      } else if (header.colorType == ColorType_Gray && length == 2) {
+        header.hasColorKey = true;
+        header.colorKey[0] = static_cast<uint16_t>((body[0] << 8) | body[1]);
+        if (header.bitDepth <= 8 && header.colorKey[0] < (1 << header.bitDepth)) {
+          header.lut[header.colorKey[0] * 4 + 3] = 0;
+        }
+      } else if (header.colorType == ColorType_RGB && length == 6) {
+        header.hasColorKey = true;
+        for (int i = 0; i < 3; ++i) {
+          header.colorKey[i] = static_cast<uint16_t>((body[i * 2] << 8) | body[i * 2 + 1]);
+        }
+      }
+    } else if (memcmp(type, "IDAT", 4) == 0) {
+      // IDATがひとつだけならファイルの内容をそのまま展開する.
+      if (!idat) {
+        idat = body;
+        idatSize = length;
+      } else {
+        if (idatBuffer.empty()) {
+          idatBuffer.assign(idat, idat + idatSize);
+        }
+        idatBuffer.insert(idatBuffer.end(), body, body + length);
+        idat = idatBuffer.data();
+        idatSize = idatBuffer.size();
+      }
+    } else if (memcmp(type, "IEND", 4) == 0) {
+      break;
+    } else if (!(type[0] & 0x20)) {
+      // 補助チャンクでなければ読み飛ばすことはできない.
+      return false;
+    }
+  }
+  if (!idat || (header.colorType == ColorType_Palette && paletteSize == 0)) {
+    return false;
+  }
+
+  // 各パスの大きさを求める. インターレースでなければ画像全体をひとつのパスとして扱う.
+  const int passCount = header.interlace ? 7 : 1;
+  uint32_t passWidth[7], passHeight[7];
+  size_t filteredSize = 0;
+  for (int pass = 0; pass < passCount; ++pass) {
+    if (header.interlace) {
+      const uint32_t xs = adam7XStart[pass], ys = adam7YStart[pass];
+      passWidth[pass] = header.width > xs ? (header.width - xs + adam7XStep[pass] - 1) / adam7XStep[pass] : 0;
+      passHeight[pass] = header.height > ys ? (header.height - ys + adam7YStep[pass] - 1) / adam7YStep[pass] : 0;
+    } else {
+      passWidth[pass] = header.width;
+      passHeight[pass] = header.height;
+    }
+    if (passWidth[pass] && passHeight[pass]) {
+      filteredSize += (GetStride(header, passWidth[pass]) + 1) * passHeight[pass];
+    }
+  }
+
+  std::vector<uint8_t> filtered(filteredSize);
+  size_t written;
+  if (!Inflate::Decompress(Inflate::Format_Zlib, idat, idatSize, filtered.data(), filteredSize, written) || written != filteredSize) {
+    return false;
+  }
+
+  pixels.resize(static_cast<size_t>(header.width) * header.height * 4);
+  const size_t dstPitch = static_cast<size_t>(header.width) * 4;
+  const std::vector<uint8_t> zeroRow(GetStride(header, header.width));
+  uint8_t* row = filtered.data();
+  for (int pass = 0; pass < passCount; ++pass) {
+    if (!passWidth[pass] || !passHeight[pass]) {
+      continue;
+    }
+    const size_t stride = GetStride(header, passWidth[pass]);
+    const uint32_t xStart = header.interlace ? adam7XStart[pass] : 0;
+    const uint32_t yStart = header.interlace ? adam7YStart[pass] : 0;
+    const uint32_t xStep = header.interlace ? adam7XStep[pass] : 1;
+    const uint32_t yStep = header.interlace ? adam7YStep[pass] : 1;
+    const uint8_t* prev = zeroRow.data();
+    for (uint32_t y = 0; y < passHeight[pass]; ++y) {
+      if (!Unfilter(row[0], row + 1, prev, stride, header.filterBpp)) {
+        return false;
+      }
+      const uint32_t dstY = header.height - 1 - (yStart + y * yStep);
+      ExpandRow(header, row + 1, passWidth[pass], pixels.data() + dstY * dstPitch + xStart * 4, xStep * 4);
+      prev = row + 1;
+      row += stride + 1;
+    }
+  }
+  width = static_cast<int>(header.width);
+  height = static_cast<int>(header.height);
+  return true;
+}
+
+} // namespace Png
@@ -0,0 +1,24 @@
+/**
+* @file Png.h
+*/
+#ifndef PNG_H_INCLUDED
+#define PNG_H_INCLUDED
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+/**
+* PNG画像を展開する機能を格納する名前空間.
+*
+* すべての形式(グレースケール、パレット、アルファ付き、1～16ビット、インターレース)をRGBA8に変換して出力する.
+* OpenGLのテクスチャ座標系に合わせて、出力する画像は下の行から並べる.
+* 関数は状態を持たないので、異なる画像を複数のスレッドから同時に展開することができる.
+*/
+namespace Png {
+
+bool IsPng(const void* data, size_t size);
+bool Decode(const void* data, size_t size, int& width, int& height, std::vector<uint8_t>& pixels);
+
+} // namespace Png
+
+#endif // PNG_H_INCLUDED
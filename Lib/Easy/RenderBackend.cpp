@@ -0,0 +1,829 @@
+/**
+* @file RenderBackend.cpp
+*/
+#include "RenderBackend.h"
+#include <iostream>
+#include <algorithm>
+#include <string.h>
+#include <ctype.h>
+#include <stdlib.h>
+
+namespace RenderBackend {
+
+namespace /* unnamed */ {
+
+/**
+* シェーダコードをコンパイルする.
+*
+* @param type シェーダの種類.
+* @param string シェーダコードへのポインタ.
+*
+* @return 作成したシェーダオブジェクト.
+*/
+GLuint CompileShader(GLenum type, const GLchar* string)
+{
+  GLuint shader = glCreateShader(type);
+  glShaderSource(shader, 1, &string, nullptr);
+  glCompileShader(shader);
+  GLint compiled = 0;
+  glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+  if (!compiled) {
+    GLint infoLen = 0;
+    glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &infoLen);
+    if (infoLen) {
+      std::vector<char> buf;
+      buf.resize(infoLen);
+      if (static_cast<int>(buf.size()) >= infoLen) {
+        glGetShaderInfoLog(shader, infoLen, NULL, buf.data());
+        std::cerr << "ERROR: シェーダのコンパイルに失敗￥n" << buf.data() << std::endl;
+      }
+    }
+    glDeleteShader(shader);
+    return 0;
+  }
+  return shader;
+}
+
+/**
+* OpenGLを呼び出すバックエンド.
+*/
+class GLBackend : public Backend
+{
+public:
+  GLBackend() = default;
+  ~GLBackend() = default;
+
+  GLuint CreateProgram(const GLchar* vsCode, const GLchar* fsCode) override
+  {
+    GLuint vs = CompileShader(GL_VERTEX_SHADER, vsCode);
+    GLuint fs = CompileShader(GL_FRAGMENT_SHADER, fsCode);
+    if (!vs || !fs) {
+      return 0;
+    }
+    GLuint program = glCreateProgram();
+    glAttachShader(program, fs);
+    glDeleteShader(fs);
+    glAttachShader(program, vs);
+    glDeleteShader(vs);
+    glLinkProgram(program);
+    GLint linkStatus = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
+    if (linkStatus != GL_TRUE) {
+      GLint infoLen = 0;
+      glGetProgramiv(program, GL_INFO_LOG_LENGTH, &infoLen);
+      if (infoLen) {
+        std::vector<char> buf;
+        buf.resize(infoLen);
+        if (static_cast<int>(buf.size()) >= infoLen) {
+          glGetProgramInfoLog(program, infoLen, NULL, buf.data());
+          std::cerr << "ERROR: シェーダのリンクに失敗￥n" << buf.data() << std::endl;
+        }
+      }
+      glDeleteProgram(program);
+      return 0;
+    }
+    return program;
+  }
+
+  void DeleteProgram(GLuint program) override
+  {
+    glDeleteProgram(program);
+  }
+
+  void GetActiveUniforms(GLuint program, std::vector<UniformInfo>& list) override
+  {
+    GLint activeUniforms = 0;
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &activeUniforms);
+    list.clear();
+    list.reserve(activeUniforms);
+    for (int i = 0; i < activeUniforms; ++i) {
+      UniformInfo info;
+      GLchar uniformName[128];
+      glGetActiveUniform(program, i, sizeof(uniformName), nullptr, &info.size, &info.type, uniformName);
+      info.name = uniformName;
+      info.location = glGetUniformLocation(program, uniformName);
+      list.push_back(info);
+    }
+  }
+
+  void GetActiveUniformBlocks(GLuint program, std::vector<std::string>& list) override
+  {
+    GLint activeBlocks = 0;
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &activeBlocks);
+    list.clear();
+    list.reserve(activeBlocks);
+    for (int i = 0; i < activeBlocks; ++i) {
+      GLchar blockName[128];
+      glGetActiveUniformBlockName(program, i, sizeof(blockName), nullptr, blockName);
+      list.push_back(blockName);
+    }
+  }
+
+  void ProgramUniform1i(GLuint program, GLint location, GLint value) override
+  {
+    glProgramUniform1i(program, location, value);
+  }
+
+  void ProgramUniform4iv(GLuint program, GLint location, const GLint* value) override
+  {
+    glProgramUniform4iv(program, location, 1, value);
+  }
+
+  void ProgramUniform4fv(GLuint program, GLint location, const GLfloat* value) override
+  {
+    glProgramUniform4fv(program, location, 1, value);
+  }
+
+  void UniformBlockBinding(GLuint program, GLuint blockIndex, GLuint bindingPoint) override
+  {
+    glUniformBlockBinding(program, blockIndex, bindingPoint);
+  }
+
+  void UseProgram(GLuint program) override
+  {
+    glUseProgram(program);
+  }
+
+  GLuint CreateBuffer(GLenum target, GLsizeiptr size, const GLvoid* data, GLenum usage) override
+  {
+    GLuint id = 0;
+    glGenBuffers(1, &id);
+    glBindBuffer(target, id);
+    glBufferData(target, size, data, usage);
+    glBindBuffer(target, 0);
+    return id;
+  }
+
+  void DeleteBuffer(GLuint buffer) override
+  {
+    glDeleteBuffers(1, &buffer);
+  }
+
+  void BufferSubData(GLenum target, GLuint buffer, GLintptr offset, GLsizeiptr size, const GLvoid* data) override
+  {
+    glBindBuffer(target, buffer);
+    glBufferSubData(target, offset, size, data);
+  }
+
+  void* MapBufferRange(GLenum target, GLuint buffer, GLintptr offset, GLsizeiptr size, GLbitfield access) override
+  {
+    glBindBuffer(target, buffer);
+    void* p = glMapBufferRange(target, offset, size, access);
+    glBindBuffer(target, 0);
+    return p;
+  }
+
+  bool UnmapBuffer(GLenum target, GLuint buffer) override
+  {
+    glBindBuffer(target, buffer);
+    const GLboolean result = glUnmapBuffer(target);
+    glBindBuffer(target, 0);
+    return result == GL_TRUE;
+  }
+
+  void CopyBufferSubData(GLuint src, GLuint dst, GLintptr srcOffset, GLintptr dstOffset, GLsizeiptr size) override
+  {
+    glBindBuffer(GL_COPY_READ_BUFFER, src);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, dst);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, srcOffset, dstOffset, size);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+  }
+
+  void BindBufferBase(GLenum target, GLuint index, GLuint buffer) override
+  {
+    glBindBufferBase(target, index, buffer);
+  }
+
+  void BindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) override
+  {
+    glBindBufferRange(target, index, buffer, offset, size);
+  }
+
+  // VAOの設定中は割り当てを変更するが、終わったら元のVAOに戻す(GLStateの記録を壊さないため).
+  GLuint CreateVertexArray(GLuint vbo, GLuint ibo) override
+  {
+    GLint prevVao = 0;
+    glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &prevVao);
+    GLuint id = 0;
+    glGenVertexArrays(1, &id);
+    glBindVertexArray(id);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+    glBindVertexArray(prevVao);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return id;
+  }
+
+  void VertexAttribPointer(GLuint vao, GLuint vbo, const VertexAttribute& attr) override
+  {
+    GLint prevVao = 0;
+    glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &prevVao);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glEnableVertexAttribArray(attr.index);
+    if (attr.isInteger) {
+      glVertexAttribIPointer(attr.index, attr.size, attr.type, attr.stride, reinterpret_cast<GLvoid*>(attr.offset));
+    } else {
+      glVertexAttribPointer(attr.index, attr.size, attr.type, attr.normalized, attr.stride, reinterpret_cast<GLvoid*>(attr.offset));
+    }
+    glBindVertexArray(prevVao);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+  }
+
+  void DeleteVertexArray(GLuint vao) override
+  {
+    glDeleteVertexArrays(1, &vao);
+  }
+
+  void BindVertexArray(GLuint vao) override
+  {
+    glBindVertexArray(vao);
+  }
+
+  GLuint CreateTexture() override
+  {
+    GLuint id = 0;
+    glGenTextures(1, &id);
+    return id;
+  }
+
+  void DeleteTexture(GLuint texture) override
+  {
+    glDeleteTextures(1, &texture);
+  }
+
+  void ActiveTexture(GLenum unit) override
+  {
+    glActiveTexture(unit);
+  }
+
+  void BindTexture(GLenum target, GLuint texture) override
+  {
+    glBindTexture(target, texture);
+  }
+
+  void TexImage2D(GLenum target, GLint level, GLint iformat, GLsizei width, GLsizei height, GLenum format, GLenum type, const GLvoid* data) override
+  {
+    glTexImage2D(target, level, iformat, width, height, 0, format, type, data);
+  }
+
+  void TexSubImage2D(GLenum target, GLint level, GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, const GLvoid* data) override
+  {
+    glTexSubImage2D(target, level, x, y, width, height, format, type, data);
+  }
+
+  // ピクセルバッファからの転送中だけGL_PIXEL_UNPACK_BUFFERを割り当てる(他の転送に影響させないため).
+  void TexSubImage2DFromBuffer(GLenum target, GLint level, GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, GLuint buffer, size_t offset) override
+  {
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+    glTexSubImage2D(target, level, x, y, width, height, format, type, reinterpret_cast<const GLvoid*>(offset));
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  }
+
+  void CompressedTexImage2D(GLenum target, GLint level, GLenum iformat, GLsizei width, GLsizei height, GLsizei imageSize, const GLvoid* data) override
+  {
+    glCompressedTexImage2D(target, level, iformat, width, height, 0, imageSize, data);
+  }
+
+  void TexParameteri(GLenum target, GLenum pname, GLint param) override
+  {
+    glTexParameteri(target, pname, param);
+  }
+
+  void Enable(GLenum cap) override
+  {
+    glEnable(cap);
+  }
+
+  void Disable(GLenum cap) override
+  {
+    glDisable(cap);
+  }
+
+  void BlendFunc(GLenum sfactor, GLenum dfactor) override
+  {
+    glBlendFunc(sfactor, dfactor);
+  }
+
+  void DrawElements(GLenum mode, GLsizei count, GLenum type, size_t offset) override
+  {
+    glDrawElements(mode, count, type, reinterpret_cast<const GLvoid*>(offset));
+  }
+
+  GLenum GetError() override
+  {
+    return glGetError();
+  }
+
+  GLint GetInteger(GLenum pname) override
+  {
+    GLint value = 0;
+    glGetIntegerv(pname, &value);
+    return value;
+  }
+};
+
+BackendPtr currentBackend; ///< 現在のバックエンド.
+
+/**
+* シェーダソースからコメントを取り除く.
+*
+* @param code シェーダソース.
+*
+* @return コメントを空白に置き換えたシェーダソース.
+*/
+std::string StripComment(const char* code)
+{
+  std::string s = code;
+  for (size_t i = 0; i + 1 < s.size(); ++i) {
+    if (s[i] == '/' && s[i + 1] == '/') {
+      while (i < s.size() && s[i] != '\n') {
+        s[i++] = ' ';
+      }
+    } else if (s[i] == '/' && s[i + 1] == '*') {
+      while (i < s.size() && !(s[i] == '*' && i + 1 < s.size() && s[i + 1] == '/')) {
+        s[i++] = ' ';
+      }
+      if (i < s.size()) {
+        s[i] = ' ';
+        if (i + 1 < s.size()) {
+          s[i + 1] = ' ';
+        }
+      }
+    }
+  }
+  return s;
+}
+
+/**
+* シェーダソースを単語と記号に分割する.
+*
+* @param code シェーダソース.
+*
+* @return 単語と記号のリスト. 配列の添字("[3]"等)は直前の単語に含まれる.
+*/
+std::vector<std::string> Tokenize(const std::string& code)
+{
+  std::vector<std::string> tokens;
+  for (size_t i = 0; i < code.size();) {
+    const char c = code[i];
+    if (isspace(static_cast<unsigned char>(c))) {
+      ++i;
+    } else if (isalnum(static_cast<unsigned char>(c)) || c == '_') {
+      const size_t begin = i;
+      while (i < code.size() && (isalnum(static_cast<unsigned char>(code[i])) || code[i] == '_' || code[i] == '[' || code[i] == ']')) {
+        ++i;
+      }
+      tokens.push_back(code.substr(begin, i - begin));
+    } else {
+      tokens.push_back(std::string(1, c));
+      ++i;
+    }
+  }
+  return tokens;
+}
+
+/**
+* GLSLの型名をOpenGLの型定数に変換する.
+*
+* @param name 型名.
+*
+* @return nameに対応する型定数. 対応する定数がなければ0.
+*/
+GLenum ToUniformType(const std::string& name)
+{
+  static const struct {
+    const char* name;
+    GLenum type;
+  } typeList[] = {
+    { "float", GL_FLOAT }, { "vec2", GL_FLOAT_VEC2 }, { "vec3", GL_FLOAT_VEC3 }, { "vec4", GL_FLOAT_VEC4 },
+    { "int", GL_INT }, { "ivec2", GL_INT_VEC2 }, { "ivec3", GL_INT_VEC3 }, { "ivec4", GL_INT_VEC4 },
+    { "mat3", GL_FLOAT_MAT3 }, { "mat3x3", GL_FLOAT_MAT3 }, { "mat4", GL_FLOAT_MAT4 }, { "mat4x4", GL_FLOAT_MAT4 },
+    { "sampler2D", GL_SAMPLER_2D }, { "samplerCube", GL_SAMPLER_CUBE }, { "isampler2D", GL_INT_SAMPLER_2D },
+    { "uint", GL_UNSIGNED_INT }, { "usampler2D", GL_UNSIGNED_INT_SAMPLER_2D },
+  };
+  for (const auto& e : typeList) {
+    if (name == e.name) {
+      return e.type;
+    }
+  }
+  return 0;
+}
+
+/**
+* 1ピクセルのバイト数を取得する.
+*
+* @param format ピクセルの形式.
+* @param type   ピクセルの型.
+*
+* @return 1ピクセルのバイト数.
+*/
+size_t BytesPerPixel(GLenum format, GLenum type)
+{
+  switch (type) {
+  case GL_UNSIGNED_SHORT_5_6_5:
+  case GL_UNSIGNED_SHORT_4_4_4_4:
+  case GL_UNSIGNED_SHORT_5_5_5_1:
+    return 2;
+  case GL_UNSIGNED_INT_8_8_8_8:
+  case GL_UNSIGNED_INT_8_8_8_8_REV:
+  case GL_UNSIGNED_INT_2_10_10_10_REV:
+    return 4;
+  default:
+    break;
+  }
+  size_t components = 4;
+  switch (format) {
+  case GL_RED: case GL_RED_INTEGER: case GL_DEPTH_COMPONENT: components = 1; break;
+  case GL_RG: case GL_RG_INTEGER: components = 2; break;
+  case GL_RGB: case GL_BGR: case GL_RGB_INTEGER: components = 3; break;
+  default: components = 4; break;
+  }
+  switch (type) {
+  case GL_UNSIGNED_SHORT: case GL_SHORT: case GL_HALF_FLOAT: return components * 2;
+  case GL_UNSIGNED_INT: case GL_INT: case GL_FLOAT: return components * 4;
+  default: return components;
+  }
+}
+
+} // unnamed namespace
+
+/**
+* 現在のバックエンドを取得する.
+*
+* @return 現在のバックエンド. Set()で設定されていなければOpenGLを呼び出すバックエンド.
+*/
+Backend& Get()
+{
+  if (!currentBackend) {
+    currentBackend = std::make_shared<GLBackend>();
+  }
+  return *currentBackend;
+}
+
+/**
+* バックエンドを切り替える.
+*
+* @param backend 新しいバックエンド. nullptrの場合はOpenGLを呼び出すバックエンドに戻す.
+*
+* 作成済みのバッファやテクスチャは作成したバックエンドでしか使えないため、
+* 描画オブジェクトを作成する前に切り替えること.
+* 切り替えたあとはGLState::Invalidate()を呼んで記録済みの状態を破棄すること.
+*/
+void Set(const BackendPtr& backend)
+{
+  currentBackend = backend;
+}
+
+/**
+* 記録用バックエンドを作成する.
+*
+* @return 作成した記録用バックエンドへのポインタ.
+*/
+NullBackendPtr NullBackend::Create()
+{
+  struct Impl : NullBackend { Impl() {} ~Impl() {} };
+  return std::make_shared<Impl>();
+}
+
+/**
+* 記録したコマンドと集計結果を消去する.
+*
+* 作成済みのバッファやプログラムは消去しない.
+*/
+void NullBackend::Clear()
+{
+  log.clear();
+  stats = {};
+}
+
+/**
+* バッファの内容を取得する.
+*
+* @param buffer バッファID.
+*
+* @return bufferの内容へのポインタ. bufferが存在しなければnullptr.
+*/
+const std::vector<uint8_t>* NullBackend::BufferData(GLuint buffer) const
+{
+  const auto itr = bufferList.find(buffer);
+  return itr != bufferList.end() ? &itr->second.data : nullptr;
+}
+
+/**
+* コマンドを記録する.
+*
+* @param type   コマンドの種類.
+* @param object 対象のオブジェクトID.
+* @param param  補助的な値.
+* @param size   転送バイト数やインデックス数.
+*/
+void NullBackend::Record(CommandType type, GLuint object, GLenum param, GLsizeiptr size)
+{
+  log.push_back({ type, object, param, size });
+}
+
+/**
+* シェーダソースのuniform宣言からプログラム情報を作成する.
+*/
+GLuint NullBackend::CreateProgram(const GLchar* vsCode, const GLchar* fsCode)
+{
+  Program program;
+  GLint nextLocation = 0;
+  for (const GLchar* code : { vsCode, fsCode }) {
+    const std::vector<std::string> tokens = Tokenize(StripComment(code));
+    for (size_t i = 0; i + 2 < tokens.size(); ++i) {
+      if (tokens[i] != "uniform") {
+        continue;
+      }
+      size_t n = i + 1;
+      while (n < tokens.size() && (tokens[n] == "lowp" || tokens[n] == "mediump" || tokens[n] == "highp")) {
+        ++n;
+      }
+      if (n + 1 >= tokens.size()) {
+        break;
+      }
+      if (tokens[n + 1] == "{") {
+        if (std::find(program.blocks.begin(), program.blocks.end(), tokens[n]) == program.blocks.end()) {
+          program.blocks.push_back(tokens[n]);
+        }
+        continue;
+      }
+      UniformInfo info;
+      info.type = ToUniformType(tokens[n]);
+      info.name = tokens[n + 1];
+      info.size = 1;
+      const size_t bracket = info.name.find('[');
+      if (bracket != std::string::npos) {
+        info.size = std::max(1, atoi(info.name.c_str() + bracket + 1));
+        info.name = info.name.substr(0, bracket) + "[0]";
+      }
+      const auto itr = std::find_if(program.uniforms.begin(), program.uniforms.end(), [&info](const UniformInfo& e) {
+        return e.name == info.name;
+      });
+      if (itr == program.uniforms.end()) {
+        info.location = nextLocation;
+        nextLocation += info.size;
+        program.uniforms.push_back(info);
+      }
+    }
+  }
+
+  const GLuint id = nextId++;
+  programList.emplace(id, std::move(program));
+  Record(CommandType_CreateProgram, id);
+  ++stats.objectsCreated;
+  return id;
+}
+
+void NullBackend::DeleteProgram(GLuint program)
+{
+  programList.erase(program);
+  Record(CommandType_DeleteProgram, program);
+  ++stats.objectsDeleted;
+}
+
+void NullBackend::GetActiveUniforms(GLuint program, std::vector<UniformInfo>& list)
+{
+  const auto itr = programList.find(program);
+  if (itr != programList.end()) {
+    list = itr->second.uniforms;
+  } else {
+    list.clear();
+  }
+}
+
+void NullBackend::GetActiveUniformBlocks(GLuint program, std::vector<std::string>& list)
+{
+  const auto itr = programList.find(program);
+  if (itr != programList.end()) {
+    list = itr->second.blocks;
+  } else {
+    list.clear();
+  }
+}
+
+void NullBackend::ProgramUniform1i(GLuint program, GLint location, GLint value)
+{
+  Record(CommandType_ProgramUniform, program, location, sizeof(value));
+}
+
+void NullBackend::ProgramUniform4iv(GLuint program, GLint location, const GLint* /* value */)
+{
+  Record(CommandType_ProgramUniform, program, location, sizeof(GLint) * 4);
+}
+
+void NullBackend::ProgramUniform4fv(GLuint program, GLint location, const GLfloat* /* value */)
+{
+  Record(CommandType_ProgramUniform, program, location, sizeof(GLfloat) * 4);
+}
+
+void NullBackend::UniformBlockBinding(GLuint program, GLuint blockIndex, GLuint bindingPoint)
+{
+  Record(CommandType_UniformBlockBinding, program, bindingPoint, blockIndex);
+}
+
+void NullBackend::UseProgram(GLuint program)
+{
+  Record(CommandType_UseProgram, program);
+  ++stats.stateChanges;
+}
+
+GLuint NullBackend::CreateBuffer(GLenum target, GLsizeiptr size, const GLvoid* data, GLenum /* usage */)
+{
+  const GLuint id = nextId++;
+  Buffer& buffer = bufferList[id];
+  buffer.data.resize(size);
+  if (data) {
+    memcpy(buffer.data.data(), data, size);
+    stats.bytesUploaded += size;
+  }
+  Record(CommandType_CreateBuffer, id, target, data ? size : 0);
+  ++stats.objectsCreated;
+  return id;
+}
+
+void NullBackend::DeleteBuffer(GLuint buffer)
+{
+  bufferList.erase(buffer);
+  Record(CommandType_DeleteBuffer, buffer);
+  ++stats.objectsDeleted;
+}
+
+void NullBackend::BufferSubData(GLenum target, GLuint buffer, GLintptr offset, GLsizeiptr size, const GLvoid* data)
+{
+  const auto itr = bufferList.find(buffer);
+  if (itr != bufferList.end() && offset + size <= static_cast<GLintptr>(itr->second.data.size())) {
+    memcpy(itr->second.data.data() + offset, data, size);
+  }
+  Record(CommandType_BufferSubData, buffer, target, size);
+  stats.bytesUploaded += size;
+}
+
+void* NullBackend::MapBufferRange(GLenum target, GLuint buffer, GLintptr offset, GLsizeiptr size, GLbitfield /* access */)
+{
+  const auto itr = bufferList.find(buffer);
+  if (itr == bufferList.end() || offset + size > static_cast<GLintptr>(itr->second.data.size())) {
+    return nullptr;
+  }
+  itr->second.mapSize = size;
+  Record(CommandType_MapBuffer, buffer, target, size);
+  return itr->second.data.data() + offset;
+}
+
+// マップした範囲は全て書き込まれたものとして転送量に含める.
+bool NullBackend::UnmapBuffer(GLenum target, GLuint buffer)
+{
+  const auto itr = bufferList.find(buffer);
+  if (itr == bufferList.end()) {
+    return false;
+  }
+  Record(CommandType_UnmapBuffer, buffer, target, itr->second.mapSize);
+  stats.bytesUploaded += itr->second.mapSize;
+  itr->second.mapSize = 0;
+  return true;
+}
+
+void NullBackend::CopyBufferSubData(GLuint src, GLuint dst, GLintptr srcOffset, GLintptr dstOffset, GLsizeiptr size)
+{
+  const auto s = bufferList.find(src);
+  const auto d = bufferList.find(dst);
+  if (s != bufferList.end() && d != bufferList.end() &&
+    srcOffset + size <= static_cast<GLintptr>(s->second.data.size()) &&
+    dstOffset + size <= static_cast<GLintptr>(d->second.data.size())) {
+    memmove(d->second.data.data() + dstOffset, s->second.data.data() + srcOffset, size);
+  }
+  Record(CommandType_CopyBuffer, dst, src, size);
+}
+
+void NullBackend::BindBufferBase(GLenum /* target */, GLuint index, GLuint buffer)
+{
+  Record(CommandType_BindBufferBase, buffer, index);
+  ++stats.stateChanges;
+}
+
+void NullBackend::BindBufferRange(GLenum /* target */, GLuint index, GLuint buffer, GLintptr /* offset */, GLsizeiptr size)
+{
+  Record(CommandType_BindBufferRange, buffer, index, size);
+  ++stats.stateChanges;
+}
+
+GLuint NullBackend::CreateVertexArray(GLuint /* vbo */, GLuint /* ibo */)
+{
+  const GLuint id = nextId++;
+  Record(CommandType_CreateVertexArray, id);
+  ++stats.objectsCreated;
+  return id;
+}
+
+void NullBackend::VertexAttribPointer(GLuint vao, GLuint /* vbo */, const VertexAttribute& attr)
+{
+  Record(CommandType_VertexAttribPointer, vao, attr.index);
+}
+
+void NullBackend::DeleteVertexArray(GLuint vao)
+{
+  Record(CommandType_DeleteVertexArray, vao);
+  ++stats.objectsDeleted;
+}
+
+void NullBackend::BindVertexArray(GLuint vao)
+{
+  Record(CommandType_BindVertexArray, vao);
+  ++stats.stateChanges;
+}
+
+GLuint NullBackend::CreateTexture()
+{
+  const GLuint id = nextId++;
+  Record(CommandType_CreateTexture, id);
+  ++stats.objectsCreated;
+  return id;
+}
+
+void NullBackend::DeleteTexture(GLuint texture)
+{
+  Record(CommandType_DeleteTexture, texture);
+  ++stats.objectsDeleted;
+}
+
+void NullBackend::ActiveTexture(GLenum unit)
+{
+  Record(CommandType_ActiveTexture, 0, unit);
+  ++stats.stateChanges;
+}
+
+void NullBackend::BindTexture(GLenum target, GLuint texture)
+{
+  Record(CommandType_BindTexture, texture, target);
+  ++stats.stateChanges;
+}
+
+void NullBackend::TexImage2D(GLenum target, GLint /* level */, GLint /* iformat */, GLsizei width, GLsizei height, GLenum format, GLenum type, const GLvoid* data)
+{
+  const GLsizeiptr size = data ? static_cast<GLsizeiptr>(width * height * BytesPerPixel(format, type)) : 0;
+  Record(CommandType_TexImage2D, 0, target, size);
+  stats.bytesUploaded += size;
+}
+
+void NullBackend::TexSubImage2D(GLenum target, GLint /* level */, GLint /* x */, GLint /* y */, GLsizei width, GLsizei height, GLenum format, GLenum type, const GLvoid* /* data */)
+{
+  const GLsizeiptr size = static_cast<GLsizeiptr>(width * height * BytesPerPixel(format, type));
+  Record(CommandType_TexSubImage2D, 0, target, size);
+  stats.bytesUploaded += size;
+}
+
+// バッファの内容は書き込み時に転送量へ含めているので、ここでは数えない.
+void NullBackend::TexSubImage2DFromBuffer(GLenum target, GLint /* level */, GLint /* x */, GLint /* y */, GLsizei width, GLsizei height, GLenum format, GLenum type, GLuint buffer, size_t /* offset */)
+{
+  Record(CommandType_TexSubImage2D, buffer, target, static_cast<GLsizeiptr>(width * height * BytesPerPixel(format, type)));
+}
+
+void NullBackend::CompressedTexImage2D(GLenum target, GLint /* level */, GLenum /* iformat */, GLsizei /* width */, GLsizei /* height */, GLsizei imageSize, const GLvoid* data)
+{
+  const GLsizeiptr size = data ? imageSize : 0;
+  Record(CommandType_TexImage2D, 0, target, size);
+  stats.bytesUploaded += size;
+}
+
+void NullBackend::TexParameteri(GLenum /* target */, GLenum pname, GLint param)
+{
+  Record(CommandType_TexParameter, 0, pname, param);
+}
+
+void NullBackend::Enable(GLenum cap)
+{
+  Record(CommandType_Enable, 0, cap);
+  ++stats.stateChanges;
+}
+
+void NullBackend::Disable(GLenum cap)
+{
+  Record(CommandType_Disable, 0, cap);
+  ++stats.stateChanges;
+}
+
+void NullBackend::BlendFunc(GLenum sfactor, GLenum dfactor)
+{
+  Record(CommandType_BlendFunc, sfactor, dfactor);
+  ++stats.stateChanges;
+}
+
+void NullBackend::DrawElements(GLenum mode, GLsizei count, GLenum /* type */, size_t offset)
+{
+  Record(CommandType_DrawElements, static_cast<GLuint>(offset), mode, count);
+  ++stats.drawCalls;
+  stats.indexCount += count;
+}
+
+GLint NullBackend::GetInteger(GLenum pname)
+{
+  switch (pname) {
+  case GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT: return 256;
+  case GL_MAX_TEXTURE_SIZE: return 16384;
+  default: return 0;
+  }
+}
+
+} // namespace RenderBackend
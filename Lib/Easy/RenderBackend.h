@@ -0,0 +1,261 @@
+/**
+* @file RenderBackend.h
+*/
+#ifndef RENDERBACKEND_H_INCLUDED
+#define RENDERBACKEND_H_INCLUDED
+#include <GL/glew.h>
+#include <vector>
+#include <string>
+#include <memory>
+#include <unordered_map>
+#include <stdint.h>
+
+/**
+* 描画APIの呼び出し先を切り替える機能を格納する名前空間.
+*
+* SpriteRenderer, Font::Renderer, TiledMap, TextureはOpenGLを直接呼び出さず、Get()で取得した
+* バックエンドを経由して描画する.
+* 通常はOpenGLを呼び出すバックエンドが使われる. NullBackendに切り替えるとOpenGLを一切呼び出さずに
+* 描画コマンドを記録するため、GPUのない環境でも描画処理を実行して呼び出し回数や転送量を検証できる.
+*/
+namespace RenderBackend {
+
+class Backend;
+typedef std::shared_ptr<Backend> BackendPtr; ///< バックエンドポインタ型.
+class NullBackend;
+typedef std::shared_ptr<NullBackend> NullBackendPtr; ///< 記録用バックエンドポインタ型.
+
+/**
+* 頂点アトリビュートの設定.
+*/
+struct VertexAttribute
+{
+  GLuint index; ///< 頂点アトリビュートのインデックス.
+  GLint size; ///< 要素数.
+  GLenum type; ///< 要素の型.
+  GLboolean normalized; ///< GL_TRUE=要素を正規化する. GL_FALSE=正規化しない.
+  bool isInteger; ///< true=整数のままシェーダに渡す. false=浮動小数点数に変換する.
+  GLsizei stride; ///< 次の頂点データまでのバイト数.
+  size_t offset; ///< 頂点データ先頭からのバイトオフセット.
+};
+
+/**
+* アクティブなuniform変数の情報.
+*/
+struct UniformInfo
+{
+  std::string name; ///< 変数名.
+  GLint location; ///< 位置. uniformブロック内の変数は-1.
+  GLint size; ///< 配列の要素数.
+  GLenum type; ///< 変数の型.
+};
+
+/**
+* 描画バックエンドのインターフェイス.
+*
+* バッファの操作は対象のバッファIDを明示して行い、バインド状態に依存しない.
+* テクスチャの転送とパラメータ設定は、アクティブなユニットに割り当てられたテクスチャが対象になる.
+*/
+class Backend
+{
+public:
+  Backend() = default;
+  virtual ~Backend() = default;
+  Backend(const Backend&) = delete;
+  Backend& operator=(const Backend&) = delete;
+
+  // プログラム.
+  virtual GLuint CreateProgram(const GLchar* vsCode, const GLchar* fsCode) = 0;
+  virtual void DeleteProgram(GLuint program) = 0;
+  virtual void GetActiveUniforms(GLuint program, std::vector<UniformInfo>& list) = 0;
+  virtual void GetActiveUniformBlocks(GLuint program, std::vector<std::string>& list) = 0;
+  virtual void ProgramUniform1i(GLuint program, GLint location, GLint value) = 0;
+  virtual void ProgramUniform4iv(GLuint program, GLint location, const GLint* value) = 0;
+  virtual void ProgramUniform4fv(GLuint program, GLint location, const GLfloat* value) = 0;
+  virtual void UniformBlockBinding(GLuint program, GLuint blockIndex, GLuint bindingPoint) = 0;
+  virtual void UseProgram(GLuint program) = 0;
+
+  // バッファ.
+  virtual GLuint CreateBuffer(GLenum target, GLsizeiptr size, const GLvoid* data, GLenum usage) = 0;
+  virtual void DeleteBuffer(GLuint buffer) = 0;
+  virtual void BufferSubData(GLenum target, GLuint buffer, GLintptr offset, GLsizeiptr size, const GLvoid* data) = 0;
+  virtual void* MapBufferRange(GLenum target, GLuint buffer, GLintptr offset, GLsizeiptr size, GLbitfield access) = 0;
+  virtual bool UnmapBuffer(GLenum target, GLuint buffer) = 0;
+  virtual void CopyBufferSubData(GLuint src, GLuint dst, GLintptr srcOffset, GLintptr dstOffset, GLsizeiptr size) = 0;
+  virtual void BindBufferBase(GLenum target, GLuint index, GLuint buffer) = 0;
+  virtual void BindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) = 0;
+
+  // VAO.
+  virtual GLuint CreateVertexArray(GLuint vbo, GLuint ibo) = 0;
+  virtual void VertexAttribPointer(GLuint vao, GLuint vbo, const VertexAttribute& attr) = 0;
+  virtual void DeleteVertexArray(GLuint vao) = 0;
+  virtual void BindVertexArray(GLuint vao) = 0;
+
+  // テクスチャ.
+  virtual GLuint CreateTexture() = 0;
+  virtual void DeleteTexture(GLuint texture) = 0;
+  virtual void ActiveTexture(GLenum unit) = 0;
+  virtual void BindTexture(GLenum target, GLuint texture) = 0;
+  virtual void TexImage2D(GLenum target, GLint level, GLint iformat, GLsizei width, GLsizei height, GLenum format, GLenum type, const GLvoid* data) = 0;
+  virtual void TexSubImage2D(GLenum target, GLint level, GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, const GLvoid* data) = 0;
+  virtual void TexSubImage2DFromBuffer(GLenum target, GLint level, GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, GLuint buffer, size_t offset) = 0;
+  virtual void CompressedTexImage2D(GLenum target, GLint level, GLenum iformat, GLsizei width, GLsizei height, GLsizei imageSize, const GLvoid* data) = 0;
+  virtual void TexParameteri(GLenum target, GLenum pname, GLint param) = 0;
+
+  // 描画状態と描画.
+  virtual void Enable(GLenum cap) = 0;
+  virtual void Disable(GLenum cap) = 0;
+  virtual void BlendFunc(GLenum sfactor, GLenum dfactor) = 0;
+  virtual void DrawElements(GLenum mode, GLsizei count, GLenum type, size_t offset) = 0;
+
+  // 問い合わせ.
+  virtual GLenum GetError() = 0;
+  virtual GLint GetInteger(GLenum pname) = 0;
+};
+
+/// 記録するコマンドの種類.
+enum CommandType {
+  CommandType_CreateProgram,
+  CommandType_DeleteProgram,
+  CommandType_ProgramUniform,
+  CommandType_UniformBlockBinding,
+  CommandType_UseProgram,
+  CommandType_CreateBuffer,
+  CommandType_DeleteBuffer,
+  CommandType_BufferSubData,
+  CommandType_MapBuffer,
+  CommandType_UnmapBuffer,
+  CommandType_CopyBuffer,
+  CommandType_BindBufferBase,
+  CommandType_BindBufferRange,
+  CommandType_CreateVertexArray,
+  CommandType_VertexAttribPointer,
+  CommandType_DeleteVertexArray,
+  CommandType_BindVertexArray,
+  CommandType_CreateTexture,
+  CommandType_DeleteTexture,
+  CommandType_ActiveTexture,
+  CommandType_BindTexture,
+  CommandType_TexImage2D,
+  CommandType_TexSubImage2D,
+  CommandType_TexParameter,
+  CommandType_Enable,
+  CommandType_Disable,
+  CommandType_BlendFunc,
+  CommandType_DrawElements,
+};
+
+/**
+* 記録したコマンド.
+*/
+struct Command
+{
+  CommandType type; ///< コマンドの種類.
+  GLuint object; ///< 対象のオブジェクトID(バッファ、テクスチャ、プログラム等).
+  GLenum param; ///< ターゲットやモード等の補助的な値.
+  GLsizeiptr size; ///< 転送バイト数やインデックス数.
+};
+
+/**
+* 記録の集計結果.
+*/
+struct Stats
+{
+  size_t drawCalls; ///< 描画コマンドの数.
+  size_t indexCount; ///< 描画したインデックスの総数.
+  size_t bytesUploaded; ///< GPUへ転送したバイト数(マップ範囲を含む).
+  size_t stateChanges; ///< 描画状態を変更したコマンドの数.
+  size_t objectsCreated; ///< 作成したオブジェクトの数.
+  size_t objectsDeleted; ///< 削除したオブジェクトの数.
+};
+
+/**
+* OpenGLを呼び出さずにコマンドを記録するバックエンド.
+*
+* バッファはシステムメモリ上に確保するため、MapBufferRangeで書き込んだ内容やCopyBufferSubDataの
+* 結果を読み出して検証できる. シェーダはコンパイルせず、ソースコードのuniform宣言から
+* uniform変数とuniformブロックの情報を作成する.
+*/
+class NullBackend : public Backend
+{
+public:
+  static NullBackendPtr Create();
+
+  const std::vector<Command>& Log() const { return log; }
+  const Stats& GetStats() const { return stats; }
+  void Clear();
+  const std::vector<uint8_t>* BufferData(GLuint buffer) const;
+
+  GLuint CreateProgram(const GLchar* vsCode, const GLchar* fsCode) override;
+  void DeleteProgram(GLuint program) override;
+  void GetActiveUniforms(GLuint program, std::vector<UniformInfo>& list) override;
+  void GetActiveUniformBlocks(GLuint program, std::vector<std::string>& list) override;
+  void ProgramUniform1i(GLuint program, GLint location, GLint value) override;
+  void ProgramUniform4iv(GLuint program, GLint location, const GLint* value) override;
+  void ProgramUniform4fv(GLuint program, GLint location, const GLfloat* value) override;
+  void UniformBlockBinding(GLuint program, GLuint blockIndex, GLuint bindingPoint) override;
+  void UseProgram(GLuint program) override;
+
+  GLuint CreateBuffer(GLenum target, GLsizeiptr size, const GLvoid* data, GLenum usage) override;
+  void DeleteBuffer(GLuint buffer) override;
+  void BufferSubData(GLenum target, GLuint buffer, GLintptr offset, GLsizeiptr size, const GLvoid* data) override;
+  void* MapBufferRange(GLenum target, GLuint buffer, GLintptr offset, GLsizeiptr size, GLbitfield access) override;
+  bool UnmapBuffer(GLenum target, GLuint buffer) override;
+  void CopyBufferSubData(GLuint src, GLuint dst, GLintptr srcOffset, GLintptr dstOffset, GLsizeiptr size) override;
+  void BindBufferBase(GLenum target, GLuint index, GLuint buffer) override;
+  void BindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) override;
+
+  GLuint CreateVertexArray(GLuint vbo, GLuint ibo) override;
+  void VertexAttribPointer(GLuint vao, GLuint vbo, const VertexAttribute& attr) override;
+  void DeleteVertexArray(GLuint vao) override;
+  void BindVertexArray(GLuint vao) override;
+
+  GLuint CreateTexture() override;
+  void DeleteTexture(GLuint texture) override;
+  void ActiveTexture(GLenum unit) override;
+  void BindTexture(GLenum target, GLuint texture) override;
+  void TexImage2D(GLenum target, GLint level, GLint iformat, GLsizei width, GLsizei height, GLenum format, GLenum type, const GLvoid* data) override;
+  void TexSubImage2D(GLenum target, GLint level, GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, const GLvoid* data) override;
+  void TexSubImage2DFromBuffer(GLenum target, GLint level, GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, GLuint buffer, size_t offset) override;
+  void CompressedTexImage2D(GLenum target, GLint level, GLenum iformat, GLsizei width, GLsizei height, GLsizei imageSize, const GLvoid* data) override;
+  void TexParameteri(GLenum target, GLenum pname, GLint param) override;
+
+  void Enable(GLenum cap) override;
+  void Disable(GLenum cap) override;
+  void BlendFunc(GLenum sfactor, GLenum dfactor) override;
+  void DrawElements(GLenum mode, GLsizei count, GLenum type, size_t offset) override;
+
+  GLenum GetError() override { return GL_NO_ERROR; }
+  GLint GetInteger(GLenum pname) override;
+
+private:
+  NullBackend() = default;
+  ~NullBackend() = default;
+
+  void Record(CommandType type, GLuint object = 0, GLenum param = 0, GLsizeiptr size = 0);
+
+  /// システムメモリ上のバッファ.
+  struct Buffer {
+    std::vector<uint8_t> data;
+    GLsizeiptr mapSize = 0; ///< マップ中の範囲のバイト数.
+  };
+
+  /// シェーダソースから作成したプログラム情報.
+  struct Program {
+    std::vector<UniformInfo> uniforms;
+    std::vector<std::string> blocks;
+  };
+
+  GLuint nextId = 1; ///< 次に作成するオブジェクトのID.
+  std::unordered_map<GLuint, Buffer> bufferList;
+  std::unordered_map<GLuint, Program> programList;
+  std::vector<Command> log;
+  Stats stats = {};
+};
+
+Backend& Get();
+void Set(const BackendPtr& backend);
+
+} // namespace RenderBackend
+
+#endif // RENDERBACKEND_H_INCLUDED
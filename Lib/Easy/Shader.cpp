@@ -3,7 +3,10 @@
 */
 #include "Shader.h"
 #include "UniformBuffer.h"
+#include "GLState.h"
+#include "RenderBackend.h"
 #include <vector>
+#include <algorithm>
 #include <iostream>
 #include <cstdint>
 #include <stdio.h>
@@ -12,85 +15,26 @@
 namespace Shader {
 
 /**
-* VF[_R[hRpC.
+* プログラムオブジェクトを作成する.
 *
-* @param type VF[_̎.
-* @param string VF[_R[hւ̃|C^.
+* @param vsCode 頂点シェーダコードへのポインタ.
+* @param fsCode フラグメントシェーダコードへのポインタ.
 *
-* @return 쐬VF[_IuWFNg.
-*/
-GLuint CompileShader(GLenum type, const GLchar* string)
-{
-  GLuint shader = glCreateShader(type);
-  glShaderSource(shader, 1, &string, nullptr);
-  glCompileShader(shader);
-  GLint compiled = 0;
-  glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
-  if (!compiled) {
-    GLint infoLen = 0;
-    glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &infoLen);
-    if (infoLen) {
-      std::vector<char> buf;
-      buf.resize(infoLen);
-      if (static_cast<int>(buf.size()) >= infoLen) {
-        glGetShaderInfoLog(shader, infoLen, NULL, buf.data());
-        std::cerr << "ERROR: VF[_̃RpCɎsn" << buf.data() << std::endl;
-      }
-    }
-    glDeleteShader(shader);
-    return 0;
-  }
-  return shader;
-}
-
-/**
-* vOIuWFNg쐬.
-*
-* @param vsCode _VF[_R[hւ̃|C^.
-* @param fsCode tOgVF[_R[hւ̃|C^.
-*
-* @return 쐬vOIuWFNg.
+* @return 作成したプログラムオブジェクト.
 */
 GLuint CreateShaderProgram(const GLchar* vsCode, const GLchar* fsCode)
 {
-  GLuint vs = CompileShader(GL_VERTEX_SHADER, vsCode);
-  GLuint fs = CompileShader(GL_FRAGMENT_SHADER, fsCode);
-  if (!vs || !fs) {
-    return 0;
-  }
-  GLuint program = glCreateProgram();
-  glAttachShader(program, fs);
-  glDeleteShader(fs);
-  glAttachShader(program, vs);
-  glDeleteShader(vs);
-  glLinkProgram(program);
-  GLint linkStatus = GL_FALSE;
-  glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
-  if (linkStatus != GL_TRUE) {
-    GLint infoLen = 0;
-    glGetProgramiv(program, GL_INFO_LOG_LENGTH, &infoLen);
-    if (infoLen) {
-      std::vector<char> buf;
-      buf.resize(infoLen);
-      if (static_cast<int>(buf.size()) >= infoLen) {
-        glGetProgramInfoLog(program, infoLen, NULL, buf.data());
-        std::cerr << "ERROR: VF[_̃NɎsn" << buf.data() << std::endl;
-      }
-    }
-    glDeleteProgram(program);
-    return 0;
-  }
-  return program;
+  return RenderBackend::Get().CreateProgram(vsCode, fsCode);
 }
 
 /**
-* t@Cǂݍ.
+* ファイルを読み込む.
 *
-* @param filename ǂݍރt@C.
-* @param buf      ǂݍݐobt@.
+* @param filename 読み込むファイル名.
+* @param buf      読み込み先バッファ.
 *
-* @retval true ǂݍݐ.
-* @retval false ǂݍݎs.
+* @retval true 読み込み成功.
+* @retval false 読み込み失敗.
 */
 bool ReadFile(const char* filename, std::vector<char>& buf)
 {
@@ -113,42 +57,42 @@ bool ReadFile(const char* filename, std::vector<char>& buf)
 }
 
 /**
-* t@CVF[_vO쐬.
+* ファイルからシェーダプログラムを作成する.
 *
-* @param vsCode _VF[_t@C.
-* @param fsCode tOgVF[_t@C.
+* @param vsCode 頂点シェーダファイル名.
+* @param fsCode フラグメントシェーダファイル名.
 *
-* @return 쐬vOIuWFNg.
+* @return 作成したプログラムオブジェクト.
 */
 GLuint CreateProgramFromFile(const char* vsFilename, const char* fsFilename)
 {
   std::vector<char> vsBuf;
   if (!ReadFile(vsFilename, vsBuf)) {
-    std::cerr << "ERROR in Shader::CreateProgramFromFile:n" << vsFilename << "ǂݍ߂܂." << std::endl;
+    std::cerr << "ERROR in Shader::CreateProgramFromFile:￥n" << vsFilename << "を読み込めません." << std::endl;
     return 0;
   }
   std::vector<char> fsBuf;
   if (!ReadFile(fsFilename, fsBuf)) {
-    std::cerr << "ERROR in Shader::CreateProgramFromFile:n" << fsFilename << "ǂݍ߂܂." << std::endl;
+    std::cerr << "ERROR in Shader::CreateProgramFromFile:￥n" << fsFilename << "を読み込めません." << std::endl;
     return 0;
   }
   return CreateShaderProgram(vsBuf.data(), fsBuf.data());
 }
 
 /**
-* VF[_vO쐬.
+* シェーダプログラムを作成する.
 *
-* @param vsCode        _VF[_R[hւ̃|C^.
-* @param fsCode        tOgVF[_R[hւ̃|C^.
+* @param vsCode        頂点シェーダコードへのポインタ.
+* @param fsCode        フラグメントシェーダコードへのポインタ.
 *
-* @return 쐬vOIuWFNg.
+* @return 作成したプログラムオブジェクト.
 */
 ProgramPtr Program::Create(const char* vsFilename, const char* fsFilename)
 {
   struct Impl : Program {};
   ProgramPtr p = std::make_shared<Impl>();
   if (!p) {
-    std::cerr << "ERROR: vO'" << vsFilename << "'̍쐬Ɏs" << std::endl;
+    std::cerr << "ERROR: プログラム'" << vsFilename << "'の作成に失敗" << std::endl;
     return {};
   }
   p->program = CreateProgramFromFile(vsFilename, fsFilename);
@@ -156,76 +100,169 @@ ProgramPtr Program::Create(const char* vsFilename, const char* fsFilename)
     return {};
   }
 
-  // Tv[̐ƈʒu擾.
-  GLint activeUniforms;
-  glGetProgramiv(p->program, GL_ACTIVE_UNIFORMS, &activeUniforms);
-  for (int i = 0; i < activeUniforms; ++i) {
-    GLint size;
-    GLenum type;
-    GLchar name[128];
-    glGetActiveUniform(p->program, i, sizeof(name), nullptr, &size, &type, name);
-    if (type == GL_SAMPLER_2D) {
-      p->samplerCount = size;
-      p->samplerLocation = glGetUniformLocation(p->program, name);
-      if (p->samplerLocation < 0) {
-        std::cerr << "ERROR: vO'" << vsFilename << "'̍쐬Ɏs" << std::endl;
-        return {};
+  // 頂点シェーダファイル名の末尾から”.vert”を取り除いたものをプログラム名とする.
+  p->name = vsFilename;
+  p->name.resize(p->name.size() - 4);
+
+  if (!p->Reflect()) {
+    std::cerr << "ERROR: プログラム'" << vsFilename << "'の作成に失敗" << std::endl;
+    return {};
+  }
+
+  return p;
+}
+
+/**
+* uniform変数とuniformブロックの情報を取得してキャッシュする.
+*
+* @retval true  取得成功.
+* @retval false 取得失敗.
+*
+* 配列のuniform変数は”[0]”を取り除いた名前でも登録される.
+* サンプラーにはテクスチャ・イメージ・ユニット番号をここで設定するため、描画時に設定し直す必要はない.
+*/
+bool Program::Reflect()
+{
+  RenderBackend::Backend& backend = RenderBackend::Get();
+  std::vector<RenderBackend::UniformInfo> uniforms;
+  backend.GetActiveUniforms(program, uniforms);
+  uniformList.clear();
+  uniformList.reserve(uniforms.size() * 2);
+  for (const auto& e : uniforms) {
+    if (e.location < 0) {
+      continue; // uniformブロック内の変数.
+    }
+    uniformList.push_back({ MakeNameId(e.name.c_str()), e.location });
+    const size_t bracket = e.name.find('[');
+    if (bracket != std::string::npos) {
+      uniformList.push_back({ MakeNameId(e.name.substr(0, bracket).c_str()), e.location });
+    }
+    if (e.type == GL_SAMPLER_2D && samplerCount == 0) {
+      samplerCount = e.size;
+      samplerLocation = e.location;
+      for (GLint unit = 0; unit < samplerCount; ++unit) {
+        backend.ProgramUniform1i(program, samplerLocation + unit, unit);
       }
-      break;
     }
   }
 
-  // _VF[_t@C̖h.verth菜̂vOƂ.
-  p->name = vsFilename;
-  p->name.resize(p->name.size() - 4);
+  std::vector<std::string> blocks;
+  backend.GetActiveUniformBlocks(program, blocks);
+  blockList.clear();
+  blockList.reserve(blocks.size());
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    blockList.push_back({ MakeNameId(blocks[i].c_str()), static_cast<GLint>(i) });
+  }
 
-  return p;
+  // 二分探索できるように並べ替え、IDの衝突を検出する.
+  for (auto* list : { &uniformList, &blockList }) {
+    std::sort(list->begin(), list->end());
+    const auto itr = std::adjacent_find(list->begin(), list->end(), [](const Location& a, const Location& b) {
+      return a.id == b.id;
+    });
+    if (itr != list->end()) {
+      std::cerr << "ERROR(" << name << "): 名前IDが衝突しています(" << itr->id << ")" << std::endl;
+      return false;
+    }
+  }
+  return backend.GetError() == GL_NO_ERROR;
 }
 
 /**
-* fXgN^.
+* uniform変数の位置を取得する.
+*
+* @param id uniform変数名のID.
+*
+* @return idに対応するuniform変数の位置.
+*         見つからない場合は-1.
+*/
+GLint Program::UniformLocation(NameId id) const
+{
+  const auto itr = std::lower_bound(uniformList.begin(), uniformList.end(), Location{ id, 0 });
+  if (itr == uniformList.end() || itr->id != id) {
+    return -1;
+  }
+  return itr->location;
+}
+
+/**
+* uniformブロックのインデックスを取得する.
+*
+* @param id uniformブロック名のID.
+*
+* @return idに対応するuniformブロックのインデックス.
+*         見つからない場合はGL_INVALID_INDEX.
+*/
+GLuint Program::UniformBlockIndex(NameId id) const
+{
+  const auto itr = std::lower_bound(blockList.begin(), blockList.end(), Location{ id, 0 });
+  if (itr == blockList.end() || itr->id != id) {
+    return GL_INVALID_INDEX;
+  }
+  return static_cast<GLuint>(itr->location);
+}
+
+/**
+* デストラクタ.
 */
 Program::~Program()
 {
   if (program) {
-    glDeleteProgram(program);
+    GLState::DeleteProgram(program);
   }
 }
 
 /**
-* UniformubNoCfBOE|CgɊ蓖Ă.
+* Uniformブロックをバインディング・ポイントに割り当てる.
 *
-* @param blockName    蓖ĂUniformubN̖O.
-* @param bindingPoint 蓖Đ̃oCfBOE|Cg.
+* @param blockName    割り当てるUniformブロックの名前.
+* @param bindingPoint 割り当て先のバインディング・ポイント.
 *
-* @retval true  蓖Đ.
-* @retval false 蓖Ďs.
+* @retval true  割り当て成功.
+* @retval false 割り当て失敗.
 */
 bool Program::UniformBlockBinding(const char* blockName, GLuint bindingPoint)
 {
-  const GLuint blockIndex = glGetUniformBlockIndex(program, blockName);
-  if (blockIndex == GL_INVALID_INDEX) {
-    std::cerr << "ERROR(" << name << "): UniformubN'" << blockName <<
-      "'܂" << std::endl;
+  const NameId blockId = MakeNameId(blockName);
+  if (UniformBlockIndex(blockId) == GL_INVALID_INDEX) {
+    std::cerr << "ERROR(" << name << "): Uniformブロック'" << blockName <<
+      "'が見つかりません" << std::endl;
     return false;
   }
-  glUniformBlockBinding(program, blockIndex, bindingPoint);
-  const GLenum result = glGetError();
-  if (result != GL_NO_ERROR) {
-    std::cerr << "ERROR(" << name << "): UniformubN'" << blockName <<
-      "'̃oChɎs" << std::endl;
+  if (!UniformBlockBinding(blockId, bindingPoint)) {
+    std::cerr << "ERROR(" << name << "): Uniformブロック'" << blockName <<
+      "'のバインドに失敗" << std::endl;
     return false;
   }
   return true;
 }
 
 /**
-* UniformubNoCfBOE|CgɊ蓖Ă.
+* Uniformブロックをバインディング・ポイントに割り当てる.
+*
+* @param blockId      割り当てるUniformブロックの名前ID.
+* @param bindingPoint 割り当て先のバインディング・ポイント.
+*
+* @retval true  割り当て成功.
+* @retval false 割り当て失敗.
+*/
+bool Program::UniformBlockBinding(NameId blockId, GLuint bindingPoint)
+{
+  const GLuint blockIndex = UniformBlockIndex(blockId);
+  if (blockIndex == GL_INVALID_INDEX) {
+    return false;
+  }
+  RenderBackend::Get().UniformBlockBinding(program, blockIndex, bindingPoint);
+  return RenderBackend::Get().GetError() == GL_NO_ERROR;
+}
+
+/**
+* Uniformブロックをバインディング・ポイントに割り当てる.
 *
-* @param object  蓖ĂUniformBufferIuWFNg.
+* @param object  割り当てるUniformBufferオブジェクト.
 *
-* @retval true  蓖Đ.
-* @retval false 蓖Ďs.
+* @retval true  割り当て成功.
+* @retval false 割り当て失敗.
 */
 bool Program::UniformBlockBinding(const UniformBuffer& object)
 {
@@ -233,28 +270,24 @@ bool Program::UniformBlockBinding(const UniformBuffer& object)
 }
 
 /**
-* `pvOɐݒ肷.
+* 描画用プログラムに設定する.
 */
 void Program::UseProgram()
 {
-  glUseProgram(program);
-  for (GLint i = 0; i < samplerCount; ++i) {
-    glUniform1i(samplerLocation + i, i);
-  }
+  GLState::UseProgram(program);
 }
 
 /**
-* eNX`eNX`EC[WEjbgɊ蓖Ă.
+* テクスチャをテクスチャ・イメージ・ユニットに割り当てる.
 *
-* @param unit    蓖Đ̃eNX`EC[WEjbgԍ(GL_TEXTURE0`).
-* @param type    蓖ĂeNX`̎(GL_TEXTURE_1D, GL_TEXTURE_2D, etc).
-* @param texture 蓖ĂeNX`IuWFNg.
+* @param unit    割り当て先のテクスチャ・イメージ・ユニット番号(GL_TEXTURE0～).
+* @param type    割り当てるテクスチャの種類(GL_TEXTURE_1D, GL_TEXTURE_2D, etc).
+* @param texture 割り当てるテクスチャオブジェクト.
 */
 void Program::BindTexture(GLenum unit, GLenum type, GLuint texture)
 {
   if (unit >= GL_TEXTURE0 && unit < static_cast<GLenum>(GL_TEXTURE0 + samplerCount)) {
-    glActiveTexture(unit);
-    glBindTexture(type, texture);
+    GLState::BindTexture(unit, type, texture);
   }
 }
 
@@ -5,17 +5,35 @@
 #define SHADER_H_INCLUDED
 #include <GL/glew.h>
 #include <string>
+#include <vector>
 #include <memory>
+#include <stdint.h>
 
 class UniformBuffer;
 
 namespace Shader {
 
 class Program;
-typedef std::shared_ptr<Program> ProgramPtr; ///< vOIuWFNg|C^^.
+typedef std::shared_ptr<Program> ProgramPtr; ///< プログラムオブジェクトポインタ型.
+typedef uint32_t NameId; ///< uniform変数名やuniformブロック名から計算したID.
 
 /**
-* VF[_[vONX.
+* 名前からIDを計算する(FNV-1a).
+*
+* @param name 名前.
+* @param hash 計算途中のハッシュ値(呼び出し側は指定しないこと).
+*
+* @return nameに対応するID.
+*
+* constexpr関数なので、定数で初期化すればコンパイル時に計算される.
+*/
+constexpr NameId MakeNameId(const char* name, NameId hash = 2166136261u)
+{
+  return *name ? MakeNameId(name + 1, (hash ^ static_cast<uint8_t>(*name)) * 16777619u) : hash;
+}
+
+/**
+* シェーダープログラムクラス.
 */
 class Program
 {
@@ -23,21 +41,38 @@ public:
   static ProgramPtr Create(const char* vsFilename, const char* fsFilename);
 
   bool UniformBlockBinding(const char* blockName, GLuint bindingPoint);
+  bool UniformBlockBinding(NameId blockId, GLuint bindingPoint);
   bool UniformBlockBinding(const UniformBuffer&);
   void UseProgram();
   void BindTexture(GLenum unit, GLenum type, GLuint texture);
 
+  GLuint Id() const { return program; }
+  GLint UniformLocation(NameId id) const;
+  GLuint UniformBlockIndex(NameId id) const;
+
 private:
   Program() = default;
   ~Program();
   Program(const Program&) = delete;
   Program& operator=(const Program&) = delete;
 
+  bool Reflect();
+
 private:
-  GLuint program = 0; ///< vOIuWFNg.
-  GLint samplerLocation = -1; ///< Tv[̈ʒu.
-  int samplerCount = 0; ///< Tv[̐.
-  std::string name; ///< vO.
+  /// 名前IDと位置の組.
+  struct Location
+  {
+    NameId id;
+    GLint location;
+    bool operator<(const Location& rhs) const { return id < rhs.id; }
+  };
+
+  GLuint program = 0; ///< プログラムオブジェクト.
+  GLint samplerLocation = -1; ///< サンプラーの位置.
+  int samplerCount = 0; ///< サンプラーの数.
+  std::vector<Location> uniformList; ///< uniform変数の位置(idの昇順).
+  std::vector<Location> blockList; ///< uniformブロックのインデックス(idの昇順).
+  std::string name; ///< プログラム名.
 };
 
 GLuint CreateShaderProgram(const GLchar* vsCode, const GLchar* fsCode);
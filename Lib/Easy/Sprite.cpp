@@ -3,149 +3,343 @@
 */
 #include "Sprite.h"
 #include "Shader.h"
+#include "GLState.h"
+#include "RenderBackend.h"
 #include <vector>
 #include <algorithm>
+#include <future>
 #include <iostream>
+#include <stdint.h>
+#include <string.h>
 #include <glm/gtc/matrix_transform.hpp>
 
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define EASY_SPRITE_USE_SSE2
+#endif
+
+const size_t SpriteRenderer::minSpritesPerThread;
+
 /**
-* _f[^^.
+* 頂点データ型.
 */
 struct Vertex
 {
-  glm::vec3 position; ///< W
-  glm::vec4 color; ///< F
-  glm::vec2 texCoord; ///< eNX`W
-  glm::i32 blendMode; ///< F[h.
+  glm::vec3 position; ///< 座標
+  glm::vec4 color; ///< 色
+  glm::vec2 texCoord; ///< テクスチャ座標
+  glm::i32 blendMode; ///< 色合成モード.
 };
+static_assert(sizeof(Vertex) == 40, "Vertexのサイズが変わった場合はWriteQuadを修正すること");
 
 namespace /* unnamed */ {
 
 /**
-* Vertex Buffer Object쐬.
+* Vertex Buffer Objectを作成する.
 *
-* @param size _f[^̃TCY.
-* @param data _f[^ւ̃|C^.
+* @param size 頂点データのサイズ.
+* @param data 頂点データへのポインタ.
 *
-* @return 쐬VBOID.
+* @return 作成したVBOのID.
 */
 GLuint CreateVBO(GLsizeiptr size, const GLvoid* data)
 {
-  GLuint vbo = 0;
-  glGenBuffers(1, &vbo);
-  glBindBuffer(GL_ARRAY_BUFFER, vbo);
-  glBufferData(GL_ARRAY_BUFFER, size, data, GL_DYNAMIC_DRAW);
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
-  return vbo;
+  return RenderBackend::Get().CreateBuffer(GL_ARRAY_BUFFER, size, data, GL_DYNAMIC_DRAW);
 }
 
 /**
-* Index Buffer Object쐬.
+* Index Buffer Objectを作成する.
 *
-* @param size CfbNXf[^̃TCY.
-* @param data CfbNXf[^ւ̃|C^.
+* @param size インデックスデータのサイズ.
+* @param data インデックスデータへのポインタ.
 *
-* @return 쐬IBOID.
+* @return 作成したIBOのID.
 */
 GLuint CreateIBO(GLsizeiptr size, const GLvoid* data)
 {
-  GLuint ibo = 0;
-  glGenBuffers(1, &ibo);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-  return ibo;
+  GLState::BindVertexArray(0); // 割り当て中のVAOのIBOを書き換えないようにする.
+  return RenderBackend::Get().CreateBuffer(GL_ELEMENT_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
 }
 
 /**
-* _Agr[gݒ肷.
+* 四角形を描画するためのIndex Buffer Objectを作成する.
+*
+* @tparam T             インデックスの型(GLushortまたはGLuint).
+* @param maxSpriteCount 描画可能な最大スプライト数.
 *
-* @param index _Agr[g̃CfbNX.
-* @param cls   _f[^^.
-* @param mbr   _Agr[gɐݒ肷cls̃oϐ.
+* @return 作成したIBOのID.
 */
-#define SetVertexAttribPointer(index, cls, mbr) \
-  SetVertexAttribPointerI(index, sizeof(cls::mbr) / sizeof(float), sizeof(cls), reinterpret_cast<GLvoid*>(offsetof(cls, mbr)))
-void SetVertexAttribPointerI(GLuint index, GLint size, GLsizei stride, const GLvoid* pointer)
+template<typename T>
+GLuint CreateQuadIBO(size_t maxSpriteCount)
 {
-  glEnableVertexAttribArray(index);
-  glVertexAttribPointer(index, size, GL_FLOAT, GL_FALSE, stride, pointer);
+  std::vector<T> indices;
+  indices.resize(maxSpriteCount * 6);
+  for (size_t i = 0; i < maxSpriteCount; ++i) {
+    const T base = static_cast<T>(i * 4);
+    indices[i * 6 + 0] = base + 0;
+    indices[i * 6 + 1] = base + 1;
+    indices[i * 6 + 2] = base + 2;
+    indices[i * 6 + 3] = base + 2;
+    indices[i * 6 + 4] = base + 3;
+    indices[i * 6 + 5] = base + 0;
+  }
+  return CreateIBO(indices.size() * sizeof(T), indices.data());
 }
 
 /**
-* _Agr[gݒ肷().
+* 頂点アトリビュートを設定する.
 *
-* @param index _Agr[g̃CfbNX.
-* @param cls   _f[^^.
-* @param mbr   _Agr[gɐݒ肷cls̃oϐ.
+* @param vao   設定するVAO.
+* @param vbo   頂点アトリビュートの参照先VBO.
+* @param index 頂点アトリビュートのインデックス.
+* @param cls   頂点データ型名.
+* @param mbr   頂点アトリビュートに設定するclsのメンバ変数名.
 */
-#define SetVertexAttribIntPointer(index, cls, mbr) \
-  SetVertexAttribIntPointerI(index, sizeof(cls::mbr) / sizeof(float), sizeof(cls), reinterpret_cast<GLvoid*>(offsetof(cls, mbr)))
-void SetVertexAttribIntPointerI(GLuint index, GLint size, GLsizei stride, const GLvoid* pointer)
-{
-  glEnableVertexAttribArray(index);
-  glVertexAttribIPointer(index, size, GL_INT, stride, pointer);
-}
+#define SetVertexAttribPointer(vao, vbo, index, cls, mbr) \
+  RenderBackend::Get().VertexAttribPointer(vao, vbo, { index, sizeof(cls::mbr) / sizeof(float), GL_FLOAT, GL_FALSE, false, sizeof(cls), offsetof(cls, mbr) })
+
+/**
+* 頂点アトリビュートを設定する(整数).
+*
+* @param vao   設定するVAO.
+* @param vbo   頂点アトリビュートの参照先VBO.
+* @param index 頂点アトリビュートのインデックス.
+* @param cls   頂点データ型名.
+* @param mbr   頂点アトリビュートに設定するclsのメンバ変数名.
+*/
+#define SetVertexAttribIntPointer(vao, vbo, index, cls, mbr) \
+  RenderBackend::Get().VertexAttribPointer(vao, vbo, { index, sizeof(cls::mbr) / sizeof(float), GL_INT, GL_FALSE, true, sizeof(cls), offsetof(cls, mbr) })
 
 /**
-* Vertex Array Object쐬.
+* Vertex Array Objectを作成する.
 *
-* @param vbo VAOɊ֘AtVBOID.
-* @param ibo VAOɊ֘AtIBOID.
+* @param vbo VAOに関連付けられるVBOのID.
+* @param ibo VAOに関連付けられるIBOのID.
 *
-* @return 쐬VAOID.
+* @return 作成したVAOのID.
 */
 GLuint CreateVAO(GLuint vbo, GLuint ibo)
 {
-  GLuint vao = 0;
-  glGenVertexArrays(1, &vao);
-  glBindVertexArray(vao);
-  glBindBuffer(GL_ARRAY_BUFFER, vbo);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
-  SetVertexAttribPointer(0, Vertex, position);
-  SetVertexAttribPointer(1, Vertex, color);
-  SetVertexAttribPointer(2, Vertex, texCoord);
-  SetVertexAttribIntPointer(3, Vertex, blendMode);
-  glBindVertexArray(0);
+  const GLuint vao = RenderBackend::Get().CreateVertexArray(vbo, ibo);
+  SetVertexAttribPointer(vao, vbo, 0, Vertex, position);
+  SetVertexAttribPointer(vao, vbo, 1, Vertex, color);
+  SetVertexAttribPointer(vao, vbo, 2, Vertex, texCoord);
+  SetVertexAttribIntPointer(vao, vbo, 3, Vertex, blendMode);
   return vao;
 }
 
+/**
+* テクスチャ座標の変換係数を取得する.
+*
+* @param texture        スプライトのテクスチャ.
+* @param reciprocalSize テクスチャの大きさの逆数の格納先.
+* @param uvOffset       テクスチャ座標に加えるオフセットの格納先.
+*
+* アトラスのサブテクスチャの場合、ページ内の位置に変換するための値を返す.
+*/
+void GetTexCoordTransform(const Texture& texture, glm::vec2& reciprocalSize, glm::vec2& uvOffset)
+{
+  reciprocalSize = glm::vec2(1) / glm::vec2(texture.PageWidth(), texture.PageHeight());
+  uvOffset = glm::vec2(texture.OffsetX(), texture.OffsetY()) * reciprocalSize;
+}
+
+#ifdef EASY_SPRITE_USE_SSE2
+/**
+* スプライト1個ぶんの4頂点をSSE2命令で作成し、頂点バッファに書き込む.
+*
+* @param p              書き込み先の頂点バッファへのポインタ.
+* @param sprite         頂点データの元になるスプライト.
+* @param reciprocalSize テクスチャの大きさの逆数.
+* @param uvOffset       テクスチャ座標に加えるオフセット.
+* @param isAligned      true=pは16バイト境界に整列している. false=整列していない.
+*
+* 座標変換行列の2Dアフィン部分だけを使って4隅の座標を同時に計算する.
+* 4頂点(160バイト)は10個の16バイトブロックにまとめてから書き込む.
+* pが整列している場合はキャッシュを経由しないストリーミングストアを使うため、
+* 書き込み終了後に_mm_sfenceを呼び出すこと.
+*/
+void WriteQuad(Vertex* p, const Sprite& sprite, const glm::vec2& reciprocalSize, const glm::vec2& uvOffset, bool isAligned)
+{
+  const Rect& rect = sprite.Rectangle();
+  const glm::mat4x4& m = sprite.Transform();
+  const glm::vec4& color = sprite.Color();
+  const glm::vec2 uv0 = rect.origin * reciprocalSize + uvOffset;
+  const glm::vec2 uv1 = uv0 + rect.size * reciprocalSize;
+  float blendMode;
+  const glm::i32 mode = sprite.ColorMode();
+  memcpy(&blendMode, &mode, sizeof(blendMode));
+
+  // 4隅の座標を同時に計算.
+  const float hx = rect.size.x * 0.5f;
+  const float hy = rect.size.y * 0.5f;
+  const __m128 xs = _mm_setr_ps(-hx, hx, hx, -hx);
+  const __m128 ys = _mm_setr_ps(-hy, -hy, hy, hy);
+  __m128 px = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(m[0][0]), xs), _mm_mul_ps(_mm_set1_ps(m[1][0]), ys)), _mm_set1_ps(m[3][0]));
+  __m128 py = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(m[0][1]), xs), _mm_mul_ps(_mm_set1_ps(m[1][1]), ys)), _mm_set1_ps(m[3][1]));
+  __m128 pz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(m[0][2]), xs), _mm_mul_ps(_mm_set1_ps(m[1][2]), ys)), _mm_set1_ps(m[3][2]));
+  __m128 pr = _mm_set1_ps(color.r);
+  // 転置して(x, y, z, r)の並びにする. これは各頂点の先頭16バイトと一致する.
+  _MM_TRANSPOSE4_PS(px, py, pz, pr);
+  alignas(16) float pos[4][4];
+  _mm_store_ps(pos[0], px);
+  _mm_store_ps(pos[1], py);
+  _mm_store_ps(pos[2], pz);
+  _mm_store_ps(pos[3], pr);
+
+  const __m128 blocks[10] = {
+    px,
+    _mm_setr_ps(color.g, color.b, color.a, uv0.x),
+    _mm_setr_ps(uv0.y, blendMode, pos[1][0], pos[1][1]),
+    _mm_setr_ps(pos[1][2], color.r, color.g, color.b),
+    _mm_setr_ps(color.a, uv1.x, uv0.y, blendMode),
+    pz,
+    _mm_setr_ps(color.g, color.b, color.a, uv1.x),
+    _mm_setr_ps(uv1.y, blendMode, pos[3][0], pos[3][1]),
+    _mm_setr_ps(pos[3][2], color.r, color.g, color.b),
+    _mm_setr_ps(color.a, uv0.x, uv1.y, blendMode),
+  };
+  float* dst = reinterpret_cast<float*>(p);
+  if (isAligned) {
+    for (int i = 0; i < 10; ++i) {
+      _mm_stream_ps(dst + i * 4, blocks[i]);
+    }
+  } else {
+    for (int i = 0; i < 10; ++i) {
+      _mm_storeu_ps(dst + i * 4, blocks[i]);
+    }
+  }
+}
+#else
+/**
+* スプライト1個ぶんの4頂点を作成し、頂点バッファに書き込む(SSE2非対応環境用).
+*
+* @param p              書き込み先の頂点バッファへのポインタ.
+* @param sprite         頂点データの元になるスプライト.
+* @param reciprocalSize テクスチャの大きさの逆数.
+* @param uvOffset       テクスチャ座標に加えるオフセット.
+*/
+void WriteQuad(Vertex* p, const Sprite& sprite, const glm::vec2& reciprocalSize, const glm::vec2& uvOffset, bool)
+{
+  const Rect& rect = sprite.Rectangle();
+  const glm::mat4x4& m = sprite.Transform();
+  const glm::vec2 uv0 = rect.origin * reciprocalSize + uvOffset;
+  const glm::vec2 uv1 = uv0 + rect.size * reciprocalSize;
+  const glm::vec2 halfSize = rect.size * 0.5f;
+  const glm::vec2 corners[4] = {
+    { -halfSize.x, -halfSize.y }, { halfSize.x, -halfSize.y }, { halfSize.x, halfSize.y }, { -halfSize.x, halfSize.y }
+  };
+  const glm::vec2 texCoords[4] = { uv0, { uv1.x, uv0.y }, uv1, { uv0.x, uv1.y } };
+  for (int i = 0; i < 4; ++i) {
+    p[i].position = m * glm::vec4(corners[i], 0, 1);
+    p[i].color = sprite.Color();
+    p[i].texCoord = texCoords[i];
+    p[i].blendMode = sprite.ColorMode();
+  }
+}
+#endif // EASY_SPRITE_USE_SSE2
+
+/**
+* WriteQuadによる書き込みを完了させる.
+*
+* ストリーミングストアを使った場合、他のスレッドやGPUから参照する前に呼び出す必要がある.
+*/
+void FinishWriteQuad()
+{
+#ifdef EASY_SPRITE_USE_SSE2
+  _mm_sfence();
+#endif // EASY_SPRITE_USE_SSE2
+}
+
+/**
+* ポインタが16バイト境界に整列しているか調べる.
+*
+* @param p 調べるポインタ.
+*
+* @retval true  整列している.
+* @retval false 整列していない.
+*/
+bool IsAligned16(const void* p)
+{
+  return (reinterpret_cast<uintptr_t>(p) % 16) == 0;
+}
+
+/**
+* スプライト描画用のシェーダを取得する.
+*
+* @return スプライト描画用シェーダ.
+*
+* シェーダは全てのSpriteRendererで共有され、使用するSpriteRendererがなくなると破棄される.
+*/
+Shader::ProgramPtr GetSpriteProgram()
+{
+  static std::weak_ptr<Shader::Program> cache;
+  Shader::ProgramPtr p = cache.lock();
+  if (!p) {
+    p = Shader::Program::Create("Res/Shader/Sprite.vert", "Res/Shader/Sprite.frag");
+    cache = p;
+  }
+  return p;
+}
+
+const GLuint viewBindingPoint = 0; ///< ビュー情報UBOのバインディング・ポイント.
+const size_t viewsPerFrame = 64; ///< 1フレームで使用できるカメラ位置と画面サイズの組み合わせ数.
+
+/// 全てのSpriteRendererで共有するビュー情報UBO.
+std::weak_ptr<ViewBuffer> sharedViewBuffer;
+
+/**
+* ビュー情報UBOを取得する.
+*
+* @return ビュー情報UBO.
+*
+* UBOは全てのSpriteRendererで共有され、使用するSpriteRendererがなくなると破棄される.
+*/
+ViewBufferPtr GetViewBuffer()
+{
+  ViewBufferPtr p = sharedViewBuffer.lock();
+  if (!p) {
+    p = ViewBuffer::Create(viewsPerFrame, viewBindingPoint);
+    sharedViewBuffer = p;
+  }
+  return p;
+}
+
 } // unnamed namespace
 
 /**
-* Sprite쐬.
+* Spriteを作成する.
 *
-* @param texname eNX`t@C̃pX.
+* @param texname テクスチャファイルのパス.
 */
 Sprite::Sprite(const char* texname) :
   texture(Texture::LoadAndCache(texname))
 {
   if (texture) {
-    Rectangle({ glm::vec2(), glm::vec2(texture->Width(), texture->Height()) });
+    FitToTexture();
   }
 }
 
 /**
-* Sprite쐬.
+* Spriteを作成する.
 *
-* @param texname eNX`t@C̃pX.
-* @param pos     \W.
+* @param texname テクスチャファイルのパス.
+* @param pos     表示する座標.
 */
 Sprite::Sprite(const char* texname, const glm::vec3& pos) :
   texture(Texture::LoadAndCache(texname))
 {
   if (texture) {
-    Rectangle({ glm::vec2(), glm::vec2(texture->Width(), texture->Height()) });
+    FitToTexture();
   }
   Position(pos);
 }
 
 /**
-* Sprite쐬.
+* Spriteを作成する.
 *
-* @param texname eNX`t@C̃pX.
-* @param pos     \W.
-* @param r       eNX`̂ǂ̕\邩.
+* @param texname テクスチャファイルのパス.
+* @param pos     表示する座標.
+* @param r       テクスチャのどの部分を表示するか.
 */
 Sprite::Sprite(const char* texname, const glm::vec3& pos, const Rect& r) :
   texture(Texture::LoadAndCache(texname)),
@@ -155,16 +349,18 @@ Sprite::Sprite(const char* texname, const glm::vec3& pos, const Rect& r) :
 }
 
 /**
-* SpriteRXgN^.
+* Spriteコンストラクタ.
+*
+* texが非同期読み込み中の場合、表示範囲は読み込み完了後のUpdateでテクスチャ全体に合わせる.
 */
 Sprite::Sprite(const TexturePtr& tex) :
-  texture(tex),
-  rect({ glm::vec2(), glm::vec2(tex->Width(), tex->Height()) })
+  texture(tex)
 {
+  FitToTexture();
 }
 
 /**
-* SpriteRXgN^.
+* Spriteコンストラクタ.
 */
 Sprite::Sprite(const TexturePtr& tex, const Rect& r) :
   texture(tex),
@@ -173,36 +369,50 @@ Sprite::Sprite(const TexturePtr& tex, const Rect& r) :
 }
 
 /**
-* `ɎgpeNX`w肷.
+* 描画に使用するテクスチャを指定する.
 *
-* @param tex `ɎgpeNX`.
+* @param tex 描画に使用するテクスチャ.
 */
 void Sprite::Texture(const TexturePtr& tex)
 {
   texture = tex;
   if (tex) {
-    Rectangle({ glm::vec2(), glm::vec2(tex->Width(), tex->Height()) });
+    FitToTexture();
   }
 }
 
 /**
-* XvCg̏ԂXV.
+* 表示範囲をテクスチャ全体に合わせる.
 *
-* @param dt O̍XV̌oߎ.
+* 非同期読み込み中のテクスチャは大きさが決まっていないので、読み込みが完了したら合わせ直す.
+*/
+void Sprite::FitToTexture()
+{
+  rect = { glm::vec2(), glm::vec2(texture->Width(), texture->Height()) };
+  isFitPending = texture->IsLoading();
+}
+
+/**
+* スプライトの状態を更新する.
+*
+* @param dt 前回の更新からの経過時間.
 */
 void Sprite::Update(glm::f32 dt)
 {
   Node::Update(dt);
+  if (isFitPending && texture && !texture->IsLoading()) {
+    FitToTexture();
+  }
   if (animator) {
     animator->Update(*this, dt);
   }
 }
 
 /**
-* t[Aj[VIuWFNgݒ肷.
+* フレームアニメーションオブジェクトを設定する.
 *
-* @param p t[Aj[VIuWFNgւ̃|C^.
-*          t[Aj[Vɂnullptrw肷.
+* @param p フレームアニメーションオブジェクトへのポインタ.
+*          フレームアニメーションを解除するにはnullptrを指定する.
 */
 void Sprite::Animator(const FrameAnimation::AnimatePtr& p)
 {
@@ -213,9 +423,9 @@ void Sprite::Animator(const FrameAnimation::AnimatePtr& p)
 }
 
 /**
-* XvCg`悷.
+* スプライトを描画する.
 *
-* @param `s_[.
+* @param 描画を行うレンダラー.
 */
 void Sprite::Draw(SpriteRenderer& renderer) const
 {
@@ -223,7 +433,7 @@ void Sprite::Draw(SpriteRenderer& renderer) const
 }
 
 /**
-* SpriteRendererfXgN^.
+* SpriteRendererデストラクタ.
 */
 SpriteRenderer::~SpriteRenderer()
 {
@@ -231,103 +441,194 @@ SpriteRenderer::~SpriteRenderer()
 }
 
 /**
-* XvCg`NX.
+* スプライト描画クラスを初期化する.
 *
-* @param maxSpriteCount `\ȍőXvCg.
+* @param maxSpriteCount 描画可能な最大スプライト数.
 *
-* @retval true  .
-* @retval false s.
+* @retval true  初期化成功.
+* @retval false 初期化失敗.
+*
+* AutoGrow(true)を設定しておくと、maxSpriteCountを超えてスプライトが追加されたとき
+* 自動的に容量が拡張される.
 */
 bool SpriteRenderer::Initialize(size_t maxSpriteCount)
 {
   if (maxSpriteCount == vboCapacity / 4) {
-    return true; // ς.
+    return true; // 初期化済み.
   }
   Finalize();
 
-  vbo = CreateVBO(sizeof(Vertex) * maxSpriteCount * 4, nullptr);
-  std::vector<GLushort> indices;
-  indices.resize(maxSpriteCount * 6);
-  for (GLushort i = 0; i < maxSpriteCount; ++i) {
-    indices[i * 6 + 0] = (i * 4) + 0;
-    indices[i * 6 + 1] = (i * 4) + 1;
-    indices[i * 6 + 2] = (i * 4) + 2;
-    indices[i * 6 + 3] = (i * 4) + 2;
-    indices[i * 6 + 4] = (i * 4) + 3;
-    indices[i * 6 + 5] = (i * 4) + 0;
-  }
-  ibo = CreateIBO(indices.size() * sizeof(GLushort), indices.data());
-  vao = CreateVAO(vbo, ibo);
-  shaderProgram = Shader::CreateProgramFromFile("Res/Shader/Sprite.vert", "Res/Shader/Sprite.frag");
-  if (!vbo || !ibo || !vao || !shaderProgram) {
+  if (!CreateBuffers(maxSpriteCount)) {
+    return false;
+  }
+  program = GetSpriteProgram();
+  if (!program) {
+    return false;
+  }
+  viewBuffer = GetViewBuffer();
+  if (!viewBuffer || !viewBuffer->UniformBlockBinding(*program)) {
     return false;
   }
 
   vboSize = 0;
   pVBO = nullptr;
-  vboCapacity = static_cast<GLsizei>(4 * maxSpriteCount);
   return true;
 }
 
 /**
-* XvCg`NXI.
+* スプライト描画クラスを終了する.
 *
-* Initialize()ŏf[^jAȌԂɖ߂.
-* ̊֐ďoƁAĂInitialize()ĂяoďƂł.
+* Initialize()で初期化したデータを破棄し、初期化前の状態に戻す.
+* この関数を呼出したあと、再びInitialize()を呼び出して初期化し直すことができる.
 */
 void SpriteRenderer::Finalize()
 {
   drawDataList.clear();
-  if (shaderProgram) {
-    glDeleteProgram(shaderProgram);
+  program.reset();
+  viewBuffer.reset();
+  DestroyBuffers();
+}
+
+/**
+* VBO, IBO, VAOを作成する.
+*
+* @param maxSpriteCount 描画可能な最大スプライト数.
+*
+* @retval true  作成成功.
+* @retval false 作成失敗.
+*
+* 頂点数が16bitインデックスで表現できる範囲(65536個)を超える場合、IBOは32bitインデックスで作成される.
+*/
+bool SpriteRenderer::CreateBuffers(size_t maxSpriteCount)
+{
+  vbo = CreateVBO(sizeof(Vertex) * maxSpriteCount * 4, nullptr);
+  if (maxSpriteCount * 4 > 65536) {
+    indexType = GL_UNSIGNED_INT;
+    ibo = CreateQuadIBO<GLuint>(maxSpriteCount);
+  } else {
+    indexType = GL_UNSIGNED_SHORT;
+    ibo = CreateQuadIBO<GLushort>(maxSpriteCount);
+  }
+  vao = CreateVAO(vbo, ibo);
+  if (!vbo || !ibo || !vao || RenderBackend::Get().GetError() != GL_NO_ERROR) {
+    DestroyBuffers();
+    return false;
   }
+  vboCapacity = static_cast<GLsizei>(4 * maxSpriteCount);
+  return true;
+}
+
+/**
+* VBO, IBO, VAOを破棄する.
+*/
+void SpriteRenderer::DestroyBuffers()
+{
   if (vao) {
-    glDeleteVertexArrays(1, &vao);
+    GLState::DeleteVertexArray(vao);
+    vao = 0;
   }
   if (ibo) {
-    glDeleteBuffers(1, &ibo);
+    RenderBackend::Get().DeleteBuffer(ibo);
+    ibo = 0;
   }
   if (vbo) {
-    glDeleteBuffers(1, &vbo);
+    RenderBackend::Get().DeleteBuffer(vbo);
+    vbo = 0;
+  }
+  vboCapacity = 0;
+}
+
+/**
+* 頂点データの作成中にVBOの容量を2倍に拡張する.
+*
+* @retval true  拡張成功. pVBOは拡張後のVBOの書き込み位置を指す.
+* @retval false 拡張失敗. 元のVBOはマップを解除された状態になる.
+*
+* それまでに書き込んだ頂点データはGPU上でコピーされるため、同じフレームの描画結果は失われない.
+*/
+bool SpriteRenderer::Grow()
+{
+  const GLuint oldVbo = vbo;
+  const GLuint oldIbo = ibo;
+  const GLuint oldVao = vao;
+  const GLsizei oldCapacity = vboCapacity;
+  RenderBackend::Backend& backend = RenderBackend::Get();
+  backend.UnmapBuffer(GL_ARRAY_BUFFER, oldVbo);
+  pVBO = nullptr;
+
+  vbo = ibo = vao = 0;
+  if (!CreateBuffers(std::max<size_t>(oldCapacity / 4, 1) * 2)) {
+    vbo = oldVbo;
+    ibo = oldIbo;
+    vao = oldVao;
+    vboCapacity = oldCapacity;
+    std::cerr << "ERROR: SpriteRendererの容量を拡張できません(" << oldCapacity / 4 << ")" << std::endl;
+    return false;
   }
+
+  backend.CopyBufferSubData(oldVbo, vbo, 0, 0, sizeof(Vertex) * vboSize);
+  GLState::DeleteVertexArray(oldVao);
+  backend.DeleteBuffer(oldIbo);
+  backend.DeleteBuffer(oldVbo);
+
+  pVBO = static_cast<Vertex*>(backend.MapBufferRange(GL_ARRAY_BUFFER, vbo, sizeof(Vertex) * vboSize, sizeof(Vertex) * (vboCapacity - vboSize), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT));
+  stats[FrameStats::Counter_BytesMapped] += sizeof(Vertex) * (vboCapacity - vboSize);
+  return pVBO != nullptr;
 }
 
 /**
-* _f[^̍쐬Jn.
+* 頂点データの作成を開始する.
+*
+* 前回のBeginUpdate()から集計した処理量を1フレームぶんの結果として履歴に追加する.
 */
 void SpriteRenderer::BeginUpdate()
 {
   if (!vbo || pVBO) {
     return;
   }
-  glBindBuffer(GL_ARRAY_BUFFER, vbo);
-  pVBO = static_cast<Vertex*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, sizeof(Vertex) * vboCapacity, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+  if (hasStats) {
+    statsHistory.Push(stats);
+  }
+  stats = {};
+  hasStats = true;
+  pVBO = static_cast<Vertex*>(RenderBackend::Get().MapBufferRange(GL_ARRAY_BUFFER, vbo, 0, sizeof(Vertex) * vboCapacity, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+  stats[FrameStats::Counter_BytesMapped] += sizeof(Vertex) * vboCapacity;
   vboSize = 0;
   ClearDrawData();
 }
 
 /**
-* _f[^ǉ.
+* 頂点データを追加する.
 *
-* @param sprite _f[^̌ɂȂXvCg.
+* @param sprite 頂点データの元になるスプライト.
 *
-* @retval true  ǉ.
-* @retval false _obt@tŒǉłȂ.
+* @retval true  追加成功.
+* @retval false 頂点バッファが満杯で追加できない.
+*
+* AutoGrow(true)が設定されている場合、頂点バッファが満杯になると容量を拡張して追加を続ける.
 */
 bool SpriteRenderer::AddVertices(const Sprite& sprite)
 {
-  if (!pVBO || vboSize >= vboCapacity) {
+  ++stats[FrameStats::Counter_Submitted];
+  if (!pVBO) {
+    ++stats[FrameStats::Counter_Rejected];
     return false;
   }
+  if (vboSize >= vboCapacity) {
+    if (!autoGrow || !Grow()) {
+      ++stats[FrameStats::Counter_Rejected];
+      return false;
+    }
+  }
   const TexturePtr& texture = sprite.Texture();
   if (!texture) {
     return true;
   }
-  const glm::vec2 textureSize(texture->Width(), texture->Height());
-  const glm::vec2 reciprocalSize(glm::vec2(1) / textureSize);
+  glm::vec2 reciprocalSize, uvOffset;
+  GetTexCoordTransform(*texture, reciprocalSize, uvOffset);
 
   Rect rect = sprite.Rectangle();
-  rect.origin *= reciprocalSize;
+  rect.origin = rect.origin * reciprocalSize + uvOffset;
   rect.size *= reciprocalSize;
   const glm::vec2 halfSize = sprite.Rectangle().size * 0.5f;
   const glm::mat4x4& transform = sprite.Transform();
@@ -354,37 +655,250 @@ bool SpriteRenderer::AddVertices(const Sprite& sprite)
 
   pVBO += 4;
   vboSize += 4;
+  stats[FrameStats::Counter_Vertices] += 4;
+  AddDrawData(texture);
+  return true;
+}
+
+/**
+* 複数のスプライトの頂点データをまとめて追加する.
+*
+* @param first 追加するスプライトへのポインタ配列の先頭.
+* @param last  追加するスプライトへのポインタ配列の終端.
+*
+* @return 処理したスプライトの数.
+*         頂点バッファが満杯で追加できなかった場合はlast - firstより小さくなる.
+*
+* 結果はAddVertices(const Sprite&)を順番に呼び出した場合と同じになる.
+*/
+size_t SpriteRenderer::AddVertices(const Sprite* const* first, const Sprite* const* last)
+{
+  const size_t spriteCount = last - first;
+  stats[FrameStats::Counter_Submitted] += spriteCount;
+  if (!pVBO) {
+    stats[FrameStats::Counter_Rejected] += spriteCount;
+    return 0;
+  }
+  const GLsizei prevSize = vboSize;
+  const size_t n = threadCount > 1 && spriteCount >= minSpritesPerThread * 2 ?
+    AddVerticesParallel(first, last) : AddVerticesSerial(first, last);
+  stats[FrameStats::Counter_Rejected] += spriteCount - n;
+  stats[FrameStats::Counter_Vertices] += vboSize - prevSize;
+  return n;
+}
 
+/**
+* 複数のスプライトの頂点データを、呼び出したスレッドで順番に追加する.
+*
+* @param first 追加するスプライトへのポインタ配列の先頭.
+* @param last  追加するスプライトへのポインタ配列の終端.
+*
+* @return 処理したスプライトの数.
+*
+* SSE2が使える環境では4頂点の座標をまとめて計算し、ストリーミングストアで書き込む.
+* また、同じテクスチャが続く間はテクスチャの大きさの逆数を再計算しない.
+*/
+size_t SpriteRenderer::AddVerticesSerial(const Sprite* const* first, const Sprite* const* last)
+{
+  bool isAligned = IsAligned16(pVBO);
+  const Texture* prevTexture = nullptr;
+  glm::vec2 reciprocalSize, uvOffset;
+  size_t n = 0;
+  for (const Sprite* const* itr = first; itr != last; ++itr, ++n) {
+    const TexturePtr& texture = (*itr)->Texture();
+    if (!texture) {
+      continue;
+    }
+    if (vboSize >= vboCapacity) {
+      FinishWriteQuad();
+      if (!autoGrow || !Grow()) {
+        break;
+      }
+      isAligned = IsAligned16(pVBO);
+    }
+    if (texture.get() != prevTexture) {
+      prevTexture = texture.get();
+      GetTexCoordTransform(*texture, reciprocalSize, uvOffset);
+    }
+    WriteQuad(pVBO, **itr, reciprocalSize, uvOffset, isAligned);
+    pVBO += 4;
+    vboSize += 4;
+    AddDrawData(texture);
+  }
+  FinishWriteQuad();
+  return n;
+}
+
+/**
+* 複数のスプライトの頂点データを、複数のスレッドで分担して追加する.
+*
+* @param first 追加するスプライトへのポインタ配列の先頭.
+* @param last  追加するスプライトへのポインタ配列の終端.
+*
+* @return 処理したスプライトの数.
+*
+* 処理は次の順で行う.
+* 1. スプライト配列をスレッド数ぶんのチャンクに分け、各チャンクの描画スプライト数を並列に数える.
+* 2. 累積和によって各チャンクの書き込み開始位置を決める. 容量が足りなければここで拡張する.
+* 3. 各スレッドはマップ済みVBOの担当範囲に直接書き込み、チャンク内の描画データを作る.
+* 4. チャンクごとの描画データを順番に連結する.
+* 結果はシングルスレッドで追加した場合と同じになる.
+*/
+size_t SpriteRenderer::AddVerticesParallel(const Sprite* const* first, const Sprite* const* last)
+{
+  struct Chunk
+  {
+    const Sprite* const* first; ///< 担当するスプライト配列の先頭.
+    const Sprite* const* last; ///< 担当するスプライト配列の終端.
+    size_t offset; ///< 書き込み開始位置(スプライト数).
+    size_t count; ///< 書き込むスプライト数.
+    size_t consumed; ///< 処理したスプライト配列の要素数.
+    std::vector<DrawData> drawDataList; ///< チャンク内の描画データ.
+  };
+
+  const size_t spriteCount = last - first;
+  const size_t chunkCount = std::min(threadCount, spriteCount / minSpritesPerThread);
+  const size_t chunkSize = (spriteCount + chunkCount - 1) / chunkCount;
+  std::vector<Chunk> chunkList(chunkCount);
+  std::vector<std::future<void>> futureList;
+  futureList.reserve(chunkCount);
+
+  // 各チャンクの描画スプライト数を数える.
+  for (size_t i = 0; i < chunkCount; ++i) {
+    Chunk& chunk = chunkList[i];
+    chunk.first = first + std::min(spriteCount, i * chunkSize);
+    chunk.last = first + std::min(spriteCount, (i + 1) * chunkSize);
+    futureList.push_back(std::async(std::launch::async, [&chunk]() {
+      chunk.count = std::count_if(chunk.first, chunk.last, [](const Sprite* p) { return p->Texture() != nullptr; });
+    }));
+  }
+  for (auto& e : futureList) {
+    e.get();
+  }
+
+  // 累積和によって書き込み開始位置を決める.
+  size_t totalCount = 0;
+  for (auto& e : chunkList) {
+    e.offset = totalCount;
+    totalCount += e.count;
+  }
+  while (vboSize + totalCount * 4 > static_cast<size_t>(vboCapacity)) {
+    if (!autoGrow || !Grow()) {
+      break;
+    }
+  }
+  if (!pVBO) {
+    return 0;
+  }
+  const size_t room = (vboCapacity - vboSize) / 4;
+  for (auto& e : chunkList) {
+    e.count = e.offset >= room ? 0 : std::min(e.count, room - e.offset);
+  }
+
+  // 各スレッドが担当範囲に頂点データを書き込む.
+  Vertex* const base = pVBO;
+  futureList.clear();
+  for (auto& chunk : chunkList) {
+    futureList.push_back(std::async(std::launch::async, [&chunk, base]() {
+      Vertex* p = base + chunk.offset * 4;
+      const bool isAligned = IsAligned16(p);
+      const Texture* prevTexture = nullptr;
+      glm::vec2 reciprocalSize, uvOffset;
+      size_t written = 0;
+      const Sprite* const* itr = chunk.first;
+      for (; itr != chunk.last; ++itr) {
+        const TexturePtr& texture = (*itr)->Texture();
+        if (!texture) {
+          continue;
+        }
+        if (written >= chunk.count) {
+          break;
+        }
+        if (texture.get() != prevTexture) {
+          prevTexture = texture.get();
+          GetTexCoordTransform(*texture, reciprocalSize, uvOffset);
+        }
+        WriteQuad(p, **itr, reciprocalSize, uvOffset, isAligned);
+        p += 4;
+        if (chunk.drawDataList.empty() || chunk.drawDataList.back().texture->Page() != texture->Page()) {
+          chunk.drawDataList.push_back({ 6, (chunk.offset + written) * 6, texture });
+        } else {
+          chunk.drawDataList.back().count += 6;
+        }
+        ++written;
+      }
+      chunk.consumed = itr - chunk.first;
+      FinishWriteQuad();
+    }));
+  }
+  for (auto& e : futureList) {
+    e.get();
+  }
+
+  // チャンクごとの描画データを順番に連結する.
+  const size_t baseOffset = drawDataList.empty() ? 0 : drawDataList.back().offset + drawDataList.back().count;
+  size_t writtenCount = 0;
+  size_t consumedCount = 0;
+  bool isAllConsumed = true;
+  for (auto& chunk : chunkList) {
+    for (auto& e : chunk.drawDataList) {
+      if (!drawDataList.empty() && drawDataList.back().texture->Page() == e.texture->Page()) {
+        drawDataList.back().count += e.count;
+      } else {
+        drawDataList.push_back({ e.count, baseOffset + e.offset, std::move(e.texture) });
+      }
+    }
+    writtenCount += chunk.count;
+    if (isAllConsumed) {
+      consumedCount += chunk.consumed;
+      isAllConsumed = chunk.consumed == static_cast<size_t>(chunk.last - chunk.first);
+    }
+  }
+  pVBO += writtenCount * 4;
+  vboSize += static_cast<GLsizei>(writtenCount * 4);
+  return consumedCount;
+}
+
+/**
+* 描画データを追加する.
+*
+* @param texture 追加したスプライトのテクスチャ.
+*
+* 直前の描画データと同じテクスチャなら、新しい描画データを作らずにインデックス数を増やす.
+* 同じアトラスページを参照するサブテクスチャは同じテクスチャとみなす.
+* 読み込み中のテクスチャは代替テクスチャと同じIDを持つため、IDではなくテクスチャ自体で比較する.
+*/
+void SpriteRenderer::AddDrawData(const TexturePtr& texture)
+{
   if (drawDataList.empty()) {
-    drawDataList.push_back({ 6, 0, sprite.Texture() });
+    drawDataList.push_back({ 6, 0, texture });
   } else {
     auto& data = drawDataList.back();
-    if (data.texture == sprite.Texture()) {
+    if (data.texture->Page() == texture->Page()) {
       data.count += 6;
     } else {
-      drawDataList.push_back({ 6, data.offset + data.count * sizeof(GLushort), sprite.Texture() });
+      drawDataList.push_back({ 6, data.offset + data.count, texture });
     }
   }
-  return true;
 }
 
 /**
-* _f[^̍쐬I.
+* 頂点データの作成を終了する.
 */
 void SpriteRenderer::EndUpdate()
 {
   if (!pVBO) {
     return;
   }
-  glUnmapBuffer(GL_ARRAY_BUFFER);
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  RenderBackend::Get().UnmapBuffer(GL_ARRAY_BUFFER, vbo);
   pVBO = nullptr;
+  stats[FrameStats::Counter_Batches] = drawDataList.size();
 }
 
 /**
-* V[Ot`悷.
+* シーングラフを描画する.
 *
-* @param node V[Ot̃[gm[h.
+* @param node シーングラフのルートノード.
 */
 void SpriteRenderer::Update(const Node& node)
 {
@@ -404,10 +918,10 @@ void SpriteRenderer::Update(const Node& node)
 }
 
 /**
-* m[hXgXV.
+* ノードリストを更新する.
 *
 * @param node
-* @param spriteList `悷m[h̃Xg.
+* @param spriteList 描画するノードのリスト.
 */
 void SpriteRenderer::MakeNodeList(const Node& node, std::vector<const Node*>& nodeList)
 {
@@ -418,10 +932,25 @@ void SpriteRenderer::MakeNodeList(const Node& node, std::vector<const Node*>& no
 }
 
 /**
-* XvCg`悷.
+* 新しいフレームの描画を開始する.
+*
+* @param deltaTime 前フレームからの経過時間(秒).
 *
-* @param texture    `ɎgpeNX`.
-* @param screenSize ʃTCY.
+* 全てのSpriteRendererが共有するビュー情報UBOを次のフレーム用の領域に切り替える.
+* 毎フレーム、最初のDraw呼び出しより前に1回だけ実行すること.
+*/
+void SpriteRenderer::BeginFrame(float deltaTime)
+{
+  if (ViewBufferPtr p = sharedViewBuffer.lock()) {
+    p->BeginFrame(deltaTime);
+  }
+}
+
+/**
+* スプライトを描画する.
+*
+* @param texture    描画に使用するテクスチャ.
+* @param screenSize 画面サイズ.
 */
 void SpriteRenderer::Draw(const glm::vec2& screenSize) const
 {
@@ -429,37 +958,33 @@ void SpriteRenderer::Draw(const glm::vec2& screenSize) const
     return;
   }
 
-  glDisable(GL_DEPTH_TEST);
-  glEnable(GL_BLEND);
-  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  GLState::Disable(GL_DEPTH_TEST);
+  GLState::Enable(GL_BLEND);
+  GLState::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-  glUseProgram(shaderProgram);
+  program->UseProgram();
 
-  const GLint matMVPLoc = glGetUniformLocation(shaderProgram, "matMVP");
-  if (matMVPLoc >= 0) {
-    const glm::mat4x4 matProj = glm::ortho(-screenSize.x * 0.5f, screenSize.x * 0.5f, -screenSize.y * 0.5f, screenSize.y * 0.5f, 200.0f, 1200.0f);
-    //const glm::mat4x4 matProj = glm::perspective(glm::radians(45.0f), screenSize.x / screenSize.y, 200.0f, 1200.0f);
-    const glm::mat4x4 matView = glm::lookAt(glm::vec3(cameraPos.x, cameraPos.y, glm::tan(glm::radians(90.0f - 22.5f)) * screenSize.y * 0.5f), cameraPos, glm::vec3(0, 1, 0));
-    const glm::mat4x4 matMVP = matProj * matView;
-    glUniformMatrix4fv(matMVPLoc, 1, GL_FALSE, &matMVP[0][0]);
-  }
-
-  const GLint colorSamplerLoc = glGetUniformLocation(shaderProgram, "colorSampler");
-  if (colorSamplerLoc >= 0) {
-    glUniform1i(colorSamplerLoc, 0);
-    glActiveTexture(GL_TEXTURE0);
+  // 同じフレームで同じカメラを使う他のレイヤーとはUBOのスロットを共有する.
+  if (!viewBuffer->Bind(cameraPos, screenSize)) {
+    return;
   }
-
-  glBindVertexArray(vao);
+  RenderBackend::Backend& backend = RenderBackend::Get();
+  const size_t indexSize = indexType == GL_UNSIGNED_INT ? sizeof(GLuint) : sizeof(GLushort);
+  GLState::BindVertexArray(vao);
+  GLuint prevTexId = 0;
   for (const auto& data : drawDataList) {
-    glBindTexture(GL_TEXTURE_2D, data.texture->Id());
-    glDrawElements(GL_TRIANGLES, data.count, GL_UNSIGNED_SHORT, reinterpret_cast<const GLvoid*>(data.offset));
+    if (data.texture->Id() != prevTexId) {
+      prevTexId = data.texture->Id();
+      ++stats[FrameStats::Counter_TextureSwitches];
+    }
+    GLState::BindTexture(GL_TEXTURE0, GL_TEXTURE_2D, data.texture->Id());
+    backend.DrawElements(GL_TRIANGLES, static_cast<GLsizei>(data.count), indexType, data.offset * indexSize);
   }
-  glBindVertexArray(0);
+  stats[FrameStats::Counter_DrawCalls] += drawDataList.size();
 }
 
 /**
-* XvCg`f[^.
+* スプライト描画データを消去する.
 */
 void SpriteRenderer::ClearDrawData()
 {
@@ -5,17 +5,20 @@
 #define SPRITE_H_INCLUDED
 #include "Node.h"
 #include "Texture.h"
+#include "Shader.h"
+#include "ViewBuffer.h"
+#include "FrameStats.h"
 #include "FrameAnimation.h"
 #include <glm/glm.hpp>
 #include <vector>
 #include <memory>
 
-// s錾
+// 先行宣言
 class Sprite;
-using SpritePtr = std::shared_ptr<Sprite>; ///< XvCg|C^.
+using SpritePtr = std::shared_ptr<Sprite>; ///< スプライトポインタ.
 
 /**
-* `\.
+* 矩形構造体.
 */
 struct Rect
 {
@@ -23,11 +26,11 @@ struct Rect
   Rect(const glm::vec2& xy, const glm::vec2& wh) : origin(xy), size(wh) {}
   Rect(float x, float y, float w, float h) : origin(x, y), size(w, h) {}
 
-  glm::vec2 origin; ///< _.
-  glm::vec2 size; ///< c̕.
+  glm::vec2 origin; ///< 左下原点.
+  glm::vec2 size; ///< 縦横の幅.
 };
 
-/// F[h.
+/// 色合成モード.
 enum BlendMode {
   BlendMode_Multiply,
   BlendMode_Add,
@@ -35,7 +38,7 @@ enum BlendMode {
 };
 
 /**
-* XvCgNX.
+* スプライトクラス.
 */
 class Sprite : public Node
 {
@@ -53,7 +56,7 @@ public:
 
   const TexturePtr& Texture() const { return texture; }
   void Texture(const TexturePtr& tex);
-  void Rectangle(const Rect& r) { rect = r; }
+  void Rectangle(const Rect& r) { rect = r; isFitPending = false; }
   const Rect& Rectangle() const { return rect; }
   void Color(const glm::vec4& c) { color = c; }
   const glm::vec4& Color() const { return color; }
@@ -67,9 +70,11 @@ public:
 
 private:
   virtual void Draw(SpriteRenderer&) const override;
+  void FitToTexture();
 
   TexturePtr texture;
   Rect rect = { glm::vec2(0, 0), glm::vec2(1, 1) };
+  bool isFitPending = false; ///< true=テクスチャの読み込み完了後に、表示範囲をテクスチャ全体に合わせる.
   glm::vec4 color = glm::vec4(1);
   BlendMode colorMode = BlendMode_Multiply;
 
@@ -77,7 +82,7 @@ private:
 };
 
 /**
-* XvCg`NX.
+* スプライト描画クラス.
 */
 class SpriteRenderer
 {
@@ -95,25 +100,49 @@ public:
 
   void BeginUpdate();
   bool AddVertices(const Sprite&);
+  size_t AddVertices(const Sprite* const* first, const Sprite* const* last);
   void EndUpdate();
 
   const glm::vec3& CameraPosition() const { return cameraPos; }
   void CameraPosition(const glm::vec3& pos) { cameraPos = pos; }
+  void AutoGrow(bool b) { autoGrow = b; }
+  bool AutoGrow() const { return autoGrow; }
+  size_t MaxSpriteCount() const { return vboCapacity / 4; }
+  void ThreadCount(size_t n) { threadCount = n; }
+  size_t ThreadCount() const { return threadCount; }
+  const FrameStats::Counters& Stats() const { return stats; }
+  const FrameStats::History& StatsHistory() const { return statsHistory; }
+
+  static void BeginFrame(float deltaTime);
 
 private:
   void MakeNodeList(const Node&, std::vector<const Node*>&);
+  bool CreateBuffers(size_t maxSpriteCount);
+  void DestroyBuffers();
+  bool Grow();
+  void AddDrawData(const TexturePtr&);
+  size_t AddVerticesSerial(const Sprite* const* first, const Sprite* const* last);
+  size_t AddVerticesParallel(const Sprite* const* first, const Sprite* const* last);
 
   GLuint vbo = 0;
   GLuint ibo = 0;
   GLuint vao = 0;
-  GLuint shaderProgram = 0;
-  GLsizei vboCapacity = 0;        ///< VBOɊi[\ȍő咸_.
-  GLsizei vboSize = 0;            ///< VBOɊi[Ă钸_.
-  struct Vertex* pVBO = nullptr;  ///< VBOւ̃|C^.
+  Shader::ProgramPtr program;     ///< 描画用シェーダ(全てのSpriteRendererで共有).
+  ViewBufferPtr viewBuffer;       ///< ビュー情報UBO(全てのSpriteRendererで共有).
+  GLenum indexType = GL_UNSIGNED_SHORT; ///< IBOのインデックスの型.
+  GLsizei vboCapacity = 0;        ///< VBOに格納可能な最大頂点数.
+  GLsizei vboSize = 0;            ///< VBOに格納されている頂点数.
+  struct Vertex* pVBO = nullptr;  ///< VBOへのポインタ.
+  bool autoGrow = false;          ///< true=VBOが満杯になったら容量を拡張する. false=拡張しない.
+  size_t threadCount = 1;         ///< 頂点データの作成に使うスレッド数.
+  static const size_t minSpritesPerThread = 4096; ///< 1スレッドが担当する最小スプライト数.
+  mutable FrameStats::Counters stats = {}; ///< 現在のフレームの集計結果.
+  FrameStats::History statsHistory; ///< 完了したフレームの集計結果.
+  bool hasStats = false;          ///< true=statsに集計中のフレームがある.
 
   struct DrawData {
-    size_t count;
-    size_t offset;
+    size_t count;  ///< 描画するインデックス数.
+    size_t offset; ///< 描画を開始するインデックスの位置(バイト数ではなくインデックス数).
     TexturePtr texture;
   };
   std::vector<DrawData> drawDataList;
@@ -2,31 +2,286 @@
 * @file Texture.cpp
 */
 #include "Texture.h"
+#include "GLState.h"
+#include "RenderBackend.h"
 #include <iostream>
 #include <vector>
 #include <algorithm>
 #include <stdint.h>
 #include <stdio.h>
 #include <sys/stat.h>
+#include <string.h>
 #include <unordered_map>
+#include <list>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include "Png.h"
+#include "MappedFile.h"
 
-#include "d3dx12.h"
+#ifdef _WIN32
+#include <direct.h>
+#include <io.h>
+#else
+#include <dirent.h>
+#endif
+
+// WindowsではPNG以外の形式をWICで読み込む. EASY_TEXTURE_NO_WICを定義するとWICを使わない.
+#if defined(_WIN32) && !defined(EASY_TEXTURE_NO_WIC)
 #include <wrl/client.h>
 #include <wincodec.h>
+#define EASY_TEXTURE_USE_WIC
+#endif
+
+const size_t Texture::defaultCacheBudget;
+const size_t Texture::defaultUploadBytes;
 
 namespace /* unnamed */ {
 
-using TextureCache = std::unordered_map<std::string, TexturePtr>;
-TextureCache  textureCache;
+/**
+* キャッシュしたテクスチャの情報.
+*/
+struct CacheEntry
+{
+  TexturePtr texture;
+  size_t byteSize; ///< residentBytesに計上したバイト数.
+  bool isPinned; ///< true=上限を超えても取り除かない.
+};
+
+/**
+* VRAM使用量の上限を持つテクスチャキャッシュ.
+*
+* lruListは最近使ったテクスチャほど先頭に近くなるように並べる.
+* 上限を超えると、どこからも参照されていないテクスチャを末尾から順に取り除く.
+* テクスチャを取り除くとOpenGLのテクスチャが削除されるため、Trimはメインスレッドだけが呼び出す.
+*/
+struct TextureCache
+{
+  using List = std::list<CacheEntry>;
+
+  List lruList;
+  std::unordered_map<std::string, List::iterator> map; ///< テクスチャ名からlruListの要素を引く.
+  size_t budgetBytes = Texture::defaultCacheBudget;
+  size_t residentBytes = 0;
+  size_t pinnedCount = 0;
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  uint64_t evictions = 0;
+
+  /**
+  * テクスチャを検索し、最近使ったものとして先頭に移動する.
+  *
+  * @param name テクスチャ名.
+  *
+  * @return 見つかったテクスチャ. 見つからなければnullptr.
+  */
+  TexturePtr Find(const std::string& name)
+  {
+    auto itr = map.find(name);
+    if (itr == map.end()) {
+      ++misses;
+      return {};
+    }
+    ++hits;
+    lruList.splice(lruList.begin(), lruList, itr->second);
+    return itr->second->texture;
+  }
+
+  /**
+  * テクスチャを最近使ったものとして追加する. 同じ名前のテクスチャがあれば何もしない.
+  */
+  void Insert(const TexturePtr& tex)
+  {
+    if (map.find(tex->Name()) != map.end()) {
+      return;
+    }
+    lruList.push_front({ tex, tex->ByteSize(), false });
+    map.emplace(tex->Name(), lruList.begin());
+    residentBytes += tex->ByteSize();
+  }
+
+  /**
+  * 要素を取り除く.
+  */
+  void Erase(List::iterator itr)
+  {
+    residentBytes -= itr->byteSize;
+    if (itr->isPinned) {
+      --pinnedCount;
+    }
+    map.erase(itr->texture->Name());
+    lruList.erase(itr);
+  }
+
+  /**
+  * テクスチャの要素を検索する.
+  *
+  * @return 見つかった要素. texと同じ名前の別のテクスチャしかなければlruList.end().
+  */
+  List::iterator FindEntry(const TexturePtr& tex)
+  {
+    auto itr = map.find(tex->Name());
+    if (itr == map.end() || itr->second->texture != tex) {
+      return lruList.end();
+    }
+    return itr->second;
+  }
+
+  /**
+  * テクスチャの大きさが変わったことを反映する.
+  */
+  void UpdateByteSize(const TexturePtr& tex)
+  {
+    auto itr = FindEntry(tex);
+    if (itr != lruList.end()) {
+      residentBytes = residentBytes - itr->byteSize + tex->ByteSize();
+      itr->byteSize = tex->ByteSize();
+    }
+  }
+
+  /**
+  * 参照されていないテクスチャを、古いものから順に取り除く.
+  *
+  * @param targetBytes  VRAM使用量をこの値以下にする.
+  * @param evictedList  取り除いたテクスチャの格納先.
+  *
+  * テクスチャの削除にかかる時間でロックを長く保持しないように、取り除いたテクスチャは
+  * evictedListに移しておき、呼び出し側でロックを解除してから破棄する.
+  */
+  void Trim(size_t targetBytes, std::vector<TexturePtr>& evictedList)
+  {
+    for (auto itr = lruList.end(); residentBytes > targetBytes && itr != lruList.begin();) {
+      --itr;
+      // 大きさが0のもの(サブテクスチャや読み込み中のテクスチャ)は取り除いてもVRAMが空かない.
+      if (itr->isPinned || itr->byteSize == 0 || itr->texture.use_count() > 1) {
+        continue;
+      }
+      evictedList.push_back(std::move(itr->texture));
+      residentBytes -= itr->byteSize;
+      map.erase(evictedList.back()->Name());
+      itr = lruList.erase(itr);
+      ++evictions;
+    }
+  }
+};
+TextureCache textureCache;
+std::mutex cacheMutex; ///< textureCacheを保護する. 非同期読み込みは他のスレッドからも開始できる.
+
+/**
+* VRAM使用量が上限を超えていれば、参照されていないテクスチャを取り除く.
+*
+* メインスレッドから呼び出すこと.
+*/
+void TrimCache()
+{
+  std::vector<TexturePtr> evictedList;
+  {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    if (textureCache.residentBytes <= textureCache.budgetBytes) {
+      return;
+    }
+    textureCache.Trim(textureCache.budgetBytes, evictedList);
+  }
+}
+
+/**
+* CPU側に展開した画像.
+*/
+struct Image
+{
+  int width = 0; ///< 幅(ピクセル数).
+  int height = 0; ///< 高さ(ピクセル数).
+  GLenum iformat = GL_NONE; ///< テクスチャのデータ形式.
+  GLenum format = GL_NONE; ///< ピクセルの要素.
+  GLenum type = GL_NONE; ///< ピクセルの要素の型.
+  size_t pitch = 0; ///< 1行のバイト数. GL_UNPACK_ALIGNMENTの初期値に合わせて4の倍数にする.
+  std::vector<uint8_t> pixels; ///< 画像データ. 1行目が画像の最下行になる.
+};
+
+/**
+* テクスチャのデータ形式から、1ピクセルあたりのVRAM使用量を推定する.
+*
+* @param iformat テクスチャのデータ形式.
+*
+* @return 1ピクセルのバイト数.
+*/
+size_t GetBytesPerPixel(GLenum iformat)
+{
+  switch (iformat) {
+  case GL_R8:
+    return 1;
+  case GL_R16:
+  case GL_R16F:
+  case GL_RGB565:
+  case GL_RGB5_A1:
+    return 2;
+  case GL_RGBA16:
+  case GL_RGBA16F:
+    return 8;
+  case GL_RGBA32F:
+    return 16;
+  default:
+    return 4; // GL_RGB8も、多くのGPUでは4バイトに揃えて格納される.
+  }
+}
+
+/**
+* ファイルの内容をすべて読み込む.
+*
+* @param filename ファイル名.
+* @param buf      読み込んだ内容の格納先.
+*
+* @retval true  読み込み成功.
+* @retval false 読み込み失敗.
+*/
+bool ReadFile(const char* filename, std::vector<uint8_t>& buf)
+{
+  struct stat st;
+  if (stat(filename, &st)) {
+    return false;
+  }
+  FILE* fp = fopen(filename, "rb");
+  if (!fp) {
+    return false;
+  }
+  buf.resize(st.st_size);
+  const size_t readSize = fread(buf.data(), 1, buf.size(), fp);
+  fclose(fp);
+  return readSize == buf.size();
+}
 
 } // unnamed namespace
 
+#ifdef EASY_TEXTURE_USE_WIC
 namespace wic {
 
 using Microsoft::WRL::ComPtr;
 
 ComPtr<IWICImagingFactory> imagingFactory;
 
+/**
+* 呼び出したスレッドでCOMを初期化する.
+*
+* WICはスレッドごとにCOMの初期化が必要. 初期化はスレッドごとに一度だけ行い、スレッドの終了時に解除する.
+*/
+void InitializeThread()
+{
+  struct ComScope
+  {
+    ComScope() : hr(CoInitializeEx(nullptr, COINIT_MULTITHREADED)) {}
+    ~ComScope()
+    {
+      if (SUCCEEDED(hr)) {
+        CoUninitialize();
+      }
+    }
+    HRESULT hr;
+  };
+  static thread_local ComScope scope;
+}
+
 struct GLFormat
 {
   GLenum format;
@@ -36,12 +291,12 @@ struct GLFormat
 };
 
 /**
-* WICtH[}bgΉGLtH[}bg𓾂.
+* WICフォーマットから対応するGLフォーマットを得る.
 *
-* @param wicFormat WICtH[}bgGUID.
+* @param wicFormat WICフォーマットを示すGUID.
 *
-* @return wicFormatɑΉGLtH[}bg.
-*         ΉtH[}bgȂꍇGL_NONEԂ.
+* @return wicFormatに対応するGLフォーマット.
+*         対応するフォーマットが見つからない場合はGL_NONEを返す.
 */
 GLFormat GetGLFormatFromWICFormat(const WICPixelFormatGUID& wicFormat)
 {
@@ -54,9 +309,9 @@ GLFormat GetGLFormatFromWICFormat(const WICPixelFormatGUID& wicFormat)
     { GUID_WICPixelFormat64bppRGBA, { GL_RGBA, GL_RGBA16, GL_UNSIGNED_SHORT, 8 } },
     { GUID_WICPixelFormat32bppRGBA, { GL_RGBA, GL_RGBA8, GL_UNSIGNED_BYTE, 4 } },
     { GUID_WICPixelFormat32bppBGRA, { GL_BGRA, GL_RGBA8, GL_UNSIGNED_BYTE, 4 } },
-    { GUID_WICPixelFormat32bppBGR, { GL_BGR, GL_RGBA, GL_UNSIGNED_BYTE, 4 } },
-    { GUID_WICPixelFormat32bppRGBA1010102XR, { GL_RGB, GL_RGB10_A2, GL_UNSIGNED_INT_2_10_10_10_REV, 2 } },
-    { GUID_WICPixelFormat32bppRGBA1010102, { GL_RGBA, GL_RGB10_A2, GL_UNSIGNED_INT_2_10_10_10_REV, 2 } },
+    { GUID_WICPixelFormat32bppBGR, { GL_BGRA, GL_RGB8, GL_UNSIGNED_BYTE, 4 } },
+    { GUID_WICPixelFormat32bppRGBA1010102XR, { GL_RGB, GL_RGB10_A2, GL_UNSIGNED_INT_2_10_10_10_REV, 4 } },
+    { GUID_WICPixelFormat32bppRGBA1010102, { GL_RGBA, GL_RGB10_A2, GL_UNSIGNED_INT_2_10_10_10_REV, 4 } },
     { GUID_WICPixelFormat16bppBGRA5551, { GL_BGRA, GL_RGB5_A1, GL_UNSIGNED_SHORT_1_5_5_5_REV, 2 } },
     { GUID_WICPixelFormat16bppBGR565, { GL_BGRA, GL_RGB565, GL_UNSIGNED_SHORT_5_6_5, 2 } },
     { GUID_WICPixelFormat32bppGrayFloat, { GL_RED, GL_R32F, GL_FLOAT, 4 } },
@@ -74,13 +329,13 @@ GLFormat GetGLFormatFromWICFormat(const WICPixelFormatGUID& wicFormat)
 }
 
 /**
-* CӂWICtH[}bgGLtH[}bgƌ݊̂WICtH[}bg𓾂.
+* 任意のWICフォーマットからGLフォーマットと互換性のあるWICフォーマットを得る.
 *
-* @param wicFormat WICtH[}bgGUID.
+* @param wicFormat WICフォーマットのGUID.
 *
-* @return GLtH[}bgƌ݊̂WICtH[}bg.
-*         ̌`ł邾Čł悤ȃtH[}bgI΂.
-*         ̂悤ȃtH[}bgȂꍇGUID_WICPixelFormatDontCareԂ.
+* @return GLフォーマットと互換性のあるWICフォーマット.
+*         元の形式をできるだけ再現できるようなフォーマットが選ばれる.
+*         そのようなフォーマットが見つからない場合はGUID_WICPixelFormatDontCareを返す.
 */
 WICPixelFormatGUID GetGLCompatibleWICFormat(const WICPixelFormatGUID& wicFormat)
 {
@@ -136,21 +391,23 @@ WICPixelFormatGUID GetGLCompatibleWICFormat(const WICPixelFormatGUID& wicFormat)
 }
 
 /**
-* t@CeNX`ǂݍ.
+* 画像ファイルを開き、上下を反転するWICビットマップを作成する.
 *
-* @param texture   ǂݍ񂾃eNX`ǗIuWFNg.
-* @param index     ǂݍ񂾃eNX`pRTVfXNv^̃CfbNX.
-* @param filename  eNX`t@C.
+* @param filename    画像ファイル名.
+* @param flipRotator 作成したビットマップの格納先.
 *
-* @return 쐬ɐꍇ̓eNX`|C^Ԃ.
-*         sꍇnullptrԂ.
+* @retval true  作成成功.
+* @retval false 作成失敗.
+*
+* OpenGLのテクスチャは左下が原点なので、画像の上下を反転して読み出す.
 */
-TexturePtr LoadFromFile(const char* filename)
+bool OpenFlipped(const char* filename, ComPtr<IWICBitmapFlipRotator>& flipRotator)
 {
   if (!imagingFactory) {
-    std::cerr << "Texture::Initialize֐Ă΂Ă܂.\n" << "vȌTexture::Initialize֐ĂяoĂ." << std::endl;
-    return {};
+    std::cerr << "Texture::Initialize関数が呼ばれていません.\n" << "プログラムの初期化中にTexture::Initialize関数を呼び出してください." << std::endl;
+    return false;
   }
+  InitializeThread();
 
   std::vector<wchar_t> wcFilename(std::strlen(filename) + 1);
   mbstowcs(wcFilename.data(), filename, wcFilename.size());
@@ -158,94 +415,200 @@ TexturePtr LoadFromFile(const char* filename)
 
   ComPtr<IWICBitmapDecoder> decoder;
   if (FAILED(imagingFactory->CreateDecoderFromFilename(wcFilename.data(), nullptr, GENERIC_READ, WICDecodeMetadataCacheOnLoad, decoder.GetAddressOf()))) {
-    std::cerr << filename << "ǂݍ߂܂.\n" << "t@CmFĂ." << std::endl;
-    return {};
+    std::cerr << filename << "を読み込めません.\n" << "ファイル名を確認してください." << std::endl;
+    return false;
   }
   ComPtr<IWICBitmapFrameDecode> frame;
   if (FAILED(decoder->GetFrame(0, frame.GetAddressOf()))) {
-    return {};
+    return false;
   }
-  ComPtr<IWICBitmapFlipRotator> flipRotator;
   if (FAILED(imagingFactory->CreateBitmapFlipRotator(flipRotator.GetAddressOf()))) {
-    return {};
+    return false;
+  }
+  return SUCCEEDED(flipRotator->Initialize(frame.Get(), WICBitmapTransformFlipVertical));
+}
+
+/**
+* 画像ファイルを、対応するGLフォーマットのままCPU側に展開する.
+*
+* @param filename 画像ファイル名.
+* @param image    展開した画像の格納先.
+*
+* @retval true  展開成功.
+* @retval false 展開失敗.
+*
+* GPUを使わないので、ワーカースレッドからも呼び出せる.
+*/
+bool Decode(const char* filename, Image& image)
+{
+  ComPtr<IWICBitmapFlipRotator> flipRotator;
+  if (!OpenFlipped(filename, flipRotator)) {
+    return false;
   }
-  flipRotator->Initialize(frame.Get(), WICBitmapTransformFlipVertical);
 
   WICPixelFormatGUID wicFormat;
   if (FAILED(flipRotator->GetPixelFormat(&wicFormat))) {
-    return {};
+    return false;
   }
   UINT width, height;
   if (FAILED(flipRotator->GetSize(&width, &height))) {
-    return {};
+    return false;
   }
   GLFormat glFormat = GetGLFormatFromWICFormat(wicFormat);
-  bool imageConverted = false;
-  ComPtr<IWICFormatConverter> converter;
+  ComPtr<IWICBitmapSource> source = flipRotator;
   if (glFormat.format == GL_NONE) {
     const WICPixelFormatGUID compatibleFormat = GetGLCompatibleWICFormat(wicFormat);
     if (compatibleFormat == GUID_WICPixelFormatDontCare) {
-      std::cerr << filename << "ǂݍ߂܂.\n" << "t@C`mFĂ." << std::endl;
-      return {};
+      std::cerr << filename << "を読み込めません.\n" << "ファイル形式を確認してください." << std::endl;
+      return false;
     }
     glFormat = GetGLFormatFromWICFormat(compatibleFormat);
+    ComPtr<IWICFormatConverter> converter;
     if (FAILED(imagingFactory->CreateFormatConverter(converter.GetAddressOf()))) {
-      return {};
+      return false;
     }
     BOOL canConvert = FALSE;
     if (FAILED(converter->CanConvert(wicFormat, compatibleFormat, &canConvert))) {
-      return {};
+      return false;
     }
     if (!canConvert) {
-      return {};
+      return false;
     }
     if (FAILED(converter->Initialize(flipRotator.Get(), compatibleFormat, WICBitmapDitherTypeNone, nullptr, 0, WICBitmapPaletteTypeCustom))) {
-      return {};
+      return false;
     }
-    imageConverted = true;
+    source = converter;
   }
 
-  ComPtr<IWICBitmap> bitmap;
-  if (imageConverted) {
-    if (FAILED(imagingFactory->CreateBitmapFromSource(converter.Get(), WICBitmapNoCache, bitmap.GetAddressOf()))) {
-      return {};
-    }
-  } else {
-    if (FAILED(imagingFactory->CreateBitmapFromSource(flipRotator.Get(), WICBitmapNoCache, bitmap.GetAddressOf()))) {
-      return {};
-    }
+  // 展開先に直接コピーする. 行の末尾は4バイト境界まで詰め物をする.
+  const size_t pitch = (width * glFormat.byteSize + 3) & ~static_cast<size_t>(3);
+  image.pixels.resize(pitch * height);
+  if (FAILED(source->CopyPixels(nullptr, static_cast<UINT>(pitch), static_cast<UINT>(image.pixels.size()), image.pixels.data()))) {
+    return false;
   }
-  ComPtr<IWICBitmapLock> lock;
-  if (FAILED(bitmap->Lock(nullptr, WICBitmapLockRead, lock.GetAddressOf()))) {
-    return {};
+  image.width = width;
+  image.height = height;
+  image.iformat = glFormat.internalformat;
+  image.format = glFormat.format;
+  image.type = glFormat.type;
+  image.pitch = pitch;
+  return true;
+}
+
+/**
+* 画像ファイルを32bitRGBA形式で読み込む.
+*
+* @param filename 画像ファイル名.
+* @param width    画像の幅の格納先.
+* @param height   画像の高さの格納先.
+* @param pixels   画像データの格納先. 1行目が画像の最下行になる.
+*
+* @retval true  読み込み成功.
+* @retval false 読み込み失敗.
+*/
+bool LoadRGBA8(const char* filename, int& width, int& height, std::vector<uint8_t>& pixels)
+{
+  ComPtr<IWICBitmapFlipRotator> flipRotator;
+  if (!OpenFlipped(filename, flipRotator)) {
+    return false;
   }
-  UINT bmpBufferSize;
-  WICInProcPointer pData;
-  if (FAILED(lock->GetDataPointer(&bmpBufferSize, &pData))) {
-    return {};
+  UINT w, h;
+  if (FAILED(flipRotator->GetSize(&w, &h))) {
+    return false;
+  }
+  ComPtr<IWICFormatConverter> converter;
+  if (FAILED(imagingFactory->CreateFormatConverter(converter.GetAddressOf()))) {
+    return false;
   }
-  auto p = Texture::Create(width, height, glFormat.internalformat, glFormat.format, glFormat.type, pData);
-  if (p) {
-    p->Name(filename);
+  if (FAILED(converter->Initialize(flipRotator.Get(), GUID_WICPixelFormat32bppRGBA, WICBitmapDitherTypeNone, nullptr, 0, WICBitmapPaletteTypeCustom))) {
+    std::cerr << filename << "をRGBA形式に変換できません." << std::endl;
+    return false;
   }
-  return p;
+  pixels.resize(w * h * 4);
+  if (FAILED(converter->CopyPixels(nullptr, w * 4, static_cast<UINT>(pixels.size()), pixels.data()))) {
+    return false;
+  }
+  width = w;
+  height = h;
+  return true;
+}
+
+} // namespace wic
+#endif // EASY_TEXTURE_USE_WIC
+
+namespace /* unnamed */ {
+
+/**
+* 画像ファイルの内容を、対応するGLフォーマットのままCPU側に展開する.
+*
+* @param filename 画像ファイル名.
+* @param data     画像ファイルの内容.
+* @param size     dataのバイト数.
+* @param image    展開した画像の格納先.
+*
+* @retval true  展開成功.
+* @retval false 展開失敗.
+*
+* PNGは内蔵のデコーダでRGBA8に展開する. それ以外の形式はWICが使える場合だけ展開できる.
+* どちらもGPUを使わないので、ワーカースレッドからも呼び出せる.
+*/
+bool DecodeImage(const char* filename, const uint8_t* data, size_t size, Image& image)
+{
+  if (Png::IsPng(data, size)) {
+    if (!Png::Decode(data, size, image.width, image.height, image.pixels)) {
+      std::cerr << "WARNING: " << filename << "を展開できません.\n" << "PNGファイルが壊れていないか確認してください." << std::endl;
+      return false;
+    }
+    image.iformat = GL_RGBA8;
+    image.format = GL_RGBA;
+    image.type = GL_UNSIGNED_BYTE;
+    image.pitch = static_cast<size_t>(image.width) * 4;
+    return true;
+  }
+#ifdef EASY_TEXTURE_USE_WIC
+  return wic::Decode(filename, image);
+#else
+  std::cerr << "WARNING: " << filename << "を読み込めません.\n" << "この環境ではPNGとDDS以外の画像形式には対応していません." << std::endl;
+  return false;
+#endif
 }
 
-} // namespace dxgi
+/**
+* DDSファイルのDX10拡張ヘッダで使われる画像形式(DXGI_FORMATの値).
+*/
+enum DXGIFormat
+{
+  DXGIFormat_BC1_UNORM = 71,
+  DXGIFormat_BC1_UNORM_SRGB = 72,
+  DXGIFormat_BC2_UNORM = 74,
+  DXGIFormat_BC2_UNORM_SRGB = 75,
+  DXGIFormat_BC3_UNORM = 77,
+  DXGIFormat_BC3_UNORM_SRGB = 78,
+  DXGIFormat_BC4_UNORM = 80,
+  DXGIFormat_BC4_SNORM = 81,
+  DXGIFormat_BC5_UNORM = 83,
+  DXGIFormat_BC5_SNORM = 84,
+  DXGIFormat_BC6H_UF16 = 95,
+  DXGIFormat_BC6H_SF16 = 96,
+  DXGIFormat_BC7_UNORM = 98,
+  DXGIFormat_BC7_UNORM_SRGB = 99,
+};
+
+} // unnamed namespace
 
 /**
-* FOURCC쐬.
+* FOURCCを作成する.
 */
 #define MAKE_FOURCC(a, b, c, d) static_cast<uint32_t>(a + (b << 8) + (c << 16) + (d << 24))
 
 /**
-* oCg񂩂琔l𕜌.
+* バイト列から数値を復元する.
 *
-* @param p      oCgւ̃|C^.
-* @param offset l̃ItZbg.
-* @param size   l̃oCg(1`4).
+* @param p      バイト列へのポインタ.
+* @param offset 数値のオフセット.
+* @param size   数値のバイト数(1～4).
 *
-* @return l.
+* @return 復元した数値.
 */
 uint32_t Get(const uint8_t* p, size_t offset, size_t size)
 {
@@ -258,26 +621,26 @@ uint32_t Get(const uint8_t* p, size_t offset, size_t size)
 }
 
 /**
-* DDS摜.
+* DDS画像情報.
 */
 struct DDSPixelFormat
 {
-  uint32_t size; ///< ̍\̂̃oCg(32).
-  uint32_t flgas; ///< 摜Ɋ܂܂f[^̎ނtO.
-  uint32_t fourCC; ///< 摜tH[}bgFOURCC.
-  uint32_t rgbBitCount; ///< 1sNZ̃rbg.
-  uint32_t redBitMask; ///< ԗvfgrbg.
-  uint32_t greenBitMask; ///< Ηvfgrbg.
-  uint32_t blueBitMask; ///< vfgrbg.
-  uint32_t alphaBitMask; ///< vfgrbg.
+  uint32_t size; ///< この構造体のバイト数(32).
+  uint32_t flgas; ///< 画像に含まれるデータの種類を示すフラグ.
+  uint32_t fourCC; ///< 画像フォーマットを示すFOURCC.
+  uint32_t rgbBitCount; ///< 1ピクセルのビット数.
+  uint32_t redBitMask; ///< 赤要素が使う部分を示すビット.
+  uint32_t greenBitMask; ///< 緑要素が使う部分を示すビット.
+  uint32_t blueBitMask; ///< 青要素が使う部分を示すビット.
+  uint32_t alphaBitMask; ///< 透明要素が使う部分を示すビット.
 };
 
 /**
-* obt@DDS摜ǂݏo.
+* バッファからDDS画像情報を読み出す.
 *
-* @param buf ǂݏoobt@.
+* @param buf 読み出し元バッファ.
 *
-* @return ǂݏoDDS摜.
+* @return 読み出したDDS画像情報.
 */
 DDSPixelFormat ReadDDSPixelFormat(const uint8_t* buf)
 {
@@ -294,29 +657,29 @@ DDSPixelFormat ReadDDSPixelFormat(const uint8_t* buf)
 }
 
 /**
-* DDSt@Cwb_.
+* DDSファイルヘッダ.
 */
 struct DDSHeader
 {
-  uint32_t size;  ///< ̍\̂̃oCg(124).
-  uint32_t flags; ///< ǂ̃p[^LtO.
-  uint32_t height; ///< 摜̍(sNZ).
-  uint32_t width; ///< 摜̕(sNZ).
-  uint32_t pitchOrLinearSize; ///< ̃oCg܂͉摜1̃oCg.
-  uint32_t depth; ///< 摜̉s()(3eNX`Ŏgp).
-  uint32_t mipMapCount; ///< ܂܂Ă~bv}bvx.
-  uint32_t reserved1[11]; ///< (̂߂ɗ\񂳂Ă).
-  DDSPixelFormat ddspf; ///< DDS摜.
-  uint32_t caps[4]; ///< ܂܂Ă摜̎.
-  uint32_t reserved2; ///< (̂߂ɗ\񂳂Ă).
+  uint32_t size;  ///< この構造体のバイト数(124).
+  uint32_t flags; ///< どのパラメータが有効かを示すフラグ.
+  uint32_t height; ///< 画像の高さ(ピクセル数).
+  uint32_t width; ///< 画像の幅(ピクセル数).
+  uint32_t pitchOrLinearSize; ///< 横のバイト数または画像1枚のバイト数.
+  uint32_t depth; ///< 画像の奥行き(枚数)(3次元テクスチャ等で使用).
+  uint32_t mipMapCount; ///< 含まれているミップマップレベル数.
+  uint32_t reserved1[11]; ///< (将来のために予約されている).
+  DDSPixelFormat ddspf; ///< DDS画像情報.
+  uint32_t caps[4]; ///< 含まれている画像の種類.
+  uint32_t reserved2; ///< (将来のために予約されている).
 };
 
 /**
-* obt@DDSt@Cwb_ǂݏo.
+* バッファからDDSファイルヘッダを読み出す.
 *
-* @param buf ǂݏoobt@.
+* @param buf 読み出し元バッファ.
 *
-* @return ǂݏoDDSt@Cwb_.
+* @return 読み出したDDSファイルヘッダ.
 */
 DDSHeader ReadDDSHeader(const uint8_t* buf)
 {
@@ -336,23 +699,23 @@ DDSHeader ReadDDSHeader(const uint8_t* buf)
 }
 
 /**
-* DDSt@Cwb_(DirectX10g).
+* DDSファイルヘッダ(DirectX10拡張).
 */
 struct DDSHeaderDX10
 {
-  uint32_t dxgiFormat; ///< 摜̎(DX10ȍ~ɒǉꂽ).
-  uint32_t resourceDimension; ///< (1D or 2D or 3D).
-  uint32_t miscFlag; ///< 摜z肷gtO.
-  uint32_t arraySize; ///< i[Ă̂eNX`z̏ꍇA̔zTCY.
-  uint32_t reserved; ///< (̂߂ɗ\񂳂Ă).
+  uint32_t dxgiFormat; ///< 画像の種類(DX10以降に追加された種類).
+  uint32_t resourceDimension; ///< 次元数(1D or 2D or 3D).
+  uint32_t miscFlag; ///< 画像が想定する使われ方を示すフラグ.
+  uint32_t arraySize; ///< 格納されているのがテクスチャ配列の場合、その配列サイズ.
+  uint32_t reserved; ///< (将来のために予約されている).
 };
 
 /**
-* obt@DDSt@Cwb_(DirectX10g)ǂݏo.
+* バッファからDDSファイルヘッダ(DirectX10拡張)を読み出す.
 *
-* @param buf ǂݏoobt@.
+* @param buf 読み出し元バッファ.
 *
-* @return ǂݏoDDSt@Cwb_(DirectX10g).
+* @return 読み出したDDSファイルヘッダ(DirectX10拡張).
 */
 DDSHeaderDX10 ReadDDSHeaderDX10(const uint8_t* buf)
 {
@@ -366,266 +729,1533 @@ DDSHeaderDX10 ReadDDSHeaderDX10(const uint8_t* buf)
 }
 
 /**
-* DDSt@CeNX`쐬.
+* DDSファイルに格納された画像の配置.
+*/
+struct DDSLayout
+{
+  int width; ///< ミップレベル0の幅(ピクセル数).
+  int height; ///< ミップレベル0の高さ(ピクセル数).
+  GLenum iformat; ///< テクスチャのデータ形式.
+  GLenum format; ///< ピクセルの要素(非圧縮形式の場合).
+  bool isCompressed; ///< true=ブロック圧縮形式.
+  uint32_t blockSize; ///< 4x4ピクセルのブロックのバイト数(圧縮形式の場合).
+  uint32_t pixelSize; ///< 1ピクセルのバイト数(非圧縮形式の場合).
+  bool isCubemap; ///< true=キューブマップ.
+  int faceCount; ///< 面の数. キューブマップなら6、それ以外は1.
+  int levelCount; ///< ミップレベルの数.
+  size_t imageOffset; ///< 最初の画像のファイル先頭からのバイトオフセット.
+  size_t faceSize; ///< 1面ぶんの全ミップレベルのバイト数.
+};
+
+/**
+* ミップレベルの1面ぶんのバイト数を求める.
 *
-* @param filename DDSt@C.
-* @param st       DDSt@CXe[^X.
-* @param buf      t@Cǂݍ񂾃obt@.
-* @param header   DDSwb_i[ւ̃|C^.
+* @param layout DDSファイルの画像の配置.
+* @param level  ミップレベル.
 *
-* @retval 0ȊO 쐬eNX`ID.
-* @retval 0     쐬s.
+* @return levelの1面ぶんのバイト数.
 */
-GLuint LoadDDS(const char* filename, const struct stat& st, const uint8_t* buf, DDSHeader* pHeader)
+size_t GetDDSLevelSize(const DDSLayout& layout, int level)
 {
-  if (st.st_size < 128) {
-    std::cerr << "WARNING: " << filename << "DDSt@Cł͂܂." << std::endl;
-    return 0;
+  const size_t w = std::max(1, layout.width >> level);
+  const size_t h = std::max(1, layout.height >> level);
+  if (layout.isCompressed) {
+    return ((w + 3) / 4) * ((h + 3) / 4) * layout.blockSize;
+  }
+  return w * h * layout.pixelSize;
+}
+
+/**
+* ミップレベルの画像の、ファイル先頭からのバイトオフセットを求める.
+*
+* @param layout DDSファイルの画像の配置.
+* @param face   面の番号.
+* @param level  ミップレベル.
+*
+* @return 画像のバイトオフセット.
+*
+* DDSファイルは、面ごとにミップレベル0から順に画像が並んでいる.
+*/
+size_t GetDDSLevelOffset(const DDSLayout& layout, int face, int level)
+{
+  size_t offset = layout.imageOffset + layout.faceSize * face;
+  for (int i = 0; i < level; ++i) {
+    offset += GetDDSLevelSize(layout, i);
+  }
+  return offset;
+}
+
+/**
+* DDSファイルのヘッダから画像の配置を読み取る.
+*
+* @param filename DDSファイル名.
+* @param buf      ファイルの内容.
+* @param size     bufのバイト数.
+* @param layout   画像の配置の格納先.
+*
+* @retval true  読み取り成功.
+* @retval false DDSファイルではないか、未対応の形式か、ファイルが途中で切れている.
+*
+* GPUを使わないので、ワーカースレッドからも呼び出せる.
+*/
+bool ReadDDSLayout(const char* filename, const uint8_t* buf, size_t size, DDSLayout& layout)
+{
+  if (size < 128 || memcmp(buf, "DDS ", 4) != 0) {
+    std::cerr << "WARNING: " << filename << "はDDSファイルではありません." << std::endl;
+    return false;
   }
 
   const DDSHeader header = ReadDDSHeader(buf + 4);
   if (header.size != 124) {
-    std::cerr << "WARNING: " << filename << "DDSt@Cł͂܂." << std::endl;
-    return 0;
+    std::cerr << "WARNING: " << filename << "はDDSファイルではありません." << std::endl;
+    return false;
   }
-  GLenum iformat;
-  GLenum format = GL_RGBA;
-  size_t imageOffset = 128;
-  uint32_t blockSize = 16;
-  bool isCompressed = false;
+  layout.width = header.width;
+  layout.height = header.height;
+  layout.iformat = GL_NONE;
+  layout.format = GL_RGBA;
+  layout.imageOffset = 128;
+  layout.blockSize = 16;
+  layout.pixelSize = 4;
+  layout.isCompressed = false;
   if (header.ddspf.flgas & 0x04) {
     switch (header.ddspf.fourCC) {
     case MAKE_FOURCC('D', 'X', 'T', '1'):
-      iformat = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
-      blockSize = 8;
+      layout.iformat = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+      layout.blockSize = 8;
       break;
     case MAKE_FOURCC('D', 'X', 'T', '2'):
     case MAKE_FOURCC('D', 'X', 'T', '3'):
-      iformat = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+      layout.iformat = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
       break;
     case MAKE_FOURCC('D', 'X', 'T', '4'):
     case MAKE_FOURCC('D', 'X', 'T', '5'):
-      iformat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+      layout.iformat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
       break;
     case MAKE_FOURCC('B', 'C', '4', 'U'):
-      iformat = GL_COMPRESSED_RED_RGTC1;
-      blockSize = 8;
+      layout.iformat = GL_COMPRESSED_RED_RGTC1;
+      layout.blockSize = 8;
       break;
     case MAKE_FOURCC('B', 'C', '4', 'S'):
-      iformat = GL_COMPRESSED_SIGNED_RED_RGTC1;
-      blockSize = 8;
+      layout.iformat = GL_COMPRESSED_SIGNED_RED_RGTC1;
+      layout.blockSize = 8;
       break;
     case MAKE_FOURCC('B', 'C', '5', 'U'):
-      iformat = GL_COMPRESSED_RG_RGTC2;
+      layout.iformat = GL_COMPRESSED_RG_RGTC2;
       break;
     case MAKE_FOURCC('B', 'C', '5', 'S'):
-      iformat = GL_COMPRESSED_SIGNED_RG_RGTC2;
+      layout.iformat = GL_COMPRESSED_SIGNED_RG_RGTC2;
       break;
     case MAKE_FOURCC('D', 'X', '1', '0'):
     {
+      if (size < 128 + 20) {
+        std::cerr << "WARNING: " << filename << "はDDSファイルではありません." << std::endl;
+        return false;
+      }
       const DDSHeaderDX10 headerDX10 = ReadDDSHeaderDX10(buf + 128);
       switch (headerDX10.dxgiFormat) {
-      case DXGI_FORMAT_BC1_UNORM: iformat = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT; blockSize = 8; break;
-      case DXGI_FORMAT_BC2_UNORM: iformat = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT; break;
-      case DXGI_FORMAT_BC3_UNORM: iformat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT; break;
-      case DXGI_FORMAT_BC1_UNORM_SRGB: iformat = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT; blockSize = 8; break;
-      case DXGI_FORMAT_BC2_UNORM_SRGB: iformat = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT; break;
-      case DXGI_FORMAT_BC3_UNORM_SRGB: iformat = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT; break;
-      case DXGI_FORMAT_BC4_UNORM: iformat = GL_COMPRESSED_RED_RGTC1; blockSize = 8; break;
-      case DXGI_FORMAT_BC4_SNORM: iformat = GL_COMPRESSED_SIGNED_RED_RGTC1; blockSize = 8; break;
-      case DXGI_FORMAT_BC5_UNORM: iformat = GL_COMPRESSED_RG_RGTC2; break;
-      case DXGI_FORMAT_BC5_SNORM: iformat = GL_COMPRESSED_SIGNED_RG_RGTC2; break;
-      case DXGI_FORMAT_BC6H_UF16: iformat = GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT; break;
-      case DXGI_FORMAT_BC6H_SF16: iformat = GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT; break;
-      case DXGI_FORMAT_BC7_UNORM: iformat = GL_COMPRESSED_RGBA_BPTC_UNORM; break;
-      case DXGI_FORMAT_BC7_UNORM_SRGB: iformat = GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM; break;
+      case DXGIFormat_BC1_UNORM: layout.iformat = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT; layout.blockSize = 8; break;
+      case DXGIFormat_BC2_UNORM: layout.iformat = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT; break;
+      case DXGIFormat_BC3_UNORM: layout.iformat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT; break;
+      case DXGIFormat_BC1_UNORM_SRGB: layout.iformat = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT; layout.blockSize = 8; break;
+      case DXGIFormat_BC2_UNORM_SRGB: layout.iformat = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT; break;
+      case DXGIFormat_BC3_UNORM_SRGB: layout.iformat = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT; break;
+      case DXGIFormat_BC4_UNORM: layout.iformat = GL_COMPRESSED_RED_RGTC1; layout.blockSize = 8; break;
+      case DXGIFormat_BC4_SNORM: layout.iformat = GL_COMPRESSED_SIGNED_RED_RGTC1; layout.blockSize = 8; break;
+      case DXGIFormat_BC5_UNORM: layout.iformat = GL_COMPRESSED_RG_RGTC2; break;
+      case DXGIFormat_BC5_SNORM: layout.iformat = GL_COMPRESSED_SIGNED_RG_RGTC2; break;
+      case DXGIFormat_BC6H_UF16: layout.iformat = GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT; break;
+      case DXGIFormat_BC6H_SF16: layout.iformat = GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT; break;
+      case DXGIFormat_BC7_UNORM: layout.iformat = GL_COMPRESSED_RGBA_BPTC_UNORM; break;
+      case DXGIFormat_BC7_UNORM_SRGB: layout.iformat = GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM; break;
       default:
-        std::cerr << "WARNING: " << filename << "͖ΉDDSt@Cł." << std::endl;
-        return 0;
+        std::cerr << "WARNING: " << filename << "は未対応のDDSファイルです." << std::endl;
+        return false;
       }
-      imageOffset = 128 + 20; // DX10wb_̂ԂZ.
+      layout.imageOffset = 128 + 20; // DX10ヘッダのぶんを加算.
       break;
     }
     default:
-      std::cerr << "WARNING: " << filename << "͖ΉDDSt@Cł." << std::endl;
-      return 0;
+      std::cerr << "WARNING: " << filename << "は未対応のDDSファイルです." << std::endl;
+      return false;
     }
-    isCompressed = true;
+    layout.isCompressed = true;
   } else if (header.ddspf.flgas & 0x40) {
     if (header.ddspf.redBitMask == 0xff) {
-      iformat = header.ddspf.alphaBitMask ? GL_RGBA8 : GL_RGB8;
-      format = header.ddspf.alphaBitMask ? GL_RGBA : GL_RGB;
+      layout.iformat = header.ddspf.alphaBitMask ? GL_RGBA8 : GL_RGB8;
+      layout.format = header.ddspf.alphaBitMask ? GL_RGBA : GL_RGB;
     } else if (header.ddspf.blueBitMask == 0xff) {
-      iformat = header.ddspf.alphaBitMask ? GL_RGBA8 : GL_RGB8;
-      format = header.ddspf.alphaBitMask ? GL_BGRA : GL_BGR;
+      layout.iformat = header.ddspf.alphaBitMask ? GL_RGBA8 : GL_RGB8;
+      layout.format = header.ddspf.alphaBitMask ? GL_BGRA : GL_BGR;
     }
-  } else {
-    std::cerr << "WARNING: " << filename << "͖ΉDDSt@Cł." << std::endl;
-    return 0;
+    layout.pixelSize = header.ddspf.rgbBitCount / 8;
   }
-
-  const bool isCubemap = header.caps[1] & 0x200;
-  const GLenum target = isCubemap ? GL_TEXTURE_CUBE_MAP_POSITIVE_X : GL_TEXTURE_2D;
-  const int faceCount = isCubemap ? 6 : 1;
-
-  GLuint texId;
-  glGenTextures(1, &texId);
-  glBindTexture(isCubemap ? GL_TEXTURE_CUBE_MAP : GL_TEXTURE_2D, texId);
-
-  const uint8_t* data = buf + imageOffset;
-  for (int faceIndex = 0; faceIndex < faceCount; ++faceIndex) {
-    GLsizei curWidth = header.width;
-    GLsizei curHeight = header.height;
-    for (int mipLevel = 0; mipLevel < static_cast<int>(header.mipMapCount); ++mipLevel) {
-      uint32_t imageSizeWithPadding;
-      if (isCompressed) {
-        imageSizeWithPadding = ((curWidth + 3) / 4) * ((curHeight + 3) / 4) * blockSize;
-      } else {
-        imageSizeWithPadding = curWidth * curHeight * 4;
-      }
-      if (isCompressed) {
-        glCompressedTexImage2D(target + faceIndex, mipLevel, iformat, curWidth, curHeight, 0, imageSizeWithPadding, data);
-      } else {
-        glTexImage2D(target + faceIndex, mipLevel, iformat, curWidth, curHeight, 0, format, GL_UNSIGNED_BYTE, data);
-      }
-      const GLenum result = glGetError();
-      switch(result) {
-      case GL_NO_ERROR:
-        break;
-      case GL_INVALID_OPERATION:
-        std::cerr << "WARNING: " << filename << "̓ǂݍ݂Ɏs." << std::endl;
-        break;
-      default:
-        std::cerr << "WARNING: " << filename << "̓ǂݍ݂Ɏs(" << std::hex << result << ")." << std::endl;
-        break;
-      }
-      curWidth = std::max(1, curWidth / 2);
-      curHeight = std::max(1, curHeight / 2);
-      data += imageSizeWithPadding;
-    }
+  if (layout.iformat == GL_NONE || layout.pixelSize == 0 || layout.width <= 0 || layout.height <= 0) {
+    std::cerr << "WARNING: " << filename << "は未対応のDDSファイルです." << std::endl;
+    return false;
   }
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, header.mipMapCount - 1);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, header.mipMapCount <= 1 ? GL_LINEAR : GL_LINEAR_MIPMAP_NEAREST);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
-  glBindTexture(GL_TEXTURE_2D, 0);
-  *pHeader = header;
-  return texId;
+  layout.isCubemap = header.caps[1] & 0x200;
+  layout.faceCount = layout.isCubemap ? 6 : 1;
+  // ミップマップを含まないファイルではmipMapCountが0のこともある.
+  layout.levelCount = std::max(1, static_cast<int>(std::min<uint32_t>(header.mipMapCount, 32)));
+  layout.faceSize = 0;
+  for (int level = 0; level < layout.levelCount; ++level) {
+    layout.faceSize += GetDDSLevelSize(layout, level);
+  }
+  if (size < layout.imageOffset + layout.faceSize * layout.faceCount) {
+    std::cerr << "WARNING: " << filename << "の画像データが不足しています." << std::endl;
+    return false;
+  }
+  return true;
 }
 
 /**
-* fXgN^.
+* DDSファイル用のテクスチャを作成する.
+*
+* @param layout DDSファイルの画像の配置.
+*
+* @return 作成したテクスチャID.
+*
+* 作成したテクスチャはGL_TEXTURE0にバインドしたままにする.
+* 画像はまだ転送していないので、呼び出し側でUploadDDSLevelを呼び出すこと.
 */
-Texture::~Texture()
+GLuint CreateDDSTexture(const DDSLayout& layout)
 {
-  if (texId) {
-    glDeleteTextures(1, &texId);
-  }
+  RenderBackend::Backend& backend = RenderBackend::Get();
+  const GLenum target = layout.isCubemap ? GL_TEXTURE_CUBE_MAP : GL_TEXTURE_2D;
+  const GLuint texId = backend.CreateTexture();
+  GLState::BindTexture(GL_TEXTURE0, target, texId);
+  backend.TexParameteri(target, GL_TEXTURE_MAX_LEVEL, layout.levelCount - 1);
+  backend.TexParameteri(target, GL_TEXTURE_MIN_FILTER, layout.levelCount <= 1 ? GL_LINEAR : GL_LINEAR_MIPMAP_NEAREST);
+  backend.TexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  backend.TexParameteri(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  backend.TexParameteri(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  return texId;
 }
 
 /**
-* DXGI摜ǂݍ݋@\̏.
+* ミップレベルの画像を、すべての面についてバインド中のテクスチャへ転送する.
 *
-* @retval true .
-* @retval false s.
+* @param filename DDSファイル名.
+* @param layout   DDSファイルの画像の配置.
+* @param buf      ファイルの内容. メモリマップトファイルから直接転送する.
+* @param level    転送するミップレベル.
+*
+* @return 転送したバイト数.
 */
-bool Texture::Initialize()
+size_t UploadDDSLevel(const char* filename, const DDSLayout& layout, const uint8_t* buf, int level)
 {
-  if (!wic::imagingFactory) {
-    if (FAILED(CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&wic::imagingFactory)))) {
-      std::cout << "WICImagingFactory̍쐬Ɏs." << std::endl;
-      return false;
+  RenderBackend::Backend& backend = RenderBackend::Get();
+  const GLenum target = layout.isCubemap ? GL_TEXTURE_CUBE_MAP_POSITIVE_X : GL_TEXTURE_2D;
+  const GLsizei w = std::max(1, layout.width >> level);
+  const GLsizei h = std::max(1, layout.height >> level);
+  const size_t levelSize = GetDDSLevelSize(layout, level);
+  for (int face = 0; face < layout.faceCount; ++face) {
+    const uint8_t* data = buf + GetDDSLevelOffset(layout, face, level);
+    if (layout.isCompressed) {
+      backend.CompressedTexImage2D(target + face, level, layout.iformat, w, h, static_cast<GLsizei>(levelSize), data);
+    } else {
+      backend.TexImage2D(target + face, level, layout.iformat, w, h, layout.format, GL_UNSIGNED_BYTE, data);
+    }
+    const GLenum result = backend.GetError();
+    switch(result) {
+    case GL_NO_ERROR:
+      break;
+    case GL_INVALID_OPERATION:
+      std::cerr << "WARNING: " << filename << "の読み込みに失敗." << std::endl;
+      break;
+    default:
+      std::cerr << "WARNING: " << filename << "の読み込みに失敗(" << std::hex << result << std::dec << ")." << std::endl;
+      break;
     }
   }
-
-  textureCache.reserve(1024);
-
-  return true;
+  return levelSize * layout.faceCount;
 }
 
 /**
-* DXGI摜ǂݍ݋@\̏.
+* 画像の配置に従って、すべてのミップレベルを転送したテクスチャを作成する.
+*
+* @param filename 画像ファイル名.
+* @param layout   画像の配置.
+* @param buf      ファイルの内容.
+*
+* @retval 0以外 作成したテクスチャID.
+* @retval 0     作成失敗.
 */
-void Texture::Finalize()
+GLuint LoadLevels(const char* filename, const DDSLayout& layout, const uint8_t* buf)
 {
-  wic::imagingFactory.Reset();
+  const GLuint texId = CreateDDSTexture(layout);
+  if (!texId) {
+    return 0;
+  }
+  for (int level = 0; level < layout.levelCount; ++level) {
+    UploadDDSLevel(filename, layout, buf, level);
+  }
+  GLState::BindTexture(GL_TEXTURE0, layout.isCubemap ? GL_TEXTURE_CUBE_MAP : GL_TEXTURE_2D, 0);
+  return texId;
 }
 
 /**
-* eNX`LbV.
+* DDSファイルからテクスチャを作成する.
 *
-* @param tex LbVΏۂ̃eNX`.
+* @param filename DDSファイル名.
+* @param buf      ファイルの内容.
+* @param size     bufのバイト数.
+* @param layout   画像の配置の格納先.
+*
+* @retval 0以外 作成したテクスチャID.
+* @retval 0     作成失敗.
+*
+* すべてのミップレベルを一度に転送する.
 */
-void Texture::Cache(const TexturePtr& tex)
+GLuint LoadDDS(const char* filename, const uint8_t* buf, size_t size, DDSLayout& layout)
 {
-  auto itr = textureCache.find(tex->name);
-  if (itr == textureCache.end()) {
-    textureCache.emplace(tex->name, tex);
+  if (!ReadDDSLayout(filename, buf, size, layout)) {
+    return 0;
   }
+  return LoadLevels(filename, layout, buf);
 }
 
+namespace /* unnamed */ {
+
 /**
-* eNX`t@CLbVĂ邩ׂ.
+* 展開済み画像のディスクキャッシュの設定.
 *
-* @param filename eNX`t@C̃pX.
+* Texture::SetDiskCacheでだけ変更する. ワーカースレッドは読み取りだけを行う.
+*/
+struct DiskCacheSettings
+{
+  std::string directory; ///< キャッシュファイルを置くディレクトリ. 空ならディスクキャッシュを使わない.
+  bool generateMipmaps = false; ///< true=ミップマップを作成して格納する.
+};
+DiskCacheSettings diskCacheSettings;
+
+const char diskCacheMagic[4] = { 'E', 'T', 'E', 'X' }; ///< キャッシュファイルの識別子.
+const uint32_t diskCacheVersion = 1; ///< キャッシュファイルの形式のバージョン.
+const char diskCacheExtension[] = ".tex"; ///< キャッシュファイルの拡張子.
+const char diskCacheTempExtension[] = ".tmp"; ///< 書き込み途中のキャッシュファイルの拡張子.
+std::atomic<unsigned int> diskCacheTempCounter(0); ///< 一時ファイル名を重複させないためのカウンタ.
+
+/**
+* ディスクキャッシュファイルのヘッダ.
 *
-* @retval true  filepath̓LbVĂ.
-* @retval false filepath̓LbVĂȂ.
+* ヘッダの後ろに元ファイルのパス(終端の0を含まない)が続き、その後ろの16バイト境界から
+* RGBA8形式の画像がミップレベル0から順に並ぶ. 画像はテクスチャと同じく1行目が最下行になる.
+* 同じプログラムで書き込んで読み込むだけなので、エンディアンは変換しない.
 */
-bool Texture::IsCached(const char* filename)
+struct DiskCacheHeader
 {
-  return textureCache.find(filename) != textureCache.end();
-}
+  char magic[4]; ///< ファイル識別子.
+  uint32_t version; ///< ファイル形式のバージョン.
+  int64_t mtime; ///< 元ファイルの更新日時.
+  uint64_t sourceSize; ///< 元ファイルのバイト数.
+  uint64_t contentHash; ///< 元ファイルの内容のハッシュ値.
+  uint32_t width; ///< ミップレベル0の幅(ピクセル数).
+  uint32_t height; ///< ミップレベル0の高さ(ピクセル数).
+  uint32_t levelCount; ///< ミップレベルの数.
+  uint32_t pathLength; ///< 元ファイルのパスのバイト数.
+};
+
+/**
+* ディスクキャッシュを照合するための、元ファイルの情報.
+*/
+struct DiskCacheKey
+{
+  std::string cachePath; ///< キャッシュファイルのパス. 空ならディスクキャッシュを使わない.
+  int64_t mtime = 0; ///< 元ファイルの更新日時.
+  uint64_t sourceSize = 0; ///< 元ファイルのバイト数.
+};
 
 /**
-* eNX`ǂݍ݁ALbV.
+* FNV-1a(64ビット)でハッシュ値を計算する.
 *
-* @param filepath eNX`t@C̃pX.
+* @param data ハッシュ値を計算するデータ.
+* @param size dataのバイト数.
 *
-* @return 쐬ɐꍇ̓eNX`|C^Ԃ.
-*         sꍇnullptrԂ.
+* @return dataのハッシュ値.
 */
-TexturePtr Texture::LoadAndCache(const char* filename)
+uint64_t HashFnv1a64(const void* data, size_t size)
 {
-  auto itr = textureCache.find(filename);
-  if (itr != textureCache.end()) {
-    return itr->second;
-  }
-  TexturePtr tex = LoadFromFile(filename);
-  if (tex) {
-    textureCache.emplace(tex->name, tex);
+  const uint8_t* p = static_cast<const uint8_t*>(data);
+  uint64_t hash = 14695981039346656037ull;
+  for (size_t i = 0; i < size; ++i) {
+    hash = (hash ^ p[i]) * 1099511628211ull;
   }
-  return tex;
+  return hash;
 }
 
 /**
-* QƂĂȂeNX`LbV菜.
+* 1x1になるまでのミップレベルの数を求める.
+*
+* @param width  ミップレベル0の幅.
+* @param height ミップレベル0の高さ.
+*
+* @return ミップレベルの数.
 */
-void Texture::RemoveOrphan()
+int GetFullLevelCount(int width, int height)
 {
-  for (auto itr = textureCache.begin(); itr != textureCache.end();) {
-    if (itr->second.use_count() == 1) {
-      itr = textureCache.erase(itr);
-    } else {
-      ++itr;
-    }
+  int count = 1;
+  while ((width | height) > 1) {
+    width >>= 1;
+    height >>= 1;
+    ++count;
   }
+  return count;
 }
 
 /**
-* 2DeNX`쐬.
+* ディスクキャッシュファイルの画像の配置を設定する.
 *
-* @param width   eNX`̕(sNZ).
-* @param height  eNX`̍(sNZ).
-* @param iformat eNX`̃f[^`.
-* @param format  ANZXvf.
-* @param type    eNX`f[^ւ̃ANZXP.
-* @param data    eNX`f[^ւ̃|C^.
+* @param width       ミップレベル0の幅.
+* @param height      ミップレベル0の高さ.
+* @param levelCount  ミップレベルの数.
+* @param pathLength  元ファイルのパスのバイト数.
+* @param layout      画像の配置の格納先.
 *
-* @return 쐬ɐꍇ̓eNX`|C^Ԃ.
-*         sꍇnullptrԂ.
+* DDSファイルと同じ配置で表せるので、転送にはDDSファイル用の関数を使う.
+*/
+void SetDiskCacheLayout(int width, int height, int levelCount, size_t pathLength, DDSLayout& layout)
+{
+  layout.width = width;
+  layout.height = height;
+  layout.iformat = GL_RGBA8;
+  layout.format = GL_RGBA;
+  layout.isCompressed = false;
+  layout.blockSize = 0;
+  layout.pixelSize = 4;
+  layout.isCubemap = false;
+  layout.faceCount = 1;
+  layout.levelCount = levelCount;
+  layout.imageOffset = (sizeof(DiskCacheHeader) + pathLength + 15) & ~static_cast<size_t>(15);
+  layout.faceSize = 0;
+  for (int level = 0; level < levelCount; ++level) {
+    layout.faceSize += GetDDSLevelSize(layout, level);
+  }
+}
+
+/**
+* 元ファイルの情報からディスクキャッシュのキーを作成する.
+*
+* @param filename 元ファイル名.
+* @param key      キーの格納先.
+*
+* @retval true  作成成功.
+* @retval false ディスクキャッシュを使わないか、元ファイルが見つからない.
+*
+* キャッシュファイル名は元ファイルのパスのハッシュ値から作る.
+*/
+bool MakeDiskCacheKey(const char* filename, DiskCacheKey& key)
+{
+  if (diskCacheSettings.directory.empty()) {
+    return false;
+  }
+  struct stat st;
+  if (stat(filename, &st)) {
+    return false;
+  }
+  char name[32];
+  snprintf(name, sizeof(name), "/%016llx", static_cast<unsigned long long>(HashFnv1a64(filename, strlen(filename))));
+  key.cachePath = diskCacheSettings.directory + name + diskCacheExtension;
+  key.mtime = st.st_mtime;
+  key.sourceSize = st.st_size;
+  return true;
+}
+
+/**
+* ディスクキャッシュファイルを検証して、ヘッダと画像の配置を読み取る.
+*
+* @param filename 元ファイル名.
+* @param file     メモリに割り当てたキャッシュファイル.
+* @param header   ヘッダの格納先.
+* @param layout   画像の配置の格納先.
+*
+* @retval true  読み取り成功.
+* @retval false 別の元ファイルのキャッシュか、形式や設定が異なるか、ファイルが途中で切れている.
+*/
+bool ReadDiskCacheLayout(const char* filename, const MappedFile& file, DiskCacheHeader& header, DDSLayout& layout)
+{
+  if (file.Size() < sizeof(header)) {
+    return false;
+  }
+  memcpy(&header, file.Data(), sizeof(header));
+  if (memcmp(header.magic, diskCacheMagic, sizeof(diskCacheMagic)) != 0 || header.version != diskCacheVersion) {
+    return false;
+  }
+  const size_t pathLength = strlen(filename);
+  if (header.pathLength != pathLength || file.Size() < sizeof(header) + pathLength ||
+    memcmp(file.Data() + sizeof(header), filename, pathLength) != 0) {
+    return false;
+  }
+  const uint32_t maxSize = 65536;
+  if (header.width == 0 || header.height == 0 || header.width > maxSize || header.height > maxSize) {
+    return false;
+  }
+  const int width = static_cast<int>(header.width);
+  const int height = static_cast<int>(header.height);
+  const int levelCount = diskCacheSettings.generateMipmaps ? GetFullLevelCount(width, height) : 1;
+  if (header.levelCount != static_cast<uint32_t>(levelCount)) {
+    return false;
+  }
+  SetDiskCacheLayout(width, height, levelCount, pathLength, layout);
+  return file.Size() >= layout.imageOffset + layout.faceSize;
+}
+
+/**
+* ディスクキャッシュファイルに記録した元ファイルの更新日時を書き換える.
+*
+* @param key    OpenDiskCacheで作成したキー. key.mtimeを新しい更新日時として記録する.
+* @param header fileから読み取ったヘッダ.
+* @param file   メモリに割り当てたキャッシュファイル.
+*
+* @return 書き換えに成功すれば、割り当て直したキャッシュファイル. 書き込みに失敗した場合はfile.
+*         名前の変更に失敗した場合はnullptrを返すことがある.
+*
+* WriteDiskCacheと同じく、一時ファイルに書き込んでから名前を変更する.
+* Windowsでは割り当て中のファイルを置き換えられないので、名前を変更する前にfileの割り当てを解除する.
+*/
+MappedFilePtr UpdateDiskCacheTime(const DiskCacheKey& key, DiskCacheHeader header, MappedFilePtr file)
+{
+  header.mtime = key.mtime;
+  const std::string tmpPath = key.cachePath + "." + std::to_string(++diskCacheTempCounter) + diskCacheTempExtension;
+  FILE* fp = fopen(tmpPath.c_str(), "wb");
+  if (!fp) {
+    return file;
+  }
+  const size_t bodySize = file->Size() - sizeof(header);
+  bool result = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+    fwrite(file->Data() + sizeof(header), 1, bodySize, fp) == bodySize;
+  if (fclose(fp) != 0) {
+    result = false;
+  }
+  if (!result) {
+    remove(tmpPath.c_str());
+    return file;
+  }
+  file.reset();
+#ifdef _WIN32
+  remove(key.cachePath.c_str()); // Windowsのrenameは既存のファイルを置き換えられない.
+#endif
+  if (rename(tmpPath.c_str(), key.cachePath.c_str()) != 0) {
+    remove(tmpPath.c_str());
+  }
+  return MappedFile::Open(key.cachePath.c_str());
+}
+
+/**
+* ディスクキャッシュから展開済みの画像を探す.
+*
+* @param filename 元ファイル名.
+* @param key      キーの格納先. キャッシュがなかった場合、WriteDiskCacheに渡すこと.
+* @param layout   画像の配置の格納先.
+*
+* @return 有効なキャッシュファイルがあれば、メモリに割り当てたキャッシュファイル.
+*         なければnullptr.
+*
+* 元ファイルの更新日時と大きさが記録と一致すれば、元ファイルを読まずに有効とみなす.
+* 大きさだけが一致する場合は、コピーやチェックアウトで更新日時だけが変わった可能性があるので、
+* 元ファイルの内容のハッシュ値を比較する. 内容が一致すれば、次回からハッシュ値を計算せずに済むように、
+* キャッシュファイルに記録した更新日時を書き換える.
+* GPUを使わないので、ワーカースレッドからも呼び出せる.
+*/
+MappedFilePtr OpenDiskCache(const char* filename, DiskCacheKey& key, DDSLayout& layout)
+{
+  if (!MakeDiskCacheKey(filename, key)) {
+    return {};
+  }
+  MappedFilePtr file = MappedFile::Open(key.cachePath.c_str());
+  DiskCacheHeader header;
+  if (!file || !ReadDiskCacheLayout(filename, *file, header, layout) || header.sourceSize != key.sourceSize) {
+    return {};
+  }
+  if (header.mtime != key.mtime) {
+    const MappedFilePtr source = MappedFile::Open(filename);
+    if (!source || source->Size() != key.sourceSize ||
+      HashFnv1a64(source->Data(), source->Size()) != header.contentHash) {
+      return {};
+    }
+    file = UpdateDiskCacheTime(key, header, std::move(file));
+    if (!file || !ReadDiskCacheLayout(filename, *file, header, layout) || header.sourceSize != key.sourceSize) {
+      return {};
+    }
+  }
+  return file;
+}
+
+/**
+* RGBA8形式の画像を、2x2ピクセルの平均で縦横半分に縮小する.
+*
+* @param src       縮小元の画像.
+* @param srcWidth  縮小元の幅.
+* @param srcHeight 縮小元の高さ.
+* @param dst       縮小した画像の格納先.
+*
+* 縮小元の幅または高さが奇数の場合、はみ出した位置は端のピクセルで補う.
+*/
+void DownsampleRGBA8(const uint8_t* src, int srcWidth, int srcHeight, uint8_t* dst)
+{
+  const int width = std::max(1, srcWidth / 2);
+  const int height = std::max(1, srcHeight / 2);
+  const size_t srcPitch = static_cast<size_t>(srcWidth) * 4;
+  for (int y = 0; y < height; ++y) {
+    const uint8_t* row0 = src + std::min(y * 2, srcHeight - 1) * srcPitch;
+    const uint8_t* row1 = src + std::min(y * 2 + 1, srcHeight - 1) * srcPitch;
+    for (int x = 0; x < width; ++x) {
+      const int x0 = std::min(x * 2, srcWidth - 1) * 4;
+      const int x1 = std::min(x * 2 + 1, srcWidth - 1) * 4;
+      for (int i = 0; i < 4; ++i) {
+        *dst++ = static_cast<uint8_t>((row0[x0 + i] + row0[x1 + i] + row1[x0 + i] + row1[x1 + i] + 2) / 4);
+      }
+    }
+  }
+}
+
+/**
+* 展開した画像をディスクキャッシュに書き込む.
+*
+* @param filename   元ファイル名.
+* @param key        OpenDiskCacheで作成したキー.
+* @param source     元ファイルの内容.
+* @param sourceSize sourceのバイト数.
+* @param width      画像の幅.
+* @param height     画像の高さ.
+* @param pixels     RGBA8形式の画像. 1行目が画像の最下行で、行の間に隙間がないこと.
+*
+* @retval true  書き込み成功.
+* @retval false ディスクキャッシュを使わないか、書き込みに失敗.
+*
+* 書き込み途中のファイルが他のスレッドから見えないように、一時ファイルに書き込んでから名前を変更する.
+* GPUを使わないので、ワーカースレッドからも呼び出せる.
+*/
+bool WriteDiskCache(const char* filename, const DiskCacheKey& key, const uint8_t* source, size_t sourceSize,
+  int width, int height, const uint8_t* pixels)
+{
+  // キーを作成してから元ファイルが変更された場合は、更新日時と内容が食い違うので書き込まない.
+  if (key.cachePath.empty() || sourceSize != key.sourceSize) {
+    return false;
+  }
+  const size_t pathLength = strlen(filename);
+  DiskCacheHeader header = {};
+  memcpy(header.magic, diskCacheMagic, sizeof(diskCacheMagic));
+  header.version = diskCacheVersion;
+  header.mtime = key.mtime;
+  header.sourceSize = sourceSize;
+  header.contentHash = HashFnv1a64(source, sourceSize);
+  header.width = width;
+  header.height = height;
+  header.levelCount = diskCacheSettings.generateMipmaps ? GetFullLevelCount(width, height) : 1;
+  header.pathLength = static_cast<uint32_t>(pathLength);
+  DDSLayout layout;
+  SetDiskCacheLayout(width, height, header.levelCount, pathLength, layout);
+
+  const std::string tmpPath = key.cachePath + "." + std::to_string(++diskCacheTempCounter) + diskCacheTempExtension;
+  FILE* fp = fopen(tmpPath.c_str(), "wb");
+  if (!fp) {
+    std::cerr << "WARNING: " << tmpPath << "を作成できません." << std::endl;
+    return false;
+  }
+  const uint8_t padding[16] = {};
+  const size_t paddingSize = layout.imageOffset - sizeof(header) - pathLength;
+  const size_t levelSize = GetDDSLevelSize(layout, 0);
+  bool result = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+    fwrite(filename, 1, pathLength, fp) == pathLength &&
+    fwrite(padding, 1, paddingSize, fp) == paddingSize &&
+    fwrite(pixels, 1, levelSize, fp) == levelSize;
+
+  // ミップレベル1以降は、1つ上のレベルを縮小して作成する.
+  std::vector<uint8_t> src;
+  std::vector<uint8_t> dst;
+  const uint8_t* p = pixels;
+  for (int level = 1; result && level < layout.levelCount; ++level) {
+    dst.resize(GetDDSLevelSize(layout, level));
+    DownsampleRGBA8(p, std::max(1, width >> (level - 1)), std::max(1, height >> (level - 1)), dst.data());
+    result = fwrite(dst.data(), 1, dst.size(), fp) == dst.size();
+    src.swap(dst);
+    p = src.data();
+  }
+  if (fclose(fp) != 0) {
+    result = false;
+  }
+  if (result) {
+#ifdef _WIN32
+    remove(key.cachePath.c_str()); // Windowsのrenameは既存のファイルを置き換えられない.
+#endif
+    result = rename(tmpPath.c_str(), key.cachePath.c_str()) == 0;
+  }
+  if (!result) {
+    remove(tmpPath.c_str());
+    std::cerr << "WARNING: " << key.cachePath << "を書き込めません." << std::endl;
+  }
+  return result;
+}
+
+/**
+* 画像がディスクキャッシュに格納できる形式か調べる.
+*
+* @param image 調べる画像.
+*
+* @retval true  格納できる.
+* @retval false 格納できない.
+*/
+bool CanWriteDiskCache(const Image& image)
+{
+  return image.iformat == GL_RGBA8 && image.format == GL_RGBA && image.type == GL_UNSIGNED_BYTE &&
+    image.pitch == static_cast<size_t>(image.width) * 4;
+}
+
+} // unnamed namespace
+
+namespace /* unnamed */ {
+
+/**
+* 非同期読み込みの要求.
+*/
+struct LoadRequest
+{
+  TexturePtr texture; ///< 読み込み先のテクスチャ.
+  std::string filename; ///< 画像ファイル名.
+
+  // ワーカースレッドが設定する.
+  bool isDecoded = false; ///< true=展開成功. false=展開失敗.
+  MappedFilePtr ddsFile; ///< メモリに割り当てたDDSファイル. DDSファイルでなければnullptr.
+  DDSLayout ddsLayout; ///< DDSファイルの配置情報.
+  Image image; ///< 展開した画像. DDSファイルの場合は使わない.
+  MappedFilePtr imageFile; ///< imageの画像データを格納したディスクキャッシュファイル.
+  const uint8_t* pixels = nullptr; ///< 転送する画像データ. image.pixelsかimageFileの中を指す.
+
+  // メインスレッドが設定する.
+  GLuint texId = 0; ///< 転送先のテクスチャID.
+  int scheduledRows = 0; ///< 転送を予約した行数.
+  int ddsLevel = 0; ///< 転送済みのDDSミップレベルの最小値. 大きいレベルから順に転送するので0まで減っていく.
+};
+using LoadRequestPtr = std::unique_ptr<LoadRequest>;
+
+/**
+* ピクセルバッファからテクスチャへ転送する範囲.
+*/
+struct UploadSlice
+{
+  LoadRequest* request; ///< 転送する要求.
+  int y; ///< 転送する最初の行.
+  int rows; ///< 転送する行数.
+  size_t offset; ///< ピクセルバッファ内のバイトオフセット.
+};
+
+/**
+* 非同期読み込みの管理データ.
+*
+* ワーカースレッドはファイルの読み込みと展開だけを行い、OpenGLは呼び出さない.
+* 展開が終わった要求は、メインスレッドがProcessUploadsで受け取って少しずつ転送する.
+*/
+struct AsyncLoader
+{
+  std::mutex mutex; ///< waitingList, decodedList, threads, isStoppingを保護する.
+  std::condition_variable requested; ///< 要求の追加または終了を通知する.
+  std::condition_variable decoded; ///< 展開の完了を通知する.
+  std::deque<LoadRequestPtr> waitingList; ///< 展開待ちの要求.
+  std::vector<LoadRequestPtr> decodedList; ///< 展開済みで、メインスレッドに渡していない要求.
+  std::vector<std::thread> threads; ///< ワーカースレッド.
+  bool isStopping = false; ///< true=ワーカースレッドを終了させる.
+
+  // 以下はメインスレッドだけが使う.
+  std::deque<LoadRequestPtr> uploadList; ///< 転送待ちの要求.
+  std::vector<UploadSlice> sliceList; ///< 今回転送する範囲.
+  std::vector<LoadRequestPtr> finishedList; ///< 今回で転送が終わる要求.
+  GLuint stagingBuffer = 0; ///< 転送に使うピクセルバッファオブジェクト.
+  size_t stagingSize = 0; ///< stagingBufferのバイト数.
+  TexturePtr placeholder; ///< 読み込み中のテクスチャの代わりに描画するテクスチャ.
+};
+AsyncLoader asyncLoader;
+
+const unsigned int maxLoaderThreadCount = 4; ///< ワーカースレッドの最大数.
+
+/**
+* メモリに割り当てたファイルの内容を、OSに読み込ませる.
+*
+* @param data 割り当てたメモリの先頭アドレス.
+* @param size 割り当てたメモリのバイト数.
+*
+* 各ページを1バイトずつ参照する. メインスレッドで転送するときに、
+* ページフォールトによるファイル読み込みで止まらないようにするために使う.
+*/
+void TouchPages(const uint8_t* data, size_t size)
+{
+  const size_t pageSize = 4096;
+  uint8_t sum = 0;
+  for (size_t i = 0; i < size; i += pageSize) {
+    sum ^= data[i];
+  }
+  volatile uint8_t sink = sum;
+  (void)sink;
+}
+
+/**
+* ディスクキャッシュファイルを転送元に設定する.
+*
+* @param request 読み込み要求.
+* @param file    メモリに割り当てたキャッシュファイル.
+* @param layout  キャッシュファイルの画像の配置.
+*
+* ミップマップがあればDDSファイルと同じく小さいレベルから転送し、
+* なければ展開した画像と同じく行単位で転送する.
+*/
+void SetDiskCacheSource(LoadRequest& request, const MappedFilePtr& file, const DDSLayout& layout)
+{
+  if (layout.levelCount > 1) {
+    request.ddsFile = file;
+    request.ddsLayout = layout;
+  } else {
+    Image& image = request.image;
+    image.width = layout.width;
+    image.height = layout.height;
+    image.iformat = GL_RGBA8;
+    image.format = GL_RGBA;
+    image.type = GL_UNSIGNED_BYTE;
+    image.pitch = static_cast<size_t>(layout.width) * 4;
+    image.pixels.clear();
+    image.pixels.shrink_to_fit();
+    request.imageFile = file;
+    request.pixels = file->Data() + layout.imageOffset;
+  }
+  request.isDecoded = true;
+}
+
+/**
+* 要求された画像ファイルを読み込んで展開する.
+*
+* @param request 読み込み要求.
+*
+* ファイルはメモリに割り当てて、コピーせずに展開する.
+* DDSファイルは圧縮形式のまま転送するので、配置情報を調べてファイルの割り当てを保持する.
+* ディスクキャッシュが有効なら、展開済みの画像をキャッシュファイルから直接転送し、
+* キャッシュがなければ展開した画像を書き込む.
+*/
+void DecodeRequest(LoadRequest& request)
+{
+  const char* filename = request.filename.c_str();
+  DiskCacheKey key;
+  DDSLayout layout;
+  if (const MappedFilePtr cacheFile = OpenDiskCache(filename, key, layout)) {
+    TouchPages(cacheFile->Data(), cacheFile->Size());
+    SetDiskCacheSource(request, cacheFile, layout);
+    return;
+  }
+
+  const MappedFilePtr file = MappedFile::Open(filename);
+  if (!file || file->Size() < 4) {
+    std::cerr << "WARNING: " << filename << "を読み込めません." << std::endl;
+    return;
+  }
+  if (memcmp(file->Data(), "DDS ", 4) == 0) {
+    if (!ReadDDSLayout(filename, file->Data(), file->Size(), request.ddsLayout)) {
+      return;
+    }
+    TouchPages(file->Data(), file->Size());
+    request.ddsFile = file;
+    request.isDecoded = true;
+    return;
+  }
+  Image& image = request.image;
+  request.isDecoded = DecodeImage(filename, file->Data(), file->Size(), image);
+  if (!request.isDecoded) {
+    return;
+  }
+  request.pixels = image.pixels.data();
+  if (CanWriteDiskCache(image) &&
+    WriteDiskCache(filename, key, file->Data(), file->Size(), image.width, image.height, image.pixels.data()) &&
+    diskCacheSettings.generateMipmaps) {
+    // 作成したミップマップも転送するため、書き込んだファイルから読み込む.
+    if (const MappedFilePtr cacheFile = OpenDiskCache(filename, key, layout)) {
+      SetDiskCacheSource(request, cacheFile, layout);
+    }
+  }
+}
+
+/**
+* ワーカースレッドの処理.
+*/
+void LoaderThread()
+{
+  AsyncLoader& loader = asyncLoader;
+  for (;;) {
+    LoadRequestPtr request;
+    {
+      std::unique_lock<std::mutex> lock(loader.mutex);
+      loader.requested.wait(lock, [&loader] { return loader.isStopping || !loader.waitingList.empty(); });
+      if (loader.isStopping) {
+        break;
+      }
+      request = std::move(loader.waitingList.front());
+      loader.waitingList.pop_front();
+    }
+    DecodeRequest(*request);
+    {
+      std::lock_guard<std::mutex> lock(loader.mutex);
+      loader.decodedList.push_back(std::move(request));
+    }
+    loader.decoded.notify_all();
+  }
+}
+
+} // unnamed namespace
+
+/**
+* デストラクタ.
+*/
+Texture::~Texture()
+{
+  // 読み込み中と読み込みに失敗したテクスチャは代替テクスチャのIDを持っているので、削除しない.
+  if (texId && !page && state == State_Ready) {
+    GLState::DeleteTexture(texId);
+  }
+}
+
+/**
+* DXGI画像読み込み機能の初期化.
+*
+* @retval true 初期化成功.
+* @retval false 初期化失敗.
+*/
+bool Texture::Initialize()
+{
+#ifdef EASY_TEXTURE_USE_WIC
+  if (!wic::imagingFactory) {
+    if (FAILED(CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&wic::imagingFactory)))) {
+      std::cout << "WICImagingFactoryの作成に失敗." << std::endl;
+      return false;
+    }
+  }
+#endif
+
+  {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    textureCache.map.reserve(1024);
+  }
+
+  if (!asyncLoader.placeholder) {
+    // 非同期読み込み中のテクスチャの代わりに描画する、半透明の灰色.
+    static const uint8_t color[4] = { 128, 128, 128, 128 };
+    asyncLoader.placeholder = Create(1, 1, GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, color);
+    if (!asyncLoader.placeholder) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/**
+* DXGI画像読み込み機能の初期化.
+*
+* 非同期読み込みのワーカースレッドを終了し、完了していない読み込みは失敗として扱う.
+*/
+void Texture::Finalize()
+{
+  AsyncLoader& loader = asyncLoader;
+  {
+    std::lock_guard<std::mutex> lock(loader.mutex);
+    loader.isStopping = true;
+  }
+  loader.requested.notify_all();
+  for (auto& e : loader.threads) {
+    e.join();
+  }
+  loader.threads.clear();
+  loader.isStopping = false;
+
+  for (auto& e : loader.waitingList) {
+    e->texture->state = State_Failed;
+  }
+  for (auto& e : loader.decodedList) {
+    e->texture->state = State_Failed;
+  }
+  for (auto& e : loader.uploadList) {
+    // 転送途中のDDSファイルは、転送済みのミップレベルだけで使える状態のまま残す.
+    if (e->texture->state == State_Ready) {
+      continue;
+    }
+    e->texture->state = State_Failed;
+    if (e->texId) {
+      GLState::DeleteTexture(e->texId);
+    }
+  }
+  loader.waitingList.clear();
+  loader.decodedList.clear();
+  loader.uploadList.clear();
+  if (loader.stagingBuffer) {
+    RenderBackend::Get().DeleteBuffer(loader.stagingBuffer);
+    loader.stagingBuffer = 0;
+    loader.stagingSize = 0;
+  }
+  loader.placeholder.reset();
+
+#ifdef EASY_TEXTURE_USE_WIC
+  wic::imagingFactory.Reset();
+#endif
+}
+
+/**
+* テクスチャをキャッシュする.
+*
+* @param tex キャッシュ対象のテクスチャ.
+*/
+void Texture::Cache(const TexturePtr& tex)
+{
+  {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    textureCache.Insert(tex);
+  }
+  TrimCache();
+}
+
+/**
+* テクスチャファイルがキャッシュされているか調べる.
+*
+* @param filename テクスチャファイルのパス.
+*
+* @retval true  filepathはキャッシュされている.
+* @retval false filepathはキャッシュされていない.
+*/
+bool Texture::IsCached(const char* filename)
+{
+  std::lock_guard<std::mutex> lock(cacheMutex);
+  return textureCache.map.find(filename) != textureCache.map.end();
+}
+
+/**
+* テクスチャを読み込み、キャッシュする.
+*
+* @param filepath テクスチャファイルのパス.
+*
+* @return 作成に成功した場合はテクスチャポインタを返す.
+*         失敗した場合はnullptr返す.
+*
+* LoadAsyncで読み込み中のテクスチャは、読み込みの完了を待ってから返す.
+* 新しく読み込んだことでVRAM使用量が上限を超えた場合、参照されていないテクスチャを古いものから取り除く.
+*/
+TexturePtr Texture::LoadAndCache(const char* filename)
+{
+  TexturePtr tex;
+  {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    tex = textureCache.Find(filename);
+  }
+  if (tex) {
+    if (tex->IsLoading() && !WaitForLoad(tex)) {
+      return {};
+    }
+    return tex;
+  }
+  tex = LoadFromFile(filename);
+  if (tex) {
+    Cache(tex);
+  }
+  return tex;
+}
+
+/**
+* 参照されていないテクスチャをキャッシュから取り除く.
+*
+* VRAM使用量の上限に関係なく、固定していないテクスチャはすべて取り除く.
+* シーンの切り替え時などに、使わなくなったテクスチャをまとめて解放するために使う.
+*/
+void Texture::RemoveOrphan()
+{
+  std::vector<TexturePtr> evictedList;
+  std::lock_guard<std::mutex> lock(cacheMutex);
+  TextureCache& cache = textureCache;
+  for (auto itr = cache.lruList.begin(); itr != cache.lruList.end();) {
+    if (!itr->isPinned && itr->texture.use_count() == 1) {
+      evictedList.push_back(itr->texture);
+      auto next = std::next(itr);
+      cache.Erase(itr);
+      ++cache.evictions;
+      itr = next;
+    } else {
+      ++itr;
+    }
+  }
+}
+
+/**
+* キャッシュするテクスチャのVRAM使用量の上限を設定する.
+*
+* @param bytes VRAM使用量の上限(バイト数).
+*
+* 上限を超えている場合は、すぐに参照されていないテクスチャを古いものから取り除く.
+* 参照されているテクスチャと固定したテクスチャは取り除かないので、使用量が上限を超えたままになることもある.
+* メインスレッドから呼び出すこと.
+*/
+void Texture::SetCacheBudget(size_t bytes)
+{
+  {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    textureCache.budgetBytes = bytes;
+  }
+  TrimCache();
+}
+
+/**
+* キャッシュしたテクスチャを、上限を超えても取り除かれないように固定する.
+*
+* @param tex 固定するテクスチャ.
+*
+* @retval true  固定した.
+* @retval false texはキャッシュされていない.
+*
+* シーンをまたいで使う、すぐに表示できなければならないテクスチャに使う.
+* RemoveOrphanでも取り除かれなくなる.
+*/
+bool Texture::Pin(const TexturePtr& tex)
+{
+  std::lock_guard<std::mutex> lock(cacheMutex);
+  TextureCache& cache = textureCache;
+  auto itr = cache.FindEntry(tex);
+  if (itr == cache.lruList.end()) {
+    return false;
+  }
+  if (!itr->isPinned) {
+    itr->isPinned = true;
+    ++cache.pinnedCount;
+  }
+  return true;
+}
+
+/**
+* テクスチャの固定を解除する.
+*
+* @param tex 固定を解除するテクスチャ.
+*
+* @retval true  固定を解除した.
+* @retval false texはキャッシュされていない.
+*/
+bool Texture::Unpin(const TexturePtr& tex)
+{
+  std::lock_guard<std::mutex> lock(cacheMutex);
+  TextureCache& cache = textureCache;
+  auto itr = cache.FindEntry(tex);
+  if (itr == cache.lruList.end()) {
+    return false;
+  }
+  if (itr->isPinned) {
+    itr->isPinned = false;
+    --cache.pinnedCount;
+  }
+  return true;
+}
+
+/**
+* テクスチャキャッシュの統計情報を取得する.
+*
+* @return 統計情報.
+*/
+Texture::CacheStats Texture::GetCacheStats()
+{
+  std::lock_guard<std::mutex> lock(cacheMutex);
+  const TextureCache& cache = textureCache;
+  CacheStats stats;
+  stats.budgetBytes = cache.budgetBytes;
+  stats.residentBytes = cache.residentBytes;
+  stats.textureCount = cache.lruList.size();
+  stats.pinnedCount = cache.pinnedCount;
+  stats.hits = cache.hits;
+  stats.misses = cache.misses;
+  stats.evictions = cache.evictions;
+  return stats;
+}
+
+/**
+* テクスチャキャッシュのヒット数、ミス数、取り除いた数を0に戻す.
+*/
+void Texture::ResetCacheStats()
+{
+  std::lock_guard<std::mutex> lock(cacheMutex);
+  textureCache.hits = 0;
+  textureCache.misses = 0;
+  textureCache.evictions = 0;
+}
+
+/**
+* 展開済み画像のディスクキャッシュを設定する.
+*
+* @param directory       キャッシュファイルを置くディレクトリ. 存在しなければ作成する.
+*                        nullptrまたは空文字列の場合はディスクキャッシュを使わない.
+* @param generateMipmaps true=ミップマップを作成してキャッシュファイルに格納する.
+*                        false=ミップレベル0だけを格納する.
+*
+* @retval true  設定成功.
+* @retval false ディレクトリを作成できなかった. ディスクキャッシュは使われない.
+*
+* 有効にすると、LoadFromFile, LoadAsync, LoadImageRGBA8で展開したPNGなどの画像を、
+* テクスチャと同じ向きのRGBA8形式でキャッシュファイルに保存する. 次回からは画像を展開せずに、
+* キャッシュファイルをメモリに割り当てて直接転送する.
+* キャッシュファイルは元ファイルのパスごとに作られ、元ファイルの更新日時、大きさ、内容のハッシュ値で
+* 照合する. 元ファイルが変更されていれば、展開し直してキャッシュファイルを作り直す.
+*
+* テクスチャの読み込みを始める前に、メインスレッドから呼び出すこと.
+*/
+bool Texture::SetDiskCache(const char* directory, bool generateMipmaps)
+{
+  diskCacheSettings.directory.clear();
+  diskCacheSettings.generateMipmaps = generateMipmaps;
+  if (!directory || !directory[0]) {
+    return true;
+  }
+  std::string path = directory;
+  while (path.size() > 1 && (path.back() == '/' || path.back() == '\\')) {
+    path.pop_back();
+  }
+#ifdef _WIN32
+  _mkdir(path.c_str());
+#else
+  mkdir(path.c_str(), 0755);
+#endif
+  struct stat st;
+  if (stat(path.c_str(), &st) || !(st.st_mode & S_IFDIR)) {
+    std::cerr << "WARNING: " << path << "を作成できません.\n" << "ディスクキャッシュは使われません." << std::endl;
+    return false;
+  }
+  diskCacheSettings.directory = path;
+  return true;
+}
+
+/**
+* ディスクキャッシュのファイルをすべて削除する.
+*
+* 書き込み途中で残った一時ファイルも削除する.
+*/
+void Texture::ClearDiskCache()
+{
+  const std::string& dir = diskCacheSettings.directory;
+  if (dir.empty()) {
+    return;
+  }
+  std::vector<std::string> list;
+#ifdef _WIN32
+  _finddata_t data;
+  const intptr_t handle = _findfirst((dir + "/*").c_str(), &data);
+  if (handle != -1) {
+    do {
+      list.push_back(data.name);
+    } while (_findnext(handle, &data) == 0);
+    _findclose(handle);
+  }
+#else
+  if (DIR* d = opendir(dir.c_str())) {
+    while (const dirent* e = readdir(d)) {
+      list.push_back(e->d_name);
+    }
+    closedir(d);
+  }
+#endif
+  const auto hasExtension = [](const std::string& name, const char* ext) {
+    const size_t len = strlen(ext);
+    return name.size() > len && name.compare(name.size() - len, len, ext) == 0;
+  };
+  for (const auto& e : list) {
+    if (hasExtension(e, diskCacheExtension) || hasExtension(e, diskCacheTempExtension)) {
+      remove((dir + "/" + e).c_str());
+    }
+  }
+}
+
+/**
+* テクスチャを非同期に読み込み、キャッシュする.
+*
+* @param filename テクスチャファイルのパス.
+*
+* @return テクスチャポインタ. 読み込みの完了を待たずに返す.
+*         Texture::Initializeが呼ばれていない場合はnullptrを返す.
+*
+* ファイルの読み込みと展開はワーカースレッドで行い、GPUへの転送はメインスレッドでProcessUploadsを
+* 呼び出すたびに少しずつ行う. 転送が終わるまでは、IsLoading()がtrueを返し、Id()は代替テクスチャを
+* 示し、Width()とHeight()は代替テクスチャの大きさ(1x1)を返す.
+* 読み込みに失敗するとIsFailed()がtrueを返し、テクスチャはキャッシュから取り除かれる.
+* DDSファイルは最小のミップレベルを転送した時点で使用可能になり、以降のフレームで詳細なレベルが追加される.
+*
+* キャッシュを調べて要求を登録するだけなので、メインスレッド以外からも呼び出せる.
+*/
+TexturePtr Texture::LoadAsync(const char* filename)
+{
+  AsyncLoader& loader = asyncLoader;
+  if (!loader.placeholder) {
+    std::cerr << "Texture::Initialize関数が呼ばれていません.\n" << "プログラムの初期化中にTexture::Initialize関数を呼び出してください." << std::endl;
+    return {};
+  }
+
+  struct Impl : Texture {};
+  TexturePtr p;
+  {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    TexturePtr cached = textureCache.Find(filename);
+    if (cached) {
+      return cached;
+    }
+    // 転送が終わるまでは大きさ0として計上する.
+    p = std::make_shared<Impl>();
+    p->name = filename;
+    p->texId = loader.placeholder->texId;
+    p->width = loader.placeholder->width;
+    p->height = loader.placeholder->height;
+    p->state = State_Loading;
+    textureCache.Insert(p);
+  }
+
+  LoadRequestPtr request(new LoadRequest);
+  request->texture = p;
+  request->filename = filename;
+  {
+    std::lock_guard<std::mutex> lock(loader.mutex);
+    if (loader.threads.empty()) {
+      const unsigned int n = std::thread::hardware_concurrency();
+      const unsigned int threadCount = std::min(n > 1 ? n - 1 : 1, maxLoaderThreadCount);
+      for (unsigned int i = 0; i < threadCount; ++i) {
+        loader.threads.emplace_back(LoaderThread);
+      }
+    }
+    loader.waitingList.push_back(std::move(request));
+  }
+  loader.requested.notify_one();
+  return p;
+}
+
+/**
+* 非同期読み込みしたテクスチャをGPUへ転送する.
+*
+* @param maxBytes 転送するバイト数の上限. 1行がこれより大きい場合でも、最低1行は転送する.
+*
+* メインスレッドで、毎フレーム1回呼び出すこと.
+* 展開の終わった画像を、ピクセルバッファオブジェクトを経由して上限に達するまで行単位で転送する.
+* 大きな画像は複数のフレームに分けて転送されるので、1フレームの処理時間が大きく伸びることはない.
+* DDSファイルは圧縮形式のまま、小さいミップレベルから順にレベル単位で転送する. 最小のレベルを転送した時点で
+* 読み込み完了となり、大きなレベルは以降のフレームで転送される. それまではGL_TEXTURE_BASE_LEVELによって
+* 転送済みのレベルだけが使われる.
+*
+* また、テクスチャキャッシュのVRAM使用量が上限を超えていれば、参照されなくなったテクスチャを取り除く.
+*/
+void Texture::ProcessUploads(size_t maxBytes)
+{
+  TrimCache();
+
+  AsyncLoader& loader = asyncLoader;
+  {
+    std::lock_guard<std::mutex> lock(loader.mutex);
+    for (auto& e : loader.decodedList) {
+      loader.uploadList.push_back(std::move(e));
+    }
+    loader.decodedList.clear();
+  }
+  if (loader.uploadList.empty()) {
+    return;
+  }
+
+  // 転送の結果をテクスチャに反映する.
+  const auto finish = [](LoadRequest& request, GLuint id, int width, int height, size_t byteSize) {
+    Texture& tex = *request.texture;
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    if (id) {
+      tex.texId = id;
+      tex.width = width;
+      tex.height = height;
+      tex.byteSize = byteSize;
+      tex.state = State_Ready;
+      textureCache.UpdateByteSize(request.texture);
+    } else {
+      tex.state = State_Failed;
+      auto itr = textureCache.FindEntry(request.texture);
+      if (itr != textureCache.lruList.end()) {
+        textureCache.Erase(itr);
+      }
+    }
+  };
+
+  // 今回転送する範囲を決める.
+  RenderBackend::Backend& backend = RenderBackend::Get();
+  size_t totalBytes = 0;
+  while (!loader.uploadList.empty() && totalBytes < maxBytes) {
+    LoadRequest& request = *loader.uploadList.front();
+    if (!request.isDecoded) {
+      if (request.texId) {
+        GLState::DeleteTexture(request.texId);
+      }
+      finish(request, 0, 0, 0, 0);
+      loader.uploadList.pop_front();
+      continue;
+    }
+    if (request.ddsFile) {
+      // 小さいミップレベルから順に、メモリに割り当てたファイルから直接転送する.
+      // GL_TEXTURE_BASE_LEVELを転送済みのレベルに制限して、最小のレベルを転送した時点で使えるようにし、
+      // 大きなレベルは以降のフレームで転送する.
+      const DDSLayout& layout = request.ddsLayout;
+      const GLenum target = layout.isCubemap ? GL_TEXTURE_CUBE_MAP : GL_TEXTURE_2D;
+      if (!request.texId) {
+        // 最小のレベルも転送できなければ、テクスチャを作らずに次のフレームへ回す.
+        const size_t smallestBytes = GetDDSLevelSize(layout, layout.levelCount - 1) * layout.faceCount;
+        if (totalBytes && totalBytes + smallestBytes > maxBytes) {
+          break;
+        }
+        request.texId = CreateDDSTexture(layout);
+        request.ddsLevel = layout.levelCount;
+      } else {
+        GLState::BindTexture(GL_TEXTURE0, target, request.texId);
+      }
+      const int prevLevel = request.ddsLevel;
+      while (request.ddsLevel > 0) {
+        const size_t levelBytes = GetDDSLevelSize(layout, request.ddsLevel - 1) * layout.faceCount;
+        if (totalBytes && totalBytes + levelBytes > maxBytes) {
+          break;
+        }
+        --request.ddsLevel;
+        totalBytes += UploadDDSLevel(request.filename.c_str(), layout, request.ddsFile->Data(), request.ddsLevel);
+      }
+      // 1レベルも転送できなかった場合、使えるレベルは変わらないので何もしない.
+      if (request.ddsLevel != prevLevel) {
+        backend.TexParameteri(target, GL_TEXTURE_BASE_LEVEL, request.ddsLevel);
+        const size_t residentBytes =
+          (layout.faceSize - (GetDDSLevelOffset(layout, 0, request.ddsLevel) - layout.imageOffset)) * layout.faceCount;
+        finish(request, request.texId, layout.width, layout.height, residentBytes);
+      }
+      GLState::BindTexture(GL_TEXTURE0, target, 0);
+      if (request.ddsLevel > 0) {
+        break;
+      }
+      loader.uploadList.pop_front();
+      continue;
+    }
+    const Image& image = request.image;
+    size_t rows = (maxBytes - totalBytes) / image.pitch;
+    if (rows == 0) {
+      if (totalBytes) {
+        break;
+      }
+      rows = 1;
+    }
+    rows = std::min(rows, static_cast<size_t>(image.height - request.scheduledRows));
+    loader.sliceList.push_back({ &request, request.scheduledRows, static_cast<int>(rows), totalBytes });
+    totalBytes += rows * image.pitch;
+    request.scheduledRows += static_cast<int>(rows);
+    if (request.scheduledRows < image.height) {
+      break;
+    }
+    loader.finishedList.push_back(std::move(loader.uploadList.front()));
+    loader.uploadList.pop_front();
+  }
+
+  if (!loader.sliceList.empty()) {
+    // ピクセルバッファに書き込む. 書き込みに失敗した場合はシステムメモリから直接転送する.
+    const size_t stagingBytes = loader.sliceList.back().offset +
+      loader.sliceList.back().rows * loader.sliceList.back().request->image.pitch;
+    if (loader.stagingSize < stagingBytes) {
+      if (loader.stagingBuffer) {
+        backend.DeleteBuffer(loader.stagingBuffer);
+      }
+      loader.stagingBuffer = backend.CreateBuffer(GL_PIXEL_UNPACK_BUFFER, stagingBytes, nullptr, GL_STREAM_DRAW);
+      loader.stagingSize = stagingBytes;
+    }
+    uint8_t* p = static_cast<uint8_t*>(backend.MapBufferRange(GL_PIXEL_UNPACK_BUFFER, loader.stagingBuffer,
+      0, stagingBytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+    if (p) {
+      for (const UploadSlice& e : loader.sliceList) {
+        const Image& image = e.request->image;
+        memcpy(p + e.offset, e.request->pixels + e.y * image.pitch, e.rows * image.pitch);
+      }
+      if (!backend.UnmapBuffer(GL_PIXEL_UNPACK_BUFFER, loader.stagingBuffer)) {
+        p = nullptr;
+      }
+    }
+
+    for (const UploadSlice& e : loader.sliceList) {
+      LoadRequest& request = *e.request;
+      const Image& image = request.image;
+      if (!request.isDecoded) {
+        continue;
+      }
+      if (!request.texId) {
+        request.texId = backend.CreateTexture();
+        GLState::BindTexture(GL_TEXTURE0, GL_TEXTURE_2D, request.texId);
+        backend.TexImage2D(GL_TEXTURE_2D, 0, image.iformat, image.width, image.height, image.format, image.type, nullptr);
+        const GLenum result = backend.GetError();
+        if (result != GL_NO_ERROR) {
+          std::cerr << "ERROR " << request.filename << "のテクスチャ作成に失敗: 0x" << std::hex << result << std::dec << std::endl;
+          GLState::DeleteTexture(request.texId);
+          request.texId = 0;
+          request.isDecoded = false;
+          continue;
+        }
+        backend.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+        backend.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        backend.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        backend.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        backend.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+      } else {
+        GLState::BindTexture(GL_TEXTURE0, GL_TEXTURE_2D, request.texId);
+      }
+      if (p) {
+        backend.TexSubImage2DFromBuffer(GL_TEXTURE_2D, 0, 0, e.y, image.width, e.rows, image.format, image.type, loader.stagingBuffer, e.offset);
+      } else {
+        backend.TexSubImage2D(GL_TEXTURE_2D, 0, 0, e.y, image.width, e.rows, image.format, image.type, request.pixels + e.y * image.pitch);
+      }
+    }
+    GLState::BindTexture(GL_TEXTURE0, GL_TEXTURE_2D, 0);
+    loader.sliceList.clear();
+  }
+
+  for (auto& e : loader.finishedList) {
+    const Image& image = e->image;
+    const size_t byteSize = static_cast<size_t>(image.width) * image.height * GetBytesPerPixel(image.iformat);
+    finish(*e, e->isDecoded ? e->texId : 0, image.width, image.height, byteSize);
+  }
+  loader.finishedList.clear();
+}
+
+/**
+* 非同期読み込みの完了を待つ.
+*
+* @param tex LoadAsyncで作成したテクスチャ.
+*
+* @retval true  読み込み成功.
+* @retval false 読み込み失敗.
+*
+* メインスレッドから呼び出すこと. 待っている間に、他の読み込み中のテクスチャの転送も進める.
+*/
+bool Texture::WaitForLoad(const TexturePtr& tex)
+{
+  AsyncLoader& loader = asyncLoader;
+  while (tex->IsLoading()) {
+    if (loader.uploadList.empty()) {
+      std::unique_lock<std::mutex> lock(loader.mutex);
+      loader.decoded.wait(lock, [&loader] { return !loader.decodedList.empty(); });
+    }
+    ProcessUploads();
+  }
+  return tex->state == State_Ready;
+}
+
+/**
+* 転送待ちの非同期読み込み要求の数を取得する.
+*
+* @return ProcessUploadsが受け取った要求のうち、転送が終わっていないものの数.
+*         ワーカースレッドで展開中の要求は含まない.
+*
+* メインスレッドから呼び出すこと.
+*/
+size_t Texture::PendingUploadCount()
+{
+  return asyncLoader.uploadList.size();
+}
+
+/**
+* 2Dテクスチャを作成する.
+*
+* @param width   テクスチャの幅(ピクセル数).
+* @param height  テクスチャの高さ(ピクセル数).
+* @param iformat テクスチャのデータ形式.
+* @param format  アクセスする要素.
+* @param type    テクスチャデータへのアクセス単位.
+* @param data    テクスチャデータへのポインタ.
+*
+* @return 作成に成功した場合はテクスチャポインタを返す.
+*         失敗した場合はnullptr返す.
 */
 TexturePtr Texture::Create(
   int width, int height, GLenum iformat, GLenum format, GLenum type, const void* data)
@@ -635,92 +2265,164 @@ TexturePtr Texture::Create(
 
   p->width = width;
   p->height = height;
-  glGenTextures(1, &p->texId);
-  glBindTexture(GL_TEXTURE_2D, p->texId);
-  glTexImage2D(
-    GL_TEXTURE_2D, 0, iformat, width, height, 0, format, type, data);
-  const GLenum result = glGetError();
+  p->byteSize = static_cast<size_t>(width) * height * GetBytesPerPixel(iformat);
+  RenderBackend::Backend& backend = RenderBackend::Get();
+  p->texId = backend.CreateTexture();
+  GLState::BindTexture(GL_TEXTURE0, GL_TEXTURE_2D, p->texId);
+  backend.TexImage2D(
+    GL_TEXTURE_2D, 0, iformat, width, height, format, type, data);
+  const GLenum result = backend.GetError();
   if (result != GL_NO_ERROR) {
-    std::cerr << "ERROR eNX`쐬Ɏs: 0x" << std::hex << result << std::endl;
+    std::cerr << "ERROR テクスチャ作成に失敗: 0x" << std::hex << result << std::endl;
     return {};
   }
 
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  backend.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+  backend.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  backend.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  backend.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  backend.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
-  glBindTexture(GL_TEXTURE_2D, 0);
+  GLState::BindTexture(GL_TEXTURE0, GL_TEXTURE_2D, 0);
 
   return p;
 }
 
 /**
-* t@C2DeNX`ǂݍ.
+* 他のテクスチャの一部を参照するテクスチャを作成する.
+*
+* @param page   参照するテクスチャ.
+* @param x      参照する領域の左下X座標(ピクセル数).
+* @param y      参照する領域の左下Y座標(ピクセル数).
+* @param width  参照する領域の幅(ピクセル数).
+* @param height 参照する領域の高さ(ピクセル数).
 *
-* @param filename t@C.
+* @return 作成に成功した場合はテクスチャポインタを返す.
+*         失敗した場合はnullptr返す.
 *
-* @return 쐬ɐꍇ̓eNX`|C^Ԃ.
-*         sꍇnullptrԂ.
+* 作成したテクスチャのId()はpageと同じ値を返し、Width()とHeight()は領域の大きさを返す.
+* テクスチャアトラスに格納した画像を、元の画像と同じように扱うために使う.
 */
-TexturePtr Texture::LoadFromFile(const char* filename)
+TexturePtr Texture::CreateSubTexture(const TexturePtr& page, int x, int y, int width, int height)
 {
-  struct stat st;
-  if (stat(filename, &st)) {
-    return {};
-  }
-  const size_t bmpFileHeaderSize = 14; // rbg}bvt@Cwb_̃oCg
-  const size_t windowsV1HeaderSize = 40; // rbg}bvwb_̃oCg.
-  if (st.st_size < bmpFileHeaderSize + windowsV1HeaderSize) {
+  if (!page || x < 0 || y < 0 || x + width > page->PageWidth() || y + height > page->PageHeight()) {
     return {};
   }
-  FILE* fp = fopen(filename, "rb");
-  if (!fp) {
-    return {};
+  struct Impl : Texture {};
+  TexturePtr p = std::make_shared<Impl>();
+  p->page = page->page ? page->page : page;
+  p->texId = page->texId;
+  p->offsetX = page->offsetX + x;
+  p->offsetY = page->offsetY + y;
+  p->width = width;
+  p->height = height;
+  return p;
+}
+
+/**
+* 画像ファイルを32bitRGBA形式で読み込む.
+*
+* @param filename 画像ファイル名.
+* @param width    画像の幅の格納先.
+* @param height   画像の高さの格納先.
+* @param pixels   画像データの格納先. テクスチャと同じく1行目が画像の最下行になる.
+*
+* @retval true  読み込み成功.
+* @retval false 読み込み失敗.
+*
+* テクスチャを作成せずにCPU側で画像を加工したい場合に使う.
+* ディスクキャッシュが有効なら、展開済みの画像をキャッシュファイルから読み込む.
+*/
+bool Texture::LoadImageRGBA8(const char* filename, int& width, int& height, std::vector<uint8_t>& pixels)
+{
+  DiskCacheKey key;
+  DDSLayout layout;
+  if (const MappedFilePtr cacheFile = OpenDiskCache(filename, key, layout)) {
+    width = layout.width;
+    height = layout.height;
+    const uint8_t* p = cacheFile->Data() + layout.imageOffset;
+    pixels.assign(p, p + GetDDSLevelSize(layout, 0));
+    return true;
   }
+
   std::vector<uint8_t> buf;
-  buf.resize(st.st_size);
-  const size_t readSize = fread(buf.data(), 1, st.st_size, fp);
-  fclose(fp);
-  if (readSize != st.st_size) {
-    return {};
+  if (!ReadFile(filename, buf)) {
+    std::cerr << filename << "を読み込めません.\n" << "ファイル名を確認してください." << std::endl;
+    return false;
   }
-  const uint8_t* pHeader = buf.data();
-
-  if (pHeader[0] == 'D' || pHeader[1] == 'D' || pHeader[2] == 'S' || pHeader[3] == ' ') {
-    DDSHeader header;
-    const GLuint texId = LoadDDS(filename, st, buf.data(), &header);
-    if (texId) {
-      struct impl : Texture {};
-      TexturePtr p = std::make_shared<impl>();
-      p->width = header.width;
-      p->height = header.height;
-      p->texId = texId;
-      p->name = filename;
-      return p;
+  if (Png::IsPng(buf.data(), buf.size())) {
+    if (!Png::Decode(buf.data(), buf.size(), width, height, pixels)) {
+      std::cerr << filename << "をRGBA形式に変換できません." << std::endl;
+      return false;
+    }
+  } else {
+#ifdef EASY_TEXTURE_USE_WIC
+    if (!wic::LoadRGBA8(filename, width, height, pixels)) {
+      return false;
     }
+#else
+    std::cerr << filename << "を読み込めません.\n" << "この環境ではPNG以外の画像形式には対応していません." << std::endl;
+    return false;
+#endif
   }
+  WriteDiskCache(filename, key, buf.data(), buf.size(), width, height, pixels.data());
+  return true;
+}
 
-  return wic::LoadFromFile(filename);
-
-  if (pHeader[0] != 'B' || pHeader[1] != 'M') {
-    return {};
-  }
-  const size_t offsetBytes = Get(pHeader, 10, 4);
-  const uint32_t infoSize = Get(pHeader, 14, 4);
-  const uint32_t width = Get(pHeader, 18, 4);
-  const uint32_t height = Get(pHeader, 22, 4);
-  const uint32_t bitCount = Get(pHeader, 28, 2);
-  const uint32_t compression = Get(pHeader, 30, 4);
-  const size_t pixelBytes = bitCount / 8;
-  if (infoSize != windowsV1HeaderSize || bitCount != 24 || compression ||
-    (width * pixelBytes) % 4) {
-    return {};
+/**
+* ファイルから2Dテクスチャを読み込む.
+*
+* @param filename ファイル名.
+*
+* @return 作成に成功した場合はテクスチャポインタを返す.
+*         失敗した場合はnullptr返す.
+*
+* ディスクキャッシュが有効なら、展開済みの画像をキャッシュファイルから直接転送する.
+*/
+TexturePtr Texture::LoadFromFile(const char* filename)
+{
+  // 展開済みの画像がディスクキャッシュにあれば、キャッシュファイルから直接転送する.
+  DiskCacheKey key;
+  DDSLayout layout;
+  MappedFilePtr file = OpenDiskCache(filename, key, layout);
+  if (!file) {
+    file = MappedFile::Open(filename);
+    if (!file || file->Size() < 4) {
+      return {};
+    }
+    const uint8_t* pHeader = file->Data();
+    if (memcmp(pHeader, "DDS ", 4) != 0 || !ReadDDSLayout(filename, pHeader, file->Size(), layout)) {
+      Image image;
+      if (!DecodeImage(filename, pHeader, file->Size(), image)) {
+        return {};
+      }
+      const bool isWritten = CanWriteDiskCache(image) &&
+        WriteDiskCache(filename, key, pHeader, file->Size(), image.width, image.height, image.pixels.data());
+      // ミップマップを作成した場合は、書き込んだファイルから転送する.
+      file.reset();
+      if (isWritten && diskCacheSettings.generateMipmaps) {
+        file = OpenDiskCache(filename, key, layout);
+      }
+      if (!file) {
+        TexturePtr p = Create(image.width, image.height, image.iformat, image.format, image.type, image.pixels.data());
+        if (p) {
+          p->Name(filename);
+        }
+        return p;
+      }
+    }
   }
-  const size_t imageSize = width * height * pixelBytes;
-  if (buf.size() < offsetBytes + imageSize) {
+
+  const GLuint texId = LoadLevels(filename, layout, file->Data());
+  if (!texId) {
     return {};
   }
-  return Create(width, height, GL_RGB8, GL_BGR, GL_UNSIGNED_BYTE, buf.data() + offsetBytes);
+  struct impl : Texture {};
+  TexturePtr p = std::make_shared<impl>();
+  p->width = layout.width;
+  p->height = layout.height;
+  p->texId = texId;
+  p->byteSize = layout.faceSize * layout.faceCount;
+  p->name = filename;
+  return p;
 }
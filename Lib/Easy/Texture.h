@@ -6,12 +6,14 @@
 #include <GL/glew.h>
 #include <memory>
 #include <string>
+#include <vector>
+#include <stdint.h>
 
 class Texture;
-typedef std::shared_ptr<Texture> TexturePtr; ///< eNX`|C^.
+typedef std::shared_ptr<Texture> TexturePtr; ///< テクスチャポインタ.
 
 /**
-* eNX`NX.
+* テクスチャクラス.
 */
 class Texture
 {
@@ -23,14 +25,58 @@ public:
   static TexturePtr LoadAndCache(const char*);
   static void RemoveOrphan();
 
+  /// テクスチャキャッシュの統計情報.
+  struct CacheStats
+  {
+    size_t budgetBytes; ///< VRAM使用量の上限.
+    size_t residentBytes; ///< キャッシュしているテクスチャのVRAM使用量(推定).
+    size_t textureCount; ///< キャッシュしているテクスチャの数.
+    size_t pinnedCount; ///< 固定しているテクスチャの数.
+    uint64_t hits; ///< キャッシュにあったテクスチャを返した回数.
+    uint64_t misses; ///< キャッシュになかったため読み込んだ回数.
+    uint64_t evictions; ///< キャッシュから取り除いたテクスチャの数.
+  };
+  static void SetCacheBudget(size_t bytes);
+  static bool Pin(const TexturePtr&);
+  static bool Unpin(const TexturePtr&);
+  static CacheStats GetCacheStats();
+  static void ResetCacheStats();
+  static const size_t defaultCacheBudget = 256 * 1024 * 1024; ///< キャッシュの標準のVRAM使用量の上限.
+
+  // 展開済み画像のディスクキャッシュ.
+  static bool SetDiskCache(const char* directory, bool generateMipmaps = false);
+  static void ClearDiskCache();
+
+  // 非同期読み込み用.
+  static TexturePtr LoadAsync(const char*);
+  static void ProcessUploads(size_t maxBytes = defaultUploadBytes);
+  static bool WaitForLoad(const TexturePtr&);
+  static size_t PendingUploadCount();
+  static const size_t defaultUploadBytes = 4 * 1024 * 1024; ///< ProcessUploadsが1回に転送する標準のバイト数.
+
   static TexturePtr Create(int width, int height, GLenum iformat, GLenum format, GLenum type, const void* data);
   static TexturePtr LoadFromFile(const char*);
+  static TexturePtr CreateSubTexture(const TexturePtr& page, int x, int y, int width, int height);
+  static bool LoadImageRGBA8(const char*, int& width, int& height, std::vector<uint8_t>& pixels);
 
   void Name(const char* str) { name = str; }
   const std::string& Name() const { return name; }
   GLuint Id() const { return texId; }
   GLsizei Width() const { return width; }
   GLsizei Height() const { return height; }
+  size_t ByteSize() const { return byteSize; }
+
+  // テクスチャアトラス用.
+  bool IsSubTexture() const { return page != nullptr; }
+  int OffsetX() const { return offsetX; }
+  int OffsetY() const { return offsetY; }
+  GLsizei PageWidth() const { return page ? page->width : width; }
+  GLsizei PageHeight() const { return page ? page->height : height; }
+  const Texture* Page() const { return page ? page.get() : this; }
+
+  // 非同期読み込みの状態.
+  bool IsLoading() const { return state == State_Loading; }
+  bool IsFailed() const { return state == State_Failed; }
 
 private:
   Texture() = default;
@@ -38,10 +84,22 @@ private:
   Texture(const Texture&) = delete;
   Texture& operator=(const Texture&) = delete;
 
+  /// 読み込み状態.
+  enum State {
+    State_Ready, ///< 使用可能.
+    State_Loading, ///< 非同期読み込み中. 代わりに代替テクスチャで描画される.
+    State_Failed, ///< 非同期読み込みに失敗した. 代替テクスチャのまま.
+  };
+
   std::string name;
   GLuint texId = 0;
   int width = 0;
   int height = 0;
+  size_t byteSize = 0; ///< VRAM使用量(推定). サブテクスチャは参照先が持つので0.
+  TexturePtr page; ///< 参照先のテクスチャ. サブテクスチャでなければnullptr.
+  int offsetX = 0; ///< 参照先テクスチャ内の左下X座標.
+  int offsetY = 0; ///< 参照先テクスチャ内の左下Y座標.
+  State state = State_Ready; ///< 読み込み状態.
 };
 
 #endif // TEXTURE_H_INCLUDED
\ No newline at end of file
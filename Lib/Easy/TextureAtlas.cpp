@@ -0,0 +1,460 @@
+/**
+* @file TextureAtlas.cpp
+*/
+#include "TextureAtlas.h"
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <iostream>
+#include <thread>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+namespace /* unnamed */ {
+
+const char layoutSignature[] = "TextureAtlas 2"; ///< レイアウトファイルの識別文字列.
+
+/**
+* スカイラインの水平な区間.
+*/
+struct Segment
+{
+  int x;
+  int y;
+  int width;
+};
+
+/**
+* スカイライン法で1ページぶんの配置を管理するクラス.
+*/
+class Skyline
+{
+public:
+  explicit Skyline(int size) : size(size) { segmentList.push_back({ 0, 0, size }); }
+
+  /**
+  * 矩形を配置する.
+  *
+  * @param w 配置する矩形の幅.
+  * @param h 配置する矩形の高さ.
+  * @param x 配置した左下X座標の格納先.
+  * @param y 配置した左下Y座標の格納先.
+  *
+  * @retval true  配置成功.
+  * @retval false 空きがないため配置できなかった.
+  *
+  * 配置後の上端が最も低くなる位置を選ぶ. 同じ高さなら無駄になる隙間が少ない位置を選ぶ.
+  */
+  bool Insert(int w, int h, int& x, int& y)
+  {
+    size_t bestIndex = segmentList.size();
+    int bestTop = size + 1;
+    int bestWaste = 0;
+    for (size_t i = 0; i < segmentList.size(); ++i) {
+      int top, waste;
+      if (!Fit(i, w, h, top, waste)) {
+        continue;
+      }
+      if (top < bestTop || (top == bestTop && waste < bestWaste)) {
+        bestIndex = i;
+        bestTop = top;
+        bestWaste = waste;
+      }
+    }
+    if (bestIndex >= segmentList.size()) {
+      return false;
+    }
+    x = segmentList[bestIndex].x;
+    y = bestTop - h;
+    Place(bestIndex, x, bestTop, w);
+    return true;
+  }
+
+private:
+  /**
+  * i番目の区間から始まる位置に矩形を置けるか調べる.
+  *
+  * @param i     矩形の左端となる区間の番号.
+  * @param w     矩形の幅.
+  * @param h     矩形の高さ.
+  * @param top   置いた場合の矩形の上端の格納先.
+  * @param waste 矩形の下にできる隙間の面積の格納先.
+  *
+  * @retval true  置ける.
+  * @retval false ページからはみ出すため置けない.
+  */
+  bool Fit(size_t i, int w, int h, int& top, int& waste) const
+  {
+    const int left = segmentList[i].x;
+    if (left + w > size) {
+      return false;
+    }
+    int bottom = 0;
+    for (size_t j = i; j < segmentList.size() && segmentList[j].x < left + w; ++j) {
+      bottom = std::max(bottom, segmentList[j].y);
+    }
+    if (bottom + h > size) {
+      return false;
+    }
+    waste = 0;
+    for (size_t j = i; j < segmentList.size() && segmentList[j].x < left + w; ++j) {
+      const int right = std::min(segmentList[j].x + segmentList[j].width, left + w);
+      waste += (right - segmentList[j].x) * (bottom - segmentList[j].y);
+    }
+    top = bottom + h;
+    return true;
+  }
+
+  /**
+  * 矩形を置いた結果をスカイラインに反映する.
+  *
+  * @param i   矩形の左端となる区間の番号.
+  * @param x   矩形の左端.
+  * @param top 矩形の上端.
+  * @param w   矩形の幅.
+  */
+  void Place(size_t i, int x, int top, int w)
+  {
+    segmentList.insert(segmentList.begin() + i, { x, top, w });
+    // 新しい区間に隠れた区間を削除、または縮める.
+    for (size_t j = i + 1; j < segmentList.size();) {
+      Segment& e = segmentList[j];
+      if (e.x >= x + w) {
+        break;
+      }
+      const int right = e.x + e.width;
+      if (right <= x + w) {
+        segmentList.erase(segmentList.begin() + j);
+        continue;
+      }
+      e.width = right - (x + w);
+      e.x = x + w;
+      break;
+    }
+    // 同じ高さで隣り合う区間を結合する.
+    for (size_t j = 0; j + 1 < segmentList.size();) {
+      if (segmentList[j].y == segmentList[j + 1].y) {
+        segmentList[j].width += segmentList[j + 1].width;
+        segmentList.erase(segmentList.begin() + j + 1);
+      } else {
+        ++j;
+      }
+    }
+  }
+
+  int size;
+  std::vector<Segment> segmentList;
+};
+
+/**
+* 画像をページに書き込み、周囲の余白を端の色で埋める.
+*
+* @param page      書き込み先のページ画像.
+* @param pageWidth ページの幅.
+* @param x         書き込む位置の左下X座標(余白を含む).
+* @param y         書き込む位置の左下Y座標(余白を含む).
+* @param padding   余白の幅.
+* @param width     画像の幅.
+* @param height    画像の高さ.
+* @param pixels    画像データ.
+*/
+void Blit(std::vector<uint8_t>& page, int pageWidth, int x, int y, int padding,
+  int width, int height, const uint8_t* pixels)
+{
+  const size_t rowBytes = (width + padding * 2) * 4;
+  for (int row = 0; row < height; ++row) {
+    uint8_t* dst = &page[((y + padding + row) * pageWidth + x) * 4];
+    const uint8_t* src = pixels + row * width * 4;
+    for (int i = 0; i < padding; ++i) {
+      memcpy(dst + i * 4, src, 4);
+      memcpy(dst + (padding + width + i) * 4, src + (width - 1) * 4, 4);
+    }
+    memcpy(dst + padding * 4, src, width * 4);
+  }
+  const uint8_t* bottom = &page[((y + padding) * pageWidth + x) * 4];
+  const uint8_t* top = &page[((y + padding + height - 1) * pageWidth + x) * 4];
+  for (int i = 0; i < padding; ++i) {
+    memcpy(&page[((y + i) * pageWidth + x) * 4], bottom, rowBytes);
+    memcpy(&page[((y + padding + height + i) * pageWidth + x) * 4], top, rowBytes);
+  }
+}
+
+} // unnamed namespace
+
+/**
+* テクスチャアトラスを作成する.
+*
+* @param pageSize ページの幅と高さの最大値(ピクセル数).
+* @param padding  画像の周囲に追加する余白(ピクセル数).
+*
+* @return 作成したテクスチャアトラスへのポインタ.
+*/
+TextureAtlasPtr TextureAtlas::Create(int pageSize, int padding)
+{
+  struct Impl : TextureAtlas { Impl() {} ~Impl() {} };
+  TextureAtlasPtr p = std::make_shared<Impl>();
+  p->pageSize = std::max(1, pageSize);
+  p->padding = std::max(0, padding);
+  return p;
+}
+
+/**
+* アトラスに含める画像を登録する.
+*
+* @param filename 画像ファイル名.
+*/
+void TextureAtlas::Add(const char* filename)
+{
+  if (std::find(filenameList.begin(), filenameList.end(), filename) == filenameList.end()) {
+    filenameList.push_back(filename);
+  }
+}
+
+/**
+* 登録された画像をページにまとめ、サブテクスチャをキャッシュに登録する.
+*
+* @param layoutFilename 配置結果を保存するファイル名. nullptrの場合は保存しない.
+*
+* @retval true  作成成功.
+* @retval false ページの作成に失敗.
+*/
+bool TextureAtlas::Build(const char* layoutFilename)
+{
+  std::vector<Image> candidateList;
+  candidateList.reserve(filenameList.size());
+  for (const auto& e : filenameList) {
+    if (Texture::IsCached(e.c_str())) {
+      std::cerr << "WARNING: " << e << "は既にキャッシュされているため、アトラスに含めません." << std::endl;
+      continue;
+    }
+    struct stat st;
+    if (stat(e.c_str(), &st)) {
+      std::cerr << "WARNING: " << e << "が見つかりません." << std::endl;
+      continue;
+    }
+    candidateList.push_back({ e, static_cast<long long>(st.st_mtime), 0, 0, 0, 0, 0, {} });
+  }
+
+  // 画像の展開は互いに独立しているので、複数のスレッドで並列に行う.
+  // 画像ごとに大きさが異なるため、各スレッドは次に展開する画像を共有カウンタから取り出す.
+  std::vector<char> loadedList(candidateList.size());
+  std::atomic<size_t> next(0);
+  const size_t threadCount = std::min<size_t>(candidateList.size(), std::max(1U, std::thread::hardware_concurrency()));
+  std::vector<std::future<void>> futureList;
+  futureList.reserve(threadCount);
+  for (size_t i = 0; i < threadCount; ++i) {
+    futureList.push_back(std::async(std::launch::async, [&candidateList, &loadedList, &next]() {
+      for (size_t i = next++; i < candidateList.size(); i = next++) {
+        Image& image = candidateList[i];
+        loadedList[i] = Texture::LoadImageRGBA8(image.filename.c_str(), image.width, image.height, image.pixels);
+      }
+    }));
+  }
+  for (auto& e : futureList) {
+    e.get();
+  }
+
+  std::vector<Image> imageList;
+  imageList.reserve(candidateList.size());
+  for (size_t i = 0; i < candidateList.size(); ++i) {
+    Image& image = candidateList[i];
+    if (!loadedList[i]) {
+      continue;
+    }
+    if (image.width + padding * 2 > pageSize || image.height + padding * 2 > pageSize) {
+      std::cerr << "WARNING: " << image.filename << "はページより大きいため、アトラスに含めません." << std::endl;
+      continue;
+    }
+    imageList.push_back(std::move(image));
+  }
+
+  int pageCount;
+  if (!layoutFilename || !LoadLayout(layoutFilename, imageList, pageCount)) {
+    pageCount = Pack(imageList);
+    if (layoutFilename) {
+      SaveLayout(layoutFilename, imageList, pageCount);
+    }
+  }
+
+  // ページの高さは使用している範囲まで縮める.
+  std::vector<int> pageHeight(pageCount, 1);
+  for (const auto& e : imageList) {
+    pageHeight[e.page] = std::max(pageHeight[e.page], e.y + e.height + padding * 2);
+  }
+
+  const size_t firstPage = pageList.size();
+  for (int page = 0; page < pageCount; ++page) {
+    std::vector<uint8_t> pixels(pageSize * pageHeight[page] * 4);
+    for (const auto& e : imageList) {
+      if (e.page == page) {
+        Blit(pixels, pageSize, e.x, e.y, padding, e.width, e.height, e.pixels.data());
+      }
+    }
+    TexturePtr tex = Texture::Create(pageSize, pageHeight[page], GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    if (!tex) {
+      std::cerr << "ERROR: テクスチャアトラスのページ作成に失敗." << std::endl;
+      return false;
+    }
+    tex->Name((std::string("*TextureAtlas") + std::to_string(firstPage + page)).c_str());
+    pageList.push_back(tex);
+  }
+
+  for (const auto& e : imageList) {
+    TexturePtr tex = Texture::CreateSubTexture(pageList[firstPage + e.page], e.x + padding, e.y + padding, e.width, e.height);
+    if (!tex) {
+      continue;
+    }
+    tex->Name(e.filename.c_str());
+    Texture::Cache(tex);
+    textureList.push_back(tex);
+  }
+  return true;
+}
+
+/**
+* 画像をページに詰め込む.
+*
+* @param imageList 詰め込む画像のリスト. 配置結果が書き込まれる.
+*
+* @return 使用したページ数.
+*
+* 高い画像から順に、既存のページの先頭から空きを探して配置する.
+* どのページにも置けない場合は新しいページを追加する.
+*/
+int TextureAtlas::Pack(std::vector<Image>& imageList) const
+{
+  std::vector<size_t> order(imageList.size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(), [&imageList](size_t a, size_t b) {
+    const Image& lhs = imageList[a];
+    const Image& rhs = imageList[b];
+    if (lhs.height != rhs.height) {
+      return lhs.height > rhs.height;
+    }
+    return lhs.width > rhs.width;
+  });
+
+  std::vector<Skyline> pages;
+  for (size_t i : order) {
+    Image& image = imageList[i];
+    const int w = image.width + padding * 2;
+    const int h = image.height + padding * 2;
+    size_t page = 0;
+    for (; page < pages.size(); ++page) {
+      if (pages[page].Insert(w, h, image.x, image.y)) {
+        break;
+      }
+    }
+    if (page >= pages.size()) {
+      pages.emplace_back(pageSize);
+      pages.back().Insert(w, h, image.x, image.y);
+    }
+    image.page = static_cast<int>(page);
+  }
+  return static_cast<int>(pages.size());
+}
+
+/**
+* 保存した配置結果を読み込む.
+*
+* @param filename  レイアウトファイル名.
+* @param imageList 配置する画像のリスト. 読み込みに成功した場合、配置結果が書き込まれる.
+* @param pageCount 読み込みに成功した場合、使用するページ数が格納される.
+*
+* @retval true  読み込み成功.
+* @retval false ファイルがない、ページの設定や画像が保存時と異なる、または配置結果が壊れている.
+*
+* ファイルは手で編集されたり途中まで書き込まれたりする可能性があるため、
+* ページ番号の範囲、画像がページ内に収まること、画像同士が重ならないことを確認する.
+*/
+bool TextureAtlas::LoadLayout(const char* filename, std::vector<Image>& imageList, int& pageCount) const
+{
+  FILE* fp = fopen(filename, "r");
+  if (!fp) {
+    return false;
+  }
+  char line[1024];
+  int savedPageSize, savedPadding, count, savedPageCount;
+  bool result = fgets(line, sizeof(line), fp) && strncmp(line, layoutSignature, sizeof(layoutSignature) - 1) == 0 &&
+    fscanf(fp, "%d %d %d %d", &savedPageSize, &savedPadding, &count, &savedPageCount) == 4 &&
+    savedPageSize == pageSize && savedPadding == padding && count == static_cast<int>(imageList.size()) &&
+    savedPageCount >= 0 && savedPageCount <= count && (savedPageCount > 0 || count == 0);
+
+  std::vector<Image> tmp(imageList.size());
+  for (size_t i = 0; result && i < imageList.size(); ++i) {
+    Image& e = tmp[i];
+    if (fscanf(fp, "%d %d %d %d %d %lld ", &e.page, &e.x, &e.y, &e.width, &e.height, &e.mtime) != 6 ||
+      !fgets(line, sizeof(line), fp)) {
+      result = false;
+      break;
+    }
+    line[strcspn(line, "\r\n")] = '\0';
+    const Image& image = imageList[i];
+    if (image.filename != line || image.mtime != e.mtime || image.width != e.width || image.height != e.height) {
+      result = false;
+      break;
+    }
+    // 余白を含めた範囲がページに収まること. 加算によるオーバーフローを避けるため、残りの幅と比較する.
+    if (e.page < 0 || e.page >= savedPageCount || e.x < 0 || e.y < 0 ||
+      e.x > pageSize - (e.width + padding * 2) || e.y > pageSize - (e.height + padding * 2)) {
+      std::cerr << "WARNING: " << filename << "の" << line << "の配置がページの範囲外です." << std::endl;
+      result = false;
+      break;
+    }
+  }
+  fclose(fp);
+
+  // 同じページの画像が重なっていると、後から書き込んだ画像が前の画像を上書きしてしまう.
+  for (size_t i = 0; result && i < tmp.size(); ++i) {
+    const Image& a = tmp[i];
+    for (size_t j = i + 1; j < tmp.size(); ++j) {
+      const Image& b = tmp[j];
+      if (a.page == b.page &&
+        a.x < b.x + b.width + padding * 2 && b.x < a.x + a.width + padding * 2 &&
+        a.y < b.y + b.height + padding * 2 && b.y < a.y + a.height + padding * 2) {
+        std::cerr << "WARNING: " << filename << "の" << imageList[i].filename << "と" <<
+          imageList[j].filename << "の配置が重なっています." << std::endl;
+        result = false;
+        break;
+      }
+    }
+  }
+
+  if (result) {
+    for (size_t i = 0; i < imageList.size(); ++i) {
+      imageList[i].page = tmp[i].page;
+      imageList[i].x = tmp[i].x;
+      imageList[i].y = tmp[i].y;
+    }
+    pageCount = savedPageCount;
+  }
+  return result;
+}
+
+/**
+* 配置結果を保存する.
+*
+* @param filename  レイアウトファイル名.
+* @param imageList 配置済みの画像のリスト.
+* @param pageCount 使用するページ数.
+*
+* @retval true  保存成功.
+* @retval false 保存失敗.
+*/
+bool TextureAtlas::SaveLayout(const char* filename, const std::vector<Image>& imageList, int pageCount) const
+{
+  FILE* fp = fopen(filename, "w");
+  if (!fp) {
+    std::cerr << "WARNING: " << filename << "に書き込めません." << std::endl;
+    return false;
+  }
+  fprintf(fp, "%s\n%d %d %d %d\n", layoutSignature, pageSize, padding, static_cast<int>(imageList.size()), pageCount);
+  for (const auto& e : imageList) {
+    fprintf(fp, "%d %d %d %d %d %lld %s\n", e.page, e.x, e.y, e.width, e.height, e.mtime, e.filename.c_str());
+  }
+  fclose(fp);
+  return true;
+}
@@ -0,0 +1,69 @@
+/**
+* @file TextureAtlas.h
+*/
+#ifndef TEXTUREATLAS_H_INCLUDED
+#define TEXTUREATLAS_H_INCLUDED
+#include "Texture.h"
+#include <vector>
+#include <string>
+#include <memory>
+
+class TextureAtlas;
+typedef std::shared_ptr<TextureAtlas> TextureAtlasPtr; ///< テクスチャアトラスポインタ型.
+
+/**
+* 複数の画像を少数の大きなテクスチャ(ページ)にまとめるクラス.
+*
+* Add()で登録した画像をBuild()でページに詰め込み、各画像をページの一部を参照する
+* サブテクスチャとしてテクスチャキャッシュに登録する.
+* 以後Texture::LoadAndCache()やSprite(texname, ...)はサブテクスチャを返すため、
+* 画像ごとのRectをそのまま使いながら同じページのスプライトを1回の描画にまとめられる.
+*
+* 詰め込みにはスカイライン法を使い、線形補間で隣の画像がにじまないように
+* 各画像の周囲をpaddingピクセルぶん端の色で埋める.
+* レイアウトファイルを指定すると配置結果を保存し、次回以降は画像が変更されていなければ
+* 詰め込みを省略して保存した配置を使う.
+*
+* Build()はその画像を使うスプライトを作成する前に呼び出すこと.
+* 既にキャッシュされている画像とページに収まらない大きさの画像は、アトラスに含めない.
+*/
+class TextureAtlas
+{
+public:
+  static TextureAtlasPtr Create(int pageSize = 2048, int padding = 1);
+
+  void Add(const char* filename);
+  bool Build(const char* layoutFilename = nullptr);
+  size_t PageCount() const { return pageList.size(); }
+  const TexturePtr& Page(size_t n) const { return pageList[n]; }
+
+private:
+  TextureAtlas() = default;
+  ~TextureAtlas() = default;
+  TextureAtlas(const TextureAtlas&) = delete;
+  TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+  /// 登録された画像.
+  struct Image {
+    std::string filename;
+    long long mtime = 0; ///< ファイルの更新時刻.
+    int width = 0;
+    int height = 0;
+    int page = 0; ///< 配置先のページ番号.
+    int x = 0; ///< 配置先の左下X座標(余白を含む).
+    int y = 0; ///< 配置先の左下Y座標(余白を含む).
+    std::vector<uint8_t> pixels;
+  };
+
+  bool LoadLayout(const char* filename, std::vector<Image>& imageList, int& pageCount) const;
+  bool SaveLayout(const char* filename, const std::vector<Image>& imageList, int pageCount) const;
+  int Pack(std::vector<Image>& imageList) const;
+
+  int pageSize = 2048; ///< ページの幅と高さの最大値.
+  int padding = 1; ///< 画像の周囲に追加する余白.
+  std::vector<std::string> filenameList; ///< 登録された画像ファイル名.
+  std::vector<TexturePtr> pageList; ///< 作成したページ.
+  std::vector<TexturePtr> textureList; ///< 作成したサブテクスチャ.
+};
+
+#endif // TEXTUREATLAS_H_INCLUDED
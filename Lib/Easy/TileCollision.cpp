@@ -0,0 +1,442 @@
+/**
+* @file TileCollision.cpp
+*/
+#include "TileCollision.h"
+#include <algorithm>
+#include <limits>
+#include <math.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace /* unnamed */ {
+
+/**
+* 最下位の1のビットの位置を取得する.
+*
+* @param v 調べる値. 0以外であること.
+*
+* @return 最下位の1のビットの位置(0～63).
+*/
+int FindFirstBit(uint64_t v)
+{
+#ifdef _MSC_VER
+  // 32bit環境では_BitScanForward64が使えないので、32bitずつ調べる.
+  unsigned long index;
+  if (_BitScanForward(&index, static_cast<unsigned long>(v))) {
+    return static_cast<int>(index);
+  }
+  _BitScanForward(&index, static_cast<unsigned long>(v >> 32));
+  return static_cast<int>(index) + 32;
+#else
+  return __builtin_ctzll(v);
+#endif
+}
+
+} // unnamed namespace
+
+/**
+* TiledMapのレイヤーから衝突判定を作成する.
+*
+* @param map     タイルマップ.
+* @param layerNo 衝突判定を作成するレイヤーの番号.
+*
+* @retval true  作成成功.
+* @retval false layerNoに対応するレイヤーがない.
+*
+* レイヤーに対応するタイルセットのsolidがtrueのタイルを、衝突判定ありとする.
+* Offset()はマップの位置とレイヤーのオフセットから設定される.
+*/
+bool TileCollision::Build(const TiledMap& map, int layerNo)
+{
+  if (layerNo < 0 || static_cast<size_t>(layerNo) >= map.LayerCount()) {
+    return false;
+  }
+  const TiledMap::Layer& layer = map.GetLayer(layerNo);
+  if (static_cast<size_t>(layer.tilesetNo) >= map.TileSetCount()) {
+    Build(layer, glm::vec2(1), [](uint32_t) { return false; });
+  } else {
+    const TiledMap::TileSet& tileset = map.GetTileSet(layer.tilesetNo);
+    const std::vector<bool>& solid = tileset.solid;
+    const int firstId = tileset.firstId;
+    Build(layer, tileset.size, [&solid, firstId](uint32_t tile) {
+      const int id = static_cast<int>(tile & TiledMap::MaskForID) - firstId;
+      return id >= 0 && static_cast<size_t>(id) < solid.size() && solid[id];
+    });
+  }
+  offset = map.Position() + layer.baseOffset + layer.offset;
+  return true;
+}
+
+/**
+* レイヤーから衝突判定を作成する.
+*
+* @param layer    レイヤー.
+* @param tileSize タイルの縦横のピクセル数.
+* @param isSolid  タイルのデータ(フラグを含む)を受け取り、衝突判定があればtrueを返す関数.
+*/
+void TileCollision::Build(const TiledMap::Layer& layer, const glm::vec2& tileSize, const std::function<bool(uint32_t)>& isSolid)
+{
+  size = layer.size;
+  this->tileSize = tileSize;
+  stride = (size.x + 63) / 64;
+  bits.assign(static_cast<size_t>(stride) * size.y, 0);
+  for (int y = 0; y < size.y; ++y) {
+    uint64_t* row = bits.data() + static_cast<size_t>(y) * stride;
+    for (int x = 0; x < size.x; ++x) {
+      if (isSolid(layer.At(y, x))) {
+        row[x / 64] |= uint64_t(1) << (x % 64);
+      }
+    }
+  }
+}
+
+/**
+* タイルの衝突判定を変更する.
+*
+* @param y     タイルの縦の位置.
+* @param x     タイルの横の位置.
+* @param solid true=衝突判定あり. false=衝突判定なし.
+*/
+void TileCollision::Set(int y, int x, bool solid)
+{
+  if (x < 0 || y < 0 || x >= size.x || y >= size.y) {
+    return;
+  }
+  uint64_t& word = bits[static_cast<size_t>(y) * stride + x / 64];
+  const uint64_t mask = uint64_t(1) << (x % 64);
+  if (solid) {
+    word |= mask;
+  } else {
+    word &= ~mask;
+  }
+}
+
+/**
+* タイルに衝突判定があるか調べる.
+*
+* @param y タイルの縦の位置.
+* @param x タイルの横の位置.
+*
+* @retval true  衝突判定あり.
+* @retval false 衝突判定なし、またはマップの外側.
+*/
+bool TileCollision::IsSolid(int y, int x) const
+{
+  if (x < 0 || y < 0 || x >= size.x || y >= size.y) {
+    return false;
+  }
+  return (bits[static_cast<size_t>(y) * stride + x / 64] >> (x % 64)) & 1;
+}
+
+/**
+* 矩形をタイル単位の座標に変換する.
+*
+* @param box 変換する矩形.
+* @param lo  左上のタイル単位の座標を格納する変数.
+* @param hi  右下のタイル単位の座標を格納する変数.
+*
+* 右下の座標をlo + size / tileSizeで求めると、タイルの境界にちょうど接する辺が誤差で境界を越えてしまう.
+* そのため、4辺ともワールド座標の辺の位置から個別に変換する.
+*/
+void TileCollision::ToTileSpace(const Rect& box, glm::vec2& lo, glm::vec2& hi) const
+{
+  const glm::vec2 half = glm::vec2(size) * 0.5f;
+  lo.x = (box.origin.x - offset.x) / tileSize.x + half.x;
+  lo.y = half.y - (box.origin.y + box.size.y - offset.y) / tileSize.y;
+  hi.x = (box.origin.x + box.size.x - offset.x) / tileSize.x + half.x;
+  hi.y = half.y - (box.origin.y - offset.y) / tileSize.y;
+}
+
+/**
+* 1行の範囲内で衝突判定のあるタイルを探す.
+*
+* @param y  行.
+* @param x0 範囲の左端の列.
+* @param x1 範囲の右端の列(範囲に含む).
+* @param x  見つかったタイルの列を格納する変数.
+*
+* @retval true  見つかった.
+* @retval false 見つからなかった.
+*
+* 範囲の両端のワードをマスクし、間のワードは0かどうかだけを調べる.
+*/
+bool TileCollision::FindInRow(int y, int x0, int x1, int& x) const
+{
+  if (y < 0 || y >= size.y) {
+    return false;
+  }
+  x0 = std::max(x0, 0);
+  x1 = std::min(x1, size.x - 1);
+  if (x0 > x1) {
+    return false;
+  }
+  const uint64_t* row = bits.data() + static_cast<size_t>(y) * stride;
+  const int w0 = x0 / 64;
+  const int w1 = x1 / 64;
+  const uint64_t headMask = ~uint64_t(0) << (x0 % 64);
+  const uint64_t tailMask = ~uint64_t(0) >> (63 - x1 % 64);
+  if (w0 == w1) {
+    const uint64_t v = row[w0] & headMask & tailMask;
+    if (v) {
+      x = w0 * 64 + FindFirstBit(v);
+      return true;
+    }
+    return false;
+  }
+  if (const uint64_t v = row[w0] & headMask) {
+    x = w0 * 64 + FindFirstBit(v);
+    return true;
+  }
+  for (int w = w0 + 1; w < w1; ++w) {
+    if (row[w]) {
+      x = w * 64 + FindFirstBit(row[w]);
+      return true;
+    }
+  }
+  if (const uint64_t v = row[w1] & tailMask) {
+    x = w1 * 64 + FindFirstBit(v);
+    return true;
+  }
+  return false;
+}
+
+/**
+* 1列の範囲内で衝突判定のあるタイルを探す.
+*
+* @param x  列.
+* @param y0 範囲の上端の行.
+* @param y1 範囲の下端の行(範囲に含む).
+* @param y  見つかったタイルの行を格納する変数.
+*
+* @retval true  見つかった.
+* @retval false 見つからなかった.
+*/
+bool TileCollision::FindInColumn(int x, int y0, int y1, int& y) const
+{
+  if (x < 0 || x >= size.x) {
+    return false;
+  }
+  y0 = std::max(y0, 0);
+  y1 = std::min(y1, size.y - 1);
+  if (y0 > y1) {
+    return false;
+  }
+  const uint64_t* word = bits.data() + static_cast<size_t>(y0) * stride + x / 64;
+  const int shift = x % 64;
+  for (int i = y0; i <= y1; ++i, word += stride) {
+    if ((*word >> shift) & 1) {
+      y = i;
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+* 矩形範囲内で衝突判定のあるタイルを探す.
+*
+* @param tileMin 範囲の左上のタイル位置.
+* @param tileMax 範囲の右下のタイル位置(範囲に含む).
+* @param tile    見つかったタイルの位置を格納する変数.
+*
+* @retval true  見つかった.
+* @retval false 見つからなかった.
+*/
+bool TileCollision::FindInRange(glm::ivec2 tileMin, glm::ivec2 tileMax, glm::ivec2& tile) const
+{
+  tileMin = glm::max(tileMin, glm::ivec2(0));
+  tileMax = glm::min(tileMax, size - 1);
+  for (int y = tileMin.y; y <= tileMax.y; ++y) {
+    if (FindInRow(y, tileMin.x, tileMax.x, tile.x)) {
+      tile.y = y;
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+* 矩形が衝突判定のあるタイルと重なっているか調べる.
+*
+* @param box  調べる矩形.
+* @param tile 重なっているタイルの位置を格納する変数. 不要ならnullptr.
+*
+* @retval true  重なっている.
+* @retval false 重なっていない.
+*
+* 辺が接しているだけの場合は重なっていないとみなす.
+*/
+bool TileCollision::Overlap(const Rect& box, glm::ivec2* tile) const
+{
+  glm::vec2 lo, hi;
+  ToTileSpace(box, lo, hi);
+  glm::ivec2 tmp;
+  if (!FindInRange(glm::ivec2(glm::floor(lo)), glm::ivec2(glm::ceil(hi)) - 1, tmp)) {
+    return false;
+  }
+  if (tile) {
+    *tile = tmp;
+  }
+  return true;
+}
+
+/**
+* 移動する矩形が最初に衝突するタイルを調べる.
+*
+* @param box  移動前の矩形.
+* @param move 移動量.
+* @param hit  衝突情報を格納する変数.
+*
+* @retval true  衝突した. hitに衝突情報が格納される.
+* @retval false 衝突しなかった.
+*
+* 矩形の先頭の辺が新しい列または行に入る時刻を順にたどり、新しく重なる1列または1行だけを調べる.
+* hit.positionに矩形を置くと、衝突したタイルにちょうど接する.
+*/
+bool TileCollision::Sweep(const Rect& box, const glm::vec2& move, Hit& hit) const
+{
+  glm::vec2 lo, hi;
+  ToTileSpace(box, lo, hi);
+  glm::ivec2 tile;
+  if (FindInRange(glm::ivec2(glm::floor(lo)), glm::ivec2(glm::ceil(hi)) - 1, tile)) {
+    hit = { 0, box.origin, glm::vec2(0), tile };
+    return true;
+  }
+
+  // 軸ごとに、次に入る列(行)とその時刻を求める. タイル単位の座標ではyが下に向かう.
+  const glm::vec2 d(move.x / tileSize.x, -move.y / tileSize.y);
+  const float infinity = std::numeric_limits<float>::infinity();
+  glm::ivec2 step, next;
+  glm::vec2 tNext, tDelta;
+  for (int i = 0; i < 2; ++i) {
+    if (d[i] > 0) {
+      step[i] = 1;
+      next[i] = static_cast<int>(ceilf(hi[i]));
+      tNext[i] = (next[i] - hi[i]) / d[i];
+      tDelta[i] = 1 / d[i];
+    } else if (d[i] < 0) {
+      step[i] = -1;
+      next[i] = static_cast<int>(floorf(lo[i])) - 1;
+      tNext[i] = (lo[i] - (next[i] + 1)) / -d[i];
+      tDelta[i] = -1 / d[i];
+    } else {
+      step[i] = 0;
+      next[i] = 0;
+      tNext[i] = infinity;
+      tDelta[i] = infinity;
+    }
+  }
+
+  for (;;) {
+    const float t = std::min(tNext.x, tNext.y);
+    if (t > 1) {
+      break;
+    }
+    // 時刻tの直後に矩形が重なっている範囲.
+    glm::ivec2 rangeMin, rangeMax;
+    bool entered[2];
+    for (int i = 0; i < 2; ++i) {
+      entered[i] = tNext[i] <= t;
+      const float a = lo[i] + d[i] * t;
+      const float b = hi[i] + d[i] * t;
+      if (step[i] > 0) {
+        rangeMin[i] = static_cast<int>(floorf(a));
+        rangeMax[i] = entered[i] ? next[i] : std::min(static_cast<int>(floorf(b)), next[i] - 1);
+      } else if (step[i] < 0) {
+        rangeMin[i] = entered[i] ? next[i] : std::max(static_cast<int>(ceilf(a)) - 1, next[i] + 1);
+        rangeMax[i] = static_cast<int>(ceilf(b)) - 1;
+      } else {
+        rangeMin[i] = static_cast<int>(floorf(a));
+        rangeMax[i] = static_cast<int>(ceilf(b)) - 1;
+      }
+    }
+    // マップから遠ざかる方向に出てしまえば、それ以上衝突することはない.
+    if ((step.x > 0 && rangeMin.x >= size.x) || (step.x < 0 && rangeMax.x < 0) ||
+      (step.y > 0 && rangeMin.y >= size.y) || (step.y < 0 && rangeMax.y < 0)) {
+      break;
+    }
+
+    if (entered[0] && FindInColumn(next.x, rangeMin.y, rangeMax.y, tile.y)) {
+      tile.x = next.x;
+      hit = { t, box.origin + move * t, glm::vec2(static_cast<float>(-step.x), 0), tile };
+      return true;
+    }
+    if (entered[1] && FindInRow(next.y, rangeMin.x, rangeMax.x, tile.x)) {
+      tile.y = next.y;
+      hit = { t, box.origin + move * t, glm::vec2(0, static_cast<float>(step.y)), tile };
+      return true;
+    }
+    for (int i = 0; i < 2; ++i) {
+      if (entered[i]) {
+        next[i] += step[i];
+        tNext[i] += tDelta[i];
+      }
+    }
+  }
+  return false;
+}
+
+/**
+* 線分が最初に交差するタイルを調べる.
+*
+* @param start 線分の始点.
+* @param end   線分の終点.
+* @param hit   衝突情報を格納する変数.
+*
+* @retval true  交差した. hitに衝突情報が格納される.
+* @retval false 交差しなかった.
+*
+* 線分が通過するタイルをDDA(Digital Differential Analyzer)で順にたどる.
+*/
+bool TileCollision::Raycast(const glm::vec2& start, const glm::vec2& end, Hit& hit) const
+{
+  const glm::vec2 half = glm::vec2(size) * 0.5f;
+  const glm::vec2 p((start.x - offset.x) / tileSize.x + half.x, half.y - (start.y - offset.y) / tileSize.y);
+  const glm::vec2 d((end.x - start.x) / tileSize.x, -(end.y - start.y) / tileSize.y);
+  glm::ivec2 cell(glm::floor(p));
+  if (IsSolid(cell.y, cell.x)) {
+    hit = { 0, start, glm::vec2(0), cell };
+    return true;
+  }
+
+  const float infinity = std::numeric_limits<float>::infinity();
+  glm::ivec2 step;
+  glm::vec2 tMax, tDelta;
+  for (int i = 0; i < 2; ++i) {
+    if (d[i] > 0) {
+      step[i] = 1;
+      tMax[i] = (cell[i] + 1 - p[i]) / d[i];
+      tDelta[i] = 1 / d[i];
+    } else if (d[i] < 0) {
+      step[i] = -1;
+      tMax[i] = (p[i] - cell[i]) / -d[i];
+      tDelta[i] = -1 / d[i];
+    } else {
+      step[i] = 0;
+      tMax[i] = infinity;
+      tDelta[i] = infinity;
+    }
+  }
+
+  for (;;) {
+    const int axis = tMax.x < tMax.y ? 0 : 1;
+    const float t = tMax[axis];
+    if (t > 1) {
+      break;
+    }
+    cell[axis] += step[axis];
+    tMax[axis] += tDelta[axis];
+    if ((step[axis] > 0 && cell[axis] >= size[axis]) || (step[axis] < 0 && cell[axis] < 0)) {
+      break; // マップから遠ざかる方向に出た.
+    }
+    if (IsSolid(cell.y, cell.x)) {
+      // タイル単位の座標とはyの向きが逆.
+      glm::vec2 normal(0);
+      normal[axis] = static_cast<float>(axis == 0 ? -step[axis] : step[axis]);
+      hit = { t, start + (end - start) * t, normal, cell };
+      return true;
+    }
+  }
+  return false;
+}
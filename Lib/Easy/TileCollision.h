@@ -0,0 +1,66 @@
+/**
+* @file TileCollision.h
+*/
+#ifndef TILECOLLISION_H_INCLUDED
+#define TILECOLLISION_H_INCLUDED
+#include "TiledMap.h"
+#include <glm/glm.hpp>
+#include <vector>
+#include <functional>
+#include <stdint.h>
+
+/**
+* タイルマップの衝突判定クラス.
+*
+* レイヤーの各タイルに衝突判定があるかどうかを1タイル1ビットで記録し、
+* 矩形との重なり、移動する矩形の衝突時刻、線分との交差を調べる.
+* 1行のビットは64bit単位で格納されていて、矩形が横に並んだタイルと重なるかどうかは
+* 1行あたり数回のワード演算で判定できる.
+*
+* 座標はTiledMap::Draw()の表示位置と一致する. Offset()にはマップの中心の位置を設定する.
+* Build(const TiledMap&, int)はTiledMapの位置とレイヤーのオフセットから自動的に設定する.
+*
+* タイルの位置は、Layer::At()と同じく左上を(0, 0)とし、yは下に向かって増加する.
+* マップの外側には衝突判定がないものとみなす.
+*/
+class TileCollision
+{
+public:
+  /// 衝突情報.
+  struct Hit
+  {
+    float time; ///< 衝突までの移動量の割合(0～1). 開始時点で重なっていた場合は0.
+    glm::vec2 position; ///< 衝突時の矩形の左下座標、または線分とタイルの交点.
+    glm::vec2 normal; ///< 衝突したタイルの面の法線. 開始時点で重なっていた場合は(0, 0).
+    glm::ivec2 tile; ///< 衝突したタイルの位置.
+  };
+
+  TileCollision() = default;
+  ~TileCollision() = default;
+
+  bool Build(const TiledMap& map, int layerNo);
+  void Build(const TiledMap::Layer& layer, const glm::vec2& tileSize, const std::function<bool(uint32_t)>& isSolid);
+  void Offset(const glm::vec2& v) { offset = v; }
+  const glm::vec2& Offset() const { return offset; }
+  const glm::ivec2& Size() const { return size; }
+
+  void Set(int y, int x, bool solid);
+  bool IsSolid(int y, int x) const;
+  bool Overlap(const Rect& box, glm::ivec2* tile = nullptr) const;
+  bool Sweep(const Rect& box, const glm::vec2& move, Hit& hit) const;
+  bool Raycast(const glm::vec2& start, const glm::vec2& end, Hit& hit) const;
+
+private:
+  void ToTileSpace(const Rect& box, glm::vec2& lo, glm::vec2& hi) const;
+  bool FindInRow(int y, int x0, int x1, int& x) const;
+  bool FindInColumn(int x, int y0, int y1, int& y) const;
+  bool FindInRange(glm::ivec2 tileMin, glm::ivec2 tileMax, glm::ivec2& tile) const;
+
+  std::vector<uint64_t> bits; ///< 衝突判定の有無. 1行はstrideワード.
+  int stride = 0; ///< 1行のワード数.
+  glm::ivec2 size = glm::ivec2(0); ///< 縦横のタイル数.
+  glm::vec2 tileSize = glm::vec2(1); ///< タイルの縦横のピクセル数.
+  glm::vec2 offset = glm::vec2(0); ///< マップの中心の位置.
+};
+
+#endif // TILECOLLISION_H_INCLUDED
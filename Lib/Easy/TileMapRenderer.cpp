@@ -0,0 +1,152 @@
+/**
+* @file TileMapRenderer.cpp
+*/
+#include "TileMapRenderer.h"
+#include "GLState.h"
+#include "RenderBackend.h"
+#include <iostream>
+
+namespace /* unnamed */ {
+
+const GLenum mapUnit = GL_TEXTURE1; ///< マップデータを割り当てるテクスチャ・イメージ・ユニット.
+const GLenum tilesetUnit = GL_TEXTURE0; ///< タイルセットを割り当てるテクスチャ・イメージ・ユニット.
+
+const Shader::NameId mapSamplerId = Shader::MakeNameId("mapSampler");
+const Shader::NameId mapInfoId = Shader::MakeNameId("mapInfo");
+const Shader::NameId tileInfoId = Shader::MakeNameId("tileInfo");
+const Shader::NameId viewInfoId = Shader::MakeNameId("viewInfo");
+const Shader::NameId colorId = Shader::MakeNameId("color");
+
+/**
+* タイルマップ描画用シェーダを取得する.
+*
+* @return タイルマップ描画用シェーダ.
+*
+* シェーダは全てのTileMapRendererで共有され、使用するTileMapRendererがなくなると破棄される.
+*/
+Shader::ProgramPtr GetTileMapProgram()
+{
+  static std::weak_ptr<Shader::Program> cache;
+  Shader::ProgramPtr p = cache.lock();
+  if (!p) {
+    p = Shader::Program::Create("Res/Shader/TileMap.vert", "Res/Shader/TileMap.frag");
+    if (p) {
+      // 整数サンプラーはProgram::Reflectで設定されないので、ここで割り当てる.
+      RenderBackend::Get().ProgramUniform1i(p->Id(), p->UniformLocation(mapSamplerId), mapUnit - GL_TEXTURE0);
+    }
+    cache = p;
+  }
+  return p;
+}
+
+} // unnamed namespace
+
+/**
+* タイルマップ描画オブジェクトを作成する.
+*
+* @param mapSize マップの縦横のタイル数.
+* @param mapData マップデータ. 上の行から順にmapSize.x * mapSize.y個のデータが並んでいること.
+*
+* @return 作成に成功した場合はタイルマップ描画オブジェクトへのポインタを返す.
+*         失敗した場合はnullptrを返す.
+*/
+TileMapRendererPtr TileMapRenderer::Create(const glm::ivec2& mapSize, const uint32_t* mapData)
+{
+  RenderBackend::Backend& backend = RenderBackend::Get();
+  const GLint maxSize = backend.GetInteger(GL_MAX_TEXTURE_SIZE);
+  if (mapSize.x <= 0 || mapSize.y <= 0 || mapSize.x > maxSize || mapSize.y > maxSize) {
+    std::cerr << "WARNING: マップの大きさ(" << mapSize.x << "x" << mapSize.y << ")がテクスチャの上限を超えています." << std::endl;
+    return {};
+  }
+
+  struct Impl : TileMapRenderer { Impl() {} ~Impl() {} };
+  TileMapRendererPtr p = std::make_shared<Impl>();
+  p->program = GetTileMapProgram();
+  if (!p->program) {
+    return {};
+  }
+  p->mapSize = mapSize;
+
+  p->texMap = backend.CreateTexture();
+  GLState::BindTexture(mapUnit, GL_TEXTURE_2D, p->texMap);
+  backend.TexImage2D(GL_TEXTURE_2D, 0, GL_R32UI, mapSize.x, mapSize.y, GL_RED_INTEGER, GL_UNSIGNED_INT, mapData);
+  const GLenum result = backend.GetError();
+  if (result != GL_NO_ERROR) {
+    std::cerr << "ERROR: マップテクスチャの作成に失敗: 0x" << std::hex << result << std::endl;
+    return {};
+  }
+  // 整数テクスチャは線形補間できない.
+  backend.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+  backend.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  backend.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  backend.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  backend.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+  // 頂点座標は頂点シェーダがgl_VertexIDから作るので、VAOにはIBOだけを関連付ける.
+  static const GLushort indices[] = { 0, 1, 3, 3, 2, 0 };
+  p->ibo.Init(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+  p->vao.Init(0, p->ibo.Id());
+  return p;
+}
+
+/**
+* デストラクタ.
+*/
+TileMapRenderer::~TileMapRenderer()
+{
+  if (texMap) {
+    GLState::DeleteTexture(texMap);
+  }
+}
+
+/**
+* マップデータの一部を更新する.
+*
+* @param origin 更新する範囲の左上のタイル位置.
+* @param size   更新する範囲の縦横のタイル数.
+* @param data   更新する範囲のマップデータ. 上の行から順にsize.x * size.y個のデータが並んでいること.
+*/
+void TileMapRenderer::Update(const glm::ivec2& origin, const glm::ivec2& size, const uint32_t* data)
+{
+  if (size.x <= 0 || size.y <= 0) {
+    return;
+  }
+  GLState::BindTexture(mapUnit, GL_TEXTURE_2D, texMap);
+  RenderBackend::Get().TexSubImage2D(GL_TEXTURE_2D, 0, origin.x, origin.y, size.x, size.y, GL_RED_INTEGER, GL_UNSIGNED_INT, data);
+}
+
+/**
+* タイルマップを描画する.
+*
+* @param tileset    タイルセットのテクスチャ.
+* @param tileSize   タイルの縦横のピクセル数.
+* @param columns    タイルセットの横のタイル数.
+* @param firstId    タイルセットの最初のタイルのID.
+* @param offset     マップの中心の表示位置.
+* @param screenSize 画面の大きさ.
+* @param opacity    不透明度.
+*/
+void TileMapRenderer::Draw(const Texture& tileset, const glm::ivec2& tileSize, int columns, int firstId,
+  const glm::vec2& offset, const glm::vec2& screenSize, float opacity) const
+{
+  RenderBackend::Backend& backend = RenderBackend::Get();
+  const GLuint id = program->Id();
+  const GLint mapInfo[4] = { mapSize.x, mapSize.y, columns, firstId };
+  // テクスチャアトラスに含まれる場合も考慮して、タイルセットの左上の位置を渡す.
+  const GLint tileInfo[4] = { tileSize.x, tileSize.y, tileset.OffsetX(), tileset.OffsetY() + tileset.Height() };
+  const GLfloat viewInfo[4] = { offset.x, offset.y, screenSize.x, screenSize.y };
+  const GLfloat color[4] = { 1, 1, 1, opacity };
+  backend.ProgramUniform4iv(id, program->UniformLocation(mapInfoId), mapInfo);
+  backend.ProgramUniform4iv(id, program->UniformLocation(tileInfoId), tileInfo);
+  backend.ProgramUniform4fv(id, program->UniformLocation(viewInfoId), viewInfo);
+  backend.ProgramUniform4fv(id, program->UniformLocation(colorId), color);
+
+  GLState::Disable(GL_DEPTH_TEST);
+  GLState::Enable(GL_BLEND);
+  GLState::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  program->UseProgram();
+  GLState::BindTexture(tilesetUnit, GL_TEXTURE_2D, tileset.Id());
+  GLState::BindTexture(mapUnit, GL_TEXTURE_2D, texMap);
+  vao.Bind();
+  backend.DrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, 0);
+}
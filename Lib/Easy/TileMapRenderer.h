@@ -0,0 +1,49 @@
+/**
+* @file TileMapRenderer.h
+*/
+#ifndef TILEMAPRENDERER_H_INCLUDED
+#define TILEMAPRENDERER_H_INCLUDED
+#include <GL/glew.h>
+#include "BufferObject.h"
+#include "Shader.h"
+#include "Texture.h"
+#include <glm/glm.hpp>
+#include <memory>
+#include <stdint.h>
+
+class TileMapRenderer;
+typedef std::shared_ptr<TileMapRenderer> TileMapRendererPtr; ///< タイルマップ描画オブジェクトポインタ型.
+
+/**
+* タイル番号を格納したテクスチャを使ってタイルマップを描画するクラス.
+*
+* マップデータ(反転・回転フラグを含む)を32bit整数テクスチャにそのまま格納し、
+* 画面全体を覆う四角形を1枚描画する. フラグメントシェーダがピクセルごとにタイル番号を読み出し、
+* タイルセットから色を取得する.
+* そのため、CPUの処理量と頂点データの量はマップの大きさに関係なく一定で、
+* スクロールはuniform変数の変更だけで済む.
+*/
+class TileMapRenderer
+{
+public:
+  static TileMapRendererPtr Create(const glm::ivec2& mapSize, const uint32_t* mapData);
+
+  void Update(const glm::ivec2& origin, const glm::ivec2& size, const uint32_t* data);
+  void Draw(const Texture& tileset, const glm::ivec2& tileSize, int columns, int firstId,
+    const glm::vec2& offset, const glm::vec2& screenSize, float opacity) const;
+  const glm::ivec2& MapSize() const { return mapSize; }
+
+private:
+  TileMapRenderer() = default;
+  ~TileMapRenderer();
+  TileMapRenderer(const TileMapRenderer&) = delete;
+  TileMapRenderer& operator=(const TileMapRenderer&) = delete;
+
+  GLuint texMap = 0; ///< マップデータを格納した整数テクスチャ.
+  BufferObject ibo;
+  VertexArrayObject vao;
+  Shader::ProgramPtr program; ///< 描画用シェーダ(全てのTileMapRendererで共有).
+  glm::ivec2 mapSize; ///< マップの縦横のタイル数.
+};
+
+#endif // TILEMAPRENDERER_H_INCLUDED
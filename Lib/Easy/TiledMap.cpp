@@ -2,11 +2,15 @@
 * @file TiledMap.cpp
 */
 #include "TiledMap.h"
-#include "Json.h"
+#include "JsonBind.h"
+#include "Base64.h"
+#include "Inflate.h"
 #include <glm/gtc/constants.hpp>
-#include <sys/stat.h>
 #include <algorithm>
+#include <map>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <windows.h>
 
 #define LOG(str, ...) { \
@@ -16,202 +20,1849 @@
   OutputDebugString(buf); \
 } (void)0
 
+const int TiledMap::chunkSize;
+
+namespace /* unnamed */ {
+
+/**
+* バイナリ形式のマップファイルの構造.
+*
+* ファイルはBinaryHeader, BinaryLayer×layerCount, BinaryTileset×tilesetCount,
+* 文字列データ, 衝突判定を持つタイル番号の配列, 各レイヤーのマップデータの順に並ぶ.
+* マップデータはbinaryDataAlignmentバイト境界に配置され、メモリに割り当てたファイルを
+* そのままLayer::mapDataとして使用できる. 数値は全てリトルエンディアン.
+*/
+const char binaryMagic[4] = { 'T', 'M', 'A', 'P' }; ///< バイナリ形式を識別する値.
+const uint32_t binaryVersion = 2; ///< バイナリ形式のバージョン.
+const size_t binaryDataAlignment = 16; ///< マップデータの配置境界.
+
+/// ファイルヘッダ.
+struct BinaryHeader
+{
+  char magic[4]; ///< binaryMagic.
+  uint32_t version; ///< binaryVersion.
+  uint32_t layerCount; ///< レイヤー数.
+  uint32_t tilesetCount; ///< タイルセット数.
+};
+static_assert(sizeof(BinaryHeader) == 16, "BinaryHeaderの大きさが想定と異なります");
+
+/// レイヤー情報.
+struct BinaryLayer
+{
+  int32_t width; ///< 横のタイル数.
+  int32_t height; ///< 縦のタイル数.
+  float offsetX; ///< 表示位置のX方向のオフセット.
+  float offsetY; ///< 表示位置のY方向のオフセット.
+  float opacity; ///< 不透明度.
+  uint32_t visible; ///< 1=表示する. 0=表示しない.
+  int32_t tilesetNo; ///< 対応するタイルセットのインデックス.
+  uint32_t reserved; ///< 未使用(0).
+  uint64_t dataOffset; ///< ファイル先頭からマップデータまでのバイト数.
+};
+static_assert(sizeof(BinaryLayer) == 40, "BinaryLayerの大きさが想定と異なります");
+
+/// タイルセット情報.
+struct BinaryTileset
+{
+  float tileWidth; ///< タイルの横のピクセル数.
+  float tileHeight; ///< タイルの縦のピクセル数.
+  int32_t columns; ///< 横のタイル数.
+  int32_t firstId; ///< 最初のタイルのID.
+  uint32_t imageOffset; ///< ファイル先頭から画像ファイル名までのバイト数.
+  uint32_t imageLength; ///< 画像ファイル名のバイト数(終端文字を含まない).
+  uint32_t solidOffset; ///< ファイル先頭から衝突判定を持つタイル番号の配列までのバイト数.
+  uint32_t solidCount; ///< 衝突判定を持つタイルの数.
+};
+static_assert(sizeof(BinaryTileset) == 32, "BinaryTilesetの大きさが想定と異なります");
+
+/**
+* バイナリ形式のファイルかどうかを調べる.
+*
+* @param file 調べるファイル.
+*
+* @retval true  バイナリ形式.
+* @retval false バイナリ形式ではない.
+*/
+bool IsBinary(const MappedFile& file)
+{
+  return file.Size() >= sizeof(BinaryHeader) && memcmp(file.Data(), binaryMagic, sizeof(binaryMagic)) == 0;
+}
+
+/**
+* タイルに衝突判定があることを記録する.
+*
+* @param solid タイルごとの衝突判定の有無.
+* @param id    タイルセット内のタイル番号.
+*/
+void SetSolid(std::vector<bool>& solid, int id)
+{
+  if (id < 0) {
+    return;
+  }
+  if (static_cast<size_t>(id) >= solid.size()) {
+    solid.resize(id + 1);
+  }
+  solid[id] = true;
+}
+
+/**
+* 無限マップのレイヤーで、Stream()の範囲に含まれる描画用チャンクの範囲を取得する.
+*
+* @param layer    無限マップのレイヤー.
+* @param minChunk 範囲の左上のチャンク位置を格納する変数.
+* @param maxChunk 範囲の右下のチャンク位置を格納する変数(範囲に含む).
+*
+* @retval true  範囲を取得した.
+* @retval false 範囲が空.
+*/
+bool GetStreamChunkRange(const TiledMap::Layer& layer, glm::ivec2& minChunk, glm::ivec2& maxChunk)
+{
+  const glm::ivec2 windowMin = layer.stream->WindowMin();
+  const glm::ivec2 windowMax = glm::min(layer.stream->WindowMax(), layer.size - 1);
+  if (windowMax.x < windowMin.x || windowMax.y < windowMin.y) {
+    return false;
+  }
+  minChunk = windowMin / TiledMap::chunkSize;
+  maxChunk = windowMax / TiledMap::chunkSize;
+  return true;
+}
+
+/**
+* 整数配列のマップデータを展開するクラス.
+*/
+class TileArrayHandler : public Json::Handler
+{
+public:
+  TileArrayHandler(uint32_t* p, size_t n) : out(p), count(n) {}
+  bool OnStartObject() override { return false; }
+  bool OnStartArray() override { return ++depth == 1; }
+  bool OnEndArray() override { --depth; return true; }
+  bool OnString(const Json::StringRef&) override { return false; }
+  bool OnNumber(Json::Number n) override { return OnInteger(static_cast<int64_t>(n)); }
+  bool OnBoolean(Json::Boolean) override { return false; }
+  bool OnNull() override { return false; }
+
+  /// 要素をoutに格納する. count個を超えた要素は無視する.
+  bool OnInteger(int64_t n) override {
+    if (depth != 1) {
+      return false;
+    }
+    if (written < count) {
+      out[written++] = static_cast<uint32_t>(n);
+    }
+    return true;
+  }
+
+  size_t Written() const { return written; }
+
+private:
+  uint32_t* out; ///< マップデータの格納先.
+  size_t count; ///< outに格納できるタイル数.
+  size_t written = 0; ///< outに格納したタイル数.
+  int depth = 0; ///< 配列の深さ.
+};
+
+/**
+* マップデータを展開する.
+*
+* @param begin       "data"の値の先頭.
+* @param end         "data"の値の終端.
+* @param encoding    マップデータの形式("csv"または"base64"). 空なら"csv".
+* @param compression マップデータの圧縮形式("zlib"または"gzip"). 空なら非圧縮.
+* @param out         展開したマップデータの格納先.
+* @param count       outに格納するタイル数.
+*
+* @retval true  展開成功.
+* @retval false データに不備があるか、対応していない形式.
+*
+* どちらの形式もタイルごとにJSONの値を作らず、outに直接展開する.
+* base64形式のタイルはリトルエンディアンの32ビット整数で、outもリトルエンディアンであることを前提とする.
+*/
+bool DecodeTileData(const char* begin, const char* end, const std::string& encoding, const std::string& compression,
+  uint32_t* out, size_t count)
+{
+  if (encoding.empty() || encoding == "csv") {
+    TileArrayHandler handler(out, count);
+    Json::Reader reader(handler);
+    if (!reader.Feed(begin, end - begin) || !reader.Finish()) {
+      return false;
+    }
+    std::fill(out + handler.Written(), out + count, 0);
+    return true;
+  }
+  if (encoding != "base64" || end - begin < 2 || *begin != '"' || end[-1] != '"') {
+    return false;
+  }
+  const char* const src = begin + 1;
+  const size_t srcSize = end - begin - 2;
+  uint8_t* const dst = reinterpret_cast<uint8_t*>(out);
+  const size_t dstSize = count * sizeof(uint32_t);
+  size_t written;
+  if (compression.empty()) {
+    return Base64::Decode(src, srcSize, dst, dstSize, written) && written == dstSize;
+  }
+  Inflate::Format format;
+  if (compression == "zlib") {
+    format = Inflate::Format_Zlib;
+  } else if (compression == "gzip") {
+    format = Inflate::Format_Gzip;
+  } else {
+    return false;
+  }
+  std::vector<uint8_t> buffer(Base64::DecodedSize(src, srcSize));
+  if (!Base64::Decode(src, srcSize, buffer.data(), buffer.size(), written)) {
+    return false;
+  }
+  return Inflate::Decompress(format, buffer.data(), written, dst, dstSize, written) && written == dstSize;
+}
+
+/**
+* タイルのカスタムプロパティの値.
+*
+* 衝突判定には真偽値のtrueだけを使うので、他の型の値は受け取っても記録しない.
+*/
+struct PropertyValue
+{
+  bool isTrue = false; ///< 真偽値のtrueだった.
+};
+
+struct TileProperties;
+struct TileList;
+
+} // unnamed namespace
+
+namespace Json {
+
+/// PropertyValueに任意の値を書き込む.
+template<>
+struct Binding<PropertyValue>
+{
+  static const TypeBinding& Get();
+};
+
+/// TilePropertiesにオブジェクト形式と配列形式のプロパティを書き込む.
+template<>
+struct Binding<TileProperties>
+{
+  static const TypeBinding& Get();
+};
+
+/// TileListに配列形式のタイルを書き込む.
+template<>
+struct Binding<TileList>
+{
+  static const TypeBinding& Get();
+};
+
+} // namespace Json
+
+namespace /* unnamed */ {
+
+/**
+* Tiled 1.2以降の配列形式のカスタムプロパティ.
+*/
+struct Property
+{
+  std::string name; ///< "name".
+  PropertyValue value; ///< "value".
+
+  JSON_FIELDS(Property,
+    JSON_REQUIRED(name, "name"),
+    JSON_OPTIONAL(value, "value"));
+};
+
+/**
+* タイルのカスタムプロパティ.
+*
+* Tiled 1.1以前のオブジェクト形式と、1.2以降の配列形式のどちらも受け付ける.
+*/
+struct TileProperties
+{
+  PropertyValue solid; ///< オブジェクト形式の"solid".
+  std::vector<Property> list; ///< 配列形式のプロパティ.
+
+  JSON_FIELDS(TileProperties,
+    JSON_OPTIONAL(solid, "solid"));
+
+  /**
+  * プロパティ"solid"がtrueかどうかを調べる.
+  *
+  * @retval true  "solid"がtrue.
+  * @retval false "solid"がないか、falseまたは真偽値以外.
+  */
+  bool IsSolid() const {
+    if (solid.isTrue) {
+      return true;
+    }
+    const auto itr = std::find_if(list.begin(), list.end(), [](const Property& e) { return e.name == "solid"; });
+    return itr != list.end() && itr->value.isTrue;
+  }
+};
+
+/**
+* Tiled 1.2以降の"tiles"の要素.
+*/
+struct Tile
+{
+  int id = -1; ///< "id". タイルセット内のタイル番号.
+  TileProperties properties; ///< "properties".
+
+  JSON_FIELDS(Tile,
+    JSON_REQUIRED(id, "id"),
+    JSON_OPTIONAL(properties, "properties"));
+};
+
+/**
+* タイルセットの"tiles".
+*
+* Tiled 1.2以降はTileの配列. 1.1以前はタイル番号をキーとするオブジェクトだが、
+* 衝突判定は"tileproperties"にあるので、オブジェクトの場合は読み飛ばす.
+*/
+struct TileList
+{
+  std::vector<Tile> list; ///< 配列形式のタイル.
+};
+
+} // unnamed namespace
+
+/**
+* Tiled Map EditorのJSONファイルのタイルセット.
+*
+* JsonHandlerが"tilesets"の要素を値を作らずに直接書き込み、LoadTileSets()でTileSetに変換する.
+*/
+struct TiledMap::JsonTileSet
+{
+  float tileWidth = 0; ///< "tilewidth".
+  float tileHeight = 0; ///< "tileheight".
+  int columns = 0; ///< "columns".
+  int firstId = 0; ///< "firstgid".
+  std::string image; ///< "image".
+  TileList tiles; ///< "tiles".
+  std::map<std::string, TileProperties> tileProperties; ///< "tileproperties". Tiled 1.1以前の形式.
+
+  JSON_FIELDS(JsonTileSet,
+    JSON_REQUIRED(tileWidth, "tilewidth"),
+    JSON_REQUIRED(tileHeight, "tileheight"),
+    JSON_REQUIRED(columns, "columns"),
+    JSON_REQUIRED(firstId, "firstgid"),
+    JSON_REQUIRED(image, "image"),
+    JSON_OPTIONAL(tiles, "tiles"),
+    JSON_OPTIONAL(tileProperties, "tileproperties"));
+};
+
+/**
+* PropertyValueの書き込み方法を取得する.
+*
+* 真偽値以外の値も受け付けるが、記録するのは真偽値だけ.
+*/
+const Json::TypeBinding& Json::Binding<PropertyValue>::Get()
+{
+  static const TypeBinding binding = {
+    "プロパティの値",
+    [](void*, const StringRef&) { return true; },
+    [](void*, Number) { return true; },
+    nullptr,
+    [](void* target, Boolean b) { static_cast<PropertyValue*>(target)->isTrue = b; return true; },
+    [](void*) { return true; },
+    nullptr, 0, nullptr, nullptr, nullptr
+  };
+  return binding;
+}
+
+/**
+* TilePropertiesの書き込み方法を取得する.
+*
+* オブジェクトはJSON_FIELDSに従ってメンバに書き込み、配列の要素はlistに追加する.
+*/
+const Json::TypeBinding& Json::Binding<TileProperties>::Get()
+{
+  static const FieldList fields = TileProperties::JsonFields();
+  static const TypeBinding binding = {
+    fields.name, nullptr, nullptr, nullptr, nullptr, nullptr, fields.fields, fields.count, nullptr,
+    [](void* target) { return Binding<std::vector<Property>>::AddElement(&static_cast<TileProperties*>(target)->list); },
+    &Binding<Property>::Get
+  };
+  return binding;
+}
+
+/**
+* TileListの書き込み方法を取得する.
+*
+* 配列の要素はlistに追加し、オブジェクトのメンバは読み飛ばす.
+*/
+const Json::TypeBinding& Json::Binding<TileList>::Get()
+{
+  static const TypeBinding binding = {
+    "TileList", nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, 0,
+    [](void*, const StringRef&) -> void* { return nullptr; },
+    [](void* target) { return Binding<std::vector<Tile>>::AddElement(&static_cast<TileList*>(target)->list); },
+    &Binding<Tile>::Get
+  };
+  return binding;
+}
+
+/**
+* マップファイルを読み込む.
+*
+* @param filename マップファイルのパス. Tiled Map EditorのJSONファイルか、Save()で作成したバイナリファイル.
+* @param drawable 描画データの作成を制御するビット.
+*                 0なら作成しない、1なら作成する.
+*                 第0bitが0番レイヤーに、第31bitが31番レイヤーに対応する.
+*                 ファイルに存在しないレイヤーのビットは無視される.
+*
+* @retval true  読み込み成功.
+* @retval false 読み込み失敗.
+*
+* 形式はファイルの先頭で判別する.
+* バイナリファイルはメモリに割り当てたまま使用するため、マップデータのコピーは行われない.
+*/
+bool TiledMap::Load(const char* filename, uint32_t drawable)
+{
+  Unload();
+  MappedFilePtr file = MappedFile::Open(filename);
+  if (!file) {
+    LOG("ERROR: %sを開けません.\n", filename);
+    return false;
+  }
+  if (IsBinary(*file)) {
+    if (!LoadBinary(file, filename)) {
+      Unload();
+      return false;
+    }
+  } else if (!LoadJson(file, filename)) {
+    Unload();
+    return false;
+  }
+
+  // テクスチャを読み込む.
+  for (auto& e : tilesets) {
+    const std::string texFilename = std::string("Res/") + e.imageFilename;
+    e.image = Texture::LoadAndCache(texFilename.c_str());
+    if (!e.image) {
+      LOG("WARNING: %sを読み込めません.\n", texFilename.c_str());
+    }
+  }
+
+  // 描画用のチャンクを準備.
+  for (auto& e : layers) {
+    e.drawable = drawable & 1;
+    drawable >>= 1;
+    e.dirty = true;
+    e.drawMode = DrawMode_Sprite;
+    e.chunkCount = (e.size + (chunkSize - 1)) / chunkSize;
+    e.chunks.resize(e.chunkCount.x * e.chunkCount.y);
+  }
+
+  Update(); // 描画データを作成.
+
+  return true;
+}
+
+/**
+* Tiled Map EditorのJSONファイルを解析し、レイヤーとタイルセットをTiledMapに格納するクラス.
+*
+* JSONの値を作らずにJson::Readerの通知を処理する.
+* 整数配列のマップデータはLayer::mapDataStorageに直接格納し、Base64のマップデータも直接デコードする.
+* 無限マップのチャンクはマップデータを展開せず、ファイル内の位置だけを記録する.
+* "tilesets"はJson::BinderでJsonTileSetに直接書き込み、解析後にLoadTileSets()で読み込む.
+*/
+class TiledMap::JsonHandler : public Json::Handler
+{
+public:
+  JsonHandler(TiledMap& m, const char* f) : map(m), filename(f), reader(*this), tileset(tilesetList, "tilesets") {}
+  bool Parse(const char* data, size_t size);
+  const std::vector<JsonTileSet>& TileSets() const { return tilesetList; }
+  bool HasStream() const { return hasStream; }
+
+  bool OnStartObject() override { return StartContainer(true); }
+  bool OnEndObject() override { return EndContainer(true); }
+  bool OnStartArray() override { return StartContainer(false); }
+  bool OnEndArray() override { return EndContainer(false); }
+  bool OnKey(const Json::StringRef&) override;
+  bool OnString(const Json::StringRef&) override;
+  bool OnNumber(Json::Number) override;
+  bool OnInteger(int64_t) override;
+  bool OnBoolean(Json::Boolean) override;
+  bool OnNull() override;
+
+private:
+  /// 解析中のオブジェクトまたは配列.
+  enum Context {
+    Context_None, ///< ルートの外.
+    Context_Root, ///< ルートのオブジェクト.
+    Context_Layers, ///< "layers"配列.
+    Context_Layer, ///< レイヤーのオブジェクト.
+    Context_LayerData, ///< レイヤーの"data"配列.
+    Context_Chunks, ///< "chunks"配列.
+    Context_Chunk, ///< チャンクのオブジェクト.
+    Context_ChunkData, ///< チャンクの"data"配列.
+  };
+
+  Context Current() const { return contexts.empty() ? Context_None : contexts.back(); }
+  bool StartContainer(bool isObject);
+  bool EndContainer(bool isObject);
+  void BeginLayer();
+  bool EndLayer();
+  bool EndChunk();
+  bool DecodeBase64(const Json::StringRef&);
+
+  TiledMap& map; ///< 読み込み先.
+  const char* filename; ///< マップファイルのパス(エラー表示用).
+  const char* fileBegin = nullptr; ///< JSONデータの先頭.
+  Json::Reader reader; ///< JSONデータを解析するReader.
+  std::vector<Context> contexts; ///< 解析中のオブジェクトと配列.
+  int skipDepth = 0; ///< 読み飛ばしている値の深さ. 0なら読み飛ばしていない.
+  int tilesetDepth = 0; ///< 書き込み中の"tilesets"の深さ. 0なら書き込んでいない.
+  std::vector<JsonTileSet> tilesetList; ///< 読み込んだタイルセット.
+  Json::Binder tileset; ///< tilesetListにタイルセットを書き込むBinder.
+  std::string key; ///< 直前のキー.
+  bool hasLayers = false; ///< "layers"があった.
+  bool hasTileSets = false; ///< "tilesets"があった.
+  bool hasStream = false; ///< 無限マップのレイヤーがあった.
+
+  // 解析中のレイヤー.
+  std::string type; ///< "type".
+  std::string encoding; ///< "encoding".
+  std::string compression; ///< "compression".
+  glm::ivec2 start; ///< "startx", "starty".
+  bool hasData; ///< "data"があった.
+  bool isBase64; ///< "data"が文字列だった.
+  size_t dataBytes; ///< "data"をデコードしたバイト数.
+
+  // 解析中のチャンク.
+  glm::ivec2 chunkPosition; ///< "x", "y".
+  glm::ivec2 chunkTileCount; ///< "width", "height".
+};
+
+/**
+* JSONデータを解析する.
+*
+* @param data JSONデータ.
+* @param size dataのバイト数.
+*
+* @retval true  解析成功.
+* @retval false 解析失敗.
+*
+* 無限マップのチャンクはdataの中の位置を記録するので、dataはTiledMapが破棄されるまで保持すること.
+*/
+bool TiledMap::JsonHandler::Parse(const char* data, size_t size)
+{
+  fileBegin = data;
+  if (!reader.Feed(data, size) || !reader.Finish()) {
+    LOG("ERROR: %sを解析できません.\n%s%s", filename, tileset.Error().c_str(), reader.Error().c_str());
+    return false;
+  }
+  if (!hasLayers || !hasTileSets) {
+    LOG("ERROR: %sはデータに不備があるか、JSONファイルではありません.\n", filename);
+    return false;
+  }
+  return true;
+}
+
+/**
+* オブジェクトまたは配列の開始を処理する.
+*
+* @param isObject true=オブジェクト. false=配列.
+*
+* @retval true  処理成功.
+* @retval false データに不備がある.
+*/
+bool TiledMap::JsonHandler::StartContainer(bool isObject)
+{
+  if (skipDepth) {
+    ++skipDepth;
+    return true;
+  }
+  if (tilesetDepth) {
+    ++tilesetDepth;
+    return isObject ? tileset.OnStartObject() : tileset.OnStartArray();
+  }
+  switch (Current()) {
+  case Context_None:
+    if (isObject) {
+      contexts.push_back(Context_Root);
+      return true;
+    }
+    return false;
+  case Context_Root:
+    if (!isObject && key == "layers") {
+      hasLayers = true;
+      contexts.push_back(Context_Layers);
+      return true;
+    } else if (!isObject && key == "tilesets") {
+      hasTileSets = true;
+      tilesetDepth = 1;
+      return tileset.OnStartArray();
+    }
+    break;
+  case Context_Layers:
+    if (isObject) {
+      BeginLayer();
+      contexts.push_back(Context_Layer);
+      return true;
+    }
+    break;
+  case Context_Layer:
+    if (!isObject && key == "data") {
+      hasData = true;
+      contexts.push_back(Context_LayerData);
+      return true;
+    } else if (!isObject && key == "chunks") {
+      map.layers.back().stream = std::make_unique<LayerStream>();
+      contexts.push_back(Context_Chunks);
+      return true;
+    }
+    break;
+  case Context_Chunks:
+    if (isObject) {
+      map.layers.back().stream->chunks.emplace_back();
+      chunkPosition = glm::ivec2(0);
+      chunkTileCount = glm::ivec2(0);
+      contexts.push_back(Context_Chunk);
+      return true;
+    }
+    break;
+  case Context_Chunk:
+    if (!isObject && key == "data") {
+      map.layers.back().stream->chunks.back().dataBegin = fileBegin + reader.TokenBegin();
+      contexts.push_back(Context_ChunkData);
+      return true;
+    }
+    break;
+  default:
+    break;
+  }
+  skipDepth = 1; // 使わない値は読み飛ばす.
+  return true;
+}
+
+/**
+* オブジェクトまたは配列の終了を処理する.
+*
+* @param isObject true=オブジェクト. false=配列.
+*
+* @retval true  処理成功.
+* @retval false データに不備がある.
+*/
+bool TiledMap::JsonHandler::EndContainer(bool isObject)
+{
+  if (skipDepth) {
+    --skipDepth;
+    return true;
+  }
+  if (tilesetDepth) {
+    if (!(isObject ? tileset.OnEndObject() : tileset.OnEndArray())) {
+      return false;
+    }
+    --tilesetDepth;
+    return true;
+  }
+  const Context context = Current();
+  contexts.pop_back();
+  switch (context) {
+  case Context_Layer:
+    return EndLayer();
+  case Context_Chunk:
+    return EndChunk();
+  case Context_ChunkData:
+    map.layers.back().stream->chunks.back().dataEnd = fileBegin + reader.TokenEnd();
+    return true;
+  default:
+    return true;
+  }
+}
+
+/**
+* キーを処理する.
+*/
+bool TiledMap::JsonHandler::OnKey(const Json::StringRef& k)
+{
+  if (skipDepth) {
+    return true;
+  }
+  if (tilesetDepth) {
+    return tileset.OnKey(k);
+  }
+  key.assign(k.data, k.size);
+  return true;
+}
+
+/**
+* 文字列を処理する.
+*/
+bool TiledMap::JsonHandler::OnString(const Json::StringRef& s)
+{
+  if (skipDepth) {
+    return true;
+  }
+  if (tilesetDepth) {
+    return tileset.OnString(s);
+  }
+  switch (Current()) {
+  case Context_Layer:
+    if (key == "type") {
+      type.assign(s.data, s.size);
+    } else if (key == "encoding") {
+      encoding.assign(s.data, s.size);
+    } else if (key == "compression") {
+      compression.assign(s.data, s.size);
+    } else if (key == "data") {
+      return DecodeBase64(s);
+    }
+    break;
+  case Context_Chunk:
+    if (key == "data") {
+      LayerStream::Chunk& chunk = map.layers.back().stream->chunks.back();
+      chunk.dataBegin = fileBegin + reader.TokenBegin();
+      chunk.dataEnd = fileBegin + reader.TokenEnd();
+    }
+    break;
+  default:
+    break;
+  }
+  return true;
+}
+
+/**
+* 整数を処理する.
+*
+* マップデータの要素はstrtodを通さずに、そのままLayer::mapDataStorageに追加する.
+*/
+bool TiledMap::JsonHandler::OnInteger(int64_t n)
+{
+  if (!skipDepth && tilesetDepth) {
+    return tileset.OnInteger(n);
+  }
+  if (!skipDepth && Current() == Context_LayerData) {
+    map.layers.back().mapDataStorage.push_back(static_cast<uint32_t>(n));
+    return true;
+  }
+  return OnNumber(static_cast<Json::Number>(n));
+}
+
+/**
+* 数値を処理する.
+*/
+bool TiledMap::JsonHandler::OnNumber(Json::Number n)
+{
+  if (skipDepth) {
+    return true;
+  }
+  if (tilesetDepth) {
+    return tileset.OnNumber(n);
+  }
+  switch (Current()) {
+  case Context_Layer: {
+    Layer& layer = map.layers.back();
+    if (key == "width") {
+      layer.size.x = static_cast<int>(n);
+    } else if (key == "height") {
+      layer.size.y = static_cast<int>(n);
+    } else if (key == "offsetx") {
+      layer.baseOffset.x = static_cast<float>(n);
+    } else if (key == "offsety") {
+      layer.baseOffset.y = static_cast<float>(n);
+    } else if (key == "opacity") {
+      layer.opacity = static_cast<float>(n);
+    } else if (key == "startx") {
+      start.x = static_cast<int>(n);
+    } else if (key == "starty") {
+      start.y = static_cast<int>(n);
+    }
+    break;
+  }
+  case Context_LayerData:
+    map.layers.back().mapDataStorage.push_back(static_cast<uint32_t>(n));
+    break;
+  case Context_Chunk:
+    if (key == "x") {
+      chunkPosition.x = static_cast<int>(n);
+    } else if (key == "y") {
+      chunkPosition.y = static_cast<int>(n);
+    } else if (key == "width") {
+      chunkTileCount.x = static_cast<int>(n);
+    } else if (key == "height") {
+      chunkTileCount.y = static_cast<int>(n);
+    }
+    break;
+  default:
+    break;
+  }
+  return true;
+}
+
+/**
+* 真偽値を処理する.
+*/
+bool TiledMap::JsonHandler::OnBoolean(Json::Boolean b)
+{
+  if (skipDepth) {
+    return true;
+  }
+  if (tilesetDepth) {
+    return tileset.OnBoolean(b);
+  }
+  if (Current() == Context_Layer && key == "visible") {
+    map.layers.back().visible = b;
+  }
+  return true;
+}
+
+/**
+* nullを処理する.
+*/
+bool TiledMap::JsonHandler::OnNull()
+{
+  if (!skipDepth && tilesetDepth) {
+    return tileset.OnNull();
+  }
+  return true;
+}
+
+/**
+* レイヤーの解析を開始する.
+*/
+void TiledMap::JsonHandler::BeginLayer()
+{
+  map.layers.emplace_back();
+  Layer& layer = map.layers.back();
+  layer.opacity = 1;
+  layer.visible = true;
+  type.clear();
+  encoding.clear();
+  compression.clear();
+  start = glm::ivec2(0);
+  hasData = false;
+  isBase64 = false;
+  dataBytes = 0;
+}
+
+/**
+* レイヤーの解析を完了する.
+*
+* @retval true  処理成功.
+* @retval false データに不備がある.
+*
+* タイルレイヤー以外のレイヤーは破棄する.
+* Base64のマップデータはここで圧縮を展開する. "compression"が"data"より後にあってもよい.
+*/
+bool TiledMap::JsonHandler::EndLayer()
+{
+  Layer& layer = map.layers.back();
+  if (type != "tilelayer") {
+    map.layers.pop_back();
+    return true;
+  }
+  if (layer.stream) {
+    layer.stream->encoding = encoding;
+    layer.stream->compression = compression;
+    if (!map.SetupStream(layer, start)) {
+      LOG("ERROR: %sのチャンクに不備があります.\n", filename);
+      return false;
+    }
+    hasStream = true;
+    return true;
+  }
+
+  const size_t count = static_cast<size_t>(std::max(layer.size.x, 0)) * std::max(layer.size.y, 0);
+  std::vector<uint32_t>& storage = layer.mapDataStorage;
+  bool isValid = hasData;
+  if (!isBase64) {
+    isValid = isValid && (encoding.empty() || encoding == "csv");
+    storage.resize(count);
+  } else if (encoding != "base64") {
+    isValid = false;
+  } else if (compression.empty()) {
+    isValid = dataBytes == count * sizeof(uint32_t);
+  } else {
+    Inflate::Format format = Inflate::Format_Zlib;
+    if (compression == "gzip") {
+      format = Inflate::Format_Gzip;
+    } else if (compression != "zlib") {
+      isValid = false;
+    }
+    if (isValid) {
+      std::vector<uint32_t> tmp(count);
+      size_t written;
+      isValid = Inflate::Decompress(format, storage.data(), dataBytes, tmp.data(), count * sizeof(uint32_t), written) &&
+        written == count * sizeof(uint32_t);
+      storage.swap(tmp);
+    }
+  }
+  if (!isValid) {
+    LOG("ERROR: %sのマップデータを読み込めません(encoding=%s, compression=%s).\n", filename, encoding.c_str(), compression.c_str());
+    return false;
+  }
+  layer.mapData = storage.data();
+  return true;
+}
+
+/**
+* チャンクの解析を完了する.
+*
+* @retval true  処理成功.
+* @retval false データに不備がある.
+*
+* チャンクの位置はSetupStream()で"startx", "starty"を反映する.
+*/
+bool TiledMap::JsonHandler::EndChunk()
+{
+  LayerStream& stream = *map.layers.back().stream;
+  // Tiledのチャンクは全て同じ大きさで、大きさの倍数の位置に配置される.
+  if (stream.chunks.size() == 1) {
+    stream.chunkSize = chunkTileCount;
+  }
+  if (chunkTileCount != stream.chunkSize || chunkTileCount.x <= 0 || chunkTileCount.y <= 0) {
+    LOG("ERROR: %sのチャンクに不備があります.\n", filename);
+    return false;
+  }
+  stream.chunks.back().origin = chunkPosition;
+  return true;
+}
+
+/**
+* Base64のマップデータをLayer::mapDataStorageにデコードする.
+*
+* @param s Base64の文字列.
+*
+* @retval true  デコード成功.
+* @retval false デコード失敗.
+*
+* 圧縮されている場合は、圧縮データのままLayer::mapDataStorageに格納される.
+*/
+bool TiledMap::JsonHandler::DecodeBase64(const Json::StringRef& s)
+{
+  std::vector<uint32_t>& storage = map.layers.back().mapDataStorage;
+  storage.resize((Base64::DecodedSize(s.data, s.size) + sizeof(uint32_t) - 1) / sizeof(uint32_t));
+  hasData = true;
+  isBase64 = true;
+  if (!Base64::Decode(s.data, s.size, reinterpret_cast<uint8_t*>(storage.data()), storage.size() * sizeof(uint32_t), dataBytes)) {
+    LOG("ERROR: %sのマップデータがBase64ではありません.\n", filename);
+    return false;
+  }
+  return true;
+}
+
+/**
+* JSON形式のマップデータを読み込む.
+*
+* @param file     マップファイル.
+* @param filename マップファイルのパス(エラー表示用).
+*
+* @retval true  読み込み成功.
+* @retval false 読み込み失敗.
+*
+* ファイル全体をJsonHandlerで解析し、マップデータはJSONの値を作らずに直接Layer::mapDataに展開する.
+* 無限マップの場合、チャンクのマップデータは位置だけを記録し、fileはTiledMapが破棄されるまで保持される.
+*/
+bool TiledMap::LoadJson(const MappedFilePtr& file, const char* filename)
+{
+  JsonHandler handler(*this, filename);
+  if (!handler.Parse(reinterpret_cast<const char*>(file->Data()), file->Size())) {
+    return false;
+  }
+  if (handler.HasStream()) {
+    mappedFile = file;
+  }
+  LoadTileSets(handler.TileSets());
+
+  // レイヤーで使われているタイルから、対応するタイルセットを決める.
+  for (auto& e : layers) {
+    if (e.stream) {
+      SelectTileSet(e, e.stream->FindFirstTile());
+      continue;
+    }
+    const uint32_t* const first = e.mapData;
+    const uint32_t* const last = first + e.mapDataStorage.size();
+    const uint32_t* const itr = std::find_if(first, last, [](uint32_t id) { return id != 0; });
+    SelectTileSet(e, itr != last ? *itr : 0);
+  }
+  return true;
+}
+
+/**
+* 無限マップのチャンクの配置を確定する.
+*
+* @param layer 確定するレイヤー. size, streamを設定しておくこと.
+* @param start レイヤーの位置(0, 0)に対応するタイル位置("startx", "starty").
+*
+* @retval true  確定成功.
+* @retval false チャンクの位置がレイヤーの範囲外か、チャンクの大きさの倍数でない.
+*/
+bool TiledMap::SetupStream(Layer& layer, const glm::ivec2& start)
+{
+  LayerStream& stream = *layer.stream;
+  for (auto& chunk : stream.chunks) {
+    chunk.origin -= start;
+    if (chunk.origin.x < 0 || chunk.origin.y < 0 || chunk.origin.x % stream.chunkSize.x || chunk.origin.y % stream.chunkSize.y ||
+      chunk.origin.x >= layer.size.x || chunk.origin.y >= layer.size.y) {
+      return false;
+    }
+  }
+  stream.gridCount = (layer.size + stream.chunkSize - 1) / stream.chunkSize;
+  stream.grid.assign(stream.gridCount.x * stream.gridCount.y, -1);
+  for (size_t i = 0; i < stream.chunks.size(); ++i) {
+    const glm::ivec2 cell = stream.chunks[i].origin / stream.chunkSize;
+    stream.grid[cell.y * stream.gridCount.x + cell.x] = static_cast<int>(i);
+  }
+  return true;
+}
+
+/**
+* タイルセットを読み込む.
+*
+* @param tilesetList "tilesets"から読み込んだタイルセット.
+*/
+void TiledMap::LoadTileSets(const std::vector<JsonTileSet>& tilesetList)
+{
+  tilesets.reserve(tilesetList.size());
+  for (const auto& e : tilesetList) {
+    tilesets.emplace_back();
+    TileSet& tmp = tilesets.back();
+
+    tmp.size.x = e.tileWidth;
+    tmp.size.y = e.tileHeight;
+    tmp.columns = e.columns;
+    tmp.firstId = e.firstId;
+    tmp.imageFilename = e.image;
+
+    // Tiled 1.1以前の"tileproperties"と、1.2以降の"tiles"のどちらにも対応する.
+    for (const auto& tile : e.tileProperties) {
+      if (tile.second.IsSolid()) {
+        SetSolid(tmp.solid, atoi(tile.first.c_str()));
+      }
+    }
+    for (const auto& tile : e.tiles.list) {
+      if (tile.properties.IsSolid()) {
+        SetSolid(tmp.solid, tile.id);
+      }
+    }
+  }
+}
+
+/**
+* レイヤーに対応するタイルセットを設定する.
+*
+* @param layer 設定するレイヤー.
+* @param tile  レイヤーで使われているタイルのデータ. 0ならタイルセット0を設定する.
+*/
+void TiledMap::SelectTileSet(Layer& layer, uint32_t tile)
+{
+  layer.tilesetNo = 0;
+  if (tile == 0) {
+    return;
+  }
+  const int id = tile & MaskForID;
+  const auto itrTileset = std::find_if(tilesets.rbegin(), tilesets.rend(), [id](const TileSet& tileset) { return tileset.firstId <= id; });
+  if (itrTileset == tilesets.rend()) {
+    return;
+  }
+  layer.tilesetNo = (itrTileset + 1).base() - tilesets.begin();
+}
+
+/**
+* バイナリ形式のマップデータを読み込む.
+*
+* @param file     マップファイル.
+* @param filename マップファイルのパス(エラー表示用).
+*
+* @retval true  読み込み成功.
+* @retval false 読み込み失敗.
+*
+* 各レイヤーのmapDataはfile内のマップデータを直接指す. fileはTiledMapが破棄されるか、Save()で割り当てを解除するまで保持される.
+*/
+bool TiledMap::LoadBinary(const MappedFilePtr& file, const char* filename)
+{
+  const uint8_t* const data = file->Data();
+  const uint64_t fileSize = file->Size();
+  const BinaryHeader& header = *reinterpret_cast<const BinaryHeader*>(data);
+  const uint64_t tableEnd = sizeof(BinaryHeader) +
+    static_cast<uint64_t>(header.layerCount) * sizeof(BinaryLayer) +
+    static_cast<uint64_t>(header.tilesetCount) * sizeof(BinaryTileset);
+  if (header.version != binaryVersion || tableEnd > fileSize) {
+    LOG("ERROR: %sは対応していないバージョンか、データに不備があります.\n", filename);
+    return false;
+  }
+  const BinaryLayer* const layerTable = reinterpret_cast<const BinaryLayer*>(data + sizeof(BinaryHeader));
+  const BinaryTileset* const tilesetTable = reinterpret_cast<const BinaryTileset*>(layerTable + header.layerCount);
+
+  tilesets.reserve(header.tilesetCount);
+  for (uint32_t i = 0; i < header.tilesetCount; ++i) {
+    const BinaryTileset& e = tilesetTable[i];
+    if (static_cast<uint64_t>(e.imageOffset) + e.imageLength > fileSize ||
+      e.solidOffset % sizeof(uint32_t) || e.solidOffset + static_cast<uint64_t>(e.solidCount) * sizeof(uint32_t) > fileSize) {
+      LOG("ERROR: %sのタイルセット%dに不備があります.\n", filename, i);
+      return false;
+    }
+    tilesets.emplace_back();
+    TileSet& tmp = tilesets.back();
+    tmp.size = glm::vec2(e.tileWidth, e.tileHeight);
+    tmp.columns = e.columns;
+    tmp.firstId = e.firstId;
+    tmp.imageFilename.assign(reinterpret_cast<const char*>(data + e.imageOffset), e.imageLength);
+    const uint32_t* const solidIds = reinterpret_cast<const uint32_t*>(data + e.solidOffset);
+    for (uint32_t n = 0; n < e.solidCount; ++n) {
+      SetSolid(tmp.solid, static_cast<int>(solidIds[n]));
+    }
+  }
+
+  layers.reserve(header.layerCount);
+  for (uint32_t i = 0; i < header.layerCount; ++i) {
+    const BinaryLayer& e = layerTable[i];
+    const uint64_t dataSize = static_cast<uint64_t>(e.width) * static_cast<uint64_t>(e.height) * sizeof(uint32_t);
+    // dataOffset + dataSizeはオーバーフローする可能性があるため、残りのバイト数と比較する.
+    if (e.width < 0 || e.height < 0 || e.dataOffset % sizeof(uint32_t) ||
+      e.dataOffset > fileSize || dataSize > fileSize - e.dataOffset ||
+      e.tilesetNo < 0 || static_cast<uint32_t>(e.tilesetNo) >= header.tilesetCount) {
+      LOG("ERROR: %sのレイヤー%dに不備があります.\n", filename, i);
+      return false;
+    }
+    layers.emplace_back();
+    Layer& tmp = layers.back();
+    tmp.size = glm::ivec2(e.width, e.height);
+    tmp.baseOffset = glm::vec2(e.offsetX, e.offsetY);
+    tmp.opacity = e.opacity;
+    tmp.visible = e.visible != 0;
+    tmp.tilesetNo = e.tilesetNo;
+    tmp.mapData = reinterpret_cast<uint32_t*>(file->Data() + e.dataOffset);
+  }
+  mappedFile = file;
+  return true;
+}
+
 /**
-* JSONt@Cǂݍ.
+* マップをバイナリ形式で保存する.
+*
+* @param filename 保存するファイルのパス.
 *
-* @param filename JSONt@C̃pX.
-* @param drawable `f[^̍쐬𐧌䂷rbg.
-*                 0Ȃ쐬ȂA1Ȃ쐬.
-*                 0bit0ԃC[ɁA31bit31ԃC[ɑΉ.
-*                 JSONt@Cɑ݂ȂC[̃rbg͖.
+* @retval true  保存成功.
+* @retval false 保存失敗.
 *
-* @retval true  ǂݍݐ.
-* @retval false ǂݍݎs.
+* Set()などで変更したタイルも保存される.
+* 書き込み途中で失敗しても元のファイルが壊れないように、一時ファイルに書き込んでから名前を変更する.
+* 読み込み元のバイナリファイルに上書きできるように、名前を変更する前にDetachMappedFile()でファイルの割り当てを解除する.
 */
-bool TiledMap::Load(const char* filename, uint32_t drawable)
+bool TiledMap::Save(const char* filename)
 {
-  // JSONt@Cǂݍ.
-  struct stat st;
-  if (stat(filename, &st)) {
-    LOG("ERROR: %sJ܂.\n", filename);
+  BinaryHeader header = {};
+  memcpy(header.magic, binaryMagic, sizeof(binaryMagic));
+  header.version = binaryVersion;
+  header.layerCount = static_cast<uint32_t>(layers.size());
+  header.tilesetCount = static_cast<uint32_t>(tilesets.size());
+
+  // ファイル内の配置を決める.
+  uint64_t offset = sizeof(BinaryHeader) + sizeof(BinaryLayer) * layers.size() + sizeof(BinaryTileset) * tilesets.size();
+  std::vector<BinaryTileset> tilesetTable;
+  tilesetTable.reserve(tilesets.size());
+  for (const auto& e : tilesets) {
+    const BinaryTileset tmp = {
+      e.size.x, e.size.y, e.columns, e.firstId,
+      static_cast<uint32_t>(offset), static_cast<uint32_t>(e.imageFilename.size()), 0, 0
+    };
+    tilesetTable.push_back(tmp);
+    offset += e.imageFilename.size();
+  }
+  std::vector<std::vector<uint32_t>> solidIdList(tilesets.size());
+  offset = (offset + sizeof(uint32_t) - 1) & ~static_cast<uint64_t>(sizeof(uint32_t) - 1);
+  for (size_t i = 0; i < tilesets.size(); ++i) {
+    const std::vector<bool>& solid = tilesets[i].solid;
+    for (size_t id = 0; id < solid.size(); ++id) {
+      if (solid[id]) {
+        solidIdList[i].push_back(static_cast<uint32_t>(id));
+      }
+    }
+    tilesetTable[i].solidOffset = static_cast<uint32_t>(offset);
+    tilesetTable[i].solidCount = static_cast<uint32_t>(solidIdList[i].size());
+    offset += solidIdList[i].size() * sizeof(uint32_t);
+  }
+  std::vector<BinaryLayer> layerTable;
+  layerTable.reserve(layers.size());
+  for (const auto& e : layers) {
+    offset = (offset + binaryDataAlignment - 1) & ~static_cast<uint64_t>(binaryDataAlignment - 1);
+    const BinaryLayer tmp = {
+      e.size.x, e.size.y, e.baseOffset.x, e.baseOffset.y, e.opacity,
+      e.visible ? 1u : 0u, e.tilesetNo, 0, offset
+    };
+    layerTable.push_back(tmp);
+    offset += static_cast<uint64_t>(e.size.x) * e.size.y * sizeof(uint32_t);
+  }
+
+  const std::string tmpFilename = std::string(filename) + ".tmp";
+  FILE* fp = fopen(tmpFilename.c_str(), "wb");
+  if (!fp) {
+    LOG("ERROR: %sを作成できません.\n", tmpFilename.c_str());
     return false;
   }
-  FILE* fp = fopen(filename, "rb");
-  std::vector<char> buf;
-  buf.resize(st.st_size);
-  const size_t readSize = fread(buf.data(), 1, st.st_size, fp);
-  fclose(fp);
-  if (readSize != st.st_size) {
-    LOG("ERROR: %sǂݍ߂܂.\n", filename);
+  fwrite(&header, sizeof(header), 1, fp);
+  fwrite(layerTable.data(), sizeof(BinaryLayer), layerTable.size(), fp);
+  fwrite(tilesetTable.data(), sizeof(BinaryTileset), tilesetTable.size(), fp);
+  for (const auto& e : tilesets) {
+    fwrite(e.imageFilename.data(), 1, e.imageFilename.size(), fp);
+  }
+  static const char padding[binaryDataAlignment] = {};
+  if (!tilesetTable.empty()) {
+    fwrite(padding, 1, static_cast<size_t>(tilesetTable[0].solidOffset - ftell(fp)), fp);
+  }
+  for (const auto& e : solidIdList) {
+    fwrite(e.data(), sizeof(uint32_t), e.size(), fp);
+  }
+  for (size_t i = 0; i < layers.size(); ++i) {
+    fwrite(padding, 1, static_cast<size_t>(layerTable[i].dataOffset - ftell(fp)), fp);
+    const Layer& layer = layers[i];
+    if (layer.mapData) {
+      fwrite(layer.mapData, sizeof(uint32_t), layer.size.x * layer.size.y, fp);
+      continue;
+    }
+    // 無限マップはチャンクの行ごとに書き出す. At()で参照すると全てのチャンクが読み込まれたままになるため、
+    // 読み込まれていないチャンクは一時的に展開するだけにして、読み込み状態を変えない.
+    LayerStream& stream = *layer.stream;
+    std::vector<uint32_t> rows(static_cast<size_t>(layer.size.x) * stream.chunkSize.y);
+    std::vector<uint32_t> chunkData(stream.chunkSize.x * stream.chunkSize.y);
+    for (int y0 = 0; y0 < layer.size.y; y0 += stream.chunkSize.y) {
+      const int height = std::min(stream.chunkSize.y, layer.size.y - y0);
+      std::fill(rows.begin(), rows.end(), 0);
+      for (int x0 = 0; x0 < layer.size.x; x0 += stream.chunkSize.x) {
+        const LayerStream::Chunk* chunk = stream.Find(y0, x0);
+        if (!chunk) {
+          continue;
+        }
+        const uint32_t* src = chunk->data.data();
+        if (chunk->data.empty()) {
+          stream.Decode(*chunk, chunkData.data());
+          src = chunkData.data();
+        }
+        const int width = std::min(stream.chunkSize.x, layer.size.x - x0);
+        for (int y = 0; y < height; ++y) {
+          std::copy(src + y * stream.chunkSize.x, src + y * stream.chunkSize.x + width, rows.begin() + y * layer.size.x + x0);
+        }
+      }
+      fwrite(rows.data(), sizeof(uint32_t), static_cast<size_t>(layer.size.x) * height, fp);
+    }
+  }
+  bool result = !ferror(fp);
+  if (fclose(fp) != 0) {
+    result = false;
+  }
+  if (result) {
+    DetachMappedFile();
+#ifdef _WIN32
+    remove(filename); // Windowsのrenameは既存のファイルを置き換えられない.
+#endif
+    result = rename(tmpFilename.c_str(), filename) == 0;
+  }
+  if (!result) {
+    remove(tmpFilename.c_str());
+    LOG("ERROR: %sに書き込めません.\n", filename);
+  }
+  return result;
+}
+
+/**
+* バイナリファイルのマップデータをメモリにコピーして、ファイルの割り当てを解除する.
+*
+* 割り当て中のファイルは、切り詰めると参照時にプロセスが停止し、Windowsでは置き換えることもできない.
+* 無限マップはチャンクの展開にファイルを使うので、割り当てを維持する.
+*/
+void TiledMap::DetachMappedFile()
+{
+  if (!mappedFile) {
+    return;
+  }
+  for (const auto& e : layers) {
+    if (e.stream) {
+      return;
+    }
+  }
+  for (auto& e : layers) {
+    if (e.mapData && e.mapData != e.mapDataStorage.data()) {
+      e.mapDataStorage.assign(e.mapData, e.mapData + static_cast<size_t>(e.size.x) * e.size.y);
+      e.mapData = e.mapDataStorage.data();
+    }
+  }
+  mappedFile.reset();
+}
+
+/**
+* Tiled Map EditorのJSONファイルをバイナリ形式に変換する.
+*
+* @param jsonFilename   変換するJSONファイルのパス.
+* @param binaryFilename 保存するバイナリファイルのパス.
+*
+* @retval true  変換成功.
+* @retval false 変換失敗.
+*
+* テクスチャは読み込まないので、OpenGLを初期化せずに実行できる.
+*/
+bool TiledMap::Convert(const char* jsonFilename, const char* binaryFilename)
+{
+  const MappedFilePtr file = MappedFile::Open(jsonFilename);
+  if (!file) {
+    LOG("ERROR: %sを開けません.\n", jsonFilename);
     return false;
   }
-  Json::Result map = Json::Parse(&buf[0], &buf[0] + buf.size());
-  if (!map.error.empty()) {
-    LOG("ERROR: %s̓f[^ɕs邩AJSONt@Cł͂܂.\n", filename);
+  TiledMap tmp;
+  if (!tmp.LoadJson(file, jsonFilename)) {
     return false;
   }
+  return tmp.Save(binaryFilename);
+}
 
-  // }bv擾.
-  const Json::Object& obj = map.value.AsObject();
-  const Json::Array& layerArray = obj.find("layers")->second.AsArray();
-  layers.reserve(layerArray.size());
-  for (const auto& e : layerArray) {
-    const Json::Object& layer = e.AsObject();
-    const Json::String& type = layer.find("type")->second.AsString();
-    if (type != "tilelayer") {
-      continue;
+/**
+* タイルマップを破棄する.
+*/
+void TiledMap::Unload()
+{
+  layers.clear();
+  tilesets.clear();
+  mappedFile.reset();
+}
+
+/**
+* タイルを変更する.
+*
+* @param y    変更するタイルの縦の位置.
+* @param x    変更するタイルの横の位置.
+* @param tile 新しいタイルのデータ.
+*
+* タイルを含むチャンクは次のUpdate()で再構築される.
+*/
+void TiledMap::Layer::Set(int y, int x, uint32_t tile)
+{
+  At(y, x) = tile;
+  MarkDirty(y, x);
+}
+
+/**
+* タイルを含むチャンクに再構築が必要であることを記録する.
+*
+* @param y タイルの縦の位置.
+* @param x タイルの横の位置.
+*/
+void TiledMap::Layer::MarkDirty(int y, int x)
+{
+  if (stream) {
+    stream->MarkModified(y, x);
+  }
+  if (chunks.empty()) {
+    return;
+  }
+  const size_t index = (y / chunkSize) * chunkCount.x + (x / chunkSize);
+  if (!chunks[index].dirty) {
+    chunks[index].dirty = true;
+    dirtyChunks.push_back(index);
+  }
+}
+
+/**
+* 無限マップのマップデータを読み込む範囲を設定する.
+*
+* @param tileMin 範囲の左上のタイル位置.
+* @param tileMax 範囲の右下のタイル位置(範囲に含む).
+*
+* 範囲の周囲1チャンク分を先に読み込み、範囲から外れたチャンクのマップデータと描画データを破棄する.
+* 範囲に入ったチャンクの描画データは次のUpdate()で構築される.
+* 無限マップでないレイヤーでは何もしない.
+*/
+void TiledMap::Layer::Stream(const glm::ivec2& tileMin, const glm::ivec2& tileMax)
+{
+  if (!stream || chunks.empty()) {
+    return;
+  }
+  glm::ivec2 oldMin, oldMax;
+  const bool hasOld = GetStreamChunkRange(*this, oldMin, oldMax);
+  if (!stream->Stream(tileMin, tileMax)) {
+    return;
+  }
+  glm::ivec2 newMin, newMax;
+  const bool hasNew = GetStreamChunkRange(*this, newMin, newMax);
+  const auto isInside = [&](int cx, int cy) {
+    return hasNew && cx >= newMin.x && cx <= newMax.x && cy >= newMin.y && cy <= newMax.y;
+  };
+
+  // 範囲から外れた描画データを破棄する.
+  if (hasOld) {
+    for (int cy = oldMin.y; cy <= oldMax.y; ++cy) {
+      for (int cx = oldMin.x; cx <= oldMax.x; ++cx) {
+        if (!isInside(cx, cy)) {
+          Chunk& chunk = chunks[cy * chunkCount.x + cx];
+          chunk.renderer.reset();
+          chunk.dirty = true;
+        }
+      }
     }
-    layers.emplace_back();
-    Layer& tmp = layers.back();
-    tmp.size.x = layer.find("width")->second.AsNumber<int>();
-    tmp.size.y = layer.find("height")->second.AsNumber<int>();
-    const auto offsetx = layer.find("offsetx");
-    if (offsetx != layer.end()) {
-      tmp.baseOffset.x = offsetx->second.AsNumber<float>();
-    }
-    const auto offsety = layer.find("offsety");
-    if (offsety != layer.end()) {
-      tmp.baseOffset.y = offsety->second.AsNumber<float>();
-    }
-    const auto opacity = layer.find("opacity");
-    if (opacity != layer.end()) {
-      tmp.opacity = opacity->second.AsNumber<float>();
-    } else {
-      tmp.opacity = 1;
-    }
-    tmp.visible = layer.find("visible")->second.AsBoolean();
-    const Json::Array& mapArray = layer.find("data")->second.AsArray();
-    tmp.mapData.reserve(mapArray.size());
-    for (const auto& e : mapArray) {
-      tmp.mapData.push_back(e.AsNumber<uint32_t>());
-    }
-    tmp.drawable = drawable & 1;
-    drawable >>= 1;
-    tmp.dirty = true;
   }
 
-  // ^C擾.
-  const Json::Array& tilesetArray = obj.find("tilesets")->second.AsArray();
-  tilesets.reserve(tilesetArray.size());
-  for (const auto& e : tilesetArray) {
-    const Json::Object& tileset = e.AsObject();
-    tilesets.emplace_back();
-    TileSet& tmp = tilesets.back();
+  // 範囲外のチャンクは常にdirtyなので、範囲内のdirtyなチャンクを再構築対象にする.
+  dirtyChunks.clear();
+  if (hasNew) {
+    for (int cy = newMin.y; cy <= newMax.y; ++cy) {
+      for (int cx = newMin.x; cx <= newMax.x; ++cx) {
+        const size_t index = cy * chunkCount.x + cx;
+        if (chunks[index].dirty) {
+          dirtyChunks.push_back(index);
+        }
+      }
+    }
+  }
+}
+
+/**
+* タイルを含むチャンクを取得する.
+*
+* @param y タイルの縦の位置.
+* @param x タイルの横の位置.
+*
+* @return タイルを含むチャンクへのポインタ. チャンクがなければnullptr.
+*/
+TiledMap::LayerStream::Chunk* TiledMap::LayerStream::Find(int y, int x)
+{
+  if (x < 0 || y < 0) {
+    return nullptr;
+  }
+  const glm::ivec2 cell = glm::ivec2(x, y) / chunkSize;
+  if (cell.x >= gridCount.x || cell.y >= gridCount.y) {
+    return nullptr;
+  }
+  const int index = grid[cell.y * gridCount.x + cell.x];
+  return index >= 0 ? &chunks[index] : nullptr;
+}
+
+/**
+* タイルを含むチャンクを取得する. チャンクがなければ作成する.
+*
+* @param y タイルの縦の位置.
+* @param x タイルの横の位置.
+*
+* @return タイルを含むチャンク.
+*/
+TiledMap::LayerStream::Chunk& TiledMap::LayerStream::FindOrCreate(int y, int x)
+{
+  if (Chunk* p = Find(y, x)) {
+    return *p;
+  }
+  const glm::ivec2 cell = glm::ivec2(x, y) / chunkSize;
+  grid[cell.y * gridCount.x + cell.x] = static_cast<int>(chunks.size());
+  chunks.emplace_back();
+  chunks.back().origin = cell * chunkSize;
+  return chunks.back();
+}
+
+/**
+* チャンクのマップデータを読み込む.
+*
+* @param chunk 読み込むチャンク.
+*
+* ファイルにないチャンクや解析できないチャンクは、全てのタイルが0になる.
+*/
+void TiledMap::LayerStream::Load(Chunk& chunk)
+{
+  chunk.data.resize(chunkSize.x * chunkSize.y);
+  ++loadedCount;
+  Decode(chunk, chunk.data.data());
+}
+
+/**
+* ファイル内のチャンクのマップデータを展開する.
+*
+* @param chunk 展開するチャンク.
+* @param out   展開先. chunkSize.x * chunkSize.y個の要素を持つこと.
+*
+* ファイルにないチャンクや解析できないチャンクは、全てのタイルが0になる.
+*/
+void TiledMap::LayerStream::Decode(const Chunk& chunk, uint32_t* out) const
+{
+  const size_t count = chunkSize.x * chunkSize.y;
+  if (!chunk.dataBegin) {
+    std::fill(out, out + count, 0);
+    return;
+  }
+  if (!DecodeTileData(chunk.dataBegin, chunk.dataEnd, encoding, compression, out, count)) {
+    LOG("WARNING: チャンク(%d, %d)のマップデータを読み込めません.\n", chunk.origin.x, chunk.origin.y);
+    std::fill(out, out + count, 0);
+  }
+}
+
+/**
+* チャンクのマップデータを破棄する.
+*
+* @param chunk 破棄するチャンク.
+*/
+void TiledMap::LayerStream::Unload(Chunk& chunk)
+{
+  std::vector<uint32_t>().swap(chunk.data);
+  --loadedCount;
+}
+
+/**
+* タイルを参照する.
+*
+* @param y タイルの縦の位置.
+* @param x タイルの横の位置.
+*
+* @return タイルへの参照.
+*
+* チャンクが読み込まれていなければ読み込む. ファイルにないチャンクは新しく作られる.
+* 参照したチャンクはStream()の範囲から外れると破棄されるため、変更した場合はMarkModified()を呼ぶこと.
+*/
+uint32_t& TiledMap::LayerStream::At(int y, int x)
+{
+  Chunk& chunk = FindOrCreate(y, x);
+  if (chunk.data.empty()) {
+    Load(chunk);
+  }
+  return chunk.data[(y - chunk.origin.y) * chunkSize.x + (x - chunk.origin.x)];
+}
+
+/**
+* タイルを取得する.
+*
+* @param y タイルの縦の位置.
+* @param x タイルの横の位置.
+*
+* @return タイルのデータ. チャンクがなければ0.
+*/
+uint32_t TiledMap::LayerStream::Get(int y, int x)
+{
+  Chunk* p = Find(y, x);
+  if (!p) {
+    return 0;
+  }
+  if (p->data.empty()) {
+    Load(*p);
+  }
+  return p->data[(y - p->origin.y) * chunkSize.x + (x - p->origin.x)];
+}
 
-    tmp.size.x = tileset.find("tilewidth")->second.AsNumber<float>();
-    tmp.size.y = tileset.find("tileheight")->second.AsNumber<float>();
-    tmp.columns = tileset.find("columns")->second.AsNumber<int>();
-    tmp.firstId = tileset.find("firstgid")->second.AsNumber<int>();
-    const std::string texFilename = std::string("Res/") + tileset.find("image")->second.AsString();
-    tmp.image = Texture::LoadAndCache(texFilename.c_str());
-    if (!tmp.image) {
-      LOG("WARNING: %sǂݍ߂܂.\n", texFilename.c_str());
+/**
+* 読み込みを維持する範囲を設定する.
+*
+* @param tileMin 範囲の左上のタイル位置.
+* @param tileMax 範囲の右下のタイル位置(範囲に含む).
+*
+* @retval true  範囲が変化した.
+* @retval false 範囲は変化していない.
+*
+* 範囲はチャンク単位に広げたうえで、さらに周囲1チャンク分を加えたものになる.
+* 範囲内のチャンクは読み込まれ、範囲外の変更されていないチャンクは破棄される.
+*/
+bool TiledMap::LayerStream::Stream(const glm::ivec2& tileMin, const glm::ivec2& tileMax)
+{
+  glm::ivec2 newMin(0), newMax(-1);
+  const glm::ivec2 gridMax = gridCount - 1;
+  if (tileMax.x >= tileMin.x && tileMax.y >= tileMin.y && tileMax.x >= 0 && tileMax.y >= 0) {
+    const glm::ivec2 minCell = glm::max(glm::max(tileMin, glm::ivec2(0)) / chunkSize - 1, glm::ivec2(0));
+    const glm::ivec2 maxCell = glm::min(tileMax / chunkSize + 1, gridMax);
+    if (minCell.x <= maxCell.x && minCell.y <= maxCell.y) {
+      newMin = minCell * chunkSize;
+      newMax = (maxCell + 1) * chunkSize - 1;
     }
   }
+  if (newMin == windowMin && newMax == windowMax) {
+    return false;
+  }
+  windowMin = newMin;
+  windowMax = newMax;
 
-  // ^CZbgNOݒ.
-  for (auto& e : layers) {
-    e.tilesetNo = 0;
-    const auto itr = std::find_if(e.mapData.begin(), e.mapData.end(), [](uint32_t id) { return id != 0; });
-    if (itr == e.mapData.end()) {
+  // 範囲外のチャンクを破棄.
+  for (auto& e : chunks) {
+    if (e.data.empty() || e.modified) {
       continue;
     }
-    const int id = *itr & MaskForID;
-    const auto itrTileset = std::find_if(tilesets.rbegin(), tilesets.rend(), [id](const TileSet& tileset) { return tileset.firstId <= id; });
-    if (itrTileset == tilesets.rend()) {
-      continue;
+    if (e.origin.x < windowMin.x || e.origin.x > windowMax.x || e.origin.y < windowMin.y || e.origin.y > windowMax.y) {
+      Unload(e);
     }
-    e.tilesetNo = (itrTileset + 1).base() - tilesets.begin();
   }
 
-  Update(); // `f[^쐬.
-
+  // 範囲内のチャンクを読み込む.
+  if (windowMax.x >= windowMin.x) {
+    const glm::ivec2 minCell = windowMin / chunkSize;
+    const glm::ivec2 maxCell = windowMax / chunkSize;
+    for (int cy = minCell.y; cy <= maxCell.y; ++cy) {
+      for (int cx = minCell.x; cx <= maxCell.x; ++cx) {
+        const int index = grid[cy * gridCount.x + cx];
+        if (index >= 0 && chunks[index].data.empty()) {
+          Load(chunks[index]);
+        }
+      }
+    }
+  }
   return true;
 }
 
 /**
-* ^C}bvj.
+* タイルが変更されたことを記録する.
+*
+* @param y 変更したタイルの縦の位置.
+* @param x 変更したタイルの横の位置.
+*
+* 変更されたチャンクは、Stream()の範囲から外れても破棄されなくなる.
 */
-void TiledMap::Unload()
+void TiledMap::LayerStream::MarkModified(int y, int x)
 {
-  layers.clear();
-  tilesets.clear();
+  if (Chunk* p = Find(y, x)) {
+    p->modified = true;
+  }
+}
+
+/**
+* 最初に見つかった0でないタイルを取得する.
+*
+* @return 0でないタイルのデータ. 見つからなければ0.
+*
+* タイルセットの選択に使う. 調べるために読み込んだチャンクは破棄される.
+*/
+uint32_t TiledMap::LayerStream::FindFirstTile()
+{
+  for (auto& e : chunks) {
+    const bool isLoaded = !e.data.empty();
+    if (!isLoaded) {
+      Load(e);
+    }
+    const auto itr = std::find_if(e.data.begin(), e.data.end(), [](uint32_t id) { return id != 0; });
+    const uint32_t tile = itr != e.data.end() ? *itr : 0;
+    if (!isLoaded) {
+      Unload(e);
+    }
+    if (tile) {
+      return tile;
+    }
+  }
+  return 0;
+}
+
+/**
+* チャンクの描画データを構築する.
+*
+* @param layer チャンクを含むレイヤー.
+* @param index 構築するチャンクの番号.
+*/
+void TiledMap::BuildChunk(Layer& layer, size_t index)
+{
+  Chunk& chunk = layer.chunks[index];
+  chunk.dirty = false;
+  // 無限マップで空のチャンクが作られないように、読み込み専用のAt()を使う.
+  const Layer& src = layer;
+
+  const TileSet& tileset = tilesets[layer.tilesetNo];
+  const int x0 = static_cast<int>(index % layer.chunkCount.x) * chunkSize;
+  const int y0 = static_cast<int>(index / layer.chunkCount.x) * chunkSize;
+  const int x1 = std::min(x0 + chunkSize, layer.size.x);
+  const int y1 = std::min(y0 + chunkSize, layer.size.y);
+
+  // タイルがひとつもなければ描画オブジェクトは不要.
+  bool hasTile = false;
+  for (int y = y0; y < y1 && !hasTile; ++y) {
+    for (int x = x0; x < x1; ++x) {
+      if (static_cast<int>(src.At(y, x) & MaskForID) >= tileset.firstId) {
+        hasTile = true;
+        break;
+      }
+    }
+  }
+  if (!hasTile || !tileset.image) {
+    chunk.renderer.reset();
+    return;
+  }
+  if (!chunk.renderer) {
+    chunk.renderer = std::make_unique<SpriteRenderer>();
+    if (!chunk.renderer->Initialize(chunkSize * chunkSize)) {
+      chunk.renderer.reset();
+      return;
+    }
+  }
+
+  Sprite sprite(tileset.image);
+  sprite.Color(glm::vec4(1, 1, 1, layer.opacity));
+  chunk.renderer->BeginUpdate();
+  for (int y = y0; y < y1; ++y) {
+    for (int x = x0; x < x1; ++x) {
+      const uint32_t tmp = src.At(y, x);
+      const int tileId = static_cast<int>(tmp & MaskForID) - tileset.firstId;
+      if (tileId < 0) {
+        continue;
+      }
+      glm::vec2 scale(1, 1);
+      float rot = 0;
+      switch (tmp & ~MaskForID) {
+      case FlipH: scale.x = -1; break;
+      case FlipV: scale.y = -1; break;
+      case Rot90: scale.x = -1; rot = -glm::pi<float>() * 0.5f; break;
+      case FlipH | FlipV: scale.x = -1; scale.y = -1; break;
+      case FlipH | Rot90: rot = -glm::pi<float>() * 0.5f; break;
+      case FlipV | Rot90: rot = glm::pi<float>() * 0.5f; break;
+      }
+      sprite.Scale(scale);
+      sprite.Rotation(rot);
+      const glm::vec2 tileOrigin((tileId % tileset.columns) * tileset.size.x, tileset.image->Height() - (tileId / tileset.columns + 1) * tileset.size.y);
+      sprite.Rectangle(Rect(tileOrigin, tileset.size));
+      sprite.Position(glm::vec3((glm::vec2(x + 0.5f, layer.size.y - y - 0.5f) - glm::vec2(layer.size) * 0.5f) * tileset.size, 0));
+      sprite.Update(0);
+      chunk.renderer->AddVertices(sprite);
+    }
+  }
+  chunk.renderer->EndUpdate();
+}
+
+/**
+* DrawMode_IndexTexture用のマップテクスチャを更新する.
+*
+* @param layer 更新するレイヤー.
+*
+* @retval true  更新成功.
+* @retval false マップテクスチャを作成できなかった.
+*
+* dirtyがtrueならマップ全体を、そうでなければ変更されたチャンクの範囲だけを転送する.
+* 変更がなければ何もしないので、毎フレーム呼び出してもチャンク数に比例する負荷は発生しない.
+*/
+bool TiledMap::UpdateIndexTexture(Layer& layer)
+{
+  // 無限マップはマップ全体をテクスチャにできない.
+  if (!layer.mapData) {
+    return false;
+  }
+  const TileSet& tileset = tilesets[layer.tilesetNo];
+  if (!tileset.image) {
+    layer.indexRenderer.reset();
+    layer.dirty = false;
+    layer.dirtyChunks.clear();
+    return true;
+  }
+
+  if (layer.dirty || !layer.indexRenderer) {
+    layer.dirty = false;
+    layer.dirtyChunks.clear();
+    // スプライト用の描画データは不要. 以後チャンクのdirtyは転送待ちを表す.
+    for (auto& e : layer.chunks) {
+      e.renderer.reset();
+      e.dirty = false;
+    }
+    // 作成済みのテクスチャは作り直さずに内容だけを転送する.
+    if (layer.indexRenderer) {
+      layer.indexRenderer->Update(glm::ivec2(0), layer.size, layer.mapData);
+      return true;
+    }
+    layer.indexRenderer = TileMapRenderer::Create(layer.size, layer.mapData);
+    return layer.indexRenderer != nullptr;
+  }
+
+  uint32_t buf[chunkSize * chunkSize];
+  for (const size_t i : layer.dirtyChunks) {
+    const glm::ivec2 origin(static_cast<int>(i % layer.chunkCount.x) * chunkSize, static_cast<int>(i / layer.chunkCount.x) * chunkSize);
+    const glm::ivec2 size = glm::min(origin + chunkSize, layer.size) - origin;
+    uint32_t* p = buf;
+    for (int y = 0; y < size.y; ++y) {
+      const uint32_t* row = layer.mapData + (origin.y + y) * layer.size.x + origin.x;
+      p = std::copy(row, row + size.x, p);
+    }
+    layer.indexRenderer->Update(origin, size, buf);
+    layer.chunks[i].dirty = false;
+  }
+  layer.dirtyChunks.clear();
+  return true;
 }
 
 /**
-* ^C}bvXV.
+* タイルマップを更新する.
+*
+* dirtyがtrueのレイヤーは全てのチャンクを、そうでなければ変更されたチャンクだけを再構築する.
 */
 void TiledMap::Update()
 {
-  // `f[^̍XV.
   for (auto& e : layers) {
-    if (!e.dirty) {
-      continue;
-    }
-    e.dirty = false;
-    // `rbgĂȂΕ`pf[^͍Ȃ.
+    // 描画ビットが立っていなければ描画用データは作らない.
     if (!e.drawable) {
+      e.dirty = false;
+      e.dirtyChunks.clear();
       continue;
     }
-    // }bv񂩂`f[^\z.
-    if (!e.renderer) {
-      e.renderer = std::make_unique<SpriteRenderer>();
-      e.renderer->Initialize(e.size.x * e.size.y);
+    if (e.drawMode == DrawMode_IndexTexture) {
+      if (UpdateIndexTexture(e)) {
+        continue;
+      }
+      LOG("WARNING: マップテクスチャを作成できないため、スプライトで描画します(%dx%d).\n", e.size.x, e.size.y);
+      e.drawMode = DrawMode_Sprite;
+      e.dirty = true;
     }
-    const TileSet& tileset = tilesets[e.tilesetNo];
-    Sprite sprite(tilesets[e.tilesetNo].image);
-    sprite.Color(glm::vec4(1, 1, 1, e.opacity));
-    e.renderer->BeginUpdate();
-    for (int y = 0; y < e.size.y; ++y) {
-      for (int x = 0; x < e.size.x; ++x) {
-        const uint32_t tmp = e.mapData[y * e.size.x + x];
-        const int tileId = static_cast<int>(tmp & MaskForID) - tileset.firstId;
-        if (tileId < 0) {
-          continue;
+    e.indexRenderer.reset();
+    if (e.stream) {
+      // 無限マップはStream()の範囲内のチャンクだけを構築する.
+      if (e.dirty) {
+        e.dirty = false;
+        e.dirtyChunks.clear();
+        for (auto& chunk : e.chunks) {
+          chunk.renderer.reset();
+          chunk.dirty = true;
         }
-        glm::vec2 scale(1, 1);
-        float rot = 0;
-        switch (tmp & ~MaskForID) {
-        case FlipH: scale.x = -1; break;
-        case FlipV: scale.y = -1; break;
-        case Rot90: scale.x = -1; rot = -glm::pi<float>() * 0.5f; break;
-        case FlipH | FlipV: scale.x = -1; scale.y = -1; break;
-        case FlipH | Rot90: rot = -glm::pi<float>() * 0.5f; break;
-        case FlipV | Rot90: rot = glm::pi<float>() * 0.5f; break;
+        glm::ivec2 minChunk, maxChunk;
+        if (GetStreamChunkRange(e, minChunk, maxChunk)) {
+          for (int cy = minChunk.y; cy <= maxChunk.y; ++cy) {
+            for (int cx = minChunk.x; cx <= maxChunk.x; ++cx) {
+              BuildChunk(e, cy * e.chunkCount.x + cx);
+            }
+          }
         }
-        sprite.Scale(scale);
-        sprite.Rotation(rot);
-        const glm::vec2 tileOrigin((tileId % tileset.columns) * tileset.size.x, tileset.image->Height() - (tileId / tileset.columns + 1) * tileset.size.y);
-        sprite.Rectangle(Rect(tileOrigin, tileset.size));
-        sprite.Position(glm::vec3((glm::vec2(x + 0.5f, e.size.y - y - 0.5f) - glm::vec2(e.size) * 0.5f) * tileset.size, 0));
-        sprite.Update(0);
-        e.renderer->AddVertices(sprite);
+        continue;
+      }
+    } else if (e.dirty) {
+      e.dirty = false;
+      e.dirtyChunks.clear();
+      for (size_t i = 0; i < e.chunks.size(); ++i) {
+        BuildChunk(e, i);
       }
-    }
-    e.renderer->EndUpdate();
-  }
-
-  // JW̍XV.
-  for (auto& e : layers) {
-    if (!e.drawable || !e.visible) {
       continue;
     }
-    e.renderer->CameraPosition(glm::vec3(-(position + e.baseOffset + e.offset), 0));
+    for (const size_t i : e.dirtyChunks) {
+      BuildChunk(e, i);
+    }
+    e.dirtyChunks.clear();
   }
 }
 
 /**
-* ^C}bv\.
+* タイルマップを表示する.
 *
-* @param ss ʂ̑傫.
+* @param ss 画面の大きさ.
+*
+* DrawMode_Spriteのレイヤーは画面と重なるチャンクだけを描画する.
 */
 void TiledMap::Draw(const glm::vec2& ss) const
 {
   for (const auto& e : layers) {
-    if (!e.drawable || !e.visible) {
+    if (!e.drawable || !e.visible || e.chunks.empty()) {
+      continue;
+    }
+    const TileSet& tileset = tilesets[e.tilesetNo];
+    const glm::vec2 offset = position + e.baseOffset + e.offset;
+    if (e.drawMode == DrawMode_IndexTexture) {
+      if (e.indexRenderer) {
+        e.indexRenderer->Draw(*tileset.image, glm::ivec2(tileset.size), tileset.columns, tileset.firstId, offset, ss, e.opacity);
+      }
+      continue;
+    }
+
+    // 画面の範囲をタイル単位の座標に変換する(yは上から下に向かう).
+    const glm::vec2 halfSize = glm::vec2(e.size) * 0.5f;
+    const glm::vec2 minTile = glm::floor(glm::vec2(
+      (-ss.x * 0.5f - offset.x) / tileset.size.x + halfSize.x,
+      halfSize.y - (ss.y * 0.5f - offset.y) / tileset.size.y));
+    const glm::vec2 maxTile = glm::floor(glm::vec2(
+      (ss.x * 0.5f - offset.x) / tileset.size.x + halfSize.x,
+      halfSize.y - (-ss.y * 0.5f - offset.y) / tileset.size.y));
+    if (maxTile.x < 0 || maxTile.y < 0 || minTile.x >= e.size.x || minTile.y >= e.size.y) {
       continue;
     }
-    const_cast<SpriteRenderer&>(*e.renderer).CameraPosition(glm::vec3(-(position + e.baseOffset + e.offset), 0));
-    e.renderer->Draw(ss);
+    const glm::ivec2 minChunk = glm::max(glm::ivec2(minTile), glm::ivec2(0)) / chunkSize;
+    const glm::ivec2 maxChunk = glm::min(glm::ivec2(maxTile), e.size - 1) / chunkSize;
+
+    const glm::vec3 cameraPos(-offset, 0);
+    for (int cy = minChunk.y; cy <= maxChunk.y; ++cy) {
+      for (int cx = minChunk.x; cx <= maxChunk.x; ++cx) {
+        const Chunk& chunk = e.chunks[cy * e.chunkCount.x + cx];
+        if (chunk.renderer) {
+          chunk.renderer->CameraPosition(cameraPos);
+          chunk.renderer->Draw(ss);
+        }
+      }
+    }
   }
 }
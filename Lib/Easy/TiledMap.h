@@ -4,57 +4,159 @@
 #ifndef EASY_TILEDMAP_H_INCLUDED
 #define EASY_TILEDMAP_H_INCLUDED
 #include "Sprite.h"
+#include "TileMapRenderer.h"
+#include "MappedFile.h"
 #include <vector>
+#include <string>
 #include <cstdint>
 
 /**
-* 2D^C}bvǗ.
+* 2Dタイルマップを管理する.
 *
-* Tiled Map EditorGNX|[gꂽJSONt@Cǂݍ݁AvOɂđ\ȃf[^\z.
+* Tiled Map EditorからエクスポートされたJSONファイルを読み込み、プログラムによって操作可能なデータを構築する.
+* Save()またはConvert()で作成したバイナリファイルも読み込める. バイナリファイルはメモリに割り当てて
+* マップデータを直接参照するため、JSONの解析とマップデータのコピーが不要になり、大きなマップでも高速に読み込める.
 *
-* - ǂݍ
+* - 読み込み
 *   TiledMap tm;
 *   tm.Load("json_from_tme.json");
 *
-* - l̎擾.
+* - バイナリ形式への変換.
+*   TiledMap::Convert("json_from_tme.json", "map.bin");
+*
+* - 値の取得.
 *   tm.GetLayer(0)
+*
+* - タイルの変更.
+*   tm.GetLayer(0).Set(y, x, id);
+*   tm.Update();
+*
+* 描画データはレイヤーをchunkSize×chunkSizeタイルのチャンクに分けて構築する.
+* Set()やMarkDirty()で変更されたチャンクだけをUpdate()で再構築し、Draw()では画面に入るチャンクだけを描画する.
+* At()で直接タイルを書き換えた場合はMarkDirty()を呼ぶか、dirtyをtrueにしてレイヤー全体を再構築すること.
+*
+* Tiled Map Editorの無限マップ("infinite": true)は、チャンクごとのマップデータをAt()で参照したときに
+* ファイルから読み込む. Layer::Stream()で指定した範囲の外にあるチャンクは破棄されるため、
+* ステージがどれだけ長くてもメモリの使用量は一定に収まる. 描画データもStream()の範囲内だけに作られる.
+*
+* マップデータは整数の配列のほか、Base64("encoding": "base64")とzlib/gzip圧縮("compression")に対応する.
+* zstd圧縮には対応していない. JSONファイルはJson::Readerで値を作らずに解析し、マップデータを直接展開する.
+*
+* レイヤーのdrawModeをDrawMode_IndexTextureにすると、マップデータを整数テクスチャに格納し、
+* シェーダでタイルを描画する(TileMapRenderer). 頂点データを作らないため、巨大なマップでも
+* 構築と描画の負荷が一定になる. 変更されたチャンクは、その範囲だけをテクスチャに転送する.
 */
 class TiledMap
 {
 public:
-  /// TMXC[.
+  static const int chunkSize = 16; ///< 描画データを構築する単位(チャンク)の縦横のタイル数.
+
+  /// レイヤーを分割した描画単位.
+  struct Chunk
+  {
+    std::unique_ptr<SpriteRenderer> renderer; ///< チャンクの描画オブジェクト. タイルがなければnullptr.
+    bool dirty = true; ///< true=描画データを再構築する. false=構築済み.
+  };
+
+  /// レイヤーの描画方法.
+  enum DrawMode {
+    DrawMode_Sprite, ///< チャンクごとにスプライトとして描画する.
+    DrawMode_IndexTexture, ///< マップデータを格納したテクスチャを使ってシェーダで描画する.
+  };
+
+  /**
+  * 無限マップのマップデータを、チャンク単位で必要になったときに読み込むクラス.
+  *
+  * 読み込み済みのチャンクは、Stream()で指定した範囲から外れたときに破棄される.
+  * ただしMarkModified()で変更が記録されたチャンクは破棄されない.
+  */
+  class LayerStream
+  {
+  public:
+    uint32_t& At(int y, int x);
+    uint32_t Get(int y, int x);
+    bool Stream(const glm::ivec2& tileMin, const glm::ivec2& tileMax);
+    void MarkModified(int y, int x);
+    const glm::ivec2& WindowMin() const { return windowMin; }
+    const glm::ivec2& WindowMax() const { return windowMax; }
+    size_t ChunkCount() const { return chunks.size(); }
+    size_t LoadedChunkCount() const { return loadedCount; }
+
+  private:
+    friend class TiledMap;
+
+    /// ファイル内のチャンク.
+    struct Chunk
+    {
+      glm::ivec2 origin; ///< 左上のタイル位置.
+      const char* dataBegin = nullptr; ///< ファイル内の"data"の先頭. nullptrならファイルにないチャンク.
+      const char* dataEnd = nullptr; ///< ファイル内の"data"の終端.
+      std::vector<uint32_t> data; ///< 読み込んだマップデータ. 空なら未読み込み.
+      bool modified = false; ///< true=変更されているので破棄しない.
+    };
+
+    Chunk* Find(int y, int x);
+    Chunk& FindOrCreate(int y, int x);
+    void Load(Chunk&);
+    void Decode(const Chunk&, uint32_t*) const;
+    void Unload(Chunk&);
+    uint32_t FindFirstTile();
+
+    std::vector<Chunk> chunks; ///< ファイル内のチャンクと、At()で新しく作られたチャンク.
+    std::vector<int> grid; ///< 位置ごとのチャンク番号. -1ならチャンクなし.
+    glm::ivec2 chunkSize = glm::ivec2(16); ///< チャンクの縦横のタイル数.
+    glm::ivec2 gridCount = glm::ivec2(0); ///< 縦横のチャンク数.
+    glm::ivec2 windowMin = glm::ivec2(0); ///< 読み込みを維持するタイル範囲の左上.
+    glm::ivec2 windowMax = glm::ivec2(-1); ///< 読み込みを維持するタイル範囲の右下(範囲に含む).
+    size_t loadedCount = 0; ///< 読み込み済みのチャンク数.
+    std::string encoding; ///< チャンクのマップデータの形式.
+    std::string compression; ///< チャンクのマップデータの圧縮形式.
+  };
+
+  /// TMXレイヤー.
   struct Layer
   {
-    uint32_t& At(int y, int x) { return mapData[y * size.x + x]; }
-    uint32_t At(int y, int x) const { return mapData[y * size.x + x]; }
-
-    std::unique_ptr<SpriteRenderer> renderer; ///< }bv`IuWFNg(ύX֎~).
-    std::vector<uint32_t> mapData; ///< }bvf[^.
-    glm::ivec2 size; ///< }bv̏c̃f[^(ύX֎~).
-    glm::vec2 baseOffset; ///< \ʒů{ItZbg(ύX֎~).
-    glm::vec2 offset; ///< ItZbg␳l.
-    bool visible; ///< \E\𐧌䂷tO. true=`悳. false=`悳Ȃ.
-    bool drawable; ///< `f[^̗L(ύX֎~). true=`\. false=`s.
-    bool dirty; ///< `f[^̍č\z𐧌䂷tO. true=č\z. false=\zς݂܂͕`f[^Ȃ.
-    int tilesetNo; ///< Ή^CZbg̃CfbNX.
-    float opacity; ///< x. 0.0()`1.0(s).
+    uint32_t& At(int y, int x) { return mapData ? mapData[y * size.x + x] : stream->At(y, x); }
+    uint32_t At(int y, int x) const { return mapData ? mapData[y * size.x + x] : stream->Get(y, x); }
+    void Set(int y, int x, uint32_t tile);
+    void MarkDirty(int y, int x);
+    void Stream(const glm::ivec2& tileMin, const glm::ivec2& tileMax);
+
+    std::vector<Chunk> chunks; ///< 描画用チャンク(変更禁止).
+    std::vector<size_t> dirtyChunks; ///< 再構築が必要なチャンクの番号(変更禁止).
+    glm::ivec2 chunkCount; ///< 縦横のチャンク数(変更禁止).
+    TileMapRendererPtr indexRenderer; ///< DrawMode_IndexTexture用の描画オブジェクト(変更禁止).
+    uint32_t* mapData = nullptr; ///< マップデータ(size.x * size.y個). 無限マップではnullptr. ポインタの変更禁止.
+    std::unique_ptr<LayerStream> stream; ///< 無限マップのマップデータ(変更禁止).
+    std::vector<uint32_t> mapDataStorage; ///< JSONから読み込んだマップデータ、またはSave()でファイルから切り離したマップデータの格納先(変更禁止).
+    glm::ivec2 size; ///< マップの縦横のデータ数(変更禁止).
+    glm::vec2 baseOffset; ///< 表示位置の基本オフセット(変更禁止).
+    glm::vec2 offset; ///< オフセット補正値.
+    bool visible; ///< 表示・非表示を制御するフラグ. true=描画される. false=描画されない.
+    bool drawable; ///< 描画データの有無(変更禁止). true=描画可能. false=描画不可.
+    bool dirty; ///< 全チャンクの再構築を制御するフラグ. true=再構築する. false=構築済みまたは描画データなし.
+    int tilesetNo; ///< 対応するタイルセットのインデックス.
+    DrawMode drawMode; ///< 描画方法. 変更した場合はdirtyをtrueにすること.
+    float opacity; ///< 透明度. 0.0(透明)～1.0(不透明).
   };
 
-  /// TMX^CZbg.
+  /// TMXタイルセット.
   struct TileSet
   {
-    glm::vec2 size; ///< ^C̏c̃sNZ.
-    int columns; ///< ̃^C.
-    int firstId; ///< ŏ()^CID.
-    TexturePtr image; ///< eNX`.
+    glm::vec2 size; ///< タイルの縦横のピクセル数.
+    int columns; ///< 横のタイル数.
+    int firstId; ///< 最初の(左上の)タイルのID.
+    std::string imageFilename; ///< テクスチャのファイル名(Resフォルダからの相対パス).
+    std::vector<bool> solid; ///< タイルごとの衝突判定の有無(プロパティ"solid"). 添え字はタイルセット内のタイル番号.
+    TexturePtr image; ///< テクスチャ.
   };
 
-  /// ^Č𐧌䂷tO.
+  /// タイルの向きを制御するフラグ.
   enum Flags {
-    FlipH = 0x8000'0000u, ///< E].
-    FlipV = 0x4000'0000u, ///< ㉺].
-    Rot90 = 0x2000'0000u, ///< 90x].
-    MaskForID = 0x1fff'ffffu, ///< f[^tOOIDo߂̃}XNl.
+    FlipH = 0x8000'0000u, ///< 左右反転.
+    FlipV = 0x4000'0000u, ///< 上下反転.
+    Rot90 = 0x2000'0000u, ///< 90度回転.
+    MaskForID = 0x1fff'ffffu, ///< データからフラグを除外してIDだけを取り出すためのマスク値.
   };
 
   TiledMap() = default;
@@ -64,6 +166,8 @@ public:
   ~TiledMap() = default;
 
   bool Load(const char* filename, uint32_t drawable = 0);
+  bool Save(const char* filename);
+  static bool Convert(const char* jsonFilename, const char* binaryFilename);
   void Unload();
   void Update();
   void Draw(const glm::vec2&) const;
@@ -76,9 +180,21 @@ public:
   const TileSet& GetTileSet(int n) const { return tilesets[n]; }
 
 private:
+  class JsonHandler;
+  struct JsonTileSet;
+  bool LoadJson(const MappedFilePtr&, const char*);
+  bool SetupStream(Layer&, const glm::ivec2&);
+  void LoadTileSets(const std::vector<JsonTileSet>&);
+  void SelectTileSet(Layer&, uint32_t);
+  bool LoadBinary(const MappedFilePtr&, const char*);
+  void DetachMappedFile();
+  void BuildChunk(Layer&, size_t);
+  bool UpdateIndexTexture(Layer&);
+
   std::vector<Layer> layers;
   std::vector<TileSet> tilesets;
   glm::vec2 position;
+  MappedFilePtr mappedFile; ///< バイナリファイルまたは無限マップから読み込んだ場合のファイル.
 };
 
 
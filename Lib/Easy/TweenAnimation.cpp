@@ -9,11 +9,11 @@
 namespace TweenAnimation {
 
 /**
-* RXgN^.
+* コンストラクタ.
 *
-* @param d  쎞.
-* @param e  ԕ@.
-* @param t  [v.
+* @param d  動作時間.
+* @param e  補間方法.
+* @param t  ループ回数.
 */
 Tween::Tween(glm::f32 d, EasingType e, glm::u32 t) :
   duration(d),
@@ -24,10 +24,10 @@ Tween::Tween(glm::f32 d, EasingType e, glm::u32 t) :
 }
 
 /**
-* ԂXV.
+* 状態を更新する.
 *
-* @param node    XVΏۂ̃m[h.
-* @param elapsed oߎ.
+* @param node    更新対象のノード.
+* @param elapsed 経過時間.
 */
 void Tween::UpdateWithEasing(Node& node, glm::f32 elapsed)
 {
@@ -41,7 +41,7 @@ void Tween::UpdateWithEasing(Node& node, glm::f32 elapsed)
   switch (easing) {
   default:
   case EasingType::Linear:
-    /* Ȃ */
+    /* 何もしない */
     break;
   case EasingType::EaseIn:
     ratio *= ratio;
@@ -85,9 +85,9 @@ void Tween::UpdateWithEasing(Node& node, glm::f32 elapsed)
 }
 
 /**
-* 䂷gEB[jOIuWFNgݒ肷.
+* 制御するトウィーニングオブジェクトを設定する.
 *
-* @param p gEB[jOIuWFNgւ̃|C^.
+* @param p トウィーニングオブジェクトへのポインタ.
 */
 void Animate::Tween(const TweenPtr& p)
 {
@@ -97,10 +97,10 @@ void Animate::Tween(const TweenPtr& p)
 }
 
 /**
-* ԂXV.
+* 状態を更新する.
 *
-* @param node  XVΏۂ̃m[h.
-* @param dt    O̍XV̌oߎ.
+* @param node  更新対象のノード.
+* @param dt    前回の更新からの経過時間.
 */
 void Animate::Update(Node& node, glm::f32 dt)
 {
@@ -121,10 +121,10 @@ void Animate::Update(Node& node, glm::f32 dt)
 }
 
 /**
-* RXgN^.
+* コンストラクタ.
 *
-* @param d  쎞.
-* @param v  ړ鋗.
+* @param d  動作時間.
+* @param v  移動する距離.
 */
 MoveBy::MoveBy(glm::f32 d, const glm::vec3& v, EasingType e, Target t)
   : Tween(d, e)
@@ -134,9 +134,9 @@ MoveBy::MoveBy(glm::f32 d, const glm::vec3& v, EasingType e, Target t)
 }
 
 /**
-* ړԂ.
+* 移動状態を初期化する.
 *
-* @param node Ώۂ̃m[h.
+* @param node 制御対象のノード.
 */
 void MoveBy::Initialize(Node& node)
 {
@@ -145,10 +145,10 @@ void MoveBy::Initialize(Node& node)
 }
 
 /**
-* ړԂXV.
+* 移動状態を更新する.
 *
-* @param node    XVΏۂ̃m[h.
-* @param elapsed oߎ.
+* @param node    更新対象のノード.
+* @param elapsed 経過時間.
 */
 void MoveBy::Update(Node& node, glm::f32 elapsed)
 {
@@ -168,9 +168,9 @@ void MoveBy::Update(Node& node, glm::f32 elapsed)
 }
 
 /**
-* gEB[jOIuWFNgǉ.
+* トウィーニングオブジェクトを追加する.
 *
-* @param p ǉgEB[jOIuWFNg.
+* @param p 追加するトウィーニングオブジェクト.
 */
 void Sequence::Add(const TweenPtr& p)
 {
@@ -179,9 +179,9 @@ void Sequence::Add(const TweenPtr& p)
 }
 
 /**
-* ̃gEB[jOIuWFNgݒ肷.
+* 次のトウィーニングオブジェクトを設定する.
 *
-* @param node Ώۂ̃m[h.
+* @param node 制御対象のノード.
 */
 bool Sequence::NextTween(Node& node)
 {
@@ -196,9 +196,9 @@ bool Sequence::NextTween(Node& node)
 }
 
 /**
-* gEB[jO.
+* トウィーニング列を初期化する.
 *
-* @param node Ώۂ̃m[h.
+* @param node 制御対象のノード.
 */
 void Sequence::Initialize(Node& node)
 {
@@ -209,10 +209,10 @@ void Sequence::Initialize(Node& node)
 }
 
 /**
-* gEB[jOXV.
+* トウィーニング列を更新する.
 *
-* @param node    XVΏۂ̃m[h.
-* @param elapsed oߎ.
+* @param node    更新対象のノード.
+* @param elapsed 経過時間.
 */
 void Sequence::Update(Node& node, glm::f32 elapsed)
 {
@@ -229,9 +229,9 @@ void Sequence::Update(Node& node, glm::f32 elapsed)
 }
 
 /**
-* ړԂ.
+* 移動状態を初期化する.
 *
-* @param node Ώۂ̃m[h.
+* @param node 制御対象のノード.
 */
 void Parallelize::Initialize(Node& node)
 {
@@ -242,10 +242,10 @@ void Parallelize::Initialize(Node& node)
 }
 
 /**
-* ړԂXV.
+* 移動状態を更新する.
 *
-* @param node    XVΏۂ̃m[h.
-* @param elapsed oߎ.
+* @param node    更新対象のノード.
+* @param elapsed 経過時間.
 */
 void Parallelize::Update(Node& node, glm::f32 elapsed)
 {
@@ -258,9 +258,9 @@ void Parallelize::Update(Node& node, glm::f32 elapsed)
 }
 
 /**
-* ɎsgEB[jOIuWFNgǉ.
+* 並列に実行するトウィーニングオブジェクトを追加する.
 *
-* @param p ǉgEB[jOIuWFNg.
+* @param p 追加するトウィーニングオブジェクト.
 */
 void Parallelize::Add(const TweenPtr& p)
 {
@@ -279,9 +279,9 @@ void RemoveFromParent::Update(Node& node, glm::f32 elapsed)
 }
 
 /**
-* ]Aj[V.
+* 回転アニメーションを初期化する.
 *
-* @param node Ώۂ̃m[h.
+* @param node 制御対象のノード.
 */
 void Rotation::Initialize(Node& node)
 {
@@ -289,10 +289,10 @@ void Rotation::Initialize(Node& node)
 }
 
 /**
-* ]Aj[VXV.
+* 回転アニメーションを更新する.
 *
-* @param node    XVΏۂ̃m[h.
-* @param elapsed oߎ.
+* @param node    更新対象のノード.
+* @param elapsed 経過時間.
 */
 void Rotation::Update(Node& node, glm::f32 dt)
 {
@@ -301,12 +301,12 @@ void Rotation::Update(Node& node, glm::f32 dt)
 }
 
 /**
-* RXgN^.
+* コンストラクタ.
 *
-* @param d  쎞.
-* @param v  gEk.
-* @param e  ԕ@.
-* @param t  ΏۂƂ鎲.
+* @param d  動作時間.
+* @param v  拡大・縮小率.
+* @param e  補間方法.
+* @param t  操作対象とする軸.
 */
 Scaling::Scaling(glm::f32 d, const glm::vec2& v, EasingType e, Target t)
   : Tween(d, e)
@@ -316,9 +316,9 @@ Scaling::Scaling(glm::f32 d, const glm::vec2& v, EasingType e, Target t)
 }
 
 /**
-* gEkAj[V.
+* 拡大・縮小アニメーションを初期化する.
 *
-* @param node Ώۂ̃m[h.
+* @param node 制御対象のノード.
 */
 void Scaling::Initialize(Node& node)
 {
@@ -327,10 +327,10 @@ void Scaling::Initialize(Node& node)
 }
 
 /**
-* gEkAj[VXV.
+* 拡大・縮小アニメーションを更新する.
 *
-* @param node    XVΏۂ̃m[h.
-* @param elapsed oߎ.
+* @param node    更新対象のノード.
+* @param elapsed 経過時間.
 */
 void Scaling::Update(Node& node, glm::f32 elapsed)
 {
@@ -347,7 +347,7 @@ void Scaling::Update(Node& node, glm::f32 elapsed)
 }
 
 /**
-* RXgN^.
+* コンストラクタ.
 */
 RemoveIfOutOfArea::RemoveIfOutOfArea(const glm::vec2& origin, const glm::vec2& size) :
   Tween(100, TweenAnimation::EasingType::Linear), origin(origin), size(size)
@@ -355,10 +355,10 @@ RemoveIfOutOfArea::RemoveIfOutOfArea(const glm::vec2& origin, const glm::vec2& s
 }
 
 /**
-* XV.
+* 更新.
 *
-* @param node    XVΏۂ̃m[h.
-* @param elapsed oߎ.
+* @param node    更新対象のノード.
+* @param elapsed 経過時間.
 */
 void RemoveIfOutOfArea::Update(Node& node, glm::f32 dt)
 {
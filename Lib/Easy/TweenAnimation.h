@@ -11,7 +11,7 @@ class Node;
 
 namespace TweenAnimation {
 
-// s錾.
+// 先行宣言.
 class Animate;
 class Tween;
 class MoveBy;
@@ -34,32 +34,32 @@ using RemoveFromParentPtr = std::shared_ptr<RemoveFromParent>;
 using RemoveIfOutOfAreaPtr = std::shared_ptr<RemoveIfOutOfArea>;
 
 /**
-* C[WO̎.
+* イージングの種類.
 */
 enum class EasingType {
-  Linear, ///< .
-  EaseIn, ///< .
-  EaseOut, ///< .
-  EaseInOut, ///< +.
-  EaseOutBack, ///< (s߂Ă߂ĂĒ~).
-  EaseOutBounce, ///< (I_ŉxeł~).
+  Linear, ///< 等速.
+  EaseIn, ///< 加速.
+  EaseOut, ///< 減速.
+  EaseInOut, ///< 加速+減速.
+  EaseOutBack, ///< 減速(少し行き過ぎてから戻ってきて停止).
+  EaseOutBounce, ///< 減速(終点で何度か弾んでから停止).
 };
 
 /**
-* Aj[VKpvf.
+* アニメーションを適用する要素.
 */
 enum class Target {
-  X = 1, ///< Xvf̂.
-  Y = 2, ///< Yvf̂.
-  XY = 3, ///< XvfYvf.
-  Z = 4, ///< Zvf̂.
-  XZ = 5, ///< XvfZvf.
-  YZ = 6, ///< YvfZvf.
-  XYZ = 7 ///< SĂ̗vf.
+  X = 1, ///< X要素のみ.
+  Y = 2, ///< Y要素のみ.
+  XY = 3, ///< X要素とY要素.
+  Z = 4, ///< Z要素のみ.
+  XZ = 5, ///< X要素とZ要素.
+  YZ = 6, ///< Y要素とZ要素.
+  XYZ = 7 ///< 全ての要素.
 };
 
 /**
-* gEB[jO{NX.
+* トウィーニング基本クラス.
 */
 class Tween
 {
@@ -85,15 +85,15 @@ public:
   virtual void Update(Node&, glm::f32 ratio) = 0;
 
 private:
-  glm::f32 duration = 1.0f; ///< 쎞.
-  glm::f32 reciprocalDuration = 1.0f; ///< 쎞Ԃ̋t.
+  glm::f32 duration = 1.0f; ///< 動作時間.
+  glm::f32 reciprocalDuration = 1.0f; ///< 動作時間の逆数.
   glm::f32 times = 1.0f;
   EasingType easing = EasingType::Linear;
   glm::u32 total = 0;
 };
 
 /**
-* gEB[jO𐧌䂷NX.
+* トウィーニングを制御するクラス.
 */
 class Animate
 {
@@ -118,16 +118,16 @@ public:
   void Update(Node&, glm::f32);
 
 private:
-  glm::f32 elapsed = 0.0f; ///< oߎ.
+  glm::f32 elapsed = 0.0f; ///< 経過時間.
   bool isInitialized = false;
-  bool isPause = false; ///< Ԍo߂ꎞ~邩ǂ.
-  bool isLoop = false; ///< [vĐsǂ.
+  bool isPause = false; ///< 時間経過を一時停止するかどうか.
+  bool isLoop = false; ///< ループ再生を行うかどうか.
 
   TweenPtr tween;
 };
 
 /**
-* ړAj[V.
+* 移動アニメーション.
 */
 class MoveBy : public Tween
 {
@@ -147,13 +147,13 @@ public:
   virtual void Update(Node&, glm::f32) override;
 
 private:
-  glm::vec3 start; ///< ړJnW.
-  glm::vec3 vector; ///< ړ鋗.
-  Target target = Target::XYZ; ///< Ώ.
+  glm::vec3 start; ///< 移動開始座標.
+  glm::vec3 vector; ///< 移動する距離.
+  Target target = Target::XYZ; ///< 操作対象.
 };
 
 /**
-* gEB[jO̗.
+* トウィーニングの列.
 */
 class Sequence : public Tween
 {
@@ -172,14 +172,14 @@ public:
 private:
   bool NextTween(Node&);
 
-  std::vector<TweenPtr> seq; ///< gEB[jOXg.
-  int index = -1;///< s̃gEB[jOIuWFNg̃CfbNX.
-  glm::f32 currentDurationBegin;///< s̃gEB[jOIuWFNg̊Jn.
-  glm::f32 currentDurationEnd;///< s̃gEB[jOIuWFNg̏I.
+  std::vector<TweenPtr> seq; ///< トウィーニングリスト.
+  int index = -1;///< 実行中のトウィーニングオブジェクトのインデックス.
+  glm::f32 currentDurationBegin;///< 実行中のトウィーニングオブジェクトの開始時間.
+  glm::f32 currentDurationEnd;///< 実行中のトウィーニングオブジェクトの終了時間.
 };
 
 /**
-* m[ḧړAj[V.
+* ノードの移動アニメーション.
 */
 class Parallelize : public Tween
 {
@@ -200,7 +200,7 @@ private:
 };
 
 /**
-* w肳ꂽԉȂ.
+* 指定された期間何もしない.
 */
 class Wait : public TweenAnimation::Tween
 {
@@ -212,7 +212,7 @@ public:
 };
 
 /**
-* em[h폜.
+* 親ノードから削除.
 */
 class RemoveFromParent : public TweenAnimation::Tween
 {
@@ -223,7 +223,7 @@ public:
 };
 
 /**
-* ]Aj[V.
+* 回転アニメーション.
 */
 class Rotation : public Tween
 {
@@ -243,7 +243,7 @@ private:
 };
 
 /**
-* gEkAj[V.
+* 拡大・縮小アニメーション.
 */
 class Scaling : public Tween
 {
@@ -263,13 +263,13 @@ public:
   virtual void Update(Node&, glm::f32) override;
 
 private:
-  glm::vec2 start; ///< ړJnW.
-  glm::vec2 vector; ///< ړ鋗.
-  Target target = Target::XY; ///< Ώ.
+  glm::vec2 start; ///< 移動開始座標.
+  glm::vec2 vector; ///< 移動する距離.
+  Target target = Target::XY; ///< 操作対象.
 };
 
 /**
-* ͈͊Oɏoem[h폜.
+* 範囲外に出たら親ノードから削除する.
 */
 class RemoveIfOutOfArea : public TweenAnimation::Tween {
 public:
@@ -2,36 +2,35 @@
 * @file UniformBuffer.cpp
 */
 #include "UniformBuffer.h"
+#include "RenderBackend.h"
 #include <iostream>
 
 /**
-* Uniformobt@쐬.
+* Uniformバッファを作成する.
 *
-* @param size         obt@̃oCgTCY.
-* @param bindingPoint obt@蓖ĂoCfBOE|Cg.
-* @param name         obt@(fobOp).
+* @param size         バッファのバイトサイズ.
+* @param bindingPoint バッファを割り当てるバインディング・ポイント.
+* @param name         バッファ名(デバッグ用).
 *
-* @return 쐬Uniformobt@ւ̃|C^.
+* @return 作成したUniformバッファへのポインタ.
 */
 UniformBufferPtr UniformBuffer::Create(GLsizeiptr size, GLuint bindingPoint, const char* name)
 {
   struct Impl : UniformBuffer { Impl() {} ~Impl() {} };
   UniformBufferPtr p = std::make_shared<Impl>();
   if (!p) {
-    std::cerr << "ERROR: UBO '" << name << "'̍쐬Ɏs" << std::endl;
+    std::cerr << "ERROR: UBO '" << name << "'の作成に失敗" << std::endl;
     return {};
   }
 
-  glGenBuffers(1, &p->ubo);
-  glBindBuffer(GL_UNIFORM_BUFFER, p->ubo);
-  glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
-  glBindBufferBase(GL_UNIFORM_BUFFER, bindingPoint, p->ubo);
-  const GLenum result = glGetError();
+  RenderBackend::Backend& backend = RenderBackend::Get();
+  p->ubo = backend.CreateBuffer(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+  backend.BindBufferBase(GL_UNIFORM_BUFFER, bindingPoint, p->ubo);
+  const GLenum result = backend.GetError();
   if (result != GL_NO_ERROR) {
-    std::cerr << "ERROR: UBO '" << name << "'̍쐬Ɏs" << std::endl;
+    std::cerr << "ERROR: UBO '" << name << "'の作成に失敗" << std::endl;
     return {};
   }
-  glBindBuffer(GL_UNIFORM_BUFFER, 0);
 
   p->size = size;
   p->bindingPoint = bindingPoint;
@@ -40,69 +39,67 @@ UniformBufferPtr UniformBuffer::Create(GLsizeiptr size, GLuint bindingPoint, con
 }
 
 /**
-* fXgN^.
+* デストラクタ.
 */
 UniformBuffer::~UniformBuffer()
 {
   if (ubo) {
-    glDeleteBuffers(1, &ubo);
+    RenderBackend::Get().DeleteBuffer(ubo);
   }
 }
 
 /**
-* Uniformobt@Ƀf[^].
+* Uniformバッファにデータを転送する.
 *
-* @param data   ]f[^ւ̃|C^.
-* @param offset ]̃oCgItZbg.
-* @param size   ]oCg.
+* @param data   転送するデータへのポインタ.
+* @param offset 転送先のバイトオフセット.
+* @param size   転送するバイト数.
 *
-* @retval true  ].
-* @retval false ]s.
+* @retval true  転送成功.
+* @retval false 転送失敗.
 *
-* offsetsize̗0̏ꍇAobt@TCY=UBOTCYƂē].
+* offsetとsizeの両方が0の場合、バッファサイズ=UBOサイズとして転送される.
 */
 bool UniformBuffer::BufferSubData(const GLvoid* data, GLintptr offset, GLsizeiptr size)
 {
   if (offset + size > this->size) {
-    std::cerr << "ERROR(" << name << "): ]͈͂obt@TCYzĂ܂(buffer=" <<
+    std::cerr << "ERROR(" << name << "): 転送範囲がバッファサイズを越えています(buffer=" <<
       this->size << " offset=" << offset << " size=" << size << ")" << std::endl;
     return false;
   }
   if (offset == 0 && size == 0) {
     size = this->size;
   }
-  glBindBuffer(GL_UNIFORM_BUFFER, ubo);
-  glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data);
+  RenderBackend::Get().BufferSubData(GL_UNIFORM_BUFFER, ubo, offset, size, data);
   return true;
 }
 
 /**
-* w肳ꂽ͈͂oCfBOE|CgɊ蓖Ă.
+* 指定された範囲をバインディング・ポイントに割り当てる.
 *
-* @param offset 蓖Ă͈͂̃oCgItZbg.
-* @param size   蓖Ă͈͂̃oCg.
+* @param offset 割り当てる範囲のバイトオフセット.
+* @param size   割り当てる範囲のバイト数.
 */
 void UniformBuffer::BindBufferRange(GLintptr offset, GLsizeiptr size) const
 {
-  glBindBufferRange(GL_UNIFORM_BUFFER, bindingPoint, ubo, offset, size);
+  RenderBackend::Get().BindBufferRange(GL_UNIFORM_BUFFER, bindingPoint, ubo, offset, size);
 }
 
 /**
-* UBOVXeɃ}bv.
+* UBOをシステムメモリにマップする.
 *
-* @return }bvւ̃|C^.
+* @return マップしたメモリへのポインタ.
 */
 void* UniformBuffer::MapBuffer() const
 {
-  glBindBuffer(GL_UNIFORM_BUFFER, ubo);
-  return glMapBufferRange(
-    GL_UNIFORM_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+  return RenderBackend::Get().MapBufferRange(
+    GL_UNIFORM_BUFFER, ubo, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
 }
 
 /**
-* obt@̊蓖Ă.
+* バッファの割り当てを解除する.
 */
 void UniformBuffer::UnmapBuffer() const
 {
-  glUnmapBuffer(GL_UNIFORM_BUFFER);
+  RenderBackend::Get().UnmapBuffer(GL_UNIFORM_BUFFER, ubo);
 }
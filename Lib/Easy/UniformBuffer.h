@@ -8,10 +8,10 @@
 #include <memory>
 
 class UniformBuffer;
-typedef std::shared_ptr<UniformBuffer> UniformBufferPtr; ///< UBO|C^^.
+typedef std::shared_ptr<UniformBuffer> UniformBufferPtr; ///< UBOポインタ型.
 
 /**
-* UBONX.
+* UBOクラス.
 */
 class UniformBuffer {
 public:
@@ -32,9 +32,9 @@ private:
 
 private:
   GLuint ubo = 0; ///< Uniform Buffer Object.
-  GLsizeiptr size = 0; ///< UBÕoCgTCY.
-  GLuint bindingPoint; ///< UBO̊蓖ĂĐoCfBOE|Cg.
-  std::string name; ///< UBO.
+  GLsizeiptr size = 0; ///< UBOのバイトサイズ.
+  GLuint bindingPoint; ///< UBOの割り当てて先バインディング・ポイント.
+  std::string name; ///< UBO名.
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,120 @@
+/**
+* @file ViewBuffer.cpp
+*/
+#include "ViewBuffer.h"
+#include "RenderBackend.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <iostream>
+
+const size_t ViewBuffer::frameCount;
+
+/**
+* ビューバッファを作成する.
+*
+* @param viewsPerFrame 1フレームで使用できるビューの数.
+* @param bindingPoint  ViewDataブロックを割り当てるバインディング・ポイント.
+*
+* @return 作成したビューバッファへのポインタ.
+*/
+ViewBufferPtr ViewBuffer::Create(size_t viewsPerFrame, GLuint bindingPoint)
+{
+  if (viewsPerFrame == 0) {
+    viewsPerFrame = 1;
+  }
+
+  // BindBufferRangeのオフセットはGL_UNIFORM_BUFFER_OFFSET_ALIGNMENTの倍数でなければならない.
+  GLint alignment = RenderBackend::Get().GetInteger(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT);
+  if (alignment <= 0) {
+    alignment = 256;
+  }
+  const GLsizeiptr slotSize = (sizeof(ViewData) + alignment - 1) / alignment * alignment;
+
+  struct Impl : ViewBuffer { Impl() {} ~Impl() {} };
+  ViewBufferPtr p = std::make_shared<Impl>();
+  p->ubo = UniformBuffer::Create(slotSize * viewsPerFrame * frameCount, bindingPoint, BlockName());
+  if (!p->ubo) {
+    std::cerr << "ERROR: ビューバッファの作成に失敗" << std::endl;
+    return {};
+  }
+  p->slotSize = slotSize;
+  p->viewsPerFrame = viewsPerFrame;
+  p->slotList.reserve(viewsPerFrame);
+  return p;
+}
+
+/**
+* 新しいフレームを開始する.
+*
+* @param deltaTime 前フレームからの経過時間(秒).
+*
+* リング上の次のフレーム領域に切り替え、前のフレームで転送したビュー情報を破棄する.
+*/
+void ViewBuffer::BeginFrame(float deltaTime)
+{
+  this->deltaTime = deltaTime;
+  time += deltaTime;
+  frame = (frame + 1) % frameCount;
+  slotList.clear();
+}
+
+/**
+* ビュー情報をバインディング・ポイントに割り当てる.
+*
+* @param cameraPos  カメラの座標.
+* @param screenSize 画面サイズ.
+*
+* @retval true  割り当て成功.
+* @retval false 割り当て失敗.
+*
+* 同じフレームで同じカメラ位置と画面サイズが既に割り当てられていれば、そのスロットを再利用する.
+* そうでなければ新しいスロットにビュー情報を転送する.
+* スロットが足りない場合は最後のスロットを上書きする(正しく描画されるが、GPUとの同期待ちが発生しうる).
+*/
+bool ViewBuffer::Bind(const glm::vec3& cameraPos, const glm::vec2& screenSize)
+{
+  const GLintptr frameOffset = slotSize * static_cast<GLintptr>(viewsPerFrame * frame);
+  for (size_t i = 0; i < slotList.size(); ++i) {
+    if (slotList[i].cameraPos == cameraPos && slotList[i].screenSize == screenSize) {
+      ubo->BindBufferRange(frameOffset + slotSize * i, sizeof(ViewData));
+      return true;
+    }
+  }
+
+  size_t index = slotList.size();
+  if (index < viewsPerFrame) {
+    slotList.push_back({ cameraPos, screenSize });
+  } else {
+    index = viewsPerFrame - 1;
+    slotList[index] = { cameraPos, screenSize };
+  }
+
+  ViewData data;
+  data.matProj = glm::ortho(-screenSize.x * 0.5f, screenSize.x * 0.5f, -screenSize.y * 0.5f, screenSize.y * 0.5f, 200.0f, 1200.0f);
+  //data.matProj = glm::perspective(glm::radians(45.0f), screenSize.x / screenSize.y, 200.0f, 1200.0f);
+  data.matView = glm::lookAt(glm::vec3(cameraPos.x, cameraPos.y, glm::tan(glm::radians(90.0f - 22.5f)) * screenSize.y * 0.5f), cameraPos, glm::vec3(0, 1, 0));
+  data.matViewProj = data.matProj * data.matView;
+  data.screenSize = screenSize;
+  data.time = time;
+  data.deltaTime = deltaTime;
+
+  const GLintptr offset = frameOffset + slotSize * index;
+  if (!ubo->BufferSubData(&data, offset, sizeof(ViewData))) {
+    return false;
+  }
+  ubo->BindBufferRange(offset, sizeof(ViewData));
+  return true;
+}
+
+/**
+* プログラムのViewDataブロックをこのバッファのバインディング・ポイントに割り当てる.
+*
+* @param program 割り当てるプログラム.
+*
+* @retval true  割り当て成功.
+* @retval false 割り当て失敗.
+*/
+bool ViewBuffer::UniformBlockBinding(Shader::Program& program) const
+{
+  static const Shader::NameId blockId = Shader::MakeNameId("ViewData");
+  return program.UniformBlockBinding(blockId, ubo->BindingPoint());
+}
@@ -0,0 +1,71 @@
+/**
+* @file ViewBuffer.h
+*/
+#ifndef VIEWBUFFER_H_INCLUDED
+#define VIEWBUFFER_H_INCLUDED
+#include "UniformBuffer.h"
+#include "Shader.h"
+#include <glm/glm.hpp>
+#include <vector>
+#include <memory>
+
+class ViewBuffer;
+typedef std::shared_ptr<ViewBuffer> ViewBufferPtr; ///< ビューバッファポインタ型.
+
+/**
+* フレーム単位のビュー情報.
+*
+* シェーダ側のViewDataブロック(std140)と同じ配置にすること.
+*/
+struct ViewData
+{
+  glm::mat4x4 matProj; ///< 射影行列.
+  glm::mat4x4 matView; ///< ビュー行列.
+  glm::mat4x4 matViewProj; ///< 射影行列 * ビュー行列.
+  glm::vec2 screenSize; ///< 画面サイズ.
+  float time; ///< 起動してからの経過時間(秒).
+  float deltaTime; ///< 前フレームからの経過時間(秒).
+};
+
+/**
+* ビュー情報を格納するUBOのリングバッファ.
+*
+* カメラ位置と画面サイズの組み合わせごとに1スロットを割り当て、フレーム中に同じ組み合わせが
+* 再び使われた場合は転送済みのスロットをBindBufferRangeで割り当て直すだけにする.
+* GPUが使用中のスロットを上書きしないように、リングは複数フレーム分のスロットを持つ.
+*/
+class ViewBuffer
+{
+public:
+  static ViewBufferPtr Create(size_t viewsPerFrame, GLuint bindingPoint);
+
+  void BeginFrame(float deltaTime);
+  bool Bind(const glm::vec3& cameraPos, const glm::vec2& screenSize);
+  bool UniformBlockBinding(Shader::Program& program) const;
+  GLuint BindingPoint() const { return ubo->BindingPoint(); }
+
+  static const char* BlockName() { return "ViewData"; }
+  static const size_t frameCount = 3; ///< リングに含めるフレーム数.
+
+private:
+  ViewBuffer() = default;
+  ~ViewBuffer() = default;
+  ViewBuffer(const ViewBuffer&) = delete;
+  ViewBuffer& operator=(const ViewBuffer&) = delete;
+
+  /// スロットに格納したビューの識別情報.
+  struct Slot {
+    glm::vec3 cameraPos;
+    glm::vec2 screenSize;
+  };
+
+  UniformBufferPtr ubo;
+  GLsizeiptr slotSize = 0; ///< 1スロットのバイト数(オフセット・アライメント込み).
+  size_t viewsPerFrame = 0; ///< 1フレームで使えるスロット数.
+  size_t frame = 0; ///< 現在のフレームのリング内番号.
+  std::vector<Slot> slotList; ///< 現在のフレームで使用中のスロット.
+  float time = 0; ///< 起動してからの経過時間.
+  float deltaTime = 0; ///< 前フレームからの経過時間.
+};
+
+#endif // VIEWBUFFER_H_INCLUDED
@@ -9,12 +9,19 @@ layout(location=0) out vec4 outColor;
 layout(location=1) out vec2 outTexCoord;
 layout(location=2) flat out int outBlendMode;
 
-uniform mat4x4 matMVP;
+layout(std140) uniform ViewData {
+  mat4x4 matProj;
+  mat4x4 matView;
+  mat4x4 matViewProj;
+  vec2 screenSize;
+  float time;
+  float deltaTime;
+} viewData;
 
 void main()
 {
   outColor = vColor;
   outTexCoord = vTexCoord;
   outBlendMode = vBlendMode;
-  gl_Position = matMVP * vec4(vPosition, 1.0);
+  gl_Position = viewData.matViewProj * vec4(vPosition, 1.0);
 }
\ No newline at end of file
@@ -0,0 +1,53 @@
+#version 410
+
+layout(location=0) in vec2 inPosition;
+
+uniform sampler2D colorSampler;
+uniform usampler2D mapSampler;
+
+// x=マップの横のタイル数, y=縦のタイル数, z=タイルセットの横のタイル数, w=最初のタイルのID.
+uniform ivec4 mapInfo;
+// xy=タイルの大きさ, zw=タイルセットの左上の位置.
+uniform ivec4 tileInfo;
+uniform vec4 color;
+
+out vec4 fragColor;
+
+const uint FlipH = 0x80000000u;
+const uint FlipV = 0x40000000u;
+const uint Rot90 = 0x20000000u;
+const uint MaskForID = 0x1fffffffu;
+
+void main()
+{
+  // マップ上の位置(yは上から下に向かう).
+  vec2 tilePos = vec2(inPosition.x / float(tileInfo.x) + float(mapInfo.x) * 0.5,
+    float(mapInfo.y) * 0.5 - inPosition.y / float(tileInfo.y));
+  ivec2 cell = ivec2(floor(tilePos));
+  if (any(lessThan(cell, ivec2(0))) || any(greaterThanEqual(cell, mapInfo.xy))) {
+    discard;
+  }
+  uint data = texelFetch(mapSampler, cell, 0).r;
+  int tileId = int(data & MaskForID) - mapInfo.w;
+  if (tileId < 0) {
+    discard;
+  }
+
+  // タイル内の位置(yは下から上に向かう)に反転・回転を適用する.
+  vec2 uv = vec2(fract(tilePos.x), 1.0 - fract(tilePos.y));
+  if ((data & Rot90) != 0u) {
+    uv = uv.yx;
+  }
+  if ((data & FlipH) != 0u) {
+    uv.x = 1.0 - uv.x;
+  }
+  if ((data & FlipV) != 0u) {
+    uv.y = 1.0 - uv.y;
+  }
+
+  // 線形補間で隣のタイルがにじまないように、テクセルを直接読み出す.
+  ivec2 tileSize = tileInfo.xy;
+  ivec2 origin = ivec2(tileId % mapInfo.z, -(tileId / mapInfo.z + 1)) * tileSize + tileInfo.zw;
+  ivec2 texel = origin + min(ivec2(uv * vec2(tileSize)), tileSize - 1);
+  fragColor = texelFetch(colorSampler, texel, 0) * color;
+}
@@ -0,0 +1,14 @@
+#version 410
+
+layout(location=0) out vec2 outPosition;
+
+// xy=マップ中心の表示位置, zw=画面の大きさ.
+uniform vec4 viewInfo;
+
+void main()
+{
+  // インデックス0～3の頂点から画面全体を覆う四角形を作る.
+  vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 2.0 - 1.0;
+  outPosition = corner * viewInfo.zw * 0.5 - viewInfo.xy;
+  gl_Position = vec4(corner, 0.0, 1.0);
+}
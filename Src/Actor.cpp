@@ -4,13 +4,13 @@
 #include "Actor.h"
 
 /**
-* 2̒`̏ՓˏԂ𒲂ׂ.
+* 2つの長方形の衝突状態を調べる.
 *
-* @param lhs `1.
-* @param rhs `2.
+* @param lhs 長方形その1.
+* @param rhs 長方形その2.
 *
-* @retval true  Փ˂Ă.
-* @retval false Փ˂ĂȂ.
+* @retval true  衝突している.
+* @retval false 衝突していない.
 */
 bool detectCollision(const Rect* lhs, const Rect* rhs)
 {
@@ -22,10 +22,10 @@ bool detectCollision(const Rect* lhs, const Rect* rhs)
 }
 
 /**
-* Actor̔z.
+* Actorの配列を初期化する.
 *
-* @param first Ώۂ̐擪vf̃|C^.
-* @param last  Ώۂ̏I[vf̃|C^.
+* @param first 初期化対象の先頭要素のポインタ.
+* @param last  初期化対象の終端要素のポインタ.
 */
 void initializeActorList(Actor* first, Actor* last)
 {
@@ -36,15 +36,15 @@ void initializeActorList(Actor* first, Actor* last)
 }
 
 /**
-* p\ȂActor擾.
+* 利用可能なのActorを取得する.
 *
-* @param first Ώۂ̐擪vf̃|C^.
-* @param last  Ώۂ̏I[vf̃|C^.
+* @param first 検索対象の先頭要素のポインタ.
+* @param last  検索対象の終端要素のポインタ.
 *
-* @return p\Actor̃|C^.
-*         p\ActorȂnullptr.
+* @return 利用可能なActorのポインタ.
+*         利用可能なActorが見つからなければnullptr.
 *
-* [first, last)͈̔͂Ap\(health0ȉ)Actor.
+* [first, last)の範囲から、利用可能な(healthが0以下の)Actorを検索する.
 */
 Actor* findAvailableActor(Actor* first, Actor* last)
 {
@@ -57,11 +57,11 @@ Actor* findAvailableActor(Actor* first, Actor* last)
 }
 
 /**
-* Actor̔zXV.
+* Actorの配列を更新する.
 *
-* @param first     XVΏۂ̐擪vf̃|C^.
-* @param last      XVΏۂ̏I[vf̃|C^.
-* @param deltaTime O̍XV̌oߎ.
+* @param first     更新対象の先頭要素のポインタ.
+* @param last      更新対象の終端要素のポインタ.
+* @param deltaTime 前回の更新からの経過時間.
 */
 void updateActorList(Actor* first, Actor* last, float deltaTime)
 {
@@ -76,11 +76,11 @@ void updateActorList(Actor* first, Actor* last, float deltaTime)
 }
 
 /**
-* Actor̔z`悷.
+* Actorの配列を描画する.
 *
-* @param first    `Ώۂ̐擪vf̃|C^.
-* @param last     `Ώۂ̏I[vf̃|C^.
-" @param renderer XvCg`p̕ϐ.
+* @param first    描画対象の先頭要素のポインタ.
+* @param last     描画対象の終端要素のポインタ.
+" @param renderer スプライト描画用の変数.
 */
 void renderActorList(const Actor* first, const Actor* last, SpriteRenderer* renderer)
 {
@@ -92,13 +92,13 @@ void renderActorList(const Actor* first, const Actor* last, SpriteRenderer* rend
 }
 
 /**
-* Փ˂o.
+* 衝突を検出する.
 *
-* @param firstA    Փ˂zA̐擪|C^.
-* @param lastA     Փ˂zȀI[|C^.
-* @param firstB    Փ˂zB̐擪|C^.
-* @param lastB     Փ˂zB̏I[|C^.
-* @param function  A-BԂŏՓ˂oꂽƂɎs֐.
+* @param firstA    衝突させる配列Aの先頭ポインタ.
+* @param lastA     衝突させる配列Aの終端ポインタ.
+* @param firstB    衝突させる配列Bの先頭ポインタ.
+* @param lastB     衝突させる配列Bの終端ポインタ.
+* @param function  A-B間で衝突が検出されたときに実行する関数.
 */
 void detectCollision(Actor* firstA, Actor* lastA, Actor* firstB, Actor* lastB, CollisionHandlerType function)
 {
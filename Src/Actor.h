@@ -5,14 +5,14 @@
 #include "Sprite.h"
 
 /**
-* Q[LN^[\.
+* ゲームキャラクター構造体.
 */
 struct Actor
 {
-  Sprite spr; // XvCg.
-  Rect collisionShape; // Փ˔̈ʒuƑ傫.
-  int health; // ϋv.
-  int type; // .
+  Sprite spr; // スプライト.
+  Rect collisionShape; // 衝突判定の位置と大きさ.
+  int health; // 耐久力.
+  int type; // 種類.
 };
 
 bool detectCollision(const Rect* lhs, const Rect* rhs);
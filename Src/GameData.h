@@ -9,13 +9,15 @@ struct TitleScene;
 struct GameOverScene;
 struct MainScene;
 
-extern SpriteRenderer renderer; // XvCg`pϐ.
-extern FontRenderer fontRenderer; // tHg`pϐ.
+extern SpriteRenderer renderer; // スプライト描画用変数.
+extern FontRenderer fontRenderer; // フォント描画用変数.
 
 const int gamestateTitle = 0;
 const int gamestateMain = 1;
 const int gamestateGameover = 2;
-extern int gamestate; // Q[̏.
+extern int gamestate; // ゲームの状態.
+
+void renderProfiler();
 
 extern TitleScene titleScene;
 extern GameOverScene gameOverScene;
@@ -6,24 +6,24 @@
 #include "GameData.h"
 
 /**
-* Q[I[o[ʂ̏ݒs.
+* ゲームオーバー画面の初期設定を行う.
 *
-* @param scene     Q[I[o[ʗp\̂̃|C^.
+* @param scene     ゲームオーバー画面用構造体のポインタ.
 *
-* @retval true  .
-* @retval false s.
+* @retval true  初期化成功.
+* @retval false 初期化失敗.
 */
 bool initialize(GameOverScene* scene)
 {
   scene->bg = Sprite("Res/UnknownPlanet.png");
-  scene->timer = 0.5f; // ͂󂯕tȂ(b).
+  scene->timer = 0.5f; // 入力を受け付けない期間(秒).
   return true;
 }
 
 /**
-* Q[I[o[ʂ̏Is.
+* ゲームオーバー画面の終了処理を行う.
 *
-* @param scene  Q[I[o[ʗp\̂̃|C^.
+* @param scene  ゲームオーバー画面用構造体のポインタ.
 */
 void finalize(GameOverScene* scene)
 {
@@ -31,10 +31,10 @@ void finalize(GameOverScene* scene)
 }
 
 /**
-* Q[I[o[ʂ̃vC[͂.
+* ゲームオーバー画面のプレイヤー入力を処理する.
 *
-* @param window Q[ǗEBhE.
-* @param scene  Q[I[o[ʗp\̂̃|C^.
+* @param window ゲームを管理するウィンドウ.
+* @param scene  ゲームオーバー画面用構造体のポインタ.
 */
 void processInput(GLFWEW::WindowRef window, GameOverScene* scene)
 {
@@ -49,10 +49,10 @@ void processInput(GLFWEW::WindowRef window, GameOverScene* scene)
 }
 
 /**
-* Q[I[o[ʂXV.
+* ゲームオーバー画面を更新する.
 *
-* @param window Q[ǗEBhE.
-* @param scene  Q[I[o[ʗp\̂̃|C^.
+* @param window ゲームを管理するウィンドウ.
+* @param scene  ゲームオーバー画面用構造体のポインタ.
 */
 void update(GLFWEW::WindowRef window, GameOverScene* scene)
 {
@@ -64,10 +64,10 @@ void update(GLFWEW::WindowRef window, GameOverScene* scene)
 }
 
 /**
-* Q[I[o[ʂXV.
+* ゲームオーバー画面を更新する.
 *
-* @param window Q[ǗEBhE.
-* @param scene  Q[I[o[ʗp\̂̃|C^.
+* @param window ゲームを管理するウィンドウ.
+* @param scene  ゲームオーバー画面用構造体のポインタ.
 */
 void render(GLFWEW::WindowRef window, GameOverScene* scene)
 {
@@ -78,6 +78,7 @@ void render(GLFWEW::WindowRef window, GameOverScene* scene)
 
   fontRenderer.BeginUpdate();
   fontRenderer.AddString(glm::vec2(-144, 16), "GAME OVER");
+  renderProfiler();
   fontRenderer.EndUpdate();
   fontRenderer.Draw();
 
@@ -6,7 +6,7 @@
 #include "Sprite.h"
 
 /**
-* Q[I[o[ʂŎgp\.
+* ゲームオーバー画面で使用する構造体.
 */
 struct GameOverScene
 {
@@ -7,47 +7,50 @@
 #include "GameData.h"
 #include "GLFWEW.h"
 #include "Texture.h"
+#include "TextureAtlas.h"
 #include "Sprite.h"
 #include "Font.h"
 #include "TiledMap.h"
 #include "Audio.h"
 #include <glm/gtc/constants.hpp>
 #include <random>
+#include <stdio.h>
 
-const char title[] = "OpenGL2D 2018"; // EBhE^Cg.
-const int windowWidth = 800; // EBhE̕.
-const int windowHeight = 600; // EBhE̍.
+const char title[] = "OpenGL2D 2018"; // ウィンドウタイトル.
+const int windowWidth = 800; // ウィンドウの幅.
+const int windowHeight = 600; // ウィンドウの高さ.
 
 /*
-* Q[̕\Ɋւϐ.
+* ゲームの表示に関する変数.
 */
-SpriteRenderer renderer; // XvCg`pϐ.
-FontRenderer fontRenderer; // tHg`pϐ.
+SpriteRenderer renderer; // スプライト描画用変数.
+FontRenderer fontRenderer; // フォント描画用変数.
 
 /*
-* Q[̃[Ɋւϐ.
+* ゲームのルールに関する変数.
 */
-std::mt19937 random; // 𔭐ϐ(GW).
+std::mt19937 random; // 乱数を発生させる変数(乱数エンジン).
 
 /*
-* vg^Cv錾.
+* プロトタイプ宣言.
 */
 void processInput(GLFWEW::WindowRef);
 void update(GLFWEW::WindowRef);
 void render(GLFWEW::WindowRef);
 
-int gamestate; // Q[̏.
+int gamestate; // ゲームの状態.
+bool showProfiler = false; // true=描画の統計情報を表示する.
 
 TitleScene titleScene;
 GameOverScene gameOverScene;
 MainScene mainScene;
 
 /**
-* vÕGg[|Cg.
+* プログラムのエントリーポイント.
 */
 int main()
 {
-  // AvP[V̏.
+  // アプリケーションの初期化.
   GLFWEW::WindowRef window = GLFWEW::Window::Instance();
   if (!window.Initialize(windowWidth, windowHeight, title)) {
     return 1;
@@ -59,9 +62,20 @@ int main()
   if (!Texture::Initialize()) {
     return 1;
   }
+  // 展開した画像をディスクに保存し、2回目以降の起動ではPNGの展開を省略する. 失敗しても起動は続ける.
+  Texture::SetDiskCache("TextureCache");
+  // スプライト用の画像を1枚のテクスチャにまとめ、テクスチャの切り替えによる描画の分割を減らす.
+  TextureAtlasPtr atlas = TextureAtlas::Create(2048);
+  atlas->Add("Res/UnknownPlanet.png");
+  atlas->Add("Res/Objects.png");
+  atlas->Add("Res/Title.png");
+  if (!atlas->Build("Res/TextureAtlas.txt")) {
+    return 1;
+  }
   if (!renderer.Initialize(1024)) {
     return 1;
   }
+  renderer.AutoGrow(true); // 1024個を超えるスプライトが追加されたら容量を拡張する.
   if (!fontRenderer.Initialize(1024, glm::vec2(windowWidth, windowHeight))) {
     return 1;
   }
@@ -69,14 +83,15 @@ int main()
     return 1;
   }
 
-  random.seed(std::random_device()()); // GW̏.
+  random.seed(std::random_device()()); // 乱数エンジンの初期化.
 
   initialize(&titleScene);
 
-  // Q[[v.
+  // ゲームループ.
   while (!window.ShouldClose()) {
     processInput(window);
     update(window);
+    Texture::ProcessUploads(); // 非同期読み込みしたテクスチャを少しずつGPUへ転送する.
     render(window);
     audio.Update();
   }
@@ -87,14 +102,22 @@ int main()
 }
 
 /**
-* vC[̓͂.
+* プレイヤーの入力を処理する.
 *
-* @param window Q[ǗEBhE.
+* @param window ゲームを管理するウィンドウ.
 */
 void processInput(GLFWEW::WindowRef window)
 {
   window.Update();
 
+  // F1キーで描画の統計情報の表示を切り替える.
+  static bool prevF1 = false;
+  const bool f1 = window.KeyPressed(GLFW_KEY_F1);
+  if (f1 && !prevF1) {
+    showProfiler = !showProfiler;
+  }
+  prevF1 = f1;
+
   if (gamestate == gamestateTitle) {
     processInput(window, &titleScene);
     return;
@@ -107,9 +130,9 @@ void processInput(GLFWEW::WindowRef window)
 }
 
 /**
-* Q[̏ԂXV.
+* ゲームの状態を更新する.
 *
-* @param window Q[ǗEBhE.
+* @param window ゲームを管理するウィンドウ.
 */
 void update(GLFWEW::WindowRef window)
 {
@@ -126,12 +149,13 @@ void update(GLFWEW::WindowRef window)
 }
 
 /**
-* Q[̏Ԃ`悷.
+* ゲームの状態を描画する.
 *
-* @param window Q[ǗEBhE.
+* @param window ゲームを管理するウィンドウ.
 */
 void render(GLFWEW::WindowRef window)
 {
+  SpriteRenderer::BeginFrame(window.DeltaTime());
   if (gamestate == gamestateTitle) {
     render(window, &titleScene);
     return;
@@ -143,3 +167,41 @@ void render(GLFWEW::WindowRef window)
     return;
   }
 }
+
+/**
+* 描画の統計情報を表示する.
+*
+* fontRenderer.BeginUpdate()とfontRenderer.EndUpdate()の間で呼び出すこと.
+* 直近のフレームの平均値を項目ごとに表示する.
+*/
+void renderProfiler()
+{
+  if (!showProfiler) {
+    return;
+  }
+  const struct {
+    const char* name;
+    const FrameStats::History& history;
+  } list[] = {
+    { "SPR", renderer.StatsHistory() },
+    { "FNT", fontRenderer.StatsHistory() },
+  };
+  const glm::vec2 scale = fontRenderer.Scale();
+  fontRenderer.Scale(glm::vec2(0.25f));
+  glm::vec2 pos(-windowWidth * 0.5f + 8, -windowHeight * 0.5f + 40);
+  for (const auto& e : list) {
+    char str[128];
+    int n = snprintf(str, sizeof(str), "%s", e.name);
+    for (int i = 0; i < FrameStats::Counter_Count && n < static_cast<int>(sizeof(str)); ++i) {
+      const FrameStats::Counter c = static_cast<FrameStats::Counter>(i);
+      double value = e.history.Average(c);
+      if (c == FrameStats::Counter_BytesMapped) {
+        value /= 1024; // KB単位で表示する.
+      }
+      n += snprintf(str + n, sizeof(str) - n, " %s:%.0f", FrameStats::CounterName(c), value);
+    }
+    fontRenderer.AddString(pos, str);
+    pos.y -= 16;
+  }
+  fontRenderer.Scale(scale);
+}
@@ -7,7 +7,7 @@
 #include <glm/gtc/constants.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
-// G̃Aj[V.
+// 敵のアニメーション.
 const FrameAnimation::KeyFrame enemyKeyFrames[] = {
   { 0.000f, glm::vec2(480, 0), glm::vec2(32, 32) },
   { 0.125f, glm::vec2(480, 96), glm::vec2(32, 32) },
@@ -16,7 +16,7 @@ const FrameAnimation::KeyFrame enemyKeyFrames[] = {
   { 0.500f, glm::vec2(480, 0), glm::vec2(32, 32) },
 };
 
-// Aj[V.
+// 爆発アニメーション.
 const FrameAnimation::KeyFrame blastKeyFrames[] = {
   { 0 / 60.0f, glm::vec2(416, 0), glm::vec2(32, 32) },
   { 5 / 60.0f, glm::vec2(416, 32), glm::vec2(32, 32) },
@@ -25,12 +25,12 @@ const FrameAnimation::KeyFrame blastKeyFrames[] = {
   { 20 / 60.0f, glm::vec2(416, 96), glm::vec2(32, 32) },
 };
 
-// ACe̎
+// アイテムの種類
 const int itemNormalShot = 0;
 const int itemLaser = 1;
 const int itemScore = 2;
 
-// G̎.
+// 敵の種類.
 const int enemyZako = 0;
 const int enemyZakoWithNormalShotItem = 1;
 const int enemyZakoWithLaserItem = 2;
@@ -41,13 +41,13 @@ void playerAndEnemyContactHandler(Actor * player, Actor * enemy);
 void playerAndItemContactHandler(Actor* player, Actor* item);
 
 /**
-* Cʗp̍\̂̏ݒs.
+* メイン画面用の構造体の初期設定を行う.
 *
-* @param scene     Cʗp\̂̃|C^.
-* @param gamestate Q[Ԃ\ϐ̃|C^.
+* @param scene     メイン画面用構造体のポインタ.
+* @param gamestate ゲーム状態を表す変数のポインタ.
 *
-* @retval true  .
-* @retval false s.
+* @retval true  初期化成功.
+* @retval false 初期化失敗.
 */
 bool initialize(MainScene* scene)
 {
@@ -85,9 +85,9 @@ bool initialize(MainScene* scene)
 }
 
 /**
-* Cʂ̏Is.
+* メイン画面の終了処理を行う.
 *
-* @param scene  Cʗp\̂̃|C^.
+* @param scene  メイン画面用構造体のポインタ.
 */
 void finalize(MainScene* scene)
 {
@@ -112,17 +112,17 @@ void finalize(MainScene* scene)
 }
 
 /**
-* vC[̓͂.
+* プレイヤーの入力を処理する.
 *
-* @param window Q[ǗEBhE.
-* @param scene  Cʗp\̂̃|C^.
+* @param window ゲームを管理するウィンドウ.
+* @param scene  メイン画面用構造体のポインタ.
 */
 void processInput(GLFWEW::WindowRef window, MainScene* scene)
 {
   if (scene->sprPlayer.health <= 0) {
     scene->playerVelocity = glm::vec3(0, 0, 0);
   } else {
-    // @̑xݒ肷.
+    // 自機の速度を設定する.
     const GamePad gamepad = window.GetGamePad();
     if (gamepad.buttons & GamePad::DPAD_UP) {
       scene->playerVelocity.y = 1;
@@ -142,7 +142,7 @@ void processInput(GLFWEW::WindowRef window, MainScene* scene)
       scene->playerVelocity = glm::normalize(scene->playerVelocity) * 400.0f;
     }
 
-    // e̔.
+    // 弾の発射.
     if (scene->weapon == scene->weaponNormalShot) {
       if (gamepad.buttonDown & GamePad::A || (gamepad.buttons & GamePad::A && scene->shotTimer <= 0)) {
         scene->shotTimer = 1.0f / 8.0f;
@@ -203,16 +203,16 @@ void processInput(GLFWEW::WindowRef window, MainScene* scene)
 }
 
 /**
-* Q[̏ԂXV.
+* ゲームの状態を更新する.
 *
-* @param window Q[ǗEBhE.
-* @param scene  Cʗp\̂̃|C^.
+* @param window ゲームを管理するウィンドウ.
+* @param scene  メイン画面用構造体のポインタ.
 */
 void update(GLFWEW::WindowRef window, MainScene* scene)
 {
   const float deltaTime = window.DeltaTime();
 
-  // @j󂳂ĂQ[I[o[ʂɐ؂ւ.
+  // 自機が破壊されていたらゲームオーバー画面に切り替える.
   if (scene->sprPlayer.health <= 0) {
     scene->timer -= deltaTime;
     if (scene->timer <= 0) {
@@ -223,7 +223,7 @@ void update(GLFWEW::WindowRef window, MainScene* scene)
     }
   }
 
-  // @̈ړ.
+  // 自機の移動.
   if (scene->sprPlayer.health > 0) {
     if (scene->playerVelocity.x || scene->playerVelocity.y) {
       const GLFWEW::WindowRef window = GLFWEW::Window::Instance();
@@ -250,24 +250,24 @@ void update(GLFWEW::WindowRef window, MainScene* scene)
     }
   }
 
-  // G̏o.
+  // 敵の出現.
 #if 1
   const TiledMap::Layer& tiledMapLayer = scene->enemyMap.GetLayer(0);
   const glm::vec2 tileSize = scene->enemyMap.GetTileSet(tiledMapLayer.tilesetNo).size;
-  // Gzu}bvQƈʒu̍XV.
-  const float enemyMapScrollSpeed = 100; // XVx.
+  // 敵配置マップ参照位置の更新.
+  const float enemyMapScrollSpeed = 100; // 更新速度.
   scene->mapCurrentPosX += enemyMapScrollSpeed * deltaTime;
   if (scene->mapCurrentPosX >= tiledMapLayer.size.x * tileSize.x) {
-    // I[𒴂擪Ƀ[v.
+    // 終端を超えたら先頭にループ.
     scene->mapCurrentPosX = 0;
     scene->mapProcessedX = 0;
   }
-  // ̗ɓBf[^ǂ.
+  // 次の列に到達したらデータを読む.
   if (scene->mapCurrentPosX - scene->mapProcessedX >= tileSize.x) {
     scene->mapProcessedX += tileSize.x;
     const int mapX = static_cast<int>(scene->mapProcessedX / tileSize.x);
     for (int mapY = 0; mapY < tiledMapLayer.size.y; ++mapY) {
-      const int enemyId = 256; // GƂ݂Ȃ^CID.
+      const int enemyId = 256; // 敵とみなすタイルID.
       const int tileNo = tiledMapLayer.At(mapY, mapX);
       struct EnemyData
       {
@@ -333,7 +333,7 @@ void update(GLFWEW::WindowRef window, MainScene* scene)
   }
 #endif
 
-  // Actor̍XV.
+  // Actorの更新.
   const float y = scene->sprPlayer.spr.Position().y;
   for (Actor* i = std::begin(scene->playerBulletList); i != std::end(scene->playerBulletList); ++i) {
     if (i->health > 0 && i->type == scene->weaponLaser) {
@@ -347,20 +347,20 @@ void update(GLFWEW::WindowRef window, MainScene* scene)
   updateActorList(std::begin(scene->effectList), std::end(scene->effectList), deltaTime);
   updateActorList(std::begin(scene->itemList), std::end(scene->itemList), deltaTime);
 
-  // @ƃACȅՓ˔.
+  // 自機とアイテムの衝突判定.
   detectCollision(
     &scene->sprPlayer, &scene->sprPlayer + 1,
     std::begin(scene->itemList), std::end(scene->itemList),
     playerAndItemContactHandler
   );
 
-  // @̒eƓG̏Փ˔.
+  // 自機の弾と敵の衝突判定.
   detectCollision(
     std::begin(scene->playerBulletList), std::end(scene->playerBulletList),
     std::begin(scene->enemyList), std::end(scene->enemyList),
     playerBulletAndEnemyContactHandler);
 
-  // @ƓG̏Փ˔.
+  // 自機と敵の衝突判定.
   detectCollision(
     &scene->sprPlayer, &scene->sprPlayer + 1,
     std::begin(scene->enemyList), std::end(scene->enemyList),
@@ -369,10 +369,10 @@ void update(GLFWEW::WindowRef window, MainScene* scene)
 }
 
 /**
-* Q[̏Ԃ`悷.
+* ゲームの状態を描画する.
 *
-* @param window Q[ǗEBhE.
-* @param scene  Cʗp\̂̃|C^.
+* @param window ゲームを管理するウィンドウ.
+* @param scene  メイン画面用構造体のポインタ.
 */
 void render(GLFWEW::WindowRef window, MainScene* scene)
 {
@@ -392,6 +392,7 @@ void render(GLFWEW::WindowRef window, MainScene* scene)
   char str[9];
   snprintf(str, 9, "%08d", scene->score);
   fontRenderer.AddString(glm::vec2(-64, 300), str);
+  renderProfiler();
   fontRenderer.EndUpdate();
   fontRenderer.Draw();
 
@@ -399,14 +400,14 @@ void render(GLFWEW::WindowRef window, MainScene* scene)
 }
 
 /**
-* @̒eƓG̏Փ˂.
+* 自機の弾と敵の衝突を処理する.
 *
-* @param bullet @̒ẽ|C^.
-* @param enemy  G̃|C^.
+* @param bullet 自機の弾のポインタ.
+* @param enemy  敵のポインタ.
 */
 void playerBulletAndEnemyContactHandler(Actor * bullet, Actor * enemy)
 {
-  // [U[͑ϋvl4̓Gђʂ.
+  // レーザーは耐久値4未満の敵を貫通する.
   enemy->health -= bullet->health;
   if (bullet->type != mainScene.weaponLaser || enemy->health >= 2 * mainScene.weaponLevel) {
     bullet->health = 0;
@@ -422,7 +423,7 @@ void playerBulletAndEnemyContactHandler(Actor * bullet, Actor * enemy)
       blast->spr.Tweener(TA::Animate::Create(TA::Rotation::Create(20 / 60.0f, glm::pi<float>() * 0.5f)));
       blast->health = 1;
     }
-    // ACeĂGꍇAΉACeo.
+    // アイテムを持っている敵だった場合、対応するアイテムを出現させる.
     if (enemy->type >= enemyZakoWithNormalShotItem && enemy->type <= enemyZakoWithScoreItem) {
       Actor* item = findAvailableActor(std::begin(mainScene.itemList), std::end(mainScene.itemList));
       if (item != nullptr) {
@@ -438,10 +439,10 @@ void playerBulletAndEnemyContactHandler(Actor * bullet, Actor * enemy)
 }
 
 /**
-* @̒eƓG̏Փ˂.
+* 自機の弾と敵の衝突を処理する.
 *
-* @param bullet @̃|C^.
-* @param enemy  G̃|C^.
+* @param bullet 自機のポインタ.
+* @param enemy  敵のポインタ.
 */
 void playerAndEnemyContactHandler(Actor * player, Actor * enemy)
 {
@@ -478,7 +479,7 @@ void playerAndEnemyContactHandler(Actor * player, Actor * enemy)
 }
 
 /**
-* @ƃACȅՓ.
+* 自機とアイテムの衝突.
 */
 void playerAndItemContactHandler(Actor* player, Actor* item)
 {
@@ -7,13 +7,13 @@
 #include "Audio.h"
 
 /**
-* ^Cgʗp̍\̂̏ݒs.
+* タイトル画面用の構造体の初期設定を行う.
 *
-* @param scene     ^Cgʗp\̂̃|C^.
-* @param gamestate Q[Ԃ\ϐ̃|C^.
+* @param scene     タイトル画面用構造体のポインタ.
+* @param gamestate ゲーム状態を表す変数のポインタ.
 *
-* @retval true  .
-* @retval false s.
+* @retval true  初期化成功.
+* @retval false 初期化失敗.
 */
 bool initialize(TitleScene* scene)
 {
@@ -25,9 +25,9 @@ bool initialize(TitleScene* scene)
 }
 
 /**
-* ^Cgʂ̏Is.
+* タイトル画面の終了処理を行う.
 *
-* @param scene  ^Cgʗp\̂̃|C^.
+* @param scene  タイトル画面用構造体のポインタ.
 */
 void finalize(TitleScene* scene)
 {
@@ -36,10 +36,10 @@ void finalize(TitleScene* scene)
 }
 
 /**
-* ^Cgʂ̃vC[͂.
+* タイトル画面のプレイヤー入力を処理する.
 *
-* @param window Q[ǗEBhE.
-* @param scene  ^Cgʗp\̂̃|C^.
+* @param window ゲームを管理するウィンドウ.
+* @param scene  タイトル画面用構造体のポインタ.
 */
 void processInput(GLFWEW::WindowRef window, TitleScene* scene)
 {
@@ -55,10 +55,10 @@ void processInput(GLFWEW::WindowRef window, TitleScene* scene)
 }
 
 /**
-* ^CgʂXV.
+* タイトル画面を更新する.
 *
-* @param window Q[ǗEBhE.
-* @param scene  ^Cgʗp\̂̃|C^.
+* @param window ゲームを管理するウィンドウ.
+* @param scene  タイトル画面用構造体のポインタ.
 */
 void update(GLFWEW::WindowRef window, TitleScene* scene)
 {
@@ -81,10 +81,10 @@ void update(GLFWEW::WindowRef window, TitleScene* scene)
 }
 
 /**
-* ^Cgʂ`悷.
+* タイトル画面を描画する.
 *
-* @param window Q[ǗEBhE.
-* @param scene  ^Cgʗp\̂̃|C^.
+* @param window ゲームを管理するウィンドウ.
+* @param scene  タイトル画面用構造体のポインタ.
 */
 void render(GLFWEW::WindowRef window, TitleScene* scene)
 {
@@ -102,6 +102,7 @@ void render(GLFWEW::WindowRef window, TitleScene* scene)
       fontRenderer.AddString(glm::vec2(-80, -100), "START");
     }
   }
+  renderProfiler();
   fontRenderer.EndUpdate();
   fontRenderer.Draw();
 
@@ -6,7 +6,7 @@
 #include "Sprite.h"
 
 /**
-* ^CgʂŎgp\.
+* タイトル画面で使用する構造体.
 */
 struct TitleScene
 {
@@ -0,0 +1,77 @@
+/**
+* @file Test/Main.cpp
+*
+* Lib/Easyの動作を確認するプログラム.
+*
+* 描画はRenderBackend::NullBackendで記録するため、GPUのない環境でも実行できる.
+* Resフォルダを参照するため、ソリューションのフォルダを作業ディレクトリにして実行すること.
+* 引数を指定すると、名前にその文字列を含むテストだけを実行する.
+*/
+#include "Test.h"
+#include <stdio.h>
+#include <string.h>
+
+namespace /* unnamed */ {
+
+/// テスト関数のリスト.
+const struct {
+  const char* name;
+  void(*func)();
+} testList[] = {
+  { "NullBackend", TestNullBackend },
+  { "GLState", TestGLState },
+  { "SpriteRendererDraw", TestSpriteRendererDraw },
+  { "SpriteRendererLoadingTexture", TestSpriteRendererLoadingTexture },
+  { "TextureAtlasLayout", TestTextureAtlasLayout },
+  { "TextureCacheLru", TestTextureCacheLru },
+  { "TextureDdsUpload", TestTextureDdsUpload },
+  { "TiledMapIndexTexture", TestTiledMapIndexTexture },
+  { "TiledMapBinaryValidation", TestTiledMapBinaryValidation },
+  { "TiledMapSaveStream", TestTiledMapSaveStream },
+  { "TiledMapSaveInPlace", TestTiledMapSaveInPlace },
+  { "TileCollisionEdge", TestTileCollisionEdge },
+};
+
+int failCount = 0; ///< 失敗した確認の数.
+
+} // unnamed namespace
+
+/**
+* 確認の結果を記録する.
+*
+* @param result 確認の結果.
+* @param expr   確認した条件式.
+* @param file   確認したソースファイル名.
+* @param line   確認した行番号.
+*
+* @return resultをそのまま返す.
+*/
+bool CheckCondition(bool result, const char* expr, const char* file, int line)
+{
+  if (!result) {
+    printf("  FAILED: %s(%d): %s\n", file, line, expr);
+    ++failCount;
+  }
+  return result;
+}
+
+/**
+* プログラムのエントリーポイント.
+*
+* @retval 0 全ての確認が成功した.
+* @retval 1 失敗した確認がある.
+*/
+int main(int argc, char** argv)
+{
+  for (const auto& e : testList) {
+    if (argc >= 2 && !strstr(e.name, argv[1])) {
+      continue;
+    }
+    printf("[%s]\n", e.name);
+    const int prevFailCount = failCount;
+    e.func();
+    printf("  %s\n", failCount == prevFailCount ? "OK" : "NG");
+  }
+  printf("%d failure(s).\n", failCount);
+  return failCount ? 1 : 0;
+}
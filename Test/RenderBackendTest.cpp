@@ -0,0 +1,249 @@
+/**
+* @file RenderBackendTest.cpp
+*/
+#include "Test.h"
+#include "RenderBackend.h"
+#include "GLState.h"
+#include "Sprite.h"
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <string.h>
+
+namespace /* unnamed */ {
+
+/**
+* 記録されたコマンドのうち、指定した種類の数を数える.
+*
+* @param backend 記録用バックエンド.
+* @param type    数えるコマンドの種類.
+*
+* @return typeのコマンドの数.
+*/
+size_t CountCommand(const RenderBackend::NullBackend& backend, RenderBackend::CommandType type)
+{
+  size_t n = 0;
+  for (const auto& e : backend.Log()) {
+    if (e.type == type) {
+      ++n;
+    }
+  }
+  return n;
+}
+
+} // unnamed namespace
+
+/**
+* NullBackendがバッファの内容とコマンドを正しく記録することを確認する.
+*/
+void TestNullBackend()
+{
+  using namespace RenderBackend;
+  const NullBackendPtr backend = NullBackend::Create();
+  Set(backend);
+  Backend& b = Get();
+  CHECK(&b == backend.get());
+
+  // バッファの作成、部分更新、マップ、コピーの結果がシステムメモリ上に反映される.
+  const uint8_t init[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+  const GLuint src = b.CreateBuffer(GL_ARRAY_BUFFER, sizeof(init), init, GL_STATIC_DRAW);
+  const GLuint dst = b.CreateBuffer(GL_ARRAY_BUFFER, sizeof(init), nullptr, GL_DYNAMIC_DRAW);
+  CHECK(src != 0 && dst != 0 && src != dst);
+  CHECK(backend->BufferData(src) && memcmp(backend->BufferData(src)->data(), init, sizeof(init)) == 0);
+  const uint8_t patch[2] = { 9, 9 };
+  b.BufferSubData(GL_ARRAY_BUFFER, src, 2, sizeof(patch), patch);
+  CHECK((*backend->BufferData(src))[2] == 9 && (*backend->BufferData(src))[3] == 9);
+  uint8_t* p = static_cast<uint8_t*>(b.MapBufferRange(GL_ARRAY_BUFFER, dst, 4, 4, GL_MAP_WRITE_BIT));
+  CHECK(p != nullptr);
+  if (p) {
+    p[0] = 42;
+  }
+  CHECK(b.UnmapBuffer(GL_ARRAY_BUFFER, dst));
+  CHECK((*backend->BufferData(dst))[4] == 42);
+  CHECK(b.MapBufferRange(GL_ARRAY_BUFFER, dst, 4, 5, GL_MAP_WRITE_BIT) == nullptr); // 範囲外.
+  b.CopyBufferSubData(src, dst, 0, 0, 4);
+  CHECK(memcmp(backend->BufferData(dst)->data(), (*backend->BufferData(src)).data(), 4) == 0);
+
+  // 転送量は作成時のデータ、部分更新、アンマップした範囲の合計になる.
+  const Stats& stats = backend->GetStats();
+  CHECK(stats.bytesUploaded == sizeof(init) + sizeof(patch) + 4);
+  CHECK(stats.objectsCreated == 2);
+
+  // 描画コマンドは回数とインデックス数が集計され、ログに順番どおり残る.
+  b.DrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, 0);
+  b.DrawElements(GL_TRIANGLES, 12, GL_UNSIGNED_SHORT, 12);
+  CHECK(stats.drawCalls == 2 && stats.indexCount == 18);
+  const Command& last = backend->Log().back();
+  CHECK(last.type == CommandType_DrawElements && last.param == GL_TRIANGLES && last.size == 12 && last.object == 12);
+
+  b.DeleteBuffer(src);
+  CHECK(backend->BufferData(src) == nullptr);
+  CHECK(stats.objectsDeleted == 1);
+
+  // uniform宣言からuniform変数とブロックの情報を作成する.
+  const GLuint program = b.CreateProgram(
+    "uniform mat4 matMVP; // comment\nlayout(std140) uniform ViewData { vec4 x; } view;\n",
+    "uniform sampler2D texColor;\n");
+  std::vector<UniformInfo> uniforms;
+  b.GetActiveUniforms(program, uniforms);
+  std::vector<std::string> blocks;
+  b.GetActiveUniformBlocks(program, blocks);
+  bool hasMatrix = false;
+  bool hasSampler = false;
+  for (const auto& e : uniforms) {
+    hasMatrix |= e.name == "matMVP";
+    hasSampler |= e.name == "texColor";
+  }
+  CHECK(hasMatrix && hasSampler);
+  CHECK(blocks.size() == 1 && blocks[0] == "ViewData");
+
+  backend->Clear();
+  CHECK(backend->Log().empty() && backend->GetStats().drawCalls == 0);
+  Set(nullptr);
+}
+
+/**
+* GLStateが状態の変わらない呼び出しを省略することを確認する.
+*/
+void TestGLState()
+{
+  using namespace RenderBackend;
+  const NullBackendPtr backend = NullBackend::Create();
+  Set(backend);
+  GLState::Invalidate();
+  GLState::ResetStats();
+
+  // 同じ状態の設定は2回目以降バックエンドを呼び出さない.
+  GLState::UseProgram(3);
+  GLState::UseProgram(3);
+  GLState::BindVertexArray(4);
+  GLState::BindVertexArray(4);
+  GLState::Enable(GL_BLEND);
+  GLState::Enable(GL_BLEND);
+  GLState::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  GLState::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  CHECK(CountCommand(*backend, CommandType_UseProgram) == 1);
+  CHECK(CountCommand(*backend, CommandType_BindVertexArray) == 1);
+  CHECK(CountCommand(*backend, CommandType_Enable) == 1);
+  CHECK(CountCommand(*backend, CommandType_BlendFunc) == 1);
+
+  // テクスチャはユニットと種類ごとに記録し、ユニットの切り替えも省略する.
+  GLState::BindTexture(GL_TEXTURE0, GL_TEXTURE_2D, 10);
+  GLState::BindTexture(GL_TEXTURE0, GL_TEXTURE_2D, 10);
+  GLState::BindTexture(GL_TEXTURE0, GL_TEXTURE_CUBE_MAP, 10);
+  GLState::BindTexture(GL_TEXTURE1, GL_TEXTURE_2D, 10);
+  CHECK(CountCommand(*backend, CommandType_BindTexture) == 3);
+  CHECK(CountCommand(*backend, CommandType_ActiveTexture) == 2);
+
+  // 削除したテクスチャの記録は消えるので、同じIDを再び割り当てるとバックエンドを呼び出す.
+  GLState::DeleteTexture(10);
+  GLState::BindTexture(GL_TEXTURE0, GL_TEXTURE_2D, 10);
+  CHECK(CountCommand(*backend, CommandType_BindTexture) == 4);
+  CHECK(CountCommand(*backend, CommandType_ActiveTexture) == 3); // GL_TEXTURE1から戻る.
+
+  const GLState::Stats& stats = GLState::GetStats();
+  CHECK(stats.skipped[GLState::StatType_Program] == 1);
+  CHECK(stats.skipped[GLState::StatType_Texture] == 1);
+  CHECK(stats.TotalIssued() == 1 + 1 + 1 + 1 + 4 + 3);
+
+  // Invalidate後は記録が不明になるので、同じ設定でも呼び出す.
+  GLState::Invalidate();
+  GLState::UseProgram(3);
+  CHECK(CountCommand(*backend, CommandType_UseProgram) == 2);
+
+  GLState::Invalidate();
+  Set(nullptr);
+}
+
+/**
+* SpriteRendererが同じテクスチャの連続するスプライトをまとめて描画することを確認する.
+*/
+void TestSpriteRendererDraw()
+{
+  using namespace RenderBackend;
+  const NullBackendPtr backend = NullBackend::Create();
+  Set(backend);
+  GLState::Invalidate();
+  {
+    const TexturePtr tex0 = Texture::Create(64, 64, GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    const TexturePtr tex1 = Texture::Create(32, 32, GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    SpriteRenderer renderer;
+    CHECK(renderer.Initialize(16));
+    renderer.AutoGrow(true);
+
+    // 同じテクスチャが10個ずつ並ぶ100個のスプライトは、10回の描画になる.
+    for (int frame = 0; frame < 2; ++frame) {
+      backend->Clear();
+      SpriteRenderer::BeginFrame(1.0f / 60.0f);
+      renderer.BeginUpdate();
+      for (int i = 0; i < 100; ++i) {
+        Sprite sprite((i / 10) % 2 ? tex1 : tex0, Rect(0, 0, 8, 8));
+        sprite.Position(glm::vec3(static_cast<float>(i), 0, 0));
+        CHECK(renderer.AddVertices(sprite));
+      }
+      renderer.EndUpdate();
+      renderer.Draw(glm::vec2(800, 600));
+      const Stats& stats = backend->GetStats();
+      CHECK(stats.drawCalls == 10);
+      CHECK(stats.indexCount == 100 * 6);
+      // 2フレーム目はプログラムなどの状態が同じなので、テクスチャの切り替えだけが発生する.
+      if (frame == 1) {
+        CHECK(CountCommand(*backend, CommandType_UseProgram) == 0);
+        CHECK(CountCommand(*backend, CommandType_BindTexture) == 10);
+      }
+    }
+    CHECK(renderer.MaxSpriteCount() >= 100);
+  }
+  GLState::Invalidate();
+  Set(nullptr);
+}
+
+/**
+* 読み込み中のテクスチャを使うスプライトが、別のテクスチャのスプライトとまとめられないことを確認する.
+*/
+void TestSpriteRendererLoadingTexture()
+{
+  using namespace RenderBackend;
+  const NullBackendPtr backend = NullBackend::Create();
+  Set(backend);
+  GLState::Invalidate();
+  CHECK(Texture::Initialize());
+  {
+    // 読み込み中のテクスチャは、どちらも代替テクスチャと同じIDを持つ.
+    const TexturePtr tex0 = Texture::LoadAsync("Res/Objects.png");
+    const TexturePtr tex1 = Texture::LoadAsync("Res/Title.png");
+    CHECK(tex0 && tex1);
+    if (tex0 && tex1) {
+      SpriteRenderer renderer;
+      CHECK(renderer.Initialize(16));
+      const auto drawFrame = [&]() {
+        backend->Clear();
+        SpriteRenderer::BeginFrame(1.0f / 60.0f);
+        renderer.BeginUpdate();
+        CHECK(renderer.AddVertices(Sprite(tex0)));
+        CHECK(renderer.AddVertices(Sprite(tex1)));
+        renderer.EndUpdate();
+        renderer.Draw(glm::vec2(800, 600));
+        return backend->GetStats().drawCalls;
+      };
+      if (tex0->IsLoading() && tex1->IsLoading()) {
+        CHECK(tex0->Id() == tex1->Id());
+        CHECK(drawFrame() == 2);
+      }
+
+      // 転送が終われば、それぞれのテクスチャで描画される.
+      for (int i = 0; i < 1000 && (tex0->IsLoading() || tex1->IsLoading()); ++i) {
+        Texture::ProcessUploads();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+      CHECK(!tex0->IsLoading() && !tex0->IsFailed());
+      CHECK(!tex1->IsLoading() && !tex1->IsFailed());
+      CHECK(tex0->Id() != tex1->Id());
+      CHECK(drawFrame() == 2);
+    }
+  }
+  Texture::RemoveOrphan(); // 後のテストがキャッシュの影響を受けないようにする.
+  Texture::Finalize();
+  GLState::Invalidate();
+  Set(nullptr);
+}
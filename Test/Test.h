@@ -0,0 +1,29 @@
+/**
+* @file Test.h
+*/
+#ifndef TEST_H_INCLUDED
+#define TEST_H_INCLUDED
+
+/**
+* 条件が成り立つことを確認する.
+*
+* 成り立たなければ、失敗した位置と条件式を表示して失敗数を数える.
+*/
+#define CHECK(cond) CheckCondition(static_cast<bool>(cond), #cond, __FILE__, __LINE__)
+
+bool CheckCondition(bool result, const char* expr, const char* file, int line);
+
+void TestNullBackend();
+void TestGLState();
+void TestSpriteRendererDraw();
+void TestSpriteRendererLoadingTexture();
+void TestTextureAtlasLayout();
+void TestTextureCacheLru();
+void TestTextureDdsUpload();
+void TestTiledMapIndexTexture();
+void TestTiledMapBinaryValidation();
+void TestTiledMapSaveStream();
+void TestTiledMapSaveInPlace();
+void TestTileCollisionEdge();
+
+#endif // TEST_H_INCLUDED
@@ -0,0 +1,135 @@
+/**
+* @file TextureAtlasTest.cpp
+*/
+#include "Test.h"
+#include "TextureAtlas.h"
+#include "RenderBackend.h"
+#include <string>
+#include <vector>
+#include <stdio.h>
+
+namespace /* unnamed */ {
+
+const char layoutFilename[] = "TextureAtlasTest.txt"; ///< テストで作成するレイアウトファイル.
+
+/**
+* ファイルの各行を読み込む.
+*
+* @param filename ファイル名.
+*
+* @return 読み込んだ行のリスト.
+*/
+std::vector<std::string> ReadLines(const char* filename)
+{
+  std::vector<std::string> lines;
+  FILE* fp = fopen(filename, "r");
+  if (fp) {
+    char line[1024];
+    while (fgets(line, sizeof(line), fp)) {
+      lines.push_back(line);
+    }
+    fclose(fp);
+  }
+  return lines;
+}
+
+/**
+* 行のリストをファイルに書き込む.
+*
+* @param filename ファイル名.
+* @param lines    書き込む行のリスト.
+*/
+void WriteLines(const char* filename, const std::vector<std::string>& lines)
+{
+  FILE* fp = fopen(filename, "w");
+  if (fp) {
+    for (const auto& e : lines) {
+      fputs(e.c_str(), fp);
+    }
+    fclose(fp);
+  }
+}
+
+/**
+* Res内の画像からテクスチャアトラスを作成する.
+*
+* @return 作成したページ数. 失敗した場合は0.
+*
+* 作成したサブテクスチャは、次の作成に影響しないように最後にキャッシュから取り除く.
+*/
+size_t BuildAtlas()
+{
+  size_t pageCount = 0;
+  {
+    TextureAtlasPtr atlas = TextureAtlas::Create(1024);
+    atlas->Add("Res/UnknownPlanet.png");
+    atlas->Add("Res/Objects.png");
+    atlas->Add("Res/Title.png");
+    if (atlas->Build(layoutFilename)) {
+      pageCount = atlas->PageCount();
+    }
+  }
+  Texture::RemoveOrphan();
+  return pageCount;
+}
+
+} // unnamed namespace
+
+/**
+* 壊れたレイアウトファイルを使わずに、配置をやり直すことを確認する.
+*
+* 配置をやり直した場合はレイアウトファイルが正しい内容で上書きされるため、
+* ファイルの内容が最初に作成したものに戻ることで確認する.
+*/
+void TestTextureAtlasLayout()
+{
+  RenderBackend::Set(RenderBackend::NullBackend::Create());
+  CHECK(Texture::Initialize());
+  remove(layoutFilename);
+
+  const size_t pageCount = BuildAtlas();
+  CHECK(pageCount == 2);
+  const std::vector<std::string> original = ReadLines(layoutFilename);
+  CHECK(original.size() == 5);
+  if (original.size() == 5) {
+    // 正しいレイアウトファイルはそのまま使われる.
+    CHECK(BuildAtlas() == pageCount);
+    CHECK(ReadLines(layoutFilename) == original);
+
+    // 行の先頭の"ページ番号 X座標 Y座標"を書き換える.
+    const auto tamper = [&original](size_t line, const char* placement) {
+      std::vector<std::string> lines = original;
+      size_t pos = 0;
+      for (int i = 0; i < 3; ++i) {
+        pos = lines[line].find(' ', pos) + 1;
+      }
+      lines[line] = placement + lines[line].substr(pos - 1);
+      WriteLines(layoutFilename, lines);
+    };
+    const struct {
+      size_t line;
+      const char* placement;
+    } tamperList[] = {
+      { 2, "2 0 0" }, // 存在しないページ.
+      { 2, "-1 0 0" }, // 負のページ番号.
+      { 3, "1 600 0" }, // ページの右端をはみ出す.
+      { 3, "0 0 2147483647" }, // 加算するとオーバーフローする位置.
+      { 4, "0 0 0" }, // ページ0の画像と重なる.
+    };
+    for (const auto& e : tamperList) {
+      tamper(e.line, e.placement);
+      CHECK(BuildAtlas() == pageCount);
+      CHECK(ReadLines(layoutFilename) == original);
+    }
+
+    // 画像同士が接しているだけなら重なりとはみなさず、書き換えた配置をそのまま使う.
+    tamper(4, "1 0 514");
+    const std::vector<std::string> touching = ReadLines(layoutFilename);
+    CHECK(BuildAtlas() == pageCount);
+    CHECK(ReadLines(layoutFilename) == touching);
+  }
+
+  remove(layoutFilename);
+  Texture::Finalize();
+  RenderBackend::Set(nullptr);
+}
@@ -0,0 +1,113 @@
+/**
+* @file TextureCacheTest.cpp
+*/
+#include "Test.h"
+#include "Texture.h"
+#include "RenderBackend.h"
+#include <stdio.h>
+#include <vector>
+
+namespace /* unnamed */ {
+
+const GLsizei textureSize = 256; ///< テスト用テクスチャの縦横のピクセル数.
+const size_t textureBytes = textureSize * textureSize * 4; ///< テスト用テクスチャのVRAM使用量.
+
+/**
+* 名前を付けたテスト用テクスチャを作成する.
+*
+* @param name テクスチャの名前.
+*
+* @return 作成したテクスチャ.
+*/
+TexturePtr CreateNamedTexture(const char* name)
+{
+  const TexturePtr p = Texture::Create(textureSize, textureSize, GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+  if (p) {
+    p->Name(name);
+  }
+  return p;
+}
+
+} // unnamed namespace
+
+/**
+* テクスチャキャッシュが上限を超えたとき、固定されていない古いテクスチャから取り除くことを確認する.
+*/
+void TestTextureCacheLru()
+{
+  RenderBackend::Set(RenderBackend::NullBackend::Create());
+  CHECK(Texture::Initialize());
+  Texture::ResetCacheStats();
+  Texture::CacheStats stats = Texture::GetCacheStats();
+  CHECK(stats.budgetBytes == Texture::defaultCacheBudget);
+  CHECK(stats.residentBytes == 0 && stats.textureCount == 0);
+
+  // 上限はテクスチャ4枚分. 参照されている間は上限を超えても取り除かない.
+  Texture::SetCacheBudget(textureBytes * 4);
+  {
+    std::vector<TexturePtr> list;
+    for (int i = 0; i < 10; ++i) {
+      char name[16];
+      snprintf(name, sizeof(name), "t%d", i);
+      list.push_back(CreateNamedTexture(name));
+      Texture::Cache(list.back());
+    }
+    Texture::ProcessUploads();
+    stats = Texture::GetCacheStats();
+    CHECK(stats.residentBytes == textureBytes * 10 && stats.textureCount == 10);
+    CHECK(stats.evictions == 0);
+
+    // キャッシュにないテクスチャは固定できない.
+    CHECK(Texture::Pin(list[0]));
+    CHECK(!Texture::Pin(CreateNamedTexture("notCached")));
+
+    // 取得したテクスチャは最も新しく使われたものになる.
+    CHECK(Texture::LoadAndCache("t1") == list[1]);
+  }
+
+  // 固定したt0と最近使ったt1, t9, t8が残り、古いt2～t7が取り除かれる.
+  Texture::ProcessUploads();
+  stats = Texture::GetCacheStats();
+  CHECK(stats.residentBytes == textureBytes * 4 && stats.textureCount == 4);
+  CHECK(stats.evictions == 6);
+  CHECK(stats.pinnedCount == 1);
+  CHECK(stats.hits == 1);
+  CHECK(Texture::IsCached("t0") && Texture::IsCached("t1"));
+  CHECK(Texture::IsCached("t8") && Texture::IsCached("t9"));
+  for (const char* e : { "t2", "t3", "t4", "t5", "t6", "t7" }) {
+    CHECK(!Texture::IsCached(e));
+  }
+
+  // 固定を解除すると、参照されていないテクスチャとして取り除ける.
+  {
+    const TexturePtr t0 = Texture::LoadAndCache("t0");
+    CHECK(Texture::Unpin(t0));
+    CHECK(Texture::Unpin(t0)); // 固定されていなくても、キャッシュにあれば成功する.
+    Texture::RemoveOrphan();
+    stats = Texture::GetCacheStats();
+    CHECK(stats.textureCount == 1 && stats.residentBytes == textureBytes);
+    CHECK(stats.pinnedCount == 0 && stats.hits == 2);
+  }
+  Texture::RemoveOrphan();
+  stats = Texture::GetCacheStats();
+  CHECK(stats.textureCount == 0 && stats.residentBytes == 0);
+
+  // 非同期読み込みは、転送が終わるまで大きさ0として計上する.
+  Texture::ResetCacheStats();
+  {
+    const TexturePtr p = Texture::LoadAsync("Res/Objects.png");
+    CHECK(p && p->IsLoading());
+    stats = Texture::GetCacheStats();
+    CHECK(stats.residentBytes == 0 && stats.misses == 1 && stats.evictions == 0);
+    CHECK(Texture::WaitForLoad(p));
+    CHECK(p->ByteSize() > 0 && Texture::GetCacheStats().residentBytes == p->ByteSize());
+    CHECK(Texture::LoadAsync("Res/Objects.png") == p);
+    CHECK(Texture::GetCacheStats().hits == 1);
+  }
+  Texture::RemoveOrphan();
+
+  Texture::SetCacheBudget(Texture::defaultCacheBudget);
+  Texture::ResetCacheStats();
+  Texture::Finalize();
+  RenderBackend::Set(nullptr);
+}
@@ -0,0 +1,126 @@
+/**
+* @file TextureDdsTest.cpp
+*/
+#include "Test.h"
+#include "Texture.h"
+#include "RenderBackend.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <stdio.h>
+#include <string.h>
+
+namespace /* unnamed */ {
+
+const char* const ddsFilenameList[] = { "TextureDdsTest0.dds", "TextureDdsTest1.dds" };
+const int ddsSize = 256; ///< テスト用DDSファイルの縦横のピクセル数.
+const int ddsLevelCount = 9; ///< テスト用DDSファイルのミップレベル数.
+
+/**
+* 32ビット値をリトルエンディアンで書き込む.
+*
+* @param buf    書き込み先のバッファ.
+* @param offset 書き込む位置.
+* @param value  書き込む値.
+*/
+void Put32(std::vector<uint8_t>& buf, size_t offset, uint32_t value)
+{
+  for (int i = 0; i < 4; ++i) {
+    buf[offset + i] = static_cast<uint8_t>(value >> (i * 8));
+  }
+}
+
+/**
+* ミップマップ付きのDXT1形式のDDSファイルを作成する.
+*
+* @param filename 作成するファイル名.
+*
+* @return 全ミップレベルのバイト数. 作成に失敗した場合は0.
+*/
+size_t WriteDds(const char* filename)
+{
+  std::vector<uint8_t> buf(128, 0);
+  memcpy(buf.data(), "DDS ", 4);
+  Put32(buf, 4, 124); // ヘッダサイズ.
+  Put32(buf, 8, 0x1007 | 0x20000); // CAPS, HEIGHT, WIDTH, PIXELFORMAT, MIPMAPCOUNT.
+  Put32(buf, 12, ddsSize);
+  Put32(buf, 16, ddsSize);
+  Put32(buf, 28, ddsLevelCount);
+  Put32(buf, 76, 32); // ピクセルフォーマットのサイズ.
+  Put32(buf, 80, 4); // FOURCC.
+  memcpy(&buf[84], "DXT1", 4);
+  Put32(buf, 108, 0x1000 | 0x400008); // TEXTURE, MIPMAP, COMPLEX.
+  size_t totalBytes = 0;
+  for (int i = 0; i < ddsLevelCount; ++i) {
+    const int size = std::max(1, ddsSize >> i);
+    totalBytes += ((size + 3) / 4) * ((size + 3) / 4) * 8;
+  }
+  buf.resize(buf.size() + totalBytes, 0x5a);
+  FILE* fp = fopen(filename, "wb");
+  if (!fp) {
+    return 0;
+  }
+  const bool result = fwrite(buf.data(), 1, buf.size(), fp) == buf.size();
+  fclose(fp);
+  return result ? totalBytes : 0;
+}
+
+} // unnamed namespace
+
+/**
+* 転送量の上限に達したDDSファイルを、ミップレベルを転送するまで読み込み完了にしないことを確認する.
+*/
+void TestTextureDdsUpload()
+{
+  using namespace RenderBackend;
+  const NullBackendPtr backend = NullBackend::Create();
+  Set(backend);
+  CHECK(Texture::Initialize());
+  size_t ddsBytes = 0;
+  for (const char* e : ddsFilenameList) {
+    ddsBytes = WriteDds(e);
+    CHECK(ddsBytes > 0);
+  }
+  {
+    const TexturePtr tex0 = Texture::LoadAsync(ddsFilenameList[0]);
+    const TexturePtr tex1 = Texture::LoadAsync(ddsFilenameList[1]);
+    CHECK(tex0 && tex1);
+    if (tex0 && tex1) {
+      // 上限を0にして、両方の要求が展開を終えて転送待ちになるまで待つ.
+      while (Texture::PendingUploadCount() < 2) {
+        Texture::ProcessUploads(0);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+
+      // 上限はDDSファイル1つ分と最小のレベル(8バイト)に満たない端数なので、後のファイルは1レベルも転送できない.
+      const size_t maxBytes = ddsBytes + 4;
+      backend->Clear();
+      Texture::ProcessUploads(maxBytes);
+      CHECK(tex0->IsLoading() != tex1->IsLoading());
+      size_t baseLevelCount = 0;
+      size_t imageCount = 0;
+      for (const auto& e : backend->Log()) {
+        if (e.type == CommandType_TexParameter && e.param == GL_TEXTURE_BASE_LEVEL) {
+          CHECK(e.size == 0);
+          ++baseLevelCount;
+        } else if (e.type == CommandType_TexImage2D) {
+          ++imageCount;
+        }
+      }
+      CHECK(baseLevelCount == 1);
+      CHECK(imageCount == ddsLevelCount);
+
+      // 次のフレームで残りのファイルを転送する.
+      Texture::ProcessUploads(maxBytes);
+      CHECK(!tex0->IsLoading() && !tex0->IsFailed() && tex0->ByteSize() == ddsBytes);
+      CHECK(!tex1->IsLoading() && !tex1->IsFailed() && tex1->ByteSize() == ddsBytes);
+    }
+  }
+  Texture::RemoveOrphan();
+  Texture::Finalize();
+  Set(nullptr);
+  for (const char* e : ddsFilenameList) {
+    remove(e);
+  }
+}
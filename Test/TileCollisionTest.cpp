@@ -0,0 +1,88 @@
+/**
+* @file TileCollisionTest.cpp
+*/
+#include "Test.h"
+#include "TileCollision.h"
+#include <random>
+#include <vector>
+
+namespace /* unnamed */ {
+
+const int mapSize = 64; ///< テスト用マップの縦横のタイル数.
+const float tileSize = 32; ///< テスト用マップのタイルの縦横のピクセル数.
+
+/**
+* タイルの左端または下端のワールド座標を求める.
+*
+* @param n タイルの列または行. 行の場合はマップ下端からの行数.
+*
+* @return タイルの端の座標.
+*/
+float TileEdge(int n)
+{
+  return (n - mapSize / 2) * tileSize;
+}
+
+} // unnamed namespace
+
+/**
+* タイルの境界にちょうど接する矩形を、重なっていないと判定することを確認する.
+*
+* 矩形の右端と下端は位置と大きさから計算されるため、位置に端数があると
+* タイル単位の座標で誤差が生じやすい. 接している列と行にだけ衝突判定を置き、
+* 矩形を少しでも動かせば重なることも合わせて確認する.
+*/
+void TestTileCollisionEdge()
+{
+  std::vector<uint32_t> data(mapSize * mapSize);
+  TiledMap::Layer layer;
+  layer.size = glm::ivec2(mapSize);
+  layer.mapData = data.data();
+
+  std::mt19937 rand(1);
+  std::uniform_int_distribution<int> edgeDist(8, mapSize - 8);
+  std::uniform_real_distribution<float> sizeDist(1, 200);
+  int xCount = 0;
+  int yCount = 0;
+  for (int i = 0; i < 2000; ++i) {
+    // 右端が列edgeの左端に接する矩形. 列edgeだけに衝突判定がある.
+    const int edge = edgeDist(rand);
+    for (int y = 0; y < mapSize; ++y) {
+      for (int x = 0; x < mapSize; ++x) {
+        data[y * mapSize + x] = x == edge;
+      }
+    }
+    TileCollision collision;
+    collision.Build(layer, glm::vec2(tileSize), [](uint32_t tile) { return tile != 0; });
+    const float right = TileEdge(edge);
+    Rect box(right - sizeDist(rand), -sizeDist(rand) * 0.5f, 0, sizeDist(rand));
+    box.size.x = right - box.origin.x;
+    if (box.origin.x + box.size.x == right) {
+      ++xCount;
+      CHECK(!collision.Overlap(box));
+      TileCollision::Hit hit;
+      CHECK(!collision.Sweep(box, glm::vec2(0, 100), hit));
+      CHECK(collision.Sweep(box, glm::vec2(1, 0), hit) && hit.time == 0 && hit.tile.x == edge);
+      box.size.x += 0.01f;
+      CHECK(collision.Overlap(box));
+    }
+
+    // 下端が行edgeの上端に接する矩形(床の上に立っている状態). 行edgeだけに衝突判定がある.
+    for (int y = 0; y < mapSize; ++y) {
+      for (int x = 0; x < mapSize; ++x) {
+        data[y * mapSize + x] = y == edge;
+      }
+    }
+    collision.Build(layer, glm::vec2(tileSize), [](uint32_t tile) { return tile != 0; });
+    // タイルの行は上から数えるので、行edgeの上端はマップ下端から(mapSize - edge)行目の下端になる.
+    const float bottom = TileEdge(mapSize - edge);
+    const Rect floorBox(-sizeDist(rand) * 0.5f + 0.1f, bottom, sizeDist(rand), sizeDist(rand));
+    ++yCount;
+    CHECK(!collision.Overlap(floorBox));
+    TileCollision::Hit hit;
+    CHECK(!collision.Sweep(floorBox, glm::vec2(100, 0), hit));
+    CHECK(collision.Sweep(floorBox, glm::vec2(0, -1), hit) && hit.time == 0 && hit.tile.y == edge);
+    CHECK(collision.Overlap(Rect(floorBox.origin - glm::vec2(0, 0.01f), floorBox.size)));
+  }
+  CHECK(xCount > 1000 && yCount > 1000);
+}
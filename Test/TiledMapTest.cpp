@@ -0,0 +1,297 @@
+/**
+* @file TiledMapTest.cpp
+*/
+#include "Test.h"
+#include "TiledMap.h"
+#include "RenderBackend.h"
+#include "GLState.h"
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <string.h>
+
+namespace /* unnamed */ {
+
+const char mapFilename[] = "TiledMapTest.json"; ///< テストで作成するマップファイル.
+const char binaryFilename[] = "TiledMapTest.tmap"; ///< テストで作成するバイナリ形式のマップファイル.
+
+/**
+* 全てのタイルが1のマップファイルを作成する.
+*
+* @param width  マップの横のタイル数.
+* @param height マップの縦のタイル数.
+*
+* @retval true  作成成功.
+* @retval false 作成失敗.
+*/
+bool WriteMap(int width, int height)
+{
+  FILE* fp = fopen(mapFilename, "w");
+  if (!fp) {
+    return false;
+  }
+  fprintf(fp, "{\"layers\":[{\"type\":\"tilelayer\",\"width\":%d,\"height\":%d,\"visible\":true,\"opacity\":1,\"data\":[", width, height);
+  for (int i = 0; i < width * height; ++i) {
+    fprintf(fp, i ? ",1" : "1");
+  }
+  fprintf(fp, "]}],\"tilesets\":[{\"tilewidth\":32,\"tileheight\":32,\"columns\":16,\"firstgid\":1,\"image\":\"Objects.png\"}]}");
+  fclose(fp);
+  return true;
+}
+
+/**
+* 記録されたコマンドのうち、マップテクスチャへの転送の数を数える.
+*
+* @param backend 記録用バックエンド.
+*
+* @return TexImage2DとTexSubImage2Dの数.
+*/
+size_t CountTextureUpload(const RenderBackend::NullBackend& backend)
+{
+  size_t n = 0;
+  for (const auto& e : backend.Log()) {
+    if (e.type == RenderBackend::CommandType_TexImage2D || e.type == RenderBackend::CommandType_TexSubImage2D) {
+      ++n;
+    }
+  }
+  return n;
+}
+
+/**
+* バイナリ形式のマップファイルの一部を書き換えたファイルを読み込む.
+*
+* @param original 書き換える前のファイルの内容.
+* @param offset   書き換える位置.
+* @param data     書き込むデータ.
+* @param size     書き込むデータのバイト数.
+*
+* @retval true  読み込みに成功した.
+* @retval false 読み込みに失敗した.
+*/
+bool LoadPatchedBinary(const std::vector<uint8_t>& original, size_t offset, const void* data, size_t size)
+{
+  std::vector<uint8_t> buf = original;
+  memcpy(buf.data() + offset, data, size);
+  FILE* fp = fopen(binaryFilename, "wb");
+  if (!fp) {
+    return false;
+  }
+  fwrite(buf.data(), 1, buf.size(), fp);
+  fclose(fp);
+  TiledMap tiledMap;
+  return tiledMap.Load(binaryFilename);
+}
+
+} // unnamed namespace
+
+/**
+* DrawMode_IndexTextureのレイヤーが、変更されたチャンクだけをテクスチャに転送することを確認する.
+*/
+void TestTiledMapIndexTexture()
+{
+  const RenderBackend::NullBackendPtr backend = RenderBackend::NullBackend::Create();
+  RenderBackend::Set(backend);
+  GLState::Invalidate();
+  CHECK(Texture::Initialize());
+  CHECK(WriteMap(100, 70));
+  {
+    TiledMap tiledMap;
+    CHECK(tiledMap.Load(mapFilename, 1));
+    CHECK(tiledMap.LayerCount() == 1);
+    if (tiledMap.LayerCount() == 1) {
+      TiledMap::Layer& layer = tiledMap.GetLayer(0);
+      layer.drawMode = TiledMap::DrawMode_IndexTexture;
+      layer.dirty = true;
+      tiledMap.Update();
+      CHECK(layer.indexRenderer != nullptr);
+
+      // 変更がなければ転送しない.
+      backend->Clear();
+      tiledMap.Update();
+      tiledMap.Update();
+      CHECK(CountTextureUpload(*backend) == 0);
+
+      // 変更したタイルを含むチャンクだけを転送する. 同じチャンクの変更は1回にまとめる.
+      layer.Set(0, 0, 2);
+      layer.Set(15, 15, 2);
+      layer.Set(69, 99, 2);
+      tiledMap.Update();
+      CHECK(CountTextureUpload(*backend) == 2);
+      const RenderBackend::Stats& stats = backend->GetStats();
+      CHECK(stats.bytesUploaded == (16 * 16 + 4 * 6) * sizeof(uint32_t));
+
+      backend->Clear();
+      tiledMap.Update();
+      CHECK(CountTextureUpload(*backend) == 0);
+
+      // レイヤー全体の更新では、テクスチャを作り直さずにマップ全体を1回で転送する.
+      const TileMapRendererPtr renderer = layer.indexRenderer;
+      layer.dirty = true;
+      tiledMap.Update();
+      CHECK(layer.indexRenderer == renderer);
+      CHECK(CountTextureUpload(*backend) == 1);
+      CHECK(stats.bytesUploaded == 100 * 70 * sizeof(uint32_t));
+    }
+  }
+  remove(mapFilename);
+  Texture::Finalize();
+  GLState::Invalidate();
+  RenderBackend::Set(nullptr);
+}
+
+/**
+* 範囲外を指すバイナリ形式のマップファイルを読み込まないことを確認する.
+*/
+void TestTiledMapBinaryValidation()
+{
+  RenderBackend::Set(RenderBackend::NullBackend::Create());
+  CHECK(Texture::Initialize());
+  CHECK(WriteMap(20, 10));
+  CHECK(TiledMap::Convert(mapFilename, binaryFilename));
+  std::vector<uint8_t> original;
+  FILE* fp = fopen(binaryFilename, "rb");
+  if (fp) {
+    uint8_t buf[4096];
+    for (size_t n; (n = fread(buf, 1, sizeof(buf), fp)) > 0;) {
+      original.insert(original.end(), buf, buf + n);
+    }
+    fclose(fp);
+  }
+  // BinaryHeader(16バイト)の直後にレイヤー0のBinaryLayerがある.
+  const size_t tilesetNoOffset = 16 + 24;
+  const size_t dataOffsetOffset = 16 + 32;
+  CHECK(original.size() > dataOffsetOffset + 8);
+  if (original.size() > dataOffsetOffset + 8) {
+    const int32_t validTilesetNo = 0;
+    CHECK(LoadPatchedBinary(original, tilesetNoOffset, &validTilesetNo, sizeof(validTilesetNo)));
+
+    // タイルセットは1つしかない.
+    const int32_t tilesetNo = 1;
+    CHECK(!LoadPatchedBinary(original, tilesetNoOffset, &tilesetNo, sizeof(tilesetNo)));
+
+    // タイルセットがなければ、タイルセット0も存在しない.
+    const uint32_t tilesetCount = 0;
+    CHECK(!LoadPatchedBinary(original, 12, &tilesetCount, sizeof(tilesetCount)));
+
+    // ファイルの外を指すマップデータ. 加算するとオーバーフローして小さな値になる位置も拒否する.
+    const uint64_t dataOffsetList[] = { original.size(), ~static_cast<uint64_t>(15) };
+    for (const uint64_t dataOffset : dataOffsetList) {
+      CHECK(!LoadPatchedBinary(original, dataOffsetOffset, &dataOffset, sizeof(dataOffset)));
+    }
+  }
+  remove(mapFilename);
+  remove(binaryFilename);
+  Texture::Finalize();
+  RenderBackend::Set(nullptr);
+}
+
+/**
+* 無限マップを保存しても、チャンクの読み込み状態が変わらないことを確認する.
+*/
+void TestTiledMapSaveStream()
+{
+  RenderBackend::Set(RenderBackend::NullBackend::Create());
+  CHECK(Texture::Initialize());
+
+  // 48x32タイルの範囲に、16x16タイルのチャンクを3つ置く. タイルの値はチャンク番号+1.
+  const int chunkPositions[][2] = { { 0, 0 }, { 32, 0 }, { 16, 16 } };
+  FILE* fp = fopen(mapFilename, "w");
+  CHECK(fp != nullptr);
+  if (fp) {
+    fprintf(fp, "{\"infinite\":true,\"layers\":[{\"type\":\"tilelayer\",\"width\":48,\"height\":32,"
+      "\"startx\":0,\"starty\":0,\"visible\":true,\"opacity\":1,\"chunks\":[");
+    for (int i = 0; i < 3; ++i) {
+      fprintf(fp, "%s{\"x\":%d,\"y\":%d,\"width\":16,\"height\":16,\"data\":[",
+        i ? "," : "", chunkPositions[i][0], chunkPositions[i][1]);
+      for (int n = 0; n < 16 * 16; ++n) {
+        fprintf(fp, n ? ",%d" : "%d", i + 1);
+      }
+      fprintf(fp, "]}");
+    }
+    fprintf(fp, "]}],\"tilesets\":[{\"tilewidth\":32,\"tileheight\":32,\"columns\":16,\"firstgid\":1,\"image\":\"Objects.png\"}]}");
+    fclose(fp);
+  }
+  {
+    TiledMap tiledMap;
+    CHECK(tiledMap.Load(mapFilename));
+    CHECK(tiledMap.LayerCount() == 1);
+    if (tiledMap.LayerCount() == 1) {
+      TiledMap::Layer& layer = tiledMap.GetLayer(0);
+      CHECK(layer.stream != nullptr);
+      if (layer.stream) {
+        // 左上のチャンクとその周囲1チャンクだけを読み込み、1つを変更する.
+        layer.Stream(glm::ivec2(0), glm::ivec2(0));
+        layer.Set(1, 1, 9);
+        const size_t loadedCount = layer.stream->LoadedChunkCount();
+        CHECK(loadedCount == 2);
+
+        CHECK(tiledMap.Save(binaryFilename));
+        CHECK(layer.stream->LoadedChunkCount() == loadedCount);
+
+        // 読み込まれていないチャンクと、変更したタイルも保存されている.
+        TiledMap saved;
+        CHECK(saved.Load(binaryFilename));
+        if (saved.LayerCount() == 1) {
+          const TiledMap::Layer& savedLayer = saved.GetLayer(0);
+          CHECK(savedLayer.size == glm::ivec2(48, 32));
+          CHECK(savedLayer.At(1, 1) == 9);
+          CHECK(savedLayer.At(0, 0) == 1);
+          CHECK(savedLayer.At(15, 47) == 2);
+          CHECK(savedLayer.At(31, 31) == 3);
+          CHECK(savedLayer.At(16, 0) == 0);
+          CHECK(savedLayer.At(31, 47) == 0);
+        }
+      }
+    }
+  }
+  remove(mapFilename);
+  remove(binaryFilename);
+  Texture::Finalize();
+  RenderBackend::Set(nullptr);
+}
+
+/**
+* バイナリ形式のマップを、読み込んだファイルへ上書き保存できることを確認する.
+*/
+void TestTiledMapSaveInPlace()
+{
+  RenderBackend::Set(RenderBackend::NullBackend::Create());
+  CHECK(Texture::Initialize());
+  CHECK(WriteMap(8, 4));
+  CHECK(TiledMap::Convert(mapFilename, binaryFilename));
+  {
+    TiledMap tiledMap;
+    CHECK(tiledMap.Load(binaryFilename));
+    CHECK(tiledMap.LayerCount() == 1);
+    if (tiledMap.LayerCount() == 1) {
+      tiledMap.GetLayer(0).Set(0, 0, 5);
+      CHECK(tiledMap.Save(binaryFilename));
+
+      // 保存後も変更したマップをそのまま使える.
+      const TiledMap::Layer& layer = tiledMap.GetLayer(0);
+      CHECK(layer.At(0, 0) == 5 && layer.At(3, 7) == 1);
+      tiledMap.GetLayer(0).Set(3, 7, 6);
+      CHECK(tiledMap.Save(binaryFilename));
+
+      TiledMap saved;
+      CHECK(saved.Load(binaryFilename));
+      if (saved.LayerCount() == 1) {
+        const TiledMap::Layer& savedLayer = saved.GetLayer(0);
+        CHECK(savedLayer.size == glm::ivec2(8, 4));
+        CHECK(savedLayer.At(0, 0) == 5);
+        CHECK(savedLayer.At(3, 7) == 6);
+        CHECK(savedLayer.At(1, 1) == 1);
+      }
+    }
+  }
+  // 一時ファイルは残らない.
+  FILE* fp = fopen((std::string(binaryFilename) + ".tmp").c_str(), "rb");
+  CHECK(fp == nullptr);
+  if (fp) {
+    fclose(fp);
+  }
+  remove(mapFilename);
+  remove(binaryFilename);
+  Texture::Finalize();
+  RenderBackend::Set(nullptr);
+}